@@ -43,13 +43,10 @@ void AmptEventReader::importEvent()
   parentInteraction->setType( ParticleType::getInteractionType());
   parentInteraction->setXYZT(0.0, 0.0, 0.0, 0.0);
   event.add(parentInteraction);
-  Long64_t ientry = LoadTree(entryIndex);
-  if (ientry < 0)
+  if (!readEntry())
     {
     postTaskEod();  return;
     }
-  nb = rootInputTreeChain()->GetEntry(entryIndex++);
-  nBytes += nb;
   if (nParticles > arraySize)
     {
     if (reportError(__FUNCTION__)) cout<< "nParticles: " << nParticles << "  exceeds capacity " << arraySize << endl;
@@ -124,21 +121,20 @@ void AmptEventReader::initInputTreeMapping()
   
   if (reportStart(__FUNCTION__))
     ;
-  TTree * tree = rootInputTreeChain();
-  tree->SetMakeClass(1);
-  tree->SetBranchAddress("eventNo", &eventNo, &b_eventNo);
-  tree->SetBranchAddress("mult",    &nParticles, &b_mult);
-  tree->SetBranchAddress("Nproj",   &Nproj, &b_Nproj);
-  tree->SetBranchAddress("Ntarg",   &Ntarg, &b_Ntarg);
-  tree->SetBranchAddress("impact",  &impact, &b_impact);
-  tree->SetBranchAddress("Nparttotal", &nPartTotal, &b_nPartTotal);
-  tree->SetBranchAddress("pid", pid, &b_pid);
-  tree->SetBranchAddress("px", px, &b_px);
-  tree->SetBranchAddress("py", py, &b_py);
-  tree->SetBranchAddress("pz", pz, &b_pz);
-  tree->SetBranchAddress("m", m, &b_m);
-  tree->SetBranchAddress("Nx", Nx, &b_Nx);
-  tree->SetBranchAddress("Ny", Ny, &b_Ny);
+  rootInputTreeChain()->SetMakeClass(1);
+  setBranchAddress("eventNo", &eventNo, &b_eventNo);
+  setBranchAddress("mult", &nParticles, &b_mult);
+  setBranchAddress("Nproj", &Nproj, &b_Nproj);
+  setBranchAddress("Ntarg", &Ntarg, &b_Ntarg);
+  setBranchAddress("impact", &impact, &b_impact);
+  setBranchAddress("Nparttotal", &nPartTotal, &b_nPartTotal);
+  setBranchAddress("pid", pid, nParticles, &b_pid);
+  setBranchAddress("px", px, nParticles, &b_px);
+  setBranchAddress("py", py, nParticles, &b_py);
+  setBranchAddress("pz", pz, nParticles, &b_pz);
+  setBranchAddress("m", m, nParticles, &b_m);
+  setBranchAddress("Nx", Nx, nParticles, &b_Nx);
+  setBranchAddress("Ny", Ny, nParticles, &b_Ny);
   if (reportEnd(__FUNCTION__))
     ;
 }
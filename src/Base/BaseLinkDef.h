@@ -13,6 +13,7 @@
 #pragma link C++ class CAP::XmlParser+;
 #pragma link C++ class CAP::XmlDocument+;
 #pragma link C++ class CAP::Collection<TH1>+;
+#pragma link C++ class CAP::HistogramAccumulator+;
 #pragma link C++ class CAP::HistogramCollection+;
 #pragma link C++ class CAP::HistogramGroup+;
 #pragma link C++ class CAP::HistogramManager+;
@@ -20,6 +21,7 @@
 
 //#pragma link C++ class CAP::MomentumGenerator+;
 #pragma link C++ class CAP::RandomGenerator+;
+#pragma link C++ class CAP::RandomStream+;
 #pragma link C++ class CAP::SelectionGenerator+;
 #pragma link C++ class CAP::ScalarIntRandomGenerator+;
 #pragma link C++ class CAP::FixedScalarIntRandomGenerator+;
@@ -0,0 +1,54 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#include "HistogramAccumulator.hpp"
+#include "Exceptions.hpp"
+
+using CAP::HistogramAccumulator;
+
+ClassImp(HistogramAccumulator);
+
+HistogramAccumulator::HistogramAccumulator(TH1 * _histogram)
+:
+histogram(_histogram),
+contents(),
+entries(0.0),
+strideX(0),
+strideY(0)
+{
+  if (!histogram) throw CAP::HistogramException("nullptr","Cannot create accumulator for a null histogram","HistogramAccumulator::HistogramAccumulator()");
+  strideX = histogram->GetNbinsX()+2;
+  strideY = histogram->GetNbinsY()+2;
+  contents.assign(histogram->GetNcells(),0.0);
+}
+
+void HistogramAccumulator::flush()
+{
+  unsigned int nCells = contents.size();
+  for (unsigned int iCell=0; iCell<nCells; iCell++)
+    {
+    double & content = contents[iCell];
+    if (content==0.0) continue;
+    histogram->AddBinContent(iCell,content);
+    content = 0.0;
+    }
+  if (entries!=0.0)
+    {
+    histogram->SetEntries(histogram->GetEntries()+entries);
+    entries = 0.0;
+    }
+}
+
+void HistogramAccumulator::reset()
+{
+  contents.assign(contents.size(),0.0);
+  entries = 0.0;
+}
@@ -0,0 +1,112 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#ifndef CAP__HistogramAccumulator
+#define CAP__HistogramAccumulator
+#include <vector>
+#include "TH1.h"
+
+namespace CAP
+{
+
+//!
+//! Dense accumulation buffer bound to a TH1, TH2, or TH3 histogram. Fill kernels add weights to the (double precision) buffer
+//! with the global bin numbering of the histogram, i.e., ix + (nx+2)*(iy + (ny+2)*iz), and count the entries filled, without any
+//! call to the histogram. The content of the buffer is added to the histogram, and the buffer zeroed, by flush().
+//!
+//! Accumulators are created with HistogramCollection::createAccumulator() (thus available to all HistogramGroup classes) and flushed
+//! automatically by the collection before its histograms are scaled, exported, or added to other histograms. Since each task clone
+//! owns its histogram groups, each thread then fills its own buffers and no locking is needed.
+//!
+class HistogramAccumulator
+{
+public:
+
+  //!
+  //! Create an accumulator bound to the given histogram. The buffer has the size (including under and overflow bins) of the histogram.
+  //!
+  HistogramAccumulator(TH1 * _histogram);
+
+  virtual ~HistogramAccumulator() {}
+
+  //!
+  //! Add the given weight to the given global bin.
+  //!
+  inline void add(int globalBin, double weight)
+  {
+  contents[globalBin] += weight;
+  }
+
+  //!
+  //! Add the given number of entries.
+  //!
+  inline void addEntries(double n)
+  {
+  entries += n;
+  }
+
+  inline int getBin(int ix) const
+  {
+  return ix;
+  }
+
+  inline int getBin(int ix, int iy) const
+  {
+  return ix + strideX*iy;
+  }
+
+  inline int getBin(int ix, int iy, int iz) const
+  {
+  return ix + strideX*(iy + strideY*iz);
+  }
+
+  //!
+  //! Returns the raw buffer, for use in hot loops.
+  //!
+  inline double * getArray()
+  {
+  return contents.data();
+  }
+
+  inline TH1 * getHistogram() const
+  {
+  return histogram;
+  }
+
+  inline double getEntries() const
+  {
+  return entries;
+  }
+
+  //!
+  //! Add the content and entries of this accumulator to its histogram and zero the buffer.
+  //!
+  void flush();
+
+  //!
+  //! Zero the buffer and entries without modifying the histogram.
+  //!
+  void reset();
+
+protected:
+
+  TH1 * histogram;
+  std::vector<double> contents;
+  double entries;
+  int strideX;
+  int strideY;
+
+  ClassDef(HistogramAccumulator,0)
+};
+
+} // namespace CAP
+
+#endif /* CAP__HistogramAccumulator */
@@ -9,10 +9,16 @@
  * Author: Claude Pruneau,   04/01/2022
  *
  * *********************************************************************/
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <algorithm>
 #include "HistogramCollection.hpp"
+#include "RandomStream.hpp"
 #include "TKey.h"
 
 using CAP::HistogramCollection;
+using CAP::HistogramAccumulator;
 using CAP::String;
 
 ClassImp(CAP::Collection<TH1>);
@@ -65,7 +71,9 @@ HistogramCollection & HistogramCollection::operator=(const HistogramCollection &
 }
 
 HistogramCollection::~HistogramCollection()
-{   }
+{
+  for (unsigned int k=0; k<accumulators.size(); k++) delete accumulators[k];
+}
 
 
 
@@ -78,10 +86,23 @@ void HistogramCollection::reset()
   if (reportStart(__FUNCTION__))
     ;
   for (unsigned int iObject=0; iObject<size(); iObject++) objects[iObject]->Reset();
+  for (unsigned int k=0; k<accumulators.size(); k++) accumulators[k]->reset();
   if (reportEnd(__FUNCTION__))
     ;
 }
 
+HistogramAccumulator * HistogramCollection::createAccumulator(TH1 * h)
+{
+  HistogramAccumulator * accumulator = new HistogramAccumulator(h);
+  accumulators.push_back(accumulator);
+  return accumulator;
+}
+
+void HistogramCollection::flushAccumulators() const
+{
+  for (unsigned int k=0; k<accumulators.size(); k++) accumulators[k]->flush();
+}
+
 //!
 //! Create 1D histogram
 //!
@@ -262,6 +283,7 @@ void HistogramCollection::addHistogramsToExtList(TList *list)
 
   if (reportDebug(__FUNCTION__))
     cout << "Adding histo to external list"  << endl;
+  flushAccumulators();
   for (unsigned int iObject=0; iObject<size(); iObject++) list->Add(objects[iObject]);
   /* the instance stops the histograms ownership */
   setOwnership(false);
@@ -278,6 +300,7 @@ void HistogramCollection::exportHistograms(TFile & outputFile)
     ;
   if (reportDebug(__FUNCTION__)) cout << "    Saving histograms to file: " << outputFile.GetName()  << endl;
   if (reportDebug(__FUNCTION__)) cout << " Number of histograms to save: " <<  size() << endl;
+  flushAccumulators();
   outputFile.cd();
   for (unsigned int iObject=0; iObject<size(); iObject++)
     {
@@ -320,6 +343,7 @@ void HistogramCollection::scale(double factor)
 {
   if (reportStart(__FUNCTION__))
     { }
+  flushAccumulators();
   for (unsigned int iObject=0; iObject<size(); iObject++)
     {
     TH1 * h = objects[iObject];
@@ -377,6 +401,8 @@ void HistogramCollection::add(const HistogramCollection & c1, double a1)
 
   if (reportStart(__FUNCTION__))
     ;
+  flushAccumulators();
+  c1.flushAccumulators();
   if (!sameSizeAs(c1))
     {
     if (reportError(__FUNCTION__) )
@@ -837,25 +863,30 @@ void HistogramCollection::squareDifferenceCollection(const HistogramCollection &
     }
   for (unsigned int iObject=0; iObject<size(); iObject++)
     {
-    TH1* hAvg = objects[iObject];
-    TH1* h    = collection.objects[iObject];
-    if (!hAvg || !h)
-      {
-      if (reportWarning(__FUNCTION__) )
-        cout << " Histogram null pointers detected at iObject:" << iObject << endl;
-      continue;
-      }
-    if (!sameDimensions(__FUNCTION__,hAvg,h)) return;
-    if (reportDebug(__FUNCTION__) )
-      {
-      cout << "At iObject:" << iObject << " Computing square difference of  histogram " << hAvg->GetName() << " and histogram " << h->GetName() << endl;
-      }
-    squareDifferenceHistos(hAvg, h, sumWeights, weight, n);
+    if (!squareDifferenceHisto(iObject, collection.objects[iObject], sumWeights, weight, n)) return;
     }
   if (reportEnd(__FUNCTION__))
     ;
 }
 
+bool HistogramCollection::squareDifferenceHisto(unsigned int iObject, TH1 * h, double sumWeights, double weight, int n)
+{
+  TH1* hAvg = objects[iObject];
+  if (!hAvg || !h)
+    {
+    if (reportWarning(__FUNCTION__) )
+      cout << " Histogram null pointers detected at iObject:" << iObject << endl;
+    return true;
+    }
+  if (!sameDimensions(__FUNCTION__,hAvg,h)) return false;
+  if (reportDebug(__FUNCTION__) )
+    {
+    cout << "At iObject:" << iObject << " Computing square difference of  histogram " << hAvg->GetName() << " and histogram " << h->GetName() << endl;
+    }
+  squareDifferenceHistos(hAvg, h, sumWeights, weight, n);
+  return true;
+}
+
 
 void HistogramCollection::squareDifferenceHistos(TH1 *hAvg, TH1 *h, double sumWeights, double weight, int n)
 {
@@ -2279,8 +2310,8 @@ int  HistogramCollection::calculateQ3DwPtPhiY(double pt1, double phi1, double y1
   double p1z   = mt1 * sinh(y1);
   double mt2   = sqrt(mSq + pt2*pt2);
   double p2z   = mt2 * sinh(y2);
-  p1.SetPtEtaPhiM(pt1*cos(phi1),pt1*sin(phi1),p1z,mPart);
-  p2.SetPtEtaPhiM(pt2*cos(phi2),pt2*sin(phi2),p2z,mPart);
+  p1.SetXYZM(pt1*cos(phi1),pt1*sin(phi1),p1z,mPart);
+  p2.SetXYZM(pt2*cos(phi2),pt2*sin(phi2),p2z,mPart);
 
   if (p1.P()>p1.E()) return 1;
   if (p2.P()>p2.E()) return 2;
@@ -2332,138 +2363,290 @@ int  HistogramCollection::calculateQ3DwPtPhiY(double pt1, double phi1, double y1
 }
 
 
-// Calculate n1n1 Q3D based on h2(y,pt) x h2(y,pt)
-void HistogramCollection::calculateN1N1H2H2_Q3D_MCY(TH2 * n1_1, TH2 * n1_2, TH3 * n1n1_Q3D, double a1 __attribute__((unused)), double a2 __attribute__((unused)))
-{
-
-  if (reportStart(__FUNCTION__))
-    ;
-  if (!ptrExist(__FUNCTION__,n1_1,n1_2,n1n1_Q3D)) return;
-  if (!sameDimensions(__FUNCTION__,n1_1,n1_2)) return;
+//!
+//! Pairs of the n1n1 Q3D calculations are pion pairs: particles of given (eta or y, pt) at azimuth 0 are stored with their
+//! energy and longitudinal momentum, and the pair variables are calculated directly from the momenta.
+//!
+static const double q3dPionMass = 0.13957;
 
-  double Qlong, Qout, Qside;
-  double pt1, phi1, y1;
-  double pt2, phi2, y2;
-  int nIter = 100000000;
+struct Q3DPoint
+{
+  double pt;
+  double pz;
+  double e;
+  double weight;
+};
 
-  //double ss = 2.0/double(n1n1_Q3D->GetNbinsX());
-  double avgN1 = n1_1->Integral();
-  double avgN2 = n1_2->Integral();
+static void setQ3DMomentum(double x, double pt, bool useRapidity, Q3DPoint & point)
+{
+  double mSq = q3dPionMass*q3dPionMass;
+  point.pt = pt;
+  if (useRapidity)
+    {
+    double mt = sqrt(mSq + pt*pt);
+    point.pz  = mt*sinh(x);
+    point.e   = mt*cosh(x);
+    }
+  else
+    {
+    point.pz  = pt*sinh(x);
+    point.e   = sqrt(mSq + pt*pt + point.pz*point.pz);
+    }
+}
 
-  if (reportDebug(__FUNCTION__))
+//!
+//! (Qlong, Qout, Qside) of a particle of momentum (pt1, 0, pz1) and a particle of momentum (px2, py2, pz2), as in calculateQ3DwPtPhiEta.
+//!
+static void calculateQ3D(const Q3DPoint & p1, const Q3DPoint & p2, double px2, double py2,
+                         double & Qlong, double & Qout, double & Qside)
+{
+  double ptot[4], q[4];
+  ptot[0] = p1.e  + p2.e;
+  ptot[1] = p1.pt + px2;
+  ptot[2] = py2;
+  ptot[3] = p1.pz + p2.pz;
+  q[0] = p1.e  - p2.e;
+  q[1] = p1.pt - px2;
+  q[2] = -py2;
+  q[3] = p1.pz - p2.pz;
+  double ptSq  = ptot[1]*ptot[1] + ptot[2]*ptot[2];
+  double s     = ptot[0]*ptot[0] - ptSq - ptot[3]*ptot[3];
+  double pt    = sqrt(ptSq);
+  double Mlong = sqrt(s+ptSq);
+  if (pt>0)
     {
-    cout << endl;
-    cout << "   avgN1: " << avgN1 << endl;
-    cout << "   avgN2: " << avgN2 << endl;
+    Qside = (ptot[1]*q[2]-ptot[2]*q[1])/pt;
+    Qlong = (ptot[0]*q[3]-ptot[3]*q[0])/Mlong;
+    Qout  = (sqrt(s)/Mlong)*(ptot[1]*q[1]+ptot[2]*q[2])/pt;
+    }
+  else
+    {
+    Qlong = q[3];
+    Qside = q[2];
+    Qout  = q[1];
     }
+}
 
-  double scalingFactor = avgN1*avgN2/double(nIter);
+//!
+//! Draws (x,pt) from the bins of positive content of a 2D histogram, uniformly within the selected bin, as TH2::GetRandom2 does.
+//! The sampler is read only once built and can be shared by threads.
+//!
+struct Q3DSampler
+{
+  vector<double> cumulative;
+  vector<double> xLow;
+  vector<double> xWidth;
+  vector<double> yLow;
+  vector<double> yWidth;
 
-  for (int k=0;k<nIter;k++)
+  void build(const TH2 * h)
+  {
+  double sum = 0.0;
+  for (int iX=1; iX<=h->GetNbinsX(); iX++)
     {
-    n1_1->GetRandom2 (y1, pt1);
-    n1_2->GetRandom2 (y2, pt2);
-    phi1 = 2.0*CAP::Math::pi() * gRandom->Rndm();
-    phi2 = 2.0*CAP::Math::pi() * gRandom->Rndm();
-    bool status = calculateQ3DwPtPhiY(pt1, phi1, y1, pt2, phi2, y2, Qlong, Qout, Qside);
-    if (status==0)
+    for (int iY=1; iY<=h->GetNbinsY(); iY++)
       {
-      n1n1_Q3D->Fill(Qlong, Qside, Qout, 1.0);
+      double v = h->GetBinContent(iX,iY);
+      if (v<=0.0) continue;
+      sum += v;
+      cumulative.push_back(sum);
+      xLow.push_back(h->GetXaxis()->GetBinLowEdge(iX));
+      xWidth.push_back(h->GetXaxis()->GetBinWidth(iX));
+      yLow.push_back(h->GetYaxis()->GetBinLowEdge(iY));
+      yWidth.push_back(h->GetYaxis()->GetBinWidth(iY));
       }
     }
-  n1n1_Q3D->Scale(scalingFactor);
+  }
+
+  void sample(double u0, double u1, double u2, double & x, double & y) const
+  {
+  unsigned int index = std::upper_bound(cumulative.begin(),cumulative.end(),u0*cumulative.back()) - cumulative.begin();
+  if (index>=cumulative.size()) index = cumulative.size()-1;
+  x = xLow[index] + u1*xWidth[index];
+  y = yLow[index] + u2*yWidth[index];
+  }
+};
+
+// Calculate n1n1 Q3D based on h2(y,pt) x h2(y,pt)
+void HistogramCollection::calculateN1N1H2H2_Q3D_MCY(TH2 * n1_1, TH2 * n1_2, TH3 * n1n1_Q3D, double a1 __attribute__((unused)), double a2 __attribute__((unused)), long nIter, int nThreads)
+{
+  if (reportStart(__FUNCTION__))
+    ;
+  calculateN1N1H2H2_Q3D_MC(n1_1,n1_2,n1n1_Q3D,true,nIter,nThreads);
 }
 
 // Calculate n1n1 Q3D based on h2(eta,pt) x h2(eta,pt)
-void HistogramCollection::calculateN1N1H2H2_Q3D_MCEta(TH2 * n1_1, TH2 * n1_2, TH3 * n1n1_Q3D, double a1 __attribute__((unused)), double a2 __attribute__((unused)))
+void HistogramCollection::calculateN1N1H2H2_Q3D_MCEta(TH2 * n1_1, TH2 * n1_2, TH3 * n1n1_Q3D, double a1 __attribute__((unused)), double a2 __attribute__((unused)), long nIter, int nThreads)
 {
+  if (reportStart(__FUNCTION__))
+    ;
+  calculateN1N1H2H2_Q3D_MC(n1_1,n1_2,n1n1_Q3D,false,nIter,nThreads);
+}
 
+void HistogramCollection::calculateN1N1H2H2_Q3D_MC(TH2 * n1_1, TH2 * n1_2, TH3 * n1n1_Q3D, bool useRapidity, long nIter, int nThreads)
+{
   if (reportStart(__FUNCTION__))
     ;
   if (!ptrExist(__FUNCTION__,n1_1,n1_2,n1n1_Q3D)) return;
   if (!sameDimensions(__FUNCTION__,n1_1,n1_2)) return;
+  if (nIter<1) return;
 
-  double Qlong, Qout, Qside;
-  double pt1, phi1, eta1;
-  double pt2, phi2, eta2;
-  int nIter = 10000000;
-
-  double avgN1 = n1_1->Integral();
-  double avgN2 = n1_2->Integral();
-  if (reportDebug(__FUNCTION__))
+  Q3DSampler sampler1;
+  Q3DSampler sampler2;
+  sampler1.build(n1_1);
+  sampler2.build(n1_2);
+  if (sampler1.cumulative.size()<1 || sampler2.cumulative.size()<1)
     {
-    cout << "   avgN1: " << avgN1 << endl;
-    cout << "   avgN2: " << avgN2 << endl;
+    if (reportWarning(__FUNCTION__)) cout << "Empty single particle histogram. Abort." << endl;
+    return;
     }
+  double avgN1 = n1_1->Integral();
+  double avgN2 = n1_2->Integral();
   double scalingFactor = avgN1*avgN2/double(nIter);
 
-  for (int k=0;k<nIter;k++)
+  // pairs are drawn in blocks of blockSize: block iBlock uses the random stream (0xFFFFFFFE,iBlock)
+  const long blockSize = 1000000;
+  long nBlocks  = (nIter+blockSize-1)/blockSize;
+  int  nWorkers = (nThreads>0) ? nThreads : int(std::thread::hardware_concurrency());
+  if (nWorkers<1)       nWorkers = 1;
+  if (nWorkers>nBlocks) nWorkers = nBlocks;
+  if (reportDebug(__FUNCTION__))
     {
-    n1_1->GetRandom2 (eta1, pt1);
-    n1_2->GetRandom2 (eta2, pt2);
-    phi1 = 2.0*CAP::Math::pi() * gRandom->Rndm();
-    phi2 = 2.0*CAP::Math::pi() * gRandom->Rndm();
-    bool status = calculateQ3DwPtPhiEta(pt1, phi1, eta1, pt2, phi2, eta2, Qlong, Qout, Qside);
-    if (status==0)
-      {
-      n1n1_Q3D->Fill(Qlong, Qside, Qout, 1.0);
+    cout << endl;
+    cout << "       avgN1: " << avgN1 << endl;
+    cout << "       avgN2: " << avgN2 << endl;
+    cout << "       nIter: " << nIter << endl;
+    cout << "    nWorkers: " << nWorkers << endl;
+    }
+
+  vector<TH3*> buffers;
+  for (int iWorker=0; iWorker<nWorkers; iWorker++)
+    {
+    TH3 * buffer = (TH3*) n1n1_Q3D->Clone(Form("%s_Buffer%d",n1n1_Q3D->GetName(),iWorker));
+    buffer->SetDirectory(nullptr);
+    buffer->Reset();
+    buffers.push_back(buffer);
+    }
+
+  ULong64_t seed = CAP::RandomStream::deriveSeed(CAP::RandomStream::getBaseSeed(),0);
+  std::atomic<long> nBlocksClaimed(0);
+  vector<std::exception_ptr> exceptions(nWorkers);
+  auto run = [&](int iWorker)
+  {
+  try
+    {
+    TH3 & buffer = *buffers[iWorker];
+    CAP::RandomStream random;
+    Q3DPoint p1, p2;
+    double u[7];
+    double x1, pt1, x2, pt2, Qlong, Qout, Qside;
+    long iBlock;
+    while ((iBlock = nBlocksClaimed++) < nBlocks)
+      {
+      random.setStream(seed,(ULong64_t(0xFFFFFFFE)<<32)|ULong64_t(iBlock));
+      long n = std::min(blockSize,nIter-iBlock*blockSize);
+      for (long k=0; k<n; k++)
+        {
+        random.fillUniform(7,u);
+        sampler1.sample(u[0],u[1],u[2],x1,pt1);
+        sampler2.sample(u[3],u[4],u[5],x2,pt2);
+        setQ3DMomentum(x1,pt1,useRapidity,p1);
+        setQ3DMomentum(x2,pt2,useRapidity,p2);
+        // the pair variables only depend on the azimuth difference
+        double dphi = CAP::Math::twoPi()*u[6];
+        calculateQ3D(p1,p2,pt2*cos(dphi),pt2*sin(dphi),Qlong,Qout,Qside);
+        buffer.Fill(Qlong, Qside, Qout, 1.0);
+        }
       }
     }
+  catch (...)
+    {
+    exceptions[iWorker] = std::current_exception();
+    }
+  };
+  ROOT::EnableThreadSafety();
+  vector<std::thread> threads;
+  for (int iWorker=0; iWorker<nWorkers; iWorker++) threads.emplace_back(run,iWorker);
+  for (auto & thread : threads) thread.join();
+  for (auto buffer : buffers)
+    {
+    n1n1_Q3D->Add(buffer);
+    delete buffer;
+    }
+  for (auto & exception : exceptions)
+    {
+    if (exception) std::rethrow_exception(exception);
+    }
   n1n1_Q3D->Scale(scalingFactor);
 }
 
-// Calculate n1n1 Q3D based on h2(eta,pt) x h2(eta,pt)
-void HistogramCollection::calculateN1N1H2H2_Q3D(const TH2 * n1_1, const TH2 * n1_2, TH3 * n1n1_Q3D, double a1 __attribute__((unused)), double a2 __attribute__((unused)))
+// Calculate n1n1 Q3D based on h2(eta,pt) x h2(eta,pt), or h2(y,pt) x h2(y,pt)
+void HistogramCollection::calculateN1N1H2H2_Q3D(const TH2 * n1_1, const TH2 * n1_2, TH3 * n1n1_Q3D, double a1, double a2, bool useRapidity, int nPhi, int nSubBins)
 {
-
   if (reportStart(__FUNCTION__))
     ;
   if (!ptrExist(__FUNCTION__,n1_1,n1_2,n1n1_Q3D)) return;
   if (!sameDimensions(__FUNCTION__,n1_1,n1_2)) return;
-  int nx = n1_1->GetNbinsX();
-  int ny = n1_1->GetNbinsY();
-  double v1;
-  double v2;
-  double v3;
-  double Qlong, Qout, Qside;
-  double pt1, phi1, eta1;
-  double pt2, phi2, eta2;
-
-  for (int i1x=1;i1x<=nx;++i1x)
-    {
-    for (int i1y=1;i1y<=ny;++i1y)
-      {
-      for (int i2x=1;i2x<=nx;++i2x)
+  if (nPhi<1)     nPhi     = 1;
+  if (nSubBins<1) nSubBins = 1;
+
+  // points of each histogram: nSubBins x nSubBins points per bin of positive content
+  auto getPoints = [&](const TH2 * h, double a, vector<Q3DPoint> & points)
+  {
+  const TAxis * xAxis = h->GetXaxis();
+  const TAxis * yAxis = h->GetYaxis();
+  double subBinFraction = 1.0/double(nSubBins);
+  for (int iX=1; iX<=h->GetNbinsX(); iX++)
+    {
+    for (int iY=1; iY<=h->GetNbinsY(); iY++)
+      {
+      double v = a*h->GetBinContent(iX,iY);
+      if (v<=0.0) continue;
+      for (int iSubX=0; iSubX<nSubBins; iSubX++)
         {
-        for (int i2y=1;i2y<=ny;++i2y)
+        double x = xAxis->GetBinLowEdge(iX) + (0.5+iSubX)*subBinFraction*xAxis->GetBinWidth(iX);
+        for (int iSubY=0; iSubY<nSubBins; iSubY++)
           {
-          v1  = a1*n1_1->GetBinContent(i1x,i1y); //ev1 = a1*n1_1->GetBinError(i1x,i1y,i1z);
-          v2  = a2*n1_2->GetBinContent(i2x,i2y); //ev2 = a2*n1_2->GetBinError(i2x,i2y,i2z);
-          if (v1>0 && v2>0)
-            {
-            v3  = v1*v2;
-            for (int k=0;k<100000;k++)
-              {
-              phi1 = 2.0*CAP::Math::pi() * gRandom->Rndm();
-              phi2 = 2.0*CAP::Math::pi() * gRandom->Rndm();
-              eta1 = n1_1->GetXaxis()->GetBinCenter(i1x);
-              pt1  = n1_1->GetZaxis()->GetBinCenter(i1y);
-              eta2 = n1_2->GetXaxis()->GetBinCenter(i2x);
-              pt2  = n1_2->GetZaxis()->GetBinCenter(i2y);
-              bool status = calculateQ3DwPtPhiEta(pt1, phi1, eta1, pt2, phi2, eta2, Qlong, Qout, Qside);
-              if (status==0)
-                {
-                //cout << " i1x:" << i1x << " i1y: " << i1y << " i1z: " << i1z << " i2x:" << i1x << " i2y: " << i2y << " i2z: " << i2z << " v1: " << v1 << " v2: " << v2 << endl;
-                //cout << " pt1:" << pt1 << " phi1: " << phi1 << " eta1: " << eta1 << " pt2:" << pt2 << " phi2: " << phi2 << " eta2: " << eta2 << " Qlong:" << Qlong << " Qout:" << Qout << " Qside:" << Qside << " v3:" << v3 << endl;
-                n1n1_Q3D->Fill(Qlong, Qside, Qout, v3);
-                }
-              }
-            }
+          double pt = yAxis->GetBinLowEdge(iY) + (0.5+iSubY)*subBinFraction*yAxis->GetBinWidth(iY);
+          Q3DPoint point;
+          setQ3DMomentum(x,pt,useRapidity,point);
+          point.weight = v*subBinFraction*subBinFraction;
+          points.push_back(point);
           }
         }
       }
     }
+  };
+  vector<Q3DPoint> points1;
+  vector<Q3DPoint> points2;
+  getPoints(n1_1,a1,points1);
+  getPoints(n1_2,a2,points2);
 
+  // Particle 1 is at azimuth 0 and particle 2 at dphi. Nodes dphi and -dphi give the same Qlong and Qout and opposite Qside:
+  // only the nodes in (0,pi) are calculated.
+  vector<double> cosDphi(nPhi);
+  vector<double> sinDphi(nPhi);
+  for (int iPhi=0; iPhi<nPhi; iPhi++)
+    {
+    double dphi = CAP::Math::pi()*(0.5+iPhi)/double(nPhi);
+    cosDphi[iPhi] = cos(dphi);
+    sinDphi[iPhi] = sin(dphi);
+    }
+  double phiWeight = 0.5/double(nPhi);
+  double Qlong, Qout, Qside;
+  for (auto & p1 : points1)
+    {
+    for (auto & p2 : points2)
+      {
+      double w = p1.weight*p2.weight*phiWeight;
+      for (int iPhi=0; iPhi<nPhi; iPhi++)
+        {
+        calculateQ3D(p1,p2,p2.pt*cosDphi[iPhi],p2.pt*sinDphi[iPhi],Qlong,Qout,Qside);
+        n1n1_Q3D->Fill(Qlong,  Qside, Qout, w);
+        n1n1_Q3D->Fill(Qlong, -Qside, Qout, w);
+        }
+      }
+    }
 }
 
 void HistogramCollection::calculateN1N1H3H3_Q3D(const TH3 * n1_1, const TH3 * n1_2, TH3 * n1n1_Q3D, double a1, double a2)
@@ -31,6 +31,7 @@
 #include "TMath.h"
 #include "TRandom.h"
 #include "Collection.hpp"
+#include "HistogramAccumulator.hpp"
 #include "MessageLogger.hpp"
 #include "MathConstants.hpp"
 #include "MathBasicFunctions.hpp"
@@ -62,6 +63,18 @@ public:
 
   virtual void reset();
 
+  //!
+  //! Create an accumulation buffer bound to the given histogram of this collection. The accumulator is owned by this collection
+  //! and flushed into its histogram before the histograms are scaled, exported, or added. See HistogramAccumulator.
+  //!
+  HistogramAccumulator * createAccumulator(TH1 * h);
+
+  //!
+  //! Add the content of all accumulators of this collection to their histograms. The (logical) content of the collection is
+  //! not changed by this operation: it is thus const and may be called on collections being added to this collection.
+  //!
+  void flushAccumulators() const;
+
   TH1 * createHistogram(const String & name,
                         int n, double min_x, double max_x,
                         const String & title_x,
@@ -145,9 +158,23 @@ public:
   int  calculateQ3DwPtPhiY(double pt1, double phi1, double y1,
                            double pt2, double phi2, double y2,
                            double & Qlong, double & Qout, double & Qside);
-  void calculateN1N1H2H2_Q3D_MCY(TH2 * n1_1, TH2 * n1_2, TH3 * n1n1_Q3D, double a1, double a2);
-  void calculateN1N1H2H2_Q3D_MCEta(TH2 * n1_1, TH2 * n1_2, TH3 * n1n1_Q3D, double a1, double a2);
-  void calculateN1N1H2H2_Q3D(const TH2 * n1_1, const TH2 * n1_2, TH3 * n1n1_Q3D, double a1, double a2);
+
+  //!
+  //! Monte Carlo calculation of the n1n1 reference in (Qlong, Qside, Qout) from single particle densities vs (y,pt) (MCY) or (eta,pt) (MCEta).
+  //! Pairs are drawn nIter times with nThreads threads (default 1, 0: one per core), each filling its own copy of n1n1_Q3D. Pairs are drawn in blocks
+  //! with their own random stream (see RandomStream) so the result does not depend on the number of threads.
+  //!
+  void calculateN1N1H2H2_Q3D_MCY(TH2 * n1_1, TH2 * n1_2, TH3 * n1n1_Q3D, double a1, double a2, long nIter=100000000, int nThreads=1);
+  void calculateN1N1H2H2_Q3D_MCEta(TH2 * n1_1, TH2 * n1_2, TH3 * n1n1_Q3D, double a1, double a2, long nIter=10000000, int nThreads=1);
+  void calculateN1N1H2H2_Q3D_MC(TH2 * n1_1, TH2 * n1_2, TH3 * n1n1_Q3D, bool useRapidity, long nIter, int nThreads);
+
+  //!
+  //! Deterministic calculation of the n1n1 reference in (Qlong, Qside, Qout) from single particle densities vs (eta,pt), or vs (y,pt) if
+  //! useRapidity is true. The densities are convolved bin by bin, with nSubBins x nSubBins points per bin. The pair variables only depend on
+  //! the azimuth difference of the particles: the integral over the azimuth of the pair is done analytically, and the integral over the
+  //! azimuth difference with a midpoint rule of 2*nPhi points.
+  //!
+  void calculateN1N1H2H2_Q3D(const TH2 * n1_1, const TH2 * n1_2, TH3 * n1n1_Q3D, double a1, double a2, bool useRapidity=false, int nPhi=180, int nSubBins=1);
   void calculateN1N1H3H3_Q3D(const TH3 * n1_1, const TH3 * n1_2, TH3 * n1n1_Q3D, double a1, double a2);
   void calculateR2_Q3D(const TH3 * n2_Q3D, const TH3 * n1n1_Q3D, TH3 * R2_Q3D, double a1, double a2);
   double avgValue(TH1 * h);
@@ -264,6 +291,13 @@ public:
 
   void squareDifferenceCollection(const HistogramCollection & collection, double sumWeights, double weight, int n);
 
+  //!
+  //! Same as squareDifferenceCollection() for the single histogram h compared to the histogram at the given index of this collection. Used to
+  //! stream the histograms of a file into the accumulated collection one at a time. Returns false if the dimensions of the histograms differ, in
+  //! which case squareDifferenceCollection() skips the remaining histograms of the collection.
+  //!
+  bool squareDifferenceHisto(unsigned int iObject, TH1 * h, double sumWeights, double weight, int n);
+
   //!
   //! Span all bins of hAvg and h and  compute the difference between histo "h" and the reference "havg", and increment the value
   //! havg accordingly. HistogramGroup must have the same exact dimensions. The histograms may be profiles.
@@ -336,6 +370,10 @@ public:
   bool ptrExist(const TH1 * h1, const TH1 * h2, const TH1 * h3, const TH1 * h4, const TH1 * h5, const TH1 * h6, const TH1 * h7, const TH1 * h8, const TH1 * h9, const TH1 * h10, const TH1 * h11) const;
   bool ptrExist(const TH1 * h1, const TH1 * h2, const TH1 * h3, const TH1 * h4, const TH1 * h5, const TH1 * h6, const TH1 * h7, const TH1 * h8, const TH1 * h9, const TH1 * h10, const TH1 * h11, const TH1 * h12) const;
 
+protected:
+
+  std::vector<HistogramAccumulator*> accumulators;
+
   ClassDef(HistogramCollection,1);
 
 }; // HistogramCollection
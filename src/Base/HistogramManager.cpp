@@ -140,3 +140,21 @@ void CAP::HistogramManager::scale(double scalingFactor)
       }
     }
 }
+
+//!
+//!Add the histograms of all sets and groups of the given manager to the corresponding histograms of this manager.
+//!
+void CAP::HistogramManager::add(const HistogramManager & manager)
+{
+  if (sets.size()!=manager.sets.size())
+    throw HistogramException("sets","Incompatible number of sets","HistogramManager::add(const HistogramManager & manager)");
+  for (unsigned int iSet=0; iSet<sets.size(); iSet++)
+    {
+    if (sets[iSet].size()!=manager.sets[iSet].size())
+      throw HistogramException(names[iSet],"Incompatible number of groups","HistogramManager::add(const HistogramManager & manager)");
+    for (unsigned int iGroup=0; iGroup<sets[iSet].size(); iGroup++)
+      {
+      sets[iSet][iGroup]->add(*manager.sets[iSet][iGroup],1.0);
+      }
+    }
+}
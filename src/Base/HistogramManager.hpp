@@ -86,6 +86,12 @@ public:
   //!
   void scale(double scalingFactor);
 
+  //!
+  //!Add the histograms of all sets and groups of the given manager to the corresponding histograms of this manager.
+  //!Both managers must hold the same number of sets and groups, e.g., a manager and the manager of a clone of the same task.
+  //!
+  void add(const HistogramManager & manager);
+
   inline int getNSets()
   {
   return sets.size();
@@ -101,6 +107,11 @@ public:
   return sets[iSet][iGroup];
   }
 
+  inline const HistogramGroup * getGroup(unsigned int iSet, unsigned int iGroup) const
+  {
+  return sets[iSet][iGroup];
+  }
+
 
   ClassDef(HistogramManager,0)
 };
@@ -10,6 +10,7 @@
  *
  * *********************************************************************/
 #include "RandomGenerators.hpp"
+#include "RandomStream.hpp"
 
 using CAP::RandomGenerator;
 using CAP::ScalarIntRandomGenerator;
@@ -167,7 +168,8 @@ histogram (theHistogram)
 // Always return the same selected value
 double  HistoScalarDoubleRandomGenerator::generate()
 {
-  return histogram->GetRandom();
+  // TH1::GetRandom() without argument uses gRandom, which is shared by all threads.
+  return histogram->GetRandom(CAP::RandomStream::getRandomStream());
 }
 
 ClassImp(VectorRandomGenerator);
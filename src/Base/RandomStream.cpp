@@ -0,0 +1,344 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#include <cmath>
+#include <algorithm>
+#include "RandomStream.hpp"
+
+ClassImp(CAP::RandomStream);
+
+namespace CAP
+{
+
+ULong64_t RandomStream::baseSeed = 1121331;
+thread_local RandomStream * RandomStream::randomStream = nullptr;
+
+RandomStream::RandomStream(ULong64_t _seed, ULong64_t _streamIndex)
+:
+TRandom(),
+streamSeed(0),
+streamIndex(0),
+counter(0),
+block(),
+blockIndex(blockSize)
+{
+  SetName("RandomStream");
+  SetTitle("Counter based random number stream (Philox4x32-10)");
+  setStream(_seed,_streamIndex);
+}
+
+void RandomStream::setStream(ULong64_t _seed, ULong64_t _streamIndex)
+{
+  streamSeed  = _seed;
+  streamIndex = _streamIndex;
+  counter     = 0;
+  blockIndex  = blockSize;
+  fSeed       = UInt_t(streamSeed);
+}
+
+void RandomStream::setPosition(ULong64_t position)
+{
+  counter    = position/blockSize;
+  blockIndex = blockSize;
+  int offset = position%blockSize;
+  if (offset>0)
+    {
+    generateBlock();
+    blockIndex = offset;
+    }
+}
+
+//!
+//! Philox4x32 with 10 rounds (Salmon et al., SC11). The 128 bits counter holds the position in the
+//! stream (low 64 bits) and the stream index (high 64 bits); the 64 bits key is the stream seed.
+//!
+void RandomStream::generateBlock()
+{
+  const ULong64_t m0 = 0xD2511F53;
+  const ULong64_t m1 = 0xCD9E8D57;
+  const UInt_t    w0 = 0x9E3779B9;
+  const UInt_t    w1 = 0xBB67AE85;
+  UInt_t c0 = UInt_t(counter);
+  UInt_t c1 = UInt_t(counter>>32);
+  UInt_t c2 = UInt_t(streamIndex);
+  UInt_t c3 = UInt_t(streamIndex>>32);
+  UInt_t k0 = UInt_t(streamSeed);
+  UInt_t k1 = UInt_t(streamSeed>>32);
+  for (int iRound=0; iRound<10; iRound++)
+    {
+    ULong64_t p0 = m0*c0;
+    ULong64_t p1 = m1*c2;
+    UInt_t n0 = UInt_t(p1>>32)^c1^k0;
+    UInt_t n1 = UInt_t(p1);
+    UInt_t n2 = UInt_t(p0>>32)^c3^k1;
+    UInt_t n3 = UInt_t(p0);
+    c0 = n0; c1 = n1; c2 = n2; c3 = n3;
+    k0 += w0;
+    k1 += w1;
+    }
+  block[0] = c0;
+  block[1] = c1;
+  block[2] = c2;
+  block[3] = c3;
+  blockIndex = 0;
+  counter++;
+}
+
+Double_t RandomStream::Rndm()
+{
+  return nextUniform();
+}
+
+void RandomStream::RndmArray(Int_t n, Float_t * array)
+{
+  for (Int_t k=0; k<n; k++) array[k] = Float_t(nextUniform());
+}
+
+void RandomStream::RndmArray(Int_t n, Double_t * array)
+{
+  for (Int_t k=0; k<n; k++) array[k] = nextUniform();
+}
+
+void RandomStream::SetSeed(ULong_t seed)
+{
+  setStream(seed,streamIndex);
+}
+
+void RandomStream::fillUniform(int n, double * buffer)
+{
+  for (int k=0; k<n; k++) buffer[k] = nextUniform();
+}
+
+void RandomStream::fillUniform(int n, double * buffer, double minimum, double maximum)
+{
+  double range = maximum - minimum;
+  for (int k=0; k<n; k++) buffer[k] = minimum + range*nextUniform();
+}
+
+//!
+//! Box-Muller transform: both deviates of each pair are used.
+//!
+void RandomStream::fillGaussian(int n, double * buffer, double mean, double sigma)
+{
+  const double twoPi = 6.283185307179586;
+  int k = 0;
+  while (k<n)
+    {
+    double r   = sigma*sqrt(-2.0*log(nextUniform()));
+    double phi = twoPi*nextUniform();
+    buffer[k++] = mean + r*cos(phi);
+    if (k<n) buffer[k++] = mean + r*sin(phi);
+    }
+}
+
+long RandomStream::binomial(long n, double p)
+{
+  if (n<=0 || p<=0.0) return 0;
+  if (p>=1.0) return n;
+  double r = (p<=0.5) ? p : 1.0-p;
+  long   k = (n*r<30.0) ? binomialInversion(n,r) : binomialBtpe(n,r);
+  return (p<=0.5) ? k : n-k;
+}
+
+//!
+//! Sequential search from k=0, restarted if k exceeds the mean by more than 10 standard deviations (where the remaining
+//! probability is negligible but rounding errors accumulate). Expects p<=0.5 and n*p<30.
+//!
+long RandomStream::binomialInversion(long n, double p)
+{
+  double q     = 1.0 - p;
+  double q2n   = exp(n*log(q));
+  double np    = n*p;
+  double bound = std::min(double(n), np + 10.0*sqrt(np*q+1.0));
+  long   k     = 0;
+  double pk    = q2n;
+  double u     = nextUniform();
+  while (u>pk)
+    {
+    k++;
+    if (k>bound)
+      {
+      k  = 0;
+      pk = q2n;
+      u  = nextUniform();
+      }
+    else
+      {
+      u -= pk;
+      pk = ((n-k+1)*p*pk)/(k*q);
+      }
+    }
+  return k;
+}
+
+//!
+//! BTPE algorithm: the distribution is majorized by a triangle centered on the mode, two parallelograms, and two exponential
+//! tails. Points accepted by the majorizing function are tested against the binomial probability, explicitly when close to
+//! the mode, or with Stirling's approximation of the factorials otherwise. Expects p<=0.5 and n*p>=30.
+//!
+long RandomStream::binomialBtpe(long n, double p)
+{
+  double q    = 1.0 - p;
+  double fm   = n*p + p;
+  long   m    = long(floor(fm));
+  double p1   = floor(2.195*sqrt(n*p*q) - 4.6*q) + 0.5;
+  double xm   = m + 0.5;
+  double xl   = xm - p1;
+  double xr   = xm + p1;
+  double c    = 0.134 + 20.5/(15.3 + m);
+  double a    = (fm - xl)/(fm - xl*p);
+  double laml = a*(1.0 + a/2.0);
+  a           = (xr - fm)/(xr*q);
+  double lamr = a*(1.0 + a/2.0);
+  double p2   = p1*(1.0 + 2.0*c);
+  double p3   = p2 + c/laml;
+  double p4   = p3 + c/lamr;
+  double nrq  = n*p*q;
+  for (;;)
+    {
+    double u = nextUniform()*p4;
+    double v = nextUniform();
+    long   y;
+    if (u<=p1)
+      {
+      // triangular region: accepted immediately
+      return long(floor(xm - p1*v + u));
+      }
+    else if (u<=p2)
+      {
+      // parallelograms
+      double x = xl + (u - p1)/c;
+      v = v*c + 1.0 - fabs(m - x + 0.5)/p1;
+      if (v>1.0) continue;
+      y = long(floor(x));
+      }
+    else if (u<=p3)
+      {
+      // left exponential tail
+      y = long(floor(xl + log(v)/laml));
+      if (y<0) continue;
+      v = v*(u - p2)*laml;
+      }
+    else
+      {
+      // right exponential tail
+      y = long(floor(xr - log(v)/lamr));
+      if (y>n) continue;
+      v = v*(u - p3)*lamr;
+      }
+
+    long k = (y>m) ? y-m : m-y;
+    if (k<=20 || k>=nrq/2.0-1.0)
+      {
+      // explicit evaluation of f(y)/f(m)
+      double s = p/q;
+      a = s*(n + 1);
+      double f = 1.0;
+      if (m<y)
+        for (long i=m+1; i<=y; i++) f *= (a/i - s);
+      else if (m>y)
+        for (long i=y+1; i<=m; i++) f /= (a/i - s);
+      if (v<=f) return y;
+      continue;
+      }
+
+    // squeeze using upper and lower bounds of log(f(y)/f(m))
+    double rho = (k/nrq)*((k*(k/3.0 + 0.625) + 0.1666666666666667)/nrq + 0.5);
+    double t   = -k*double(k)/(2.0*nrq);
+    double lv  = log(v);
+    if (lv<t-rho) return y;
+    if (lv>t+rho) continue;
+
+    // final acceptance test with Stirling's formula
+    double x1 = y + 1;
+    double f1 = m + 1;
+    double z  = n + 1 - m;
+    double w  = n - y + 1;
+    double x2 = x1*x1;
+    double f2 = f1*f1;
+    double z2 = z*z;
+    double w2 = w*w;
+    double bound = xm*log(f1/x1) + (n - m + 0.5)*log(z/w) + (y - m)*log(w*p/(x1*q))
+    + (13680.0 - (462.0 - (132.0 - (99.0 - 140.0/f2)/f2)/f2)/f2)/f1/166320.0
+    + (13680.0 - (462.0 - (132.0 - (99.0 - 140.0/z2)/z2)/z2)/z2)/z/166320.0
+    + (13680.0 - (462.0 - (132.0 - (99.0 - 140.0/x2)/x2)/x2)/x2)/x1/166320.0
+    + (13680.0 - (462.0 - (132.0 - (99.0 - 140.0/w2)/w2)/w2)/w2)/w/166320.0;
+    if (lv<=bound) return y;
+    }
+}
+
+void RandomStream::multinomial(long n, int nCategories, const double * probabilities, long * counts)
+{
+  double remainingProbability = 0.0;
+  for (int iCategory=0; iCategory<nCategories; iCategory++) remainingProbability += probabilities[iCategory];
+  for (int iCategory=0; iCategory<nCategories; iCategory++)
+    {
+    if (n<=0 || remainingProbability<=0.0)
+      {
+      counts[iCategory] = 0;
+      continue;
+      }
+    // the last category takes all the remaining trials, whatever the rounding of the remaining probability
+    if (iCategory==nCategories-1 && probabilities[iCategory]>0.0)
+      counts[iCategory] = n;
+    else
+      counts[iCategory] = binomial(n,probabilities[iCategory]/remainingProbability);
+    n -= counts[iCategory];
+    remainingProbability -= probabilities[iCategory];
+    }
+}
+
+Int_t RandomStream::Binomial(Int_t ntot, Double_t prob)
+{
+  return Int_t(binomial(ntot,prob));
+}
+
+//!
+//! SplitMix64 finalizer applied to the seed and each of the indices in turn.
+//!
+ULong64_t RandomStream::deriveSeed(ULong64_t seed, ULong64_t index1, ULong64_t index2)
+{
+  ULong64_t values[3] = { seed, index1, index2 };
+  ULong64_t h = 0;
+  for (int k=0; k<3; k++)
+    {
+    h ^= values[k];
+    h += 0x9E3779B97F4A7C15ULL;
+    h  = (h ^ (h>>30)) * 0xBF58476D1CE4E5B9ULL;
+    h  = (h ^ (h>>27)) * 0x94D049BB133111EBULL;
+    h ^= (h>>31);
+    }
+  return h;
+}
+
+void RandomStream::setBaseSeed(ULong64_t seed)
+{
+  baseSeed = seed;
+  if (randomStream) randomStream->setStream(deriveSeed(baseSeed,0),randomStream->getStreamIndex());
+}
+
+ULong64_t RandomStream::getBaseSeed()
+{
+  return baseSeed;
+}
+
+RandomStream * RandomStream::getRandomStream()
+{
+  if (!randomStream) randomStream = new RandomStream(deriveSeed(baseSeed,0),0);
+  return randomStream;
+}
+
+void RandomStream::selectRandomStream(ULong64_t index1, ULong64_t index2)
+{
+  getRandomStream()->setStream(deriveSeed(baseSeed,0),(index1<<32)|(index2&0xFFFFFFFF));
+}
+
+} // namespace CAP
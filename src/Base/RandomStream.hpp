@@ -0,0 +1,172 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#ifndef CAP__RandomStream
+#define CAP__RandomStream
+#include "TRandom.h"
+
+namespace CAP
+{
+
+//!
+//! Counter-based random number stream (Philox4x32-10). The i-th number of a stream is a pure function of the stream seed,
+//! the stream index, and i: streams with distinct seeds or indices are statistically independent and a stream can be
+//! re-positioned at will without any state to carry around. The class derives from TRandom so it can be used wherever
+//! a TRandom is expected (Gaus, Exp, Poisson, etc are inherited and draw from Rndm()).
+//!
+//! Each thread owns a stream obtained with getRandomStream(). It replaces gRandom in the generators, models, and decayers
+//! so that event chains executed concurrently (see TaskIterator) do not share any random number state. The stream of
+//! a thread is seeded from a base seed (the seed given to RunAna) and stream indices selected by TaskIterator:
+//! (0,iThread) for a thread, or (1+iBunch,iSubBunch) for a sub-bunch when partial saves are used, so that the events of
+//! a given sub-bunch do not depend on the thread that produced them. The upper 32 bits of the second index count the
+//! executions of the task iterators of the job, so a job running several iterators does not replay the same numbers. TherminatorGenerator integrates the multiplicity of
+//! species iType with the stream (0xFFFFFFFF,iType), and HistogramCollection draws block iBlock of the pairs of the n1n1 Q3D
+//! Monte Carlo with the stream (0xFFFFFFFE,iBlock).
+//!
+//! Use the fillUniform() and fillGaussian() methods to obtain blocks of numbers in hot loops: these avoid a virtual call per number.
+//! Use binomial() and multinomial() to sample the number of successes of many trials (e.g., the number of particles that survive an
+//! efficiency loss) in O(1) expected time rather than one number per trial.
+//!
+class RandomStream : public TRandom
+{
+public:
+
+  //!
+  //! Create a stream with the given seed and stream index.
+  //!
+  RandomStream(ULong64_t _seed=0, ULong64_t _streamIndex=0);
+
+  virtual ~RandomStream() {}
+
+  //!
+  //! Set the seed and index of this stream and rewind it to its first number.
+  //!
+  void setStream(ULong64_t _seed, ULong64_t _streamIndex);
+
+  //!
+  //! Position the stream at the given count of 32 bits words produced since the beginning of the stream (each uniform deviate uses two words).
+  //!
+  void setPosition(ULong64_t position);
+
+  ULong64_t getStreamSeed() const  { return streamSeed;  }
+  ULong64_t getStreamIndex() const { return streamIndex; }
+  ULong64_t getPosition() const    { return 4*counter - (blockSize-blockIndex); }
+
+  //!
+  //! Uniform deviate in the interval (0,1).
+  //!
+  virtual Double_t Rndm();
+  virtual void     RndmArray(Int_t n, Float_t  * array);
+  virtual void     RndmArray(Int_t n, Double_t * array);
+
+  //!
+  //! Reseed this stream, keeping its stream index.
+  //!
+  virtual void     SetSeed(ULong_t seed=0);
+  virtual UInt_t   GetSeed() const { return UInt_t(streamSeed); }
+
+  //!
+  //! Fill the given buffer with n uniform deviates in the interval (0,1).
+  //!
+  void fillUniform(int n, double * buffer);
+
+  //!
+  //! Fill the given buffer with n uniform deviates in the interval (minimum,maximum).
+  //!
+  void fillUniform(int n, double * buffer, double minimum, double maximum);
+
+  //!
+  //! Fill the given buffer with n Gaussian deviates of given mean and sigma.
+  //!
+  void fillGaussian(int n, double * buffer, double mean=0.0, double sigma=1.0);
+
+  //!
+  //! Number of successes of n trials with success probability p, sampled exactly from the binomial distribution. Uses inversion
+  //! when n*min(p,1-p)<30 and the BTPE acceptance/rejection algorithm (Kachitvichyanukul and Schmeiser, 1988) otherwise:
+  //! the expected number of uniform deviates used is bounded independently of n.
+  //!
+  long binomial(long n, double p);
+
+  //!
+  //! Distribute n trials among nCategories categories with the given probabilities (normalized to their sum), sampled exactly
+  //! from the multinomial distribution as a sequence of conditional binomials. The counts of the categories are returned in counts.
+  //!
+  void multinomial(long n, int nCategories, const double * probabilities, long * counts);
+
+  //!
+  //! TRandom::Binomial draws one number per trial: use binomial() instead.
+  //!
+  virtual Int_t Binomial(Int_t ntot, Double_t prob);
+
+  //!
+  //! Derive a (well mixed) seed from the given seed and indices.
+  //!
+  static ULong64_t deriveSeed(ULong64_t seed, ULong64_t index1, ULong64_t index2=0);
+
+  //!
+  //! Set the base seed used to seed the streams of all threads. Call this method before any stream is used.
+  //!
+  static void setBaseSeed(ULong64_t seed);
+  static ULong64_t getBaseSeed();
+
+  //!
+  //! Returns the stream of the calling thread. The stream is created on first use with the base seed and the index (0,0).
+  //!
+  static RandomStream * getRandomStream();
+
+  //!
+  //! Select the stream (index1,index2) of the base seed for the calling thread.
+  //!
+  static void selectRandomStream(ULong64_t index1, ULong64_t index2=0);
+
+protected:
+
+  static const int blockSize = 4;
+
+  //!
+  //! Compute the block of four 32 bits words of the current counter and increment the counter.
+  //!
+  void generateBlock();
+
+  long binomialInversion(long n, double p);
+  long binomialBtpe(long n, double p);
+
+  inline UInt_t nextWord()
+  {
+  if (blockIndex>=blockSize) generateBlock();
+  return block[blockIndex++];
+  }
+
+  //!
+  //! Uniform deviate in (0,1) with 53 bits of precision.
+  //!
+  inline double nextUniform()
+  {
+  ULong64_t hi = nextWord();
+  ULong64_t lo = nextWord();
+  return (double(((hi<<32)|lo)>>11) + 0.5) * (1.0/9007199254740992.0);
+  }
+
+  ULong64_t streamSeed;
+  ULong64_t streamIndex;
+  ULong64_t counter;
+  UInt_t    block[blockSize];
+  int       blockIndex;
+
+  static ULong64_t baseSeed;
+  static thread_local RandomStream * randomStream;
+
+  ClassDef(RandomStream,0)
+};
+
+}
+
+#endif /* CAP__RandomStream */
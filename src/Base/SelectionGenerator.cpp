@@ -12,6 +12,7 @@
 #include <iostream>
 #include <vector>
 #include "SelectionGenerator.hpp"
+#include "RandomStream.hpp"
 using std::cout;
 using std::endl;
 using CAP::SelectionGenerator;
@@ -20,53 +21,93 @@ ClassImp(SelectionGenerator);
 
 SelectionGenerator::SelectionGenerator()
 :
-cumulativeProbability()
+aliasProbability(),
+aliasIndex()
 {    }
 
 SelectionGenerator::SelectionGenerator(std::vector<double> & probabilities)
 :
-cumulativeProbability()
+aliasProbability(),
+aliasIndex()
 {
   initializeWith(probabilities);
 }
 
+SelectionGenerator::SelectionGenerator(const SelectionGenerator & source)
+:
+aliasProbability(source.aliasProbability),
+aliasIndex(source.aliasIndex)
+{    }
+
 SelectionGenerator & SelectionGenerator::operator=(const SelectionGenerator & source)
 {
   if (this!=&source)
     {
-    cumulativeProbability = source.cumulativeProbability;
+    aliasProbability = source.aliasProbability;
+    aliasIndex       = source.aliasIndex;
     }
   return *this;
 }
 
 void SelectionGenerator::initializeWith(std::vector<double> & probabilities)
 {
-  cumulativeProbability.clear();
   int n = probabilities.size();
+  aliasProbability.assign(n,1.0);
+  aliasIndex.resize(n);
+  for (int k=0; k<n; k++) aliasIndex[k] = k;
+  if (n<1) return;
   double sum = 0.0;
   for (int k=0; k<n; k++)
     {
-    sum += probabilities[k];
+    if (probabilities[k]>0.0) sum += probabilities[k];
     }
-  double prob = 0.0;
-  for (int kk=0; kk<n; kk++)
+  if (sum<=0.0)
     {
-    prob += probabilities[kk]/sum;
-    cumulativeProbability.push_back(prob);
+    for (int k=0; k<n; k++)
+      {
+      aliasProbability[k] = 0.0;
+      aliasIndex[k]       = n-1;
+      }
+    return;
     }
-//  cout << "SelectionGenerator::initializeWith(std::vector<double> & probabilities) cumulativeProbability.size() : " << cumulativeProbability.size() << endl;
 
+  // Vose's method: scaled probabilities below (above) one are paired with a partition that fills the rest of their bin.
+  std::vector<double> scaled(n);
+  std::vector<int>    small;
+  std::vector<int>    large;
+  for (int k=0; k<n; k++)
+    {
+    scaled[k] = (probabilities[k]>0.0) ? probabilities[k]*n/sum : 0.0;
+    if (scaled[k]<1.0) small.push_back(k); else large.push_back(k);
+    }
+  while (!small.empty() && !large.empty())
+    {
+    int s = small.back(); small.pop_back();
+    int l = large.back();
+    aliasProbability[s] = scaled[s];
+    aliasIndex[s]       = l;
+    scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+    if (scaled[l]<1.0)
+      {
+      large.pop_back();
+      small.push_back(l);
+      }
+    }
+  // partitions left over (by round off) fill their own bin
+  for (int k : large) aliasProbability[k] = 1.0;
+  for (int k : small) aliasProbability[k] = (probabilities[k]>0.0) ? 1.0 : 0.0;
+  for (int k : small)
+    {
+    if (aliasProbability[k]==0.0)
+      {
+      // a null partition left over must never be returned: use any partition with a positive probability
+      for (int j=0; j<n; j++) if (probabilities[j]>0.0) { aliasIndex[k] = j; break; }
+      }
+    }
 }
 
 
 int SelectionGenerator::generate()
 {
-  double v = gRandom->Rndm();
-  int n = cumulativeProbability.size();
-  for (int k=0; k<n; k++)
-  {
-  if (v <= cumulativeProbability[k]) return k;
-  }
-  return n-1;
+  return generate(CAP::RandomStream::getRandomStream()->Rndm());
 }
-
@@ -19,6 +19,10 @@
 // Produces a random integer based
 // on a probability distribution.
 //
+// The distribution is stored as a Walker/Vose alias table built by
+// initializeWith(): each call to generate() costs one random draw and
+// a constant number of operations, whatever the number of partitions.
+//
 ////////////////////////////////////////////////////////////////////////
 #include <vector>
 #include "TRandom.h"
@@ -31,19 +35,44 @@ class SelectionGenerator
 public:
   SelectionGenerator();
   SelectionGenerator(std::vector<double> & probabilities);
+  SelectionGenerator(const SelectionGenerator & source);
   SelectionGenerator & operator=(const SelectionGenerator & source);
 
   virtual ~SelectionGenerator(){}
+
+  //!
+  //! Build the alias table of the given (not necessarily normalized) probabilities. Negative probabilities are treated as null. If all
+  //! probabilities are null, generate() always returns the last index.
+  //!
   virtual void initializeWith(std::vector<double> & probabilities);
+
+  //!
+  //! Returns a random index drawn with the random stream of the current thread, or -1 if the generator has no partition.
+  //!
   virtual int generate();
+
+  //!
+  //! Returns the index selected by the given uniform deviate in [0,1), or -1 if the generator has no partition.
+  //!
+  inline int generate(double u) const
+  {
+  int    n = aliasIndex.size();
+  if (n==0) return -1;
+  double x = u*n;
+  int    k = int(x);
+  if (k>=n) k = n-1;
+  return (x-k < aliasProbability[k]) ? k : aliasIndex[k];
+  }
+
   int nPartitions() const
   {
-    return cumulativeProbability.size();
+    return aliasIndex.size();
   }
 
 protected:
 
-  std::vector<double> cumulativeProbability;
+  std::vector<double> aliasProbability; //!< probability of keeping partition k once bin k is drawn
+  std::vector<int>    aliasIndex;       //!< partition selected otherwise
   ClassDef(SelectionGenerator,0)
 };
 
@@ -46,7 +46,7 @@ String StateManager::getStateName() const
 }
 
 
-StateManager * StateManager::stateManagerSingleton = nullptr;
+thread_local StateManager * StateManager::stateManagerSingleton = nullptr;
 
 StateManager * StateManager::getStateManager()
 {
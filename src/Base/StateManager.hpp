@@ -36,9 +36,10 @@ protected:
 public:
 
   //!
-  //! Singleton instance of this StateManager class.
+  //! Singleton instance of this StateManager class. The instance is thread local so that end-of-data and other
+  //! states posted by an event chain running on one thread (see TaskIterator) do not affect chains running on other threads.
   //!
-  static StateManager * stateManagerSingleton;
+  static thread_local StateManager * stateManagerSingleton;
 
   //!
   //! Get a pointer to the singleton instance of this StateManager class.
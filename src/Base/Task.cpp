@@ -56,6 +56,8 @@ taskDataImportPath       (""),
 taskDataExportPath       (""),
 taskHistosImportPath     (""),
 taskHistosExportPath     (""),
+threadIndex              (0),
+threadCount              (1),
 subTasks                 (),
 rootInputFile            (nullptr),
 rootOutputFile           (nullptr)
@@ -100,6 +102,8 @@ taskDataImportPath       (""),
 taskDataExportPath       (""),
 taskHistosImportPath     (""),
 taskHistosExportPath     (""),
+threadIndex              (0),
+threadCount              (1),
 rootInputFile            (nullptr),
 rootOutputFile           (nullptr)
 {
@@ -435,6 +439,55 @@ void Task::partial(const String & outputPathBase)
     ;
 }
 
+Task * Task::clone() const
+{
+  throw TaskException("Task does not support cloning (multithreaded execution)","Task::clone()");
+}
+
+bool Task::isThreadShareable() const
+{
+  for (unsigned int  iTask=0; iTask<getNSubTasks(); iTask++)
+    {
+    if (!subTasks[iTask]->isThreadShareable()) return false;
+    }
+  return true;
+}
+
+Task * Task::configureClone(Task * task) const
+{
+  if (!task)  throw TaskException("Given task pointer is null.", "Task::configureClone(Task * task)");
+  task->setParent(parent);
+  task->configure();
+  for (unsigned int  iTask=0; iTask<getNSubTasks(); iTask++)
+    {
+    Task * subTask = subTasks[iTask]->clone();
+    subTask->setParent(task);
+    task->addSubTask(subTask);
+    }
+  return task;
+}
+
+void Task::setThreadIndex(int index, int count)
+{
+  threadIndex = index;
+  threadCount = count;
+  for (unsigned int  iTask=0; iTask<getNSubTasks(); iTask++)  subTasks[iTask]->setThreadIndex(index,count);
+}
+
+void Task::merge(const Task & task)
+{
+  if (reportStart(__FUNCTION__))
+    ;
+  if (task.getNSubTasks()!=getNSubTasks())
+    throw TaskException("Incompatible number of subtasks","Task::merge(const Task & task)");
+  taskExecutedTotal += task.taskExecutedTotal;
+  taskExecuted      += task.taskExecuted;
+  if (histosCreate)  histogramManager.add(task.histogramManager);
+  for (unsigned int  iTask=0; iTask<getNSubTasks(); iTask++)  subTasks[iTask]->merge(*task.subTasks[iTask]);
+  if (reportEnd(__FUNCTION__))
+    ;
+}
+
 
 void Task::closeHistogramFiles()
 {
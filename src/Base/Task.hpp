@@ -103,6 +103,18 @@ protected:
   String taskHistosImportPath;
   String taskHistosExportPath;
 
+  //!
+  //! Index of the thread executing this task instance: 0 for the primary (main thread) instance, and 1, 2, ... for the clones
+  //! executed on worker threads by TaskIterator.
+  //!
+  int    threadIndex;
+
+  //!
+  //! Number of threads sharing the execution of this task: 1 unless the task belongs to one of the event chains executed by TaskIterator on
+  //! separate threads.
+  //!
+  int    threadCount;
+
   //!
   //! Array of pointers to subTasks called by this task instance, once per event analyzed (or iteration generated by TaskIterator task). If this instance carries out
   //! initialize, finalize, execute type operations, these are performed BEFORE the corresponding operations by the subTasks.
@@ -315,6 +327,47 @@ public:
 
   virtual void partial(const String & outputPathBase);
 
+  //!
+  //! Create a new, configured but uninitialized, instance of this task with the same name, parent, and configuration. Clones are used
+  //! by TaskIterator to execute independent copies of the event chain on separate threads. The base class implementation throws
+  //! a TaskException: derived classes that support multithreaded execution must override this method and call configureClone().
+  //!
+  virtual Task * clone() const;
+
+  //!
+  //! Returns true if clones of this task, executed by TaskIterator on separate threads, each process their own share of the events.
+  //! Tasks reading their events from an input that is not split between the clones must return false: every clone would read, and
+  //! the chain analyze, every event. The base class implementation returns true if all the subtasks do.
+  //!
+  virtual bool isThreadShareable() const;
+
+  //!
+  //! Set the index of the thread executing this task and its subtasks, and the number of threads sharing their execution.
+  //!
+  void setThreadIndex(int index, int count=1);
+
+  //!
+  //! Returns the index of the thread executing this task: 0 for the primary instance, 1, 2, ... for clones executed on worker threads.
+  //!
+  int getThreadIndex() const
+  {
+  return threadIndex;
+  }
+
+  //!
+  //! Returns the number of threads sharing the execution of this task (see setThreadIndex()).
+  //!
+  int getThreadCount() const
+  {
+  return threadCount;
+  }
+
+  //!
+  //! Add the histograms and counters accumulated by the given task (typically a clone of this task executed on a separate thread)
+  //! to those held by this task. The subtasks of the given task are merged recursively into the subtasks of this task.
+  //!
+  virtual void merge(const Task & task);
+
   virtual void closeHistogramFiles();
 
   //!
@@ -528,6 +581,16 @@ public:
 
   int getNAncestors() const;
 
+protected:
+
+  //!
+  //! Configure the given clone of this task: attach it to the parent of this task, configure it, and clone the subtasks of this task into it.
+  //! Called by the clone() method of derived classes.
+  //!
+  Task * configureClone(Task * task) const;
+
+public:
+
 
 
 
@@ -9,12 +9,51 @@
  * Author: Claude Pruneau,   04/01/2022
  *
  * *********************************************************************/
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <algorithm>
+#include "TROOT.h"
+#include "TH1.h"
+#include "TRandom.h"
 #include "TaskIterator.hpp"
+#include "RandomStream.hpp"
 //using CAP::Task;
 //using CAP::TaskIterator;
 //using CAP::Configuration;
 using namespace CAP;
 
+namespace
+{
+
+//!
+//! Generator installed as gRandom while the event loop runs on several threads. It forwards the draws of all threads, one at a
+//! time, to the generator it replaces so tasks drawing from gRandom do not race on its state.
+//!
+class SerializedRandom : public TRandom
+{
+public:
+  SerializedRandom(TRandom * _random) : TRandom(), random(_random) {}
+  virtual ~SerializedRandom() {}
+  virtual Double_t Rndm()                              { std::lock_guard<std::mutex> lock(mutex); return random->Rndm(); }
+  virtual void     RndmArray(Int_t n, Double_t * array) { std::lock_guard<std::mutex> lock(mutex); random->RndmArray(n,array); }
+  virtual void     RndmArray(Int_t n, Float_t * array)  { std::lock_guard<std::mutex> lock(mutex); random->RndmArray(n,array); }
+  virtual void     SetSeed(ULong_t seed=0)              { std::lock_guard<std::mutex> lock(mutex); random->SetSeed(seed); }
+  virtual UInt_t   GetSeed() const                      { std::lock_guard<std::mutex> lock(mutex); return random->GetSeed(); }
+
+protected:
+  TRandom * random;
+  mutable std::mutex mutex;
+};
+
+//!
+//! Number of executions of the task iterators of the job: each execution selects its own random streams.
+//!
+std::atomic<ULong64_t> nExecutions(0);
+
+}
+
 
 ClassImp(TaskIterator);
 
@@ -28,11 +67,13 @@ nSubbunchesPerBunch(1),
 nBunches(1),
 nEventsRequested(1),
 nEventsReport(10),
+nThreads(1),
 bunchLabel("BUNCH"),
 subbunchLabel(""),
 iEvent(0),
 iSubBunch(0),
-iBunch(0)
+iBunch(0),
+executionIndex(0)
 {
   appendClassName("TaskIterator");
 }
@@ -47,6 +88,7 @@ void TaskIterator::setDefaultConfiguration()
   addParameter("nBunches",                nBunches);
   addParameter("nEventsRequested",        nEventsRequested);
   addParameter("nEventsReport",           nEventsReport);
+  addParameter("nThreads",                nThreads);
   addParameter("BunchLabel",              bunchLabel);
   addParameter("SubbunchLabel",           subbunchLabel);
 }
@@ -60,6 +102,8 @@ void TaskIterator::configure()
   nBunches               = getValueInt(   "nBunches");
   nEventsRequested       = getValueLong(  "nEventsRequested");
   nEventsReport          = getValueLong(  "nEventsReport");
+  nThreads               = getValueInt(   "nThreads");
+  if (nThreads<1) nThreads = 1;
   bunchLabel             = getValueString("BunchLabel");
   subbunchLabel          = getValueString("SubbunchLabel");
 
@@ -78,6 +122,7 @@ void TaskIterator::configure()
     printItem("nBunches" ,nBunches);
     printItem("nEventsRequested" ,nEventsRequested);
     printItem("nEventsReport" ,nEventsReport);
+    printItem("nThreads" ,nThreads);
     printItem("bunchLabel" ,bunchLabel);
     printItem("subbunchLabel" ,subbunchLabel);
     }
@@ -91,19 +136,23 @@ void TaskIterator::partial(const String & outputPathBase)
     cout << "Partial save of histograms" << endl;
     }
   String outputPath = outputPathBase;
-  if (!isGrid)
-    {
-    outputPath += "/";
-    outputPath += bunchLabel;
-    outputPath += Form("%02d",iBunch);
-    outputPath += "/";
-    outputPath += subbunchLabel;
-    outputPath +=  Form("%02d",iSubBunch);
-    outputPath += "/";
-    }
+  if (!isGrid) outputPath = getPartialPath(outputPathBase,iBunch,iSubBunch);
   for (unsigned int  iTask=0; iTask<getNSubTasks(); iTask++)  subTasks[iTask]->partial(outputPath);
 }
 
+String TaskIterator::getPartialPath(const String & outputPathBase, int bunch, int subBunch) const
+{
+  String outputPath = outputPathBase;
+  outputPath += "/";
+  outputPath += bunchLabel;
+  outputPath += Form("%02d",bunch);
+  outputPath += "/";
+  outputPath += subbunchLabel;
+  outputPath +=  Form("%02d",subBunch);
+  outputPath += "/";
+  return outputPath;
+}
+
 void TaskIterator::execute()
 {
   histosImportPath = getValueString("HistogramsImportPath");
@@ -148,50 +197,64 @@ void TaskIterator::execute()
     printItem("nEventsPerSubbunch",nEventsPerSubbunch);
     printItem("nSubbunchesPerBunch",nSubbunchesPerBunch);
     printItem("nBunches",nBunches);
+    printItem("nThreads",nThreads);
     printItem("HistogramsImportPath",histosImportPath);
     printItem("HistogramsExportPath",histosExportPath);
     }
   timer.start();
+  executionIndex   = nExecutions++;
   iEvent           = 0;
   iSubBunch        = 0;
   iBunch           = 0;
-  bool working     = true;
-  while (working)
+  if (nThreads>1)
     {
-    for (unsigned int  iTask=0; iTask<getNSubTasks(); iTask++)  subTasks[iTask]->execute();
-    iEvent++;
-    if (iEvent%nEventsReport == 0) printItem("iEvent",iEvent);
-    if (isTaskEod())
-      {
-      working = false; break;
-      }
-    if (iEvent>=nEventsRequested)
+    executeThreads();
+    }
+  else
+    {
+    if (histosExportPartial && !isGrid)
+      selectRandomStream(1+iBunch,iSubBunch);
+    else
+      selectRandomStream(0,0);
+    bool working     = true;
+    while (working)
       {
-      if (reportInfo(__FUNCTION__))
+      for (unsigned int  iTask=0; iTask<getNSubTasks(); iTask++)  subTasks[iTask]->execute();
+      iEvent++;
+      if (iEvent%nEventsReport == 0) printItem("iEvent",iEvent);
+      if (isTaskEod())
         {
-        cout << endl;
-        printItem("iEvent",iEvent);
-        printItem("nEventsRequested",nEventsRequested);
-        cout << endl;
+        working = false; break;
+        }
+      if (iEvent>=nEventsRequested)
+        {
+        if (reportInfo(__FUNCTION__))
+          {
+          cout << endl;
+          printItem("iEvent",iEvent);
+          printItem("nEventsRequested",nEventsRequested);
+          cout << endl;
+          }
+        working = false; break;
         }
-      working = false; break;
-      }
 
-    // in local mode, with partial saves on
-    //
-    if (histosExportPartial  && !isGrid)
-      {
-      if (iEvent%(nBunches*nSubbunchesPerBunch*nEventsPerSubbunch)==0)
+      // in local mode, with partial saves on
+      //
+      if (histosExportPartial  && !isGrid)
         {
-        // subbunch is completed
-        partial(histosExportPath);
-        iSubBunch++;
-        if (iSubBunch==nSubbunchesPerBunch)
+        if (iEvent%nEventsPerSubbunch==0)
           {
-          // bunch is completed
-          iSubBunch=0;
-          iBunch++;
-          if (iBunch==nBunches) working = false;
+          // subbunch is completed
+          partial(histosExportPath);
+          iSubBunch++;
+          if (iSubBunch==nSubbunchesPerBunch)
+            {
+            // bunch is completed
+            iSubBunch=0;
+            iBunch++;
+            if (iBunch==nBunches) working = false;
+            }
+          selectRandomStream(1+iBunch,iSubBunch);
           }
         }
       }
@@ -202,6 +265,147 @@ void TaskIterator::execute()
 }
 
 
+void TaskIterator::selectRandomStream(ULong64_t index1, ULong64_t index2) const
+{
+  RandomStream::selectRandomStream(index1,(executionIndex<<32)|index2);
+}
+
+void TaskIterator::executeThreads()
+{
+  if (reportStart(__FUNCTION__))
+    ;
+  for (unsigned int  iTask=0; iTask<getNSubTasks(); iTask++)
+    {
+    if (!subTasks[iTask]->isThreadShareable())
+      throw TaskException(subTasks[iTask]->getName()+": the events it imports are not split between threads. Set nThreads to 1.","TaskIterator::executeThreads()");
+    }
+  ROOT::EnableThreadSafety();
+  // tasks still drawing from gRandom share it: its draws are serialized while the threads run.
+  TRandom * sharedRandom = gRandom;
+  SerializedRandom serializedRandom(sharedRandom);
+  gRandom = &serializedRandom;
+  // histograms of the clones are owned by their histogram groups and must not be attached to the current directory.
+  bool addDirectory = TH1::AddDirectoryStatus();
+  TH1::AddDirectory(false);
+
+  // Clones are created and configured on the main thread. They are initialized on their own thread so they obtain
+  // the (thread local) event streams, particle factory, and state manager of that thread.
+  int nTasks = getNSubTasks();
+  vector< vector<Task*> > chains(nThreads);
+  chains[0] = subTasks;
+  for (int iTask=0; iTask<nTasks; iTask++) subTasks[iTask]->setThreadIndex(0,nThreads);
+  for (int iThread=1; iThread<nThreads; iThread++)
+    {
+    for (int iTask=0; iTask<nTasks; iTask++)
+      {
+      Task * task = subTasks[iTask]->clone();
+      task->setThreadIndex(iThread,nThreads);
+      chains[iThread].push_back(task);
+      }
+    }
+
+  bool partialSave = histosExportPartial && !isGrid;
+  long nSubBunches = long(nBunches)*long(nSubbunchesPerBunch);
+  std::atomic<long> nEventsClaimed(0);
+  std::atomic<long> nSubBunchesClaimed(0);
+  std::atomic<long> nEventsCompleted(0);
+  std::atomic<bool> done(false);
+  std::mutex ioMutex;
+  vector<std::exception_ptr> exceptions(nThreads);
+
+  auto run = [&](int iThread)
+  {
+  vector<Task*> & chain = chains[iThread];
+  // execute one event; returns false if the end of the data of this thread was reached. Tasks importing their events read
+  // a share of them on each thread: the other threads keep going.
+  auto executeEvent = [&]()
+  {
+  for (int iTask=0; iTask<nTasks; iTask++) chain[iTask]->execute();
+  long nCompleted = ++nEventsCompleted;
+  if (nCompleted%nEventsReport == 0)
+    {
+    std::lock_guard<std::mutex> lock(ioMutex);
+    printItem("iEvent",nCompleted);
+    }
+  return !isTaskEod();
+  };
+  try
+    {
+    // each thread uses its own random stream. With partial saves, each sub-bunch uses its own stream
+    // so the events it contains do not depend on the thread that produced them.
+    selectRandomStream(0,iThread);
+    if (iThread>0) for (int iTask=0; iTask<nTasks; iTask++) chain[iTask]->initialize();
+    if (partialSave)
+      {
+      long subBunch;
+      while (!done && (subBunch = nSubBunchesClaimed++) < nSubBunches)
+        {
+        long first = subBunch*nEventsPerSubbunch;
+        long last  = std::min(first+nEventsPerSubbunch,nEventsRequested);
+        if (first>=last) break;
+        selectRandomStream(1+subBunch/nSubbunchesPerBunch,subBunch%nSubbunchesPerBunch);
+        bool working = true;
+        for (long k=first; k<last && working; k++) working = executeEvent();
+        std::lock_guard<std::mutex> lock(ioMutex);
+        String outputPath = getPartialPath(histosExportPath,subBunch/nSubbunchesPerBunch,subBunch%nSubbunchesPerBunch);
+        for (int iTask=0; iTask<nTasks; iTask++) chain[iTask]->partial(outputPath);
+        if (!working) break;
+        }
+      }
+    else
+      {
+      while (!done && nEventsClaimed++ < nEventsRequested)
+        {
+        if (!executeEvent()) break;
+        }
+      }
+    }
+  catch (...)
+    {
+    exceptions[iThread] = std::current_exception();
+    done = true;
+    }
+  };
+
+  vector<std::thread> threads;
+  for (int iThread=1; iThread<nThreads; iThread++) threads.emplace_back(run,iThread);
+  run(0);
+  for (auto & thread : threads) thread.join();
+  for (int iTask=0; iTask<nTasks; iTask++) subTasks[iTask]->setThreadIndex(0,1);
+  TH1::AddDirectory(addDirectory);
+  gRandom = sharedRandom;
+
+  iEvent = nEventsCompleted;
+  if (partialSave)
+    {
+    long nCompleted = std::min(long(nSubBunchesClaimed),nSubBunches);
+    iBunch    = nCompleted/nSubbunchesPerBunch;
+    iSubBunch = nCompleted%nSubbunchesPerBunch;
+    }
+  for (int iThread=1; iThread<nThreads; iThread++)
+    {
+    for (int iTask=0; iTask<nTasks; iTask++)
+      {
+      Task * task = chains[iThread][iTask];
+      if (!partialSave && !exceptions[iThread]) subTasks[iTask]->merge(*task);
+      task->clear();
+      delete task;
+      }
+    }
+  for (int iThread=0; iThread<nThreads; iThread++)
+    {
+    if (exceptions[iThread]) std::rethrow_exception(exceptions[iThread]);
+    }
+  if (reportInfo(__FUNCTION__))
+    {
+    cout << endl;
+    printItem("nThreads",nThreads);
+    printItem("iEvent",iEvent);
+    printItem("nEventsRequested",nEventsRequested);
+    cout << endl;
+    }
+}
+
 void TaskIterator::finalize()
 {
   finalizeSubTasks();
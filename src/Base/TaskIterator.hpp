@@ -22,6 +22,16 @@ namespace CAP {
 //!
 //!  Optionally, the iterator may call a subsampleAnalysis method to carry out a sub-sample analysis of all the sub tasks operated by this iterator.
 //!
+//!  When the parameter nThreads is larger than one, the event loop is executed concurrently on nThreads threads. The subtasks run on the
+//!  main thread while each of the nThreads-1 worker threads executes its own clone of the subtasks (see Task::clone()), with its own event
+//!  streams, particle factory, and histograms. Without partial saves, the events requested are shared dynamically among the threads and the
+//!  histograms and counters of the clones are merged into the subtasks before finalize() is called: the exported file then has the same content as a
+//!  serial run of the same total number of events. With partial saves, each thread claims complete sub-bunches and saves them on its own.
+//!  In both modes, a sub-bunch holds nEventsPerSubbunch events. All subtasks must support cloning and share the events among their clones
+//!  (see Task::isThreadShareable()): executeThreads() throws a TaskException if a subtask imports its events from an input that is not
+//!  split between the threads. Tasks reading a CAP event file read a contiguous share of its events on each thread (see Task::getThreadCount());
+//!  a thread reaching the end of its share stops while the others complete theirs.
+//!
 class TaskIterator : public Task
 {
 public:
@@ -51,11 +61,32 @@ public:
   virtual void configure();
 
   virtual void partial(const String & outputPathBase);
+
+  //!
+  //! Returns the path where the histograms of the given bunch and sub-bunch are saved by partial saves.
+  //!
+  String getPartialPath(const String & outputPathBase, int bunch, int subBunch) const;
+
   //!
   //! Execute the subtasks
   //!
   virtual void execute();
 
+  //!
+  //! Execute the subtasks and their clones concurrently on nThreads threads. Each thread selects its own RandomStream: tasks executed
+  //! on several threads should draw their random numbers from RandomStream::getRandomStream(). While the threads run, gRandom is
+  //! replaced by a generator serializing the draws of all threads on it: tasks still drawing from gRandom are thread safe, but the
+  //! numbers they obtain depend on the order in which the threads draw.
+  //!
+  virtual void executeThreads();
+
+  //!
+  //! Select the random stream (index1,index2) of the current execution of this iterator for the calling thread. The execution
+  //! index, counted over all the task iterators of the job, is carried by the upper 32 bits of index2: successive executions do not
+  //! replay the random numbers of the previous ones.
+  //!
+  void selectRandomStream(ULong64_t index1, ULong64_t index2) const;
+
   //!
   //! Finalize the subtasks
   //!
@@ -69,11 +100,13 @@ protected:
   int     nBunches;
   long    nEventsRequested;
   long    nEventsReport;
+  int     nThreads;
   String  bunchLabel;
   String  subbunchLabel;
   long    iEvent;
   int     iSubBunch;
   int     iBunch;
+  ULong64_t executionIndex;
 
   ClassDef(TaskIterator,0)
 };
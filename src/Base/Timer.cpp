@@ -23,6 +23,8 @@ Timer::Timer()
 startTime(),
 stopTime(),
 totalDuration(),
+intervalStartTime(),
+accumulatedDuration(0.0),
 hours(0),
 minutes(0),
 seconds(0)
@@ -56,6 +58,21 @@ void Timer::stop()
   oldStop  = stopTime;
 }
 
+void Timer::startInterval()
+{
+  intervalStartTime = high_resolution_clock::now();
+}
+
+void Timer::stopInterval()
+{
+  accumulatedDuration += high_resolution_clock::now() - intervalStartTime;
+}
+
+void Timer::resetAccumulated()
+{
+  accumulatedDuration = duration<double>(0.0);
+}
+
 void Timer::print(ostream & os)
 {
   os << "             Time since start : " << days << " days, "<< hours << " hours, " << minutes << " minutes, " << seconds << " seconds." << endl;
@@ -31,11 +31,33 @@ public:
   void stop();
   void print(ostream & os);
 
+  //!
+  //! Start an interval accumulated by stopInterval(). Intervals are timed independently of start() and stop().
+  //!
+  void startInterval();
+
+  //!
+  //! Add the time elapsed since the last call to startInterval() to the accumulated time.
+  //!
+  void stopInterval();
+
+  //!
+  //! Returns the accumulated time, in seconds, of the intervals timed since the last call to resetAccumulated().
+  //!
+  double getAccumulated() const
+  {
+  return accumulatedDuration.count();
+  }
+
+  void resetAccumulated();
+
   high_resolution_clock::time_point startTime;
   high_resolution_clock::time_point stopTime;
   high_resolution_clock::time_point oldStop;
   duration<double> totalDuration;
   duration<double> intervalDuration;
+  high_resolution_clock::time_point intervalStartTime;
+  duration<double> accumulatedDuration;
   int    days;
   int    hours;
   int    minutes;
@@ -10,6 +10,7 @@
  *
  * *********************************************************************/
 #include "RapidityGenerator.hpp"
+#include "RandomStream.hpp"
 using CAP::RapidityGenerator;
 
 ClassImp(RapidityGenerator);
@@ -35,6 +36,7 @@ void RapidityGenerator::reset()
 
 double RapidityGenerator::generate()
 {
+  TRandom * random = CAP::RandomStream::getRandomStream();
   double v;
   double localRap;
   double rap1, rap2;
@@ -49,7 +51,7 @@ double RapidityGenerator::generate()
         {
           case 0:  // uniform
 
-          v = maxRapidity * (2.0*gRandom->Rndm() - 1.0);
+          v = maxRapidity * (2.0*random->Rndm() - 1.0);
           break;
 
           case 1:  // exponential
@@ -57,8 +59,8 @@ double RapidityGenerator::generate()
           v = -99999;
           while (fabs(v)>maxRapidity)
             {
-            v = 0.5*minimumSeparation + gRandom->Exp(scale);
-            v = (gRandom->Rndm()>0.50) ? v : -v;
+            v = 0.5*minimumSeparation + random->Exp(scale);
+            v = (random->Rndm()>0.50) ? v : -v;
             }
           break;
 
@@ -67,7 +69,7 @@ double RapidityGenerator::generate()
           v = -99999;
           while (fabs(v)>maxRapidity)
             {
-            v = 0.5*minimumSeparation + gRandom->Gaus(0.0, scale);
+            v = 0.5*minimumSeparation + random->Gaus(0.0, scale);
             }
           break;
         }
@@ -93,7 +95,7 @@ double RapidityGenerator::generate()
       while (!OK)
         {
         // generate a new pair average rapidity
-        pairRapidity = maxRapidity * (2.0*gRandom->Rndm() - 1.0);
+        pairRapidity = maxRapidity * (2.0*random->Rndm() - 1.0);
         switch (option)
           {
             case 0:  // uniform
@@ -104,14 +106,14 @@ double RapidityGenerator::generate()
             localRap = -99999;
             while (fabs(localRap)>2*maxRapidity)
               {
-              localRap = gRandom->Exp(scale);
+              localRap = random->Exp(scale);
               }
             break;
             case 2:  // Gaussian
             localRap = -99999;
             while (fabs(localRap)>2*maxRapidity)
               {
-              localRap = gRandom->Gaus(0.0, scale);
+              localRap = random->Gaus(0.0, scale);
               }
             break;
           }
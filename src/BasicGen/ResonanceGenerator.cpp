@@ -11,6 +11,7 @@
  * *********************************************************************/
 #include "ResonanceGenerator.hpp"
 #include "ParticleDecayer.hpp"
+#include "RandomStream.hpp"
 using CAP::ResonanceGenerator;
 
 ClassImp(ResonanceGenerator);
@@ -37,6 +38,13 @@ pTslope(0.4)
 
 }
 
+CAP::Task * ResonanceGenerator::clone() const
+{
+  ResonanceGenerator * task = new ResonanceGenerator(getName(),configuration);
+  configureClone(task);
+  return task;
+}
+
 
 void ResonanceGenerator::setDefaultConfiguration()
 {
@@ -150,6 +158,7 @@ void ResonanceGenerator::createEvent()
 
 void ResonanceGenerator::generate(Particle * parentInteraction)
 {
+  TRandom * random = CAP::RandomStream::getRandomStream();
   Event & event = * eventStreams[0];
   //ParticleFilter & particleFilter = * particleFilters[0];
 
@@ -163,12 +172,12 @@ void ResonanceGenerator::generate(Particle * parentInteraction)
   ParticleDecayer decayer;
   Particle * parent = particleFactory->getNextObject();
   double y, phi, pt, mt, px, py, pz, e;
-  int mult = int( nPartMinimum +  double(nPartRange) * gRandom->Rndm());
+  int mult = int( nPartMinimum +  double(nPartRange) * random->Rndm());
   for (int iParticle = 0; iParticle < mult; iParticle++)
     {
-    y   = yMinimum + yRange * gRandom->Rndm();
-    phi = CAP::Math::twoPi() * gRandom->Rndm();
-    pt  = 1.0+gRandom->Exp(pTslope);
+    y   = yMinimum + yRange * random->Rndm();
+    phi = CAP::Math::twoPi() * random->Rndm();
+    pt  = 1.0+random->Exp(pTslope);
     px  = pt*cos(phi);
     py  = pt*sin(phi);
     mt  = sqrt(mass*mass+pt*pt);
@@ -9,21 +9,54 @@
  * Author: Claude Pruneau,   04/01/2022
  *
  * *********************************************************************/
-
+#include <cmath>
+#include <mutex>
 #include "PythiaEventGenerator.hpp"
 using CAP::PythiaEventGenerator;
+using CAP::PythiaParticleRecord;
 
 ClassImp(PythiaEventGenerator);
 
+//!
+//! Serializes the initializations that read or save the multiparton interaction initialization file.
+//!
+static std::mutex mpiInitMutex;
+
 PythiaEventGenerator::PythiaEventGenerator(const String & _name,
                                            const Configuration & _configuration)
 :
 EventTask(_name, _configuration),
-pythia(nullptr)
+pythia(nullptr),
+poolSize(0),
+poolBatchSize(16),
+pool(),
+poolFilling(),
+poolReady(),
+poolThreads(),
+poolExceptions(),
+readyInstance(0),
+readyEvent(0),
+records(),
+typeTable()
 {
   appendClassName("PythiaEventGenerator");
 }
 
+PythiaEventGenerator::~PythiaEventGenerator()
+{
+  for (auto & thread : poolThreads)
+    {
+    if (thread.joinable()) thread.join();
+    }
+}
+
+CAP::Task * PythiaEventGenerator::clone() const
+{
+  PythiaEventGenerator * task = new PythiaEventGenerator(getName(),configuration);
+  configureClone(task);
+  return task;
+}
+
 
 void PythiaEventGenerator::setDefaultConfiguration()
 {
@@ -48,6 +81,9 @@ void PythiaEventGenerator::setDefaultConfiguration()
   addParameter("UseRopes",         false);
   addParameter("UseShoving",       false);
   addParameter("xmlInputPath",     TString(""));
+  addParameter("PoolSize",         0);
+  addParameter("PoolBatchSize",    16);
+  addParameter("MPIInitFile",      TString(""));
 
   for (int k=0; k<30; k++)
     {
@@ -60,6 +96,10 @@ void PythiaEventGenerator::setDefaultConfiguration()
 void PythiaEventGenerator::configure()
 {
   EventTask::configure();
+  poolSize      = getValueInt("PoolSize");
+  poolBatchSize = getValueInt("PoolBatchSize");
+  if (poolSize<0)      poolSize = 0;
+  if (poolBatchSize<1) poolBatchSize = 1;
   if (reportDebug(__FUNCTION__)) printConfiguration(cout);
 }
 
@@ -71,10 +111,116 @@ void PythiaEventGenerator::configure()
 //!
 void PythiaEventGenerator::initialize()
 {
-  //;
-  //EventTask::configure();
   EventTask::initialize();
+  initializeTypeTable();
   pythia = new Pythia8::Pythia(getValueString("xmlInputPath").Data(), getValueBool("Print:Banner"));
+  configurePythia();
+  if (poolSize<1)
+    {
+    // clones executed on worker threads must generate independent event sequences.
+    if (getValueBool("SetSeed") || threadIndex>0) setSeed(*pythia,getValueLong("SeedValue") + threadIndex);
+    initializePythia(*pythia,true);
+    if (reportEnd(__FUNCTION__))
+      ;
+    return;
+    }
+
+  // the other instances copy the settings and particle data of the first one, and are initialized concurrently.
+  pool.assign(1,pythia);
+  for (int iInstance=1; iInstance<poolSize; iInstance++)
+    {
+    Pythia8::Pythia * instance = new Pythia8::Pythia(pythia->settings,pythia->particleData,false);
+    instance->readString("Print:quiet = on");
+    pool.push_back(instance);
+    }
+  for (int iInstance=0; iInstance<poolSize; iInstance++)
+    setSeed(*pool[iInstance],getValueLong("SeedValue") + long(threadIndex)*poolSize + iInstance);
+  initializePythia(*pythia,true);
+  poolExceptions.assign(poolSize,nullptr);
+  poolThreads.clear();
+  for (int iInstance=1; iInstance<poolSize; iInstance++)
+    {
+    poolThreads.emplace_back([this,iInstance]()
+                             {
+                             try { initializePythia(*pool[iInstance],false); }
+                             catch (...) { poolExceptions[iInstance] = std::current_exception(); }
+                             });
+    }
+  for (auto & thread : poolThreads) thread.join();
+  poolThreads.clear();
+  for (auto & exception : poolExceptions)
+    {
+    if (exception) std::rethrow_exception(exception);
+    }
+  if (reportInfo(__FUNCTION__))
+    {
+    cout << endl;
+    printItem("PoolSize",poolSize);
+    printItem("PoolBatchSize",poolBatchSize);
+    }
+  poolFilling.assign(poolSize,PythiaEventBuffer());
+  poolReady.assign(poolSize,PythiaEventBuffer());
+  readyInstance = poolSize;
+  readyEvent    = 0;
+  startBatch();
+  if (reportEnd(__FUNCTION__))
+    ;
+}
+
+void PythiaEventGenerator::setSeed(Pythia8::Pythia & instance, long seed)
+{
+  // PYTHIA seeds range from 1 to 900000000 (0 selects a time based seed)
+  if (seed>900000000) seed = 1 + (seed-1)%900000000;
+  String  seedValueString = "Random:seed = ";
+  seedValueString += seed;
+  instance.readString("Random:setSeed = on");
+  instance.readString(seedValueString.Data());
+  if (&instance==pythia)
+    {
+    printItem("Pythia:Random:setSeed","ON");
+    printItem("Pythia:Random:SeedValue",seedValueString);
+    }
+}
+
+void PythiaEventGenerator::initializePythia(Pythia8::Pythia & instance, bool first)
+{
+  String mpiInitFile = getValueString("MPIInitFile");
+  if (mpiInitFile.IsNull())
+    {
+    instance.init();
+    return;
+    }
+  // reuseInit 3: read the file if it exists, else initialize and save it. 2: read the file.
+  String fileString = "MultipartonInteractions:initFile = "; fileString += mpiInitFile;
+  instance.readString(fileString.Data());
+  if (first)
+    {
+    std::lock_guard<std::mutex> lock(mpiInitMutex);
+    instance.readString("MultipartonInteractions:reuseInit = 3");
+    instance.init();
+    }
+  else
+    {
+    instance.readString("MultipartonInteractions:reuseInit = 2");
+    instance.init();
+    }
+}
+
+void PythiaEventGenerator::initializeTypeTable()
+{
+  ParticleDb * particleDb = ParticleDb::getDefaultParticleDb();
+  typeTable.assign(2*maxTablePdgCode,nullptr);
+  // the first type of the db with a given code is kept, as in ParticleDb::findPdgCode()
+  for (unsigned int iType=particleDb->size(); iType>0; iType--)
+    {
+    ParticleType * type = particleDb->getParticleType(iType-1);
+    int pdgCode = type->getPdgCode();
+    if (pdgCode>-maxTablePdgCode && pdgCode<maxTablePdgCode) typeTable[pdgCode+maxTablePdgCode] = type;
+    }
+}
+
+void PythiaEventGenerator::configurePythia()
+{
   pythia->settings.mode("Beams:idA",       getValueInt(   "Beams:idA"));
   pythia->settings.mode("Beams:idB",       getValueInt(   "Beams:idB"));
   pythia->settings.mode("Beams:frameType", getValueInt(   "Beams:frameType"));
@@ -91,15 +237,6 @@ void PythiaEventGenerator::initialize()
     }
 
 
-  if (getValueDouble("SetSeed"))
-    {
-    String  seedValueString = "Random:seed = ";
-    seedValueString += getValueLong("SeedValue");
-    pythia->readString("Random:setSeed = on");
-    pythia->readString(seedValueString.Data());
-    printItem("Pythia:Random:setSeed","ON");
-    printItem("Pythia:Random:SeedValue",seedValueString);
-    }
   for (int k=0; k<30; k++)
     {
     String key = "Option"; key += k;
@@ -172,18 +309,109 @@ void PythiaEventGenerator::initialize()
     pythia->readString("PartonVertex:protonRadius = 0.7");
     pythia->readString("PartonVertex:emissionWidth = 0.1");
     }
-  pythia->init();
-//  if (reportDebug(__FUNCTION__))
-//    {
-//    pythia->settings.listAll();
-//    pythia->settings.listChanged();
-//    }
-  if (reportEnd(__FUNCTION__))
-    ;
+}
+
+void PythiaEventGenerator::copyParticles(Pythia8::Pythia & instance, vector<PythiaParticleRecord> & particleRecords) const
+{
+  Pythia8::Event & pythiaEvent = instance.event;
+  int nParticleToCopy   = pythiaEvent.size();
+  if (pythiaEvent[0].id() == 90) nParticleToCopy--;
+  for (int i = 1; i <= nParticleToCopy; i++)
+    {
+    const Pythia8::Particle & pythiaParticle = pythiaEvent[i];
+    int pdg = pythiaParticle.id();
+    if (abs(pdg)<40  || pdg==2101) continue; // skip quarks,  leptons, and photons
+    if (!pythiaParticle.isFinal()) continue;
+    ParticleType * particleType = getParticleType(pdg);
+    if (particleType==nullptr) continue;
+    // momentum-energy units are  [GeV/c]
+    // positions are in [mm], time in [mm/c]
+    PythiaParticleRecord record;
+    record.type = particleType;
+    record.px   = pythiaParticle.px();
+    record.py   = pythiaParticle.py();
+    record.pz   = pythiaParticle.pz();
+    record.e    = pythiaParticle.e();
+    record.x    = pythiaParticle.xProd();
+    record.y    = pythiaParticle.yProd();
+    record.z    = pythiaParticle.zProd();
+    record.t    = pythiaParticle.tProd();
+    particleRecords.push_back(record);
+    }
+}
+
+void PythiaEventGenerator::startBatch()
+{
+  poolExceptions.assign(poolSize,nullptr);
+  poolThreads.clear();
+  for (int iInstance=0; iInstance<poolSize; iInstance++)
+    {
+    poolThreads.emplace_back([this,iInstance]()
+                             {
+                             try
+                               {
+                               Pythia8::Pythia & instance = *pool[iInstance];
+                               PythiaEventBuffer & buffer = poolFilling[iInstance];
+                               buffer.particles.clear();
+                               buffer.eventEnds.clear();
+                               for (int iEvent=0; iEvent<poolBatchSize; iEvent++)
+                                 {
+                                 instance.next();
+                                 copyParticles(instance,buffer.particles);
+                                 buffer.eventEnds.push_back(buffer.particles.size());
+                                 }
+                               }
+                             catch (...)
+                               {
+                               poolExceptions[iInstance] = std::current_exception();
+                               }
+                             });
+    }
+}
+
+void PythiaEventGenerator::finishBatch()
+{
+  for (auto & thread : poolThreads) thread.join();
+  poolThreads.clear();
+  for (auto & exception : poolExceptions)
+    {
+    if (exception) std::rethrow_exception(exception);
+    }
+  poolReady.swap(poolFilling);
+  readyInstance = 0;
+  readyEvent    = 0;
 }
 
 void PythiaEventGenerator::createEvent()
 {
+  const PythiaParticleRecord * first;
+  const PythiaParticleRecord * last;
+  if (poolSize>0)
+    {
+    if (readyInstance>=poolReady.size())
+      {
+      finishBatch();
+      startBatch();
+      }
+    const PythiaEventBuffer & buffer = poolReady[readyInstance];
+    int begin = (readyEvent>0) ? buffer.eventEnds[readyEvent-1] : 0;
+    first = buffer.particles.data() + begin;
+    last  = buffer.particles.data() + buffer.eventEnds[readyEvent];
+    if (++readyEvent>=buffer.eventEnds.size())
+      {
+      readyInstance++;
+      readyEvent = 0;
+      }
+    }
+  else
+    {
+    pythia->next();
+    records.clear();
+    copyParticles(*pythia,records);
+    first = records.data();
+    last  = first + records.size();
+    }
+
   Event & event = *eventStreams[0];
   EventProperties & eventProperties = * event.getEventProperties();
   Particle * interaction;
@@ -196,53 +424,13 @@ void PythiaEventGenerator::createEvent()
   event.add(interaction);
   event.setNucleusA(1.0,1.0);
   event.setNucleusB(1.0,1.0);
-  pythia->next();
-
-//  int ioff = 0;
-  int nParticleToCopy   = pythia->event.size();
-  //printItem("nParticleToCopy",nParticleToCopy);
-
-  if (pythia->event[0].id() == 90)
-    {
-    nParticleToCopy--;
-//     ioff = -1;
-    }
-
-//  if (reportDebug(__FUNCTION__)) cout << "nParticleToCopy : " << nParticleToCopy << endl;
-
-  for (int i = 1; i <= nParticleToCopy; i++)
+  for (const PythiaParticleRecord * record=first; record<last; record++)
     {
-
-//    int ist = tracks_fStatusCode[iParticle];
-//    if (ist <= 0) continue;
-    int pdg = pythia->event[i].id();
-    if (abs(pdg)<40  || pdg==2101) continue; // skip quarks,  leptons, and photons
-    if (!pythia->event[i].isFinal()) continue;
-    //if (reportDebug(__FUNCTION__))   cout << "     pdg:" << pdg << endl;
-    ParticleType * particleType = ParticleDb::getDefaultParticleDb()->findPdgCode(pdg);
-    if (particleType==nullptr)
-      {
-      if (reportDebug(__FUNCTION__)) cout << "     is an unknown code" << endl;
-      continue;
-      }
-    //if (particleType->isPhoton()) continue;
-
     Particle & particle = *particleFactory->getNextObject();
-    particle.setType(particleType);
+    particle.setType(record->type);
     particle.setLive(1);
-//    particle.setParents(pythia->event[i].mother1()   + ioff,
-//                        pythia->event[i].mother2()   + ioff);
-//
-////    setParents(Particle * parent1, Particle * parent2);
-//
-//    particle.setChildren(pythia->event[i].daughter1() + ioff,
-//                         pythia->event[i].daughter2() + ioff)
-    // momentum-energy units are  [GeV/c]
-    // positions are in [mm], time in [mm/c]
-    particle.setPxPyPzE(pythia->event[i].px(),pythia->event[i].py(),pythia->event[i].pz(),pythia->event[i].e());
-    particle.setXYZT(pythia->event[i].xProd(),pythia->event[i].yProd(),pythia->event[i].zProd(),pythia->event[i].tProd());
-    //incrementParticlesAccepted();
-    //if (reportDebug(__FUNCTION__)) cout << "   Add Particle to the event" << endl;
+    particle.setPxPyPzE(record->px,record->py,record->pz,record->e);
+    particle.setXYZT(record->x,record->y,record->z,record->t);
     event.add(&particle);
     }
   int multiplicity = event.getParticleCount();
@@ -268,13 +456,61 @@ void PythiaEventGenerator::createEvent()
 
 void PythiaEventGenerator::finalize()
 {
+  // the batch generated in advance is discarded
+  for (auto & thread : poolThreads) thread.join();
+  poolThreads.clear();
   if (reportInfo(__FUNCTION__) && getValueBool("Print:Statistics"))
     {
-    cout << endl;
-    pythia->stat();
-    cout << endl;
+    if (poolSize>0)
+      printPoolStatistics();
+    else
+      {
+      cout << endl;
+      pythia->stat();
+      cout << endl;
+      }
     }
-  delete pythia;
+  if (poolSize>0)
+    {
+    for (auto instance : pool) delete instance;
+    pool.clear();
+    }
+  else
+    delete pythia;
+  pythia = nullptr;
   if (reportEnd(__FUNCTION__))
     ;
 }
+
+//!
+//! Each instance of the pool samples the same processes with its own seed, so the cross section of the pool is the average of the
+//! estimates of the instances weighted by their number of tried events, and its error combines their errors with the same weights.
+//!
+void PythiaEventGenerator::printPoolStatistics()
+{
+  long   nTried     = 0;
+  long   nSelected  = 0;
+  long   nAccepted  = 0;
+  double sumSigma   = 0.0;
+  double sumError2  = 0.0;
+  for (unsigned int iInstance=0; iInstance<pool.size(); iInstance++)
+    {
+    const Pythia8::Info & info = pool[iInstance]->info;
+    cout << endl << "PYTHIA instance " << iInstance << endl;
+    pool[iInstance]->stat();
+    double tried = double(info.nTried());
+    nTried    += info.nTried();
+    nSelected += info.nSelected();
+    nAccepted += info.nAccepted();
+    sumSigma  += tried*info.sigmaGen();
+    sumError2 += tried*tried*info.sigmaErr()*info.sigmaErr();
+    }
+  cout << endl;
+  printItem("PYTHIA instances",  int(pool.size()));
+  printItem("nTried",            nTried);
+  printItem("nSelected",         nSelected);
+  printItem("nAccepted",         nAccepted);
+  printItem("sigmaGen (mb)",     nTried>0 ? sumSigma/double(nTried) : 0.0);
+  printItem("sigmaErr (mb)",     nTried>0 ? std::sqrt(sumError2)/double(nTried) : 0.0);
+  cout << endl;
+}
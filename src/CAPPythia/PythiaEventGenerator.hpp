@@ -14,6 +14,9 @@
 //#include "TTree.h"
 //#include "TParticle.h"
 //#include "TClonesArray.h"
+#include <vector>
+#include <thread>
+#include <exception>
 #include "Pythia.h"
 #include "EventTask.hpp"
 //#include "Event.hpp"
@@ -23,7 +26,36 @@
 namespace CAP
 {
 
+//!
+//! Final state particle of a generated PYTHIA event, with its CAP type resolved.
+//!
+struct PythiaParticleRecord
+{
+  ParticleType * type;
+  double px, py, pz, e;
+  double x, y, z, t;
+};
+
+//!
+//! Events generated by a PYTHIA instance of the generator pool: the particles of all events, and the index past the last particle of each event.
+//!
+struct PythiaEventBuffer
+{
+  vector<PythiaParticleRecord> particles;
+  vector<int>                  eventEnds;
+};
 
+//!
+//! Task generating events with PYTHIA 8.
+//!
+//! With PoolSize>0, the task owns PoolSize PYTHIA instances with distinct seeds (SeedValue + threadIndex*PoolSize + iInstance). The instances
+//! generate PoolBatchSize events each, concurrently, in the background while the events of the previous batch are handed to the analysis
+//! chain: all events of instance 0, then all events of instance 1, etc. The sequence of events is thus the same for any thread scheduling.
+//! The instances are created from the settings and particle data of the first instance, so the XML database is read once.
+//! Set MPIInitFile to save the multiparton interaction initialization to this file the first time and read it afterwards.
+//!
+//! The PDG codes of the PYTHIA particles are translated to CAP types with a table indexed by PDG code built once at initialization.
+//!
 class PythiaEventGenerator : public EventTask
 {
 public:
@@ -43,8 +75,13 @@ public:
   //!
   //! DTOR
   //!
-  virtual ~PythiaEventGenerator() {}
-  
+  virtual ~PythiaEventGenerator();
+
+  //!
+  //! Returns a configured clone of this task used for multithreaded execution.
+  //!
+  virtual Task * clone() const;
+
   //!
   //! Sets the default  values of the configuration parameters used by this task
   //!
@@ -70,8 +107,67 @@ public:
 
 
 protected:
-  
-  Pythia8::Pythia * pythia;
+
+  //!
+  //! Apply the beam, option, and model settings of the configuration to the first instance (the other instances of the pool copy
+  //! its settings). The seed is not set.
+  //!
+  void configurePythia();
+
+  //!
+  //! Set the seed of the given instance.
+  //!
+  void setSeed(Pythia8::Pythia & instance, long seed);
+
+  //!
+  //! Initialize the given instance, with the multiparton interaction initialization read from (or saved to) MPIInitFile if requested.
+  //!
+  void initializePythia(Pythia8::Pythia & instance, bool first);
+
+  //!
+  //! Build the table of CAP types indexed by PDG code.
+  //!
+  void initializeTypeTable();
+
+  inline ParticleType * getParticleType(int pdgCode) const
+  {
+  if (pdgCode>-maxTablePdgCode && pdgCode<maxTablePdgCode)
+    {
+    ParticleType * type = typeTable[pdgCode+maxTablePdgCode];
+    if (type) return type;
+    }
+  return ParticleDb::getDefaultParticleDb()->findPdgCode(pdgCode);
+  }
+
+  //!
+  //! Append the final state particles of the current event of the given instance to the given records.
+  //!
+  void copyParticles(Pythia8::Pythia & instance, vector<PythiaParticleRecord> & records) const;
+
+  //!
+  //! Start generating the next batch of events of the pool, and wait for the batch in progress, if any, to complete.
+  //!
+  void startBatch();
+  void finishBatch();
+
+  //!
+  //! Print the statistics of each instance of the pool, and the numbers of events and the cross section of the pool.
+  //!
+  void printPoolStatistics();
+
+  Pythia8::Pythia * pythia;       //!< single instance, or first instance of the pool
+  int    poolSize;                //!< number of PYTHIA instances of the pool (0: single instance generating on the calling thread)
+  int    poolBatchSize;           //!< number of events generated per instance and per batch
+  vector<Pythia8::Pythia*>  pool;         //!< instances of the pool, the first one being pythia
+  vector<PythiaEventBuffer> poolFilling;  //!< events being generated, per instance
+  vector<PythiaEventBuffer> poolReady;    //!< events being handed to the analysis chain, per instance
+  vector<std::thread>       poolThreads;  //!
+  vector<std::exception_ptr> poolExceptions; //!
+  unsigned int readyInstance;     //!< instance and event of the next event handed to the analysis chain
+  unsigned int readyEvent;
+  vector<PythiaParticleRecord> records;  //!< particles of the current event (single instance)
+  vector<ParticleType*>        typeTable;  //!< type of PDG code c at c+maxTablePdgCode (nullptr if no such type)
+  static const int maxTablePdgCode = 10000;
 
   ClassDef(PythiaEventGenerator,0)
 };
@@ -10,4 +10,5 @@
 #pragma link C++ class  CAP::CollisionGeometryMoments+;
 #pragma link C++ class  CAP::NucleusGenerator+;
 #pragma link C++ class  CAP::NucleonNucleonCollisionGenerator+;
+#pragma link C++ class  CAP::SpatialGrid+;
 #endif
@@ -9,7 +9,9 @@
  * Author: Claude Pruneau,   04/01/2022
  *
  * *********************************************************************/
+#include <algorithm>
 #include "CollisionGeometryGenerator.hpp"
+#include "RandomStream.hpp"
 using CAP::CollisionGeometryGenerator;
 
 ClassImp(CollisionGeometryGenerator);
@@ -26,7 +28,10 @@ CollisionGeometryGenerator::CollisionGeometryGenerator(const String & _name,
 EventTask(_name,_configuration),
 minB(0), minBSq(0.0), maxB(10.0), maxBSq(100.0),
 nnCrossSection(0.0),
-maxNNDistanceSq(0.)
+maxNNDistanceSq(0.),
+gridB(),
+candidates(),
+partners()
 {
   appendClassName("CollisionGeometryGenerator");
 }
@@ -155,37 +160,58 @@ void CollisionGeometryGenerator::createEvent()
   Event & event = *eventStreams[0];
   Nucleus & nucleusA = event.getNucleusA();
   Nucleus & nucleusB = event.getNucleusB();
-  double rr = gRandom->Rndm();
+  double rr = CAP::RandomStream::getRandomStream()->Rndm();
   double b  = sqrt(minBSq + rr*(maxBSq-minBSq));
   nucleusGeneratorA->generate(nucleusA, -b/2.0);
   nucleusGeneratorB->generate(nucleusB,  b/2.0);
+  // Only the nucleons of B in the cell of a nucleon of A, or in the neighbouring cells, can interact with it. The partners
+  // found are sorted so the interactions are added in the same order as with a test of all the pairs.
+  unsigned int nNucleonsB = nucleusB.getNNucleons();
+  double minimum[2] = { 0.0, 0.0 };
+  double maximum[2] = { 0.0, 0.0 };
+  for (unsigned int i2=0; i2<nNucleonsB; i2++)
+    {
+    LorentzVector & positionB = nucleusB.getNucleonAt(i2)->getPosition();
+    if (i2==0 || positionB.X()<minimum[0]) minimum[0] = positionB.X();
+    if (i2==0 || positionB.X()>maximum[0]) maximum[0] = positionB.X();
+    if (i2==0 || positionB.Y()<minimum[1]) minimum[1] = positionB.Y();
+    if (i2==0 || positionB.Y()>maximum[1]) maximum[1] = positionB.Y();
+    }
+  gridB.setGeometry(2,minimum,maximum,sqrt(maxNNDistanceSq));
+  for (unsigned int i2=0; i2<nNucleonsB; i2++)
+    {
+    LorentzVector & positionB = nucleusB.getNucleonAt(i2)->getPosition();
+    gridB.add(i2,positionB.X(),positionB.Y());
+    }
   Particle* interaction;
   for (unsigned int i1=0; i1<nucleusA.getNNucleons(); i1++)
     {
     Particle * nucleonA = nucleusA.getNucleonAt(i1);
-    for (unsigned int i2=0; i2<nucleusB.getNNucleons(); i2++)
+    LorentzVector & positionA = nucleonA->getPosition();
+    candidates.clear();
+    partners.clear();
+    gridB.getCandidates(positionA.X(),positionA.Y(),0.0,candidates);
+    for (auto i2 : candidates)
+      {
+      if (nucleonA->distanceXYSq(nucleusB.getNucleonAt(i2))<maxNNDistanceSq) partners.push_back(i2);
+      }
+    std::sort(partners.begin(),partners.end());
+    for (auto i2 : partners)
       {
       Particle * nucleonB = nucleusB.getNucleonAt(i2);
-      double dSq = nucleonA->distanceXYSq(nucleonB);
-      if (dSq<maxNNDistanceSq)
+      interaction = event.addInteraction(nucleonA,nucleonB);
+      if (!nucleonA->isWounded())
+        {
+      //  event.getParticipantMoments().fill(positionA.X() ,positionA.Y());
+        nucleonA->setWounded(true);
+        }
+      if (!nucleonB->isWounded())
         {
-        //cout << " A:  x= " << nucleonA->getPosition().X() << " B:  x= " << nucleonB->getPosition().X() << " I:  x= " << interaction.getPosition().X() << endl;
-        interaction = event.addInteraction(nucleonA,nucleonB);
-        if (!nucleonA->isWounded())
-          {
-          LorentzVector & positionA = nucleonA->getPosition();
-        //  event.getParticipantMoments().fill(positionA.X() ,positionA.Y());
-          nucleonA->setWounded(true);
-          }
-        if (!nucleonB->isWounded())
-          {
-          LorentzVector & positionB = nucleonA->getPosition();
-        //  event.getParticipantMoments().fill(positionB.X() ,positionB.Y());
-          nucleonB->setWounded(true);
-          }
-        LorentzVector & positionInt = interaction->getPosition();
-       // event.getBinaryMoments().fill(positionInt.X(),positionInt.Y());
+      //  event.getParticipantMoments().fill(positionB.X() ,positionB.Y());
+        nucleonB->setWounded(true);
         }
+      LorentzVector & positionInt = interaction->getPosition();
+     // event.getBinaryMoments().fill(positionInt.X(),positionInt.Y());
       }
     }
   //event.getBinaryMoments().calculate();
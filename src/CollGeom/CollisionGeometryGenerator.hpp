@@ -16,6 +16,7 @@
 #include "Particle.hpp"
 #include "ParticleType.hpp"
 #include "NucleusGenerator.hpp"
+#include "SpatialGrid.hpp"
 
 namespace CAP
 {
@@ -120,6 +121,17 @@ protected:
   //!
   double maxNNDistanceSq;
 
+  //!
+  //! Nucleons of nucleus B binned in the transverse plane with cells no smaller than the maximum interaction distance.
+  //!
+  SpatialGrid gridB;
+
+  //!
+  //! Work arrays: nucleons of B near, and interacting with, the current nucleon of A.
+  //!
+  vector<int> candidates;
+  vector<int> partners;
+
   ClassDef(CollisionGeometryGenerator,0)
 };
 
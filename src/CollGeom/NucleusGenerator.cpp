@@ -10,6 +10,7 @@
  *
  * *********************************************************************/
 #include "NucleusGenerator.hpp"
+#include "RandomStream.hpp"
 using CAP::NucleusGenerator;
 
 ClassImp(NucleusGenerator);
@@ -29,6 +30,8 @@ useRecentering(true),
 useNucleonExclusion(true),
 exclusionRadius(0.4), // fm
 exclusionRadiusSq(0.4*0.4),
+nucleonGrid(),
+candidates(),
 rDensity(nullptr),
 rProfile(nullptr),
 rProfileGen(nullptr)
@@ -77,6 +80,9 @@ void NucleusGenerator::initialize()
   useNucleonExclusion = configuration.getValueInt(getName(),"useNucleonExclusion");
   exclusionRadius     = configuration.getValueInt(getName(),"exclusionRadius"); // fm
   exclusionRadiusSq   = exclusionRadius*exclusionRadius;
+  double gridMinimum[3] = { -maxR, -maxR, -maxR };
+  double gridMaximum[3] = {  maxR,  maxR,  maxR };
+  nucleonGrid.setGeometry(3,gridMinimum,gridMaximum,exclusionRadius);
   double dr = (maxR-minR)/double(nR);
   double r  = minR + dr/2.0;
   double density;
@@ -151,6 +157,9 @@ void NucleusGenerator::generate(Nucleus & nucleus, double xShift)
   //nucleus.reset(); already handled by the collision geometry
   unsigned int iNucleon = 0;
   unsigned int nNucleons = nucleus.getNNucleons();
+  // with a null exclusion radius, no nucleon can be rejected.
+  bool exclusion = useNucleonExclusion && exclusionRadiusSq>0.0;
+  nucleonGrid.clear();
   while (iNucleon < nNucleons)
     {
     Particle * nucleon = nucleus.getNucleonAt(iNucleon);
@@ -158,10 +167,14 @@ void NucleusGenerator::generate(Nucleus & nucleus, double xShift)
     nucleon->setRCosThetaPhiT(r,cosTheta,phi,0.0);
     //nucleon->printProperties(cout);
     int sanityCheck = 0;
-    if (useNucleonExclusion)
+    LorentzVector & nucleonPosition = nucleon->getPosition();
+    if (exclusion)
       {
+      // only the nucleons accepted in the neighbouring cells can be closer than the exclusion radius.
       bool reject = false;
-      for (unsigned int jNucleon=0; jNucleon<iNucleon; jNucleon++)
+      candidates.clear();
+      nucleonGrid.getCandidates(nucleonPosition.X(),nucleonPosition.Y(),nucleonPosition.Z(),candidates);
+      for (auto jNucleon : candidates)
         {
         Particle * otherNucleon = nucleus.getNucleonAt(jNucleon);
         if (nucleon->distanceXYZSq(otherNucleon) < exclusionRadiusSq)
@@ -180,7 +193,8 @@ void NucleusGenerator::generate(Nucleus & nucleus, double xShift)
         continue;
         }
       }
-    position += nucleon->getPosition();
+    if (exclusion) nucleonGrid.add(iNucleon,nucleonPosition.X(),nucleonPosition.Y(),nucleonPosition.Z());
+    position += nucleonPosition;
     if (iNucleon<nucleus.getNProtons())
       nucleon->setType(ParticleType::getProtonType());
     else
@@ -201,9 +215,10 @@ void NucleusGenerator::generate(Nucleus & nucleus, double xShift)
 
 void NucleusGenerator::generate(double & r, double & cosTheta, double & phi)
 {
-  cosTheta = -1 + 2.0*gRandom->Rndm();
-  phi      = 2.0*3.1415927*gRandom->Rndm();
-  r        = rProfile->GetRandom();
+  TRandom * random = CAP::RandomStream::getRandomStream();
+  cosTheta = -1 + 2.0*random->Rndm();
+  phi      = 2.0*3.1415927*random->Rndm();
+  r        = rProfile->GetRandom(random);
   rProfileGen->Fill(r);
 }
 
@@ -16,6 +16,7 @@
 #include "Particle.hpp"
 #include "ParticleType.hpp"
 #include "Nucleus.hpp"
+#include "SpatialGrid.hpp"
 
 namespace CAP
 {
@@ -89,6 +90,12 @@ protected:
   double exclusionRadius;
   double exclusionRadiusSq;
 
+  //!
+  //! Nucleons accepted so far, binned in space with cells no smaller than the exclusion radius (useNucleonExclusion).
+  //!
+  SpatialGrid nucleonGrid;
+  vector<int> candidates;
+
   TH1 * rDensity;
   TH1 * rProfile;
   TH1 * rProfileGen;
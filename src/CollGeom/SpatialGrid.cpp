@@ -0,0 +1,102 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#include <algorithm>
+#include "SpatialGrid.hpp"
+using CAP::SpatialGrid;
+
+ClassImp(SpatialGrid);
+
+SpatialGrid::SpatialGrid()
+:
+nDimensions(2),
+head(),
+next(),
+filled()
+{
+  for (int iDimension=0; iDimension<3; iDimension++)
+    {
+    nCells[iDimension]          = 1;
+    origin[iDimension]          = 0.0;
+    inverseCellSize[iDimension] = 0.0;
+    }
+}
+
+void SpatialGrid::setGeometry(int _nDimensions, const double * minimum, const double * maximum, double cellSize, int maxCellsPerDimension)
+{
+  nDimensions = (_nDimensions<3) ? 2 : 3;
+  if (maxCellsPerDimension<1) maxCellsPerDimension = 1;
+  int nCellsTotal = 1;
+  for (int iDimension=0; iDimension<3; iDimension++)
+    {
+    nCells[iDimension]          = 1;
+    origin[iDimension]          = 0.0;
+    inverseCellSize[iDimension] = 0.0;
+    if (iDimension>=nDimensions) continue;
+    double range = maximum[iDimension] - minimum[iDimension];
+    double size  = cellSize;
+    if (size*maxCellsPerDimension < range) size = range/maxCellsPerDimension;
+    origin[iDimension] = minimum[iDimension];
+    if (size>0.0 && range>0.0)
+      {
+      nCells[iDimension]          = std::min(maxCellsPerDimension,int(range/size)+1);
+      inverseCellSize[iDimension] = 1.0/size;
+      }
+    nCellsTotal *= nCells[iDimension];
+    }
+  head.assign(nCellsTotal,-1);
+  filled.clear();
+}
+
+void SpatialGrid::clear()
+{
+  for (auto cell : filled) head[cell] = -1;
+  filled.clear();
+}
+
+int SpatialGrid::getCell(int iDimension, double value) const
+{
+  double u = (value-origin[iDimension])*inverseCellSize[iDimension];
+  if (!(u>0.0)) return 0;
+  int cell = int(u);
+  return (cell<nCells[iDimension]) ? cell : nCells[iDimension]-1;
+}
+
+void SpatialGrid::add(int index, double x, double y, double z)
+{
+  int cell = getCell(0,x) + nCells[0]*getCell(1,y);
+  if (nDimensions==3) cell += nCells[0]*nCells[1]*getCell(2,z);
+  if (index>=int(next.size())) next.resize(index+1,-1);
+  if (head[cell]<0) filled.push_back(cell);
+  next[index] = head[cell];
+  head[cell]  = index;
+}
+
+void SpatialGrid::getCandidates(double x, double y, double z, vector<int> & candidates) const
+{
+  int ix = getCell(0,x);
+  int iy = getCell(1,y);
+  int iz = (nDimensions==3) ? getCell(2,z) : 0;
+  int ixMin = std::max(ix-1,0), ixMax = std::min(ix+1,nCells[0]-1);
+  int iyMin = std::max(iy-1,0), iyMax = std::min(iy+1,nCells[1]-1);
+  int izMin = std::max(iz-1,0), izMax = std::min(iz+1,nCells[2]-1);
+  for (int jz=izMin; jz<=izMax; jz++)
+    {
+    for (int jy=iyMin; jy<=iyMax; jy++)
+      {
+      int cell = nCells[0]*(jy + nCells[1]*jz);
+      for (int jx=ixMin; jx<=ixMax; jx++)
+        {
+        for (int index=head[cell+jx]; index>=0; index=next[index]) candidates.push_back(index);
+        }
+      }
+    }
+}
@@ -0,0 +1,75 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#ifndef CAP__SpatialGrid
+#define CAP__SpatialGrid
+#include <vector>
+#include "TObject.h"
+using namespace std;
+
+namespace CAP
+{
+
+//!
+//! Uniform grid of cells, in the transverse plane (2D) or in space (3D), used to find the neighbours of a point without testing
+//! all the points. Points are added with an index (e.g., the index of a nucleon in its nucleus). Since the cells are no smaller than
+//! the requested cell size, all the points closer to a point than the cell size lie in its cell or in the neighbouring cells:
+//! getCandidates() returns the indices of the points of these cells, to be tested by the caller with its own distance criterion.
+//!
+//! Points outside the grid range are assigned to the edge cells, which preserves the above property. The number of cells per
+//! dimension is capped (maxCellsPerDimension) by enlarging the cells. Clearing the grid only resets the cells that were filled.
+//!
+class SpatialGrid
+{
+public:
+
+  SpatialGrid();
+  virtual ~SpatialGrid() {}
+
+  //!
+  //! Define the grid and remove all points. nDimensions is 2 (x,y) or 3 (x,y,z); minimum and maximum give the range of each dimension.
+  //!
+  void setGeometry(int nDimensions, const double * minimum, const double * maximum, double cellSize, int maxCellsPerDimension=64);
+
+  //!
+  //! Remove all points.
+  //!
+  void clear();
+
+  //!
+  //! Add the point of given index at the given position (z is ignored by 2D grids).
+  //!
+  void add(int index, double x, double y, double z=0.0);
+
+  //!
+  //! Append to candidates the indices of the points of the cell of the given position and of its neighbouring cells. The order of
+  //! the indices is not specified.
+  //!
+  void getCandidates(double x, double y, double z, vector<int> & candidates) const;
+
+protected:
+
+  int getCell(int iDimension, double value) const;
+
+  int    nDimensions;
+  int    nCells[3];
+  double origin[3];
+  double inverseCellSize[3];
+  vector<int> head;     //!< first point of each cell, -1 if the cell is empty
+  vector<int> next;     //!< next point of the cell of each point, -1 for the last point
+  vector<int> filled;   //!< cells that hold at least one point
+
+  ClassDef(SpatialGrid,0)
+};
+
+} // namespace CAP
+
+#endif /* CAP__SpatialGrid */
@@ -45,13 +45,10 @@ void EposEventReader::importEvent()
   parentInteraction->setType( ParticleType::getInteractionType());
   parentInteraction->setXYZT(0.0, 0.0, 0.0, 0.0);
   event.add(parentInteraction);
-  Long64_t ientry = LoadTree(entryIndex);
-  if (ientry < 0)
+  if (!readEntry())
     {
     postTaskEod();  return;
     }
-  nb = rootInputTreeChain()->GetEntry(entryIndex++);
-  nBytes += nb;
   if (nParticles > arraySize)
     {
     if (reportError(__FUNCTION__)) cout<< "nParticles: " << nParticles << "  exceeds capacity " << arraySize << endl;
@@ -124,16 +121,15 @@ void EposEventReader::importEvent()
 
 void EposEventReader::initInputTreeMapping()
 {
-  TTree * tree = rootInputTreeChain();
-  tree->SetMakeClass(1);
-  tree->SetBranchAddress("Events", &events,   &b_Events);
-  tree->SetBranchAddress("Mult", &nParticles, &b_Mult);
-  tree->SetBranchAddress("Impact", &impact,   &b_Impact);
-  tree->SetBranchAddress("PID", pid, &b_PID);
-  tree->SetBranchAddress("Px", px, &b_Px);
-  tree->SetBranchAddress("Py", py, &b_Py);
-  tree->SetBranchAddress("Pz", pz, &b_Pz);
-  tree->SetBranchAddress("E", e, &b_E);
+  rootInputTreeChain()->SetMakeClass(1);
+  setBranchAddress("Events", &events, &b_Events);
+  setBranchAddress("Mult", &nParticles, &b_Mult);
+  setBranchAddress("Impact", &impact, &b_Impact);
+  setBranchAddress("PID", pid, nParticles, &b_PID);
+  setBranchAddress("Px", px, nParticles, &b_Px);
+  setBranchAddress("Py", py, nParticles, &b_Py);
+  setBranchAddress("Pz", pz, nParticles, &b_Pz);
+  setBranchAddress("E", e, nParticles, &b_E);
 }
 
 
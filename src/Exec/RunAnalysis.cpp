@@ -16,9 +16,11 @@
 #include "DerivedHistoIterator.hpp"
 #include "BalanceFunctionCalculator.hpp"
 #include "SubSampleStatCalculator.hpp"
+#include "HierarchicalMerger.hpp"
 #include "ClosureIterator.hpp"
 #include "PythiaEventGenerator.hpp"
 #include "AmptEventReader.hpp"
+#include "EventCAPReaderTask.hpp"
 #include "TherminatorGenerator.hpp"
 #include "ResonanceGenerator.hpp"
 #include "MeasurementPerformanceSimulator.hpp"
@@ -67,7 +69,8 @@ labelEpos("Epos"),
 labelUrqmd("Urqmd"),
 labelTherminator("Therminator"),
 labelResonance("Resonance"),
-labelPerformance("Performance")
+labelPerformance("Performance"),
+labelCAPReader("CAPReader")
 {
   appendClassName("RunAnalysis");
 }
@@ -103,6 +106,7 @@ void RunAnalysis::setDefaultConfiguration()
   addParameter("labelTherminator",    labelTherminator);
   addParameter("labelResonance",      labelResonance);
   addParameter("labelPerformance",    labelPerformance);
+  addParameter("labelCAPReader",      labelCAPReader);
 
   addParameter("Severity",                   TString("Info"));
   addParameter("RunParticleDbManager",       YES);
@@ -130,6 +134,9 @@ void RunAnalysis::setDefaultConfiguration()
   addParameter("RunSubsampleBalFct",         NO);
   addParameter("RunSubsampleBalFctGen",      NO);
   addParameter("RunSubsampleBalFctReco",     NO);
+  addParameter("RunMerge",                   NO);
+  addParameter("RunMergeGen",                NO);
+  addParameter("RunMergeReco",               NO);
 
   addParameter("Analysis:RunPerformanceSim",          NO);
   addParameter("Analysis:RunPerformanceAna",          NO);
@@ -145,6 +152,7 @@ void RunAnalysis::setDefaultConfiguration()
   addParameter("Analysis:RunUrqmdReader",             NO);
   addParameter("Analysis:RunTherminatorGenerator",    NO);
   addParameter("Analysis:RunHijingReader",            NO);
+  addParameter("Analysis:RunCAPReader",               NO);
   addParameter("Analysis:RunResonanceGenerator",      NO);
   addParameter("Analysis:RunGlobalAnalysisGen",       NO);
   addParameter("Analysis:RunGlobalAnalysisReco",      NO);
@@ -189,6 +197,7 @@ void RunAnalysis::configureLabels()
   labelTherminator    = getValueString("labelTherminator");
   labelResonance      = getValueString("labelResonance");
   labelPerformance    = getValueString("labelPerformance");
+  labelCAPReader      = getValueString("labelCAPReader");
 
   if (reportDebug(__FUNCTION__))
     {
@@ -218,6 +227,7 @@ void RunAnalysis::configureLabels()
     printItem("labelTherminator",   labelTherminator);
     printItem("labelResonance",     labelResonance);
     printItem("labelPerformance",   labelPerformance);
+    printItem("labelCAPReader",     labelCAPReader);
     }
 }
 
@@ -260,6 +270,7 @@ void RunAnalysis::configure()
 
     if (getValueBool("Analysis:RunPythiaGenerator"))         eventAnalysis->addSubTask(new PythiaEventGenerator(labelPythia,*requestedConfiguration));
     if (getValueBool("Analysis:RunAmptReader"))              eventAnalysis->addSubTask(new AmptEventReader(labelAmpt,*requestedConfiguration));
+    if (getValueBool("Analysis:RunCAPReader"))               eventAnalysis->addSubTask(new EventCAPReaderTask(labelCAPReader,*requestedConfiguration));
     if (getValueBool("Analysis:RunTherminatorGenerator"))    eventAnalysis->addSubTask(new TherminatorGenerator(labelTherminator,*requestedConfiguration));
     if (getValueBool("Analysis:RunResonanceGenerator"))      eventAnalysis->addSubTask(new ResonanceGenerator(labelResonance,*requestedConfiguration));
     if (getValueBool("Analysis:RunPerformanceSim"))          eventAnalysis->addSubTask(new MeasurementPerformanceSimulator(labelPerformance,*requestedConfiguration));
@@ -513,6 +524,30 @@ void RunAnalysis::configure()
     if (reportInfo(__FUNCTION__)) cout << "Subsample calculation Setup Completed" << std::endl;
     }
 
+  //
+  // Run tasks that merge (sum) the histograms of all bunches and sub-bunches.
+  //
+  if (getValueBool("RunMerge"))
+    {
+    if (getValueBool("RunMergeGen"))
+      {
+      if (getValueBool("Analysis:RunGlobalAnalysisGen"))     addMergeTask(histoImportPath,labelGlobal+labelGenerator);
+      if (getValueBool("Analysis:RunSpherocityAnalysisGen")) addMergeTask(histoImportPath,labelSpherocity+labelGenerator);
+      if (getValueBool("Analysis:RunPartSingleAnalysisGen")) addMergeTask(histoImportPath,labelSingle+labelGenerator);
+      if (getValueBool("Analysis:RunPartPairAnalysisGen"))   addMergeTask(histoImportPath,labelPair+labelGenerator);
+      if (getValueBool("Analysis:RunNuDynAnalysisGen"))      addMergeTask(histoImportPath,labelNuDyn+labelGenerator);
+      }
+    if (getValueBool("RunMergeReco"))
+      {
+      if (getValueBool("Analysis:RunGlobalAnalysisReco"))     addMergeTask(histoImportPath,labelGlobal+labelReconstruction);
+      if (getValueBool("Analysis:RunSpherocityAnalysisReco")) addMergeTask(histoImportPath,labelSpherocity+labelReconstruction);
+      if (getValueBool("Analysis:RunPartSingleAnalysisReco")) addMergeTask(histoImportPath,labelSingle+labelReconstruction);
+      if (getValueBool("Analysis:RunPartPairAnalysisReco"))   addMergeTask(histoImportPath,labelPair+labelReconstruction);
+      if (getValueBool("Analysis:RunNuDynAnalysisReco"))      addMergeTask(histoImportPath,labelNuDyn+labelReconstruction);
+      }
+    if (reportInfo(__FUNCTION__)) cout << "Merge Setup Completed" << std::endl;
+    }
+
   // He we call configure on all tasks and subtasks. We also make sure all the tasks have the same import
   // and export paths for histograms.
   //
@@ -764,4 +799,24 @@ void RunAnalysis::addBalFctSubSampleTask(const String & basePath,
 
 }
 
+void RunAnalysis::addMergeTask(const String & basePath,
+                               const String & taskType)
+{
+  if (reportInfo(__FUNCTION__))
+    {
+    printItem("basePath",basePath);
+    printItem("taskType",taskType);
+    }
+  Configuration & subConfig = * new Configuration(configuration);
+  subConfig.addParameter(TString("Run:")+taskType+TString(":Severity"),"Info");
+  subConfig.addParameter(TString("Run:")+taskType+TString(":HistogramsImportPath"),basePath);
+  subConfig.addParameter(TString("Run:")+taskType+TString(":HistogramsExportPath"),basePath);
+  subConfig.addParameter(TString("Run:")+taskType+TString(":IncludedPattern0"),taskType);
+  subConfig.addParameter(TString("Run:")+taskType+TString(":ExcludedPattern1"),TString("Derived"));
+  subConfig.addParameter(TString("Run:")+taskType+TString(":ExcludedPattern2"),TString("BalFct"));
+  subConfig.addParameter(TString("Run:")+taskType+TString(":ExcludedPattern3"),TString("Sum"));
+  subConfig.addParameter(TString("Run:")+taskType+TString(":ExcludedPattern4"),TString("Merged"));
+  addSubTask( new HierarchicalMerger(taskType,subConfig));
+}
+
 } // namespace CAP
@@ -71,6 +71,9 @@ public:
                               int   maximumDepth,
                               const String & taskType);
 
+  void addMergeTask(const String & basePath,
+                    const String & taskType);
+
 
 
 
@@ -101,6 +104,7 @@ protected:
   String labelTherminator;
   String labelResonance;
   String labelPerformance;
+  String labelCAPReader;
 
   ClassDef(RunAnalysis,0)
 };
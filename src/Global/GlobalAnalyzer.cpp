@@ -34,6 +34,13 @@ ptSum()
   appendClassName("GlobalAnalyzer");
 }
 
+CAP::Task * GlobalAnalyzer::clone() const
+{
+  GlobalAnalyzer * task = new GlobalAnalyzer(getName(),configuration);
+  configureClone(task);
+  return task;
+}
+
 //!
 //!
 void GlobalAnalyzer::setDefaultConfiguration()
@@ -225,8 +232,10 @@ void GlobalAnalyzer::analyzeEvent()
   // resetParticleCounters();
   unsigned int nEventFilters    = eventFilters.size();
   unsigned int nParticleFilters = particleFilters.size();
-  unsigned int nParticles       = event.getNParticles();
+  const EventCAPView * view     = event.getView();
+  unsigned int nParticles       = view ? view->getNParticles() : event.getNParticles();
   resetNParticlesAcceptedEvent();
+  fillParticleFilterMasks(event);
 
 //  if (reportInfo(__FUNCTION__))
 //    {
@@ -248,24 +257,39 @@ void GlobalAnalyzer::analyzeEvent()
     s.assign(nParticleFilters,0.0);
     b.assign(nParticleFilters,0.0);
     ptSum.assign(nParticleFilters,0.0);
-    for (unsigned int iParticle=0; iParticle<event.getNParticles(); iParticle++)
+    for (unsigned int iParticle=0; iParticle<nParticles; iParticle++)
       {
-      Particle & particle = * event.getParticleAt(iParticle);
+      if (!isAcceptedByAny(iParticle)) continue;
+      ParticleType * type;
+      double energy, pt;
+      if (view)
+        {
+        // particles of unknown type are rejected by the filters
+        type   = view->getType(iParticle);
+        energy = view->e[iParticle];
+        pt     = view->getPt(iParticle);
+        }
+      else
+        {
+        Particle & particle = * event.getParticleAt(iParticle);
+        LorentzVector & momentum = particle.getMomentum();
+        type   = particle.getTypePtr();
+        energy = momentum.E();
+        pt     = momentum.Pt();
+        }
       for (unsigned int iParticleFilter=0; iParticleFilter<nParticleFilters; iParticleFilter++ )
         {
         //cout << iParticleFilter << "  " << particle.getType().getName() << endl;
-        if (particleFilters[iParticleFilter]->accept(particle))
+        if (isAccepted(iParticle,iParticleFilter))
           {
           incrementNParticlesAccepted(iEventFilter,iParticleFilter);
           // // incrementParticlesAccepted();
-          ParticleType & type = particle.getType();
-          LorentzVector & momentum = particle.getMomentum();
           n[iParticleFilter]++;
-          e[iParticleFilter] += momentum.E();
-          q[iParticleFilter] += type.getCharge();
-          s[iParticleFilter] += type.getStrangessNumber();
-          b[iParticleFilter] += type.getBaryonNumber();
-          ptSum[iParticleFilter] += momentum.Pt();
+          e[iParticleFilter] += energy;
+          q[iParticleFilter] += type->getCharge();
+          s[iParticleFilter] += type->getStrangessNumber();
+          b[iParticleFilter] += type->getBaryonNumber();
+          ptSum[iParticleFilter] += pt;
           }
         }
       }
@@ -51,7 +51,12 @@ public:
   //! DTOR
   //!
   virtual ~GlobalAnalyzer() {}
-  
+
+  //!
+  //! Returns a configured clone of this task used for multithreaded execution.
+  //!
+  virtual Task * clone() const;
+
   //!
   //! Sets the default  values of the configuration parameters used by this task
   //!
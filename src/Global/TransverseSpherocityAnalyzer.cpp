@@ -10,6 +10,7 @@
  *
  * *********************************************************************/
 
+#include <algorithm>
 #include "TransverseSpherocityAnalyzer.hpp"
 using CAP::TransverseSpherocityAnalyzer;
 
@@ -22,12 +23,24 @@ EventTask(_name,_configuration),
 setEvent(true),
 fillS0(true),
 fillS1(false),
+exact(true),
 nSteps(360),
-stepSize(CAP::Math::twoPi()/360.0)
+stepSize(CAP::Math::twoPi()/360.0),
+particlePx(),
+particlePy(),
+particlePt(),
+directions()
 {
   appendClassName("TransverseSpherocityAnalyzer");
 }
 
+CAP::Task * TransverseSpherocityAnalyzer::clone() const
+{
+  TransverseSpherocityAnalyzer * task = new TransverseSpherocityAnalyzer(getName(),configuration);
+  configureClone(task);
+  return task;
+}
+
 //!
 //!
 void TransverseSpherocityAnalyzer::setDefaultConfiguration()
@@ -40,7 +53,8 @@ void TransverseSpherocityAnalyzer::setDefaultConfiguration()
   addParameter("EventsUseStream1",    false);
   addParameter("SetEvent",            true);
   addParameter("FillCorrelationHistos",false);
-  addParameter("nSteps", 1000);
+  addParameter("Exact",  true);
+  addParameter("nSteps", 360);
   addParameter("FillS0", true);
   addParameter("FillS1", false);
   addParameter("FillS1VsS0", false);
@@ -56,6 +70,10 @@ void TransverseSpherocityAnalyzer::configure()
   fillS0     = getValueBool("FillS0");
   fillS1     = getValueBool("FillS1");
   fillS1VsS0 = getValueBool("FillS1VsS0");
+  exact      = getValueBool("Exact");
+  nSteps     = getValueInt("nSteps");
+  if (nSteps<1) nSteps = 1;
+  stepSize   = CAP::Math::twoPi()/double(nSteps);
 
   if (reportInfo(__FUNCTION__))
     {
@@ -69,6 +87,7 @@ void TransverseSpherocityAnalyzer::configure()
     printItem("HistogramsExport");
     printItem("SetEvent");
     printItem("FillCorrelationHistos");
+    printItem("Exact");
     printItem("nSteps");
     printItem("FillS0");
     printItem("FillS1");
@@ -160,7 +179,21 @@ void TransverseSpherocityAnalyzer::analyzeEvent()
   unsigned int nEventFilters    = eventFilters.size();
   unsigned int nParticleFilters = particleFilters.size();
   unsigned int nParticles       = event.getNParticles();
-  
+  fillParticleFilterMasks(event);
+
+  // momenta are computed once per event and shared by all filters and directions.
+  particlePx.resize(nParticles);
+  particlePy.resize(nParticles);
+  particlePt.resize(nParticles);
+  for (unsigned int iParticle=0; iParticle<nParticles; iParticle++)
+    {
+    if (!isAcceptedByAny(iParticle)) continue;
+    LorentzVector & momentum = event.getParticleAt(iParticle)->getMomentum();
+    particlePx[iParticle] = momentum.Px();
+    particlePy[iParticle] = momentum.Py();
+    particlePt[iParticle] = momentum.Pt();
+    }
+
   for (unsigned int iEventFilter=0; iEventFilter<nEventFilters; iEventFilter++ )
     {
     if (!eventFilters[iEventFilter]->accept(event)) continue;
@@ -172,55 +205,13 @@ void TransverseSpherocityAnalyzer::analyzeEvent()
       {
       double  s0 = 1.0E10;
       double  s1 = 1.0E10;
-      double  num0, num1, nx, ny, px, py, pt;
-      double  denom0 = 0;
-      double  denom1 = 0;
-      double  refPhi  = 0.0;
-      for(int k = 0; k < nSteps; k++)
-        {
-        //double  phiparam = ((CAP::Math::pi()) * i * stepSize) / 180;
-        nx = cos(refPhi); // x component of a unitary vector n
-        ny = sin(refPhi); // y component of a unitary vector n
-        num0 = 0;
-        num1 = 0;
-        for (unsigned int iParticle=0; iParticle<nParticles; iParticle++)
-          {
-          Particle & particle = * event.getParticleAt(iParticle);
-          if (!particleFilters[iParticleFilter]->accept(particle)) continue;
-          LorentzVector & momentum = particle.getMomentum();
-          pt = momentum.Pt();
-          px = momentum.Px();
-          py = momentum.Py();
-          if (fillS0)
-            {
-            num0 += TMath::Abs(ny*px - nx*py);
-            if(k==0) denom0 += pt;
-            }
-          if (fillS1)
-            {
-            double  ax = px/pt;
-            double  ay = py/pt;
-            num1 += TMath::Abs(ny*ax - nx*ay);
-            if(k==0) denom1 += 1;
-            }
-          }
-        if (fillS0)
-          {
-          double ratio = num0/denom0;
-          double r2 = ratio*ratio;
-          if (r2 < s0) s0 = r2;
-          }
-        if (fillS1)
-          {
-          double ratio = num1/denom1;
-          double r2 = ratio*ratio;
-          if (r2 < s1) s1 = r2;
-          }
-        refPhi += stepSize;
-        }
-        if (fillS0) s0Filtered[iParticleFilter] = s0*factor;
-        if (fillS1) s1Filtered[iParticleFilter] = s1*factor;
-        }
+      if (exact)
+        calculateExact(iParticleFilter,s0,s1);
+      else
+        calculateWithScan(iParticleFilter,s0,s1);
+      if (fillS0) s0Filtered[iParticleFilter] = s0*factor;
+      if (fillS1) s1Filtered[iParticleFilter] = s1*factor;
+      }
     if (setEvent && iEventFilter==0)
         {
         EventProperties * ep = event.getEventProperties();
@@ -231,6 +222,127 @@ void TransverseSpherocityAnalyzer::analyzeEvent()
   }
 }
 
+void TransverseSpherocityAnalyzer::calculateWithScan(unsigned int iParticleFilter, double & s0, double & s1)
+{
+  unsigned int nParticles = particlePt.size();
+  double  num0, num1, nx, ny, px, py, pt;
+  double  denom0 = 0;
+  double  denom1 = 0;
+  double  refPhi  = 0.0;
+  for(int k = 0; k < nSteps; k++)
+    {
+    nx = cos(refPhi); // x component of a unitary vector n
+    ny = sin(refPhi); // y component of a unitary vector n
+    num0 = 0;
+    num1 = 0;
+    for (unsigned int iParticle=0; iParticle<nParticles; iParticle++)
+      {
+      if (!isAccepted(iParticle,iParticleFilter)) continue;
+      pt = particlePt[iParticle];
+      px = particlePx[iParticle];
+      py = particlePy[iParticle];
+      if (fillS0)
+        {
+        num0 += TMath::Abs(ny*px - nx*py);
+        if(k==0) denom0 += pt;
+        }
+      if (fillS1)
+        {
+        double  ax = px/pt;
+        double  ay = py/pt;
+        num1 += TMath::Abs(ny*ax - nx*ay);
+        if(k==0) denom1 += 1;
+        }
+      }
+    if (fillS0)
+      {
+      double ratio = num0/denom0;
+      double r2 = ratio*ratio;
+      if (r2 < s0) s0 = r2;
+      }
+    if (fillS1)
+      {
+      double ratio = num1/denom1;
+      double r2 = ratio*ratio;
+      if (r2 < s1) s1 = r2;
+      }
+    refPhi += stepSize;
+    }
+}
+
+void TransverseSpherocityAnalyzer::calculateExact(unsigned int iParticleFilter, double & s0, double & s1)
+{
+  unsigned int nParticles = particlePt.size();
+  double denom0 = 0;
+  double denom1 = 0;
+  double totalPx = 0, totalPy = 0;
+  double totalUx = 0, totalUy = 0;
+  directions.clear();
+  for (unsigned int iParticle=0; iParticle<nParticles; iParticle++)
+    {
+    if (!isAccepted(iParticle,iParticleFilter)) continue;
+    double pt = particlePt[iParticle];
+    if (pt<=0.0) continue; // no direction, no contribution to the numerators
+    Direction direction;
+    // |n x p| does not change when p is reversed: p is reflected into the upper half plane, with azimuth in [0,pi].
+    bool reflect = particlePy[iParticle]<0.0 || (particlePy[iParticle]==0.0 && particlePx[iParticle]<0.0);
+    direction.px  = reflect ? -particlePx[iParticle] : particlePx[iParticle];
+    direction.py  = reflect ? -particlePy[iParticle] : particlePy[iParticle];
+    direction.ux  = direction.px/pt;
+    direction.uy  = direction.py/pt;
+    direction.phi = atan2(direction.py,direction.px);
+    directions.push_back(direction);
+    denom0  += pt;
+    denom1  += 1;
+    totalPx += direction.px;
+    totalPy += direction.py;
+    totalUx += direction.ux;
+    totalUy += direction.uy;
+    }
+  if (directions.size()<1) return;
+  std::sort(directions.begin(),directions.end());
+  // For n = (cos phi, sin phi) along a particle, |n x p_i| = n x p_i for the particles with larger azimuth and -n x p_i for
+  // those with smaller azimuth (n x p = px sin phi - py cos phi up to the sign): the sums of both groups are running sums.
+  double lowerPx = 0, lowerPy = 0;
+  double lowerUx = 0, lowerUy = 0;
+  double num0Min = 1.0E300;
+  double num1Min = 1.0E300;
+  for (auto & direction : directions)
+    {
+    double nx = direction.ux;
+    double ny = direction.uy;
+    if (fillS0)
+      {
+      double upper = (totalPy-lowerPy)*nx - (totalPx-lowerPx)*ny;
+      double lower = lowerPy*nx - lowerPx*ny;
+      double num0  = upper - lower;
+      if (num0 < num0Min) num0Min = num0;
+      }
+    if (fillS1)
+      {
+      double upper = (totalUy-lowerUy)*nx - (totalUx-lowerUx)*ny;
+      double lower = lowerUy*nx - lowerUx*ny;
+      double num1  = upper - lower;
+      if (num1 < num1Min) num1Min = num1;
+      }
+    lowerPx += direction.px;
+    lowerPy += direction.py;
+    lowerUx += direction.ux;
+    lowerUy += direction.uy;
+    }
+  // rounding errors of the running sums may yield slightly negative minima for collinear events.
+  if (fillS0)
+    {
+    double ratio = (num0Min>0.0) ? num0Min/denom0 : 0.0;
+    s0 = ratio*ratio;
+    }
+  if (fillS1)
+    {
+    double ratio = (num1Min>0.0) ? num1Min/denom1 : 0.0;
+    s1 = ratio*ratio;
+    }
+}
+
 void TransverseSpherocityAnalyzer::createDerivedHistograms()
 {
 
@@ -44,7 +44,12 @@ public:
   //! DTOR
   //!
   virtual ~TransverseSpherocityAnalyzer() {}
-  
+
+  //!
+  //! Returns a configured clone of this task used for multithreaded execution.
+  //!
+  virtual Task * clone() const;
+
   //!
   //! Sets the default  values of the configuration parameters used by this task
   //!
@@ -79,14 +84,45 @@ public:
   virtual void calculateDerivedHistograms();
 
 protected:
+
+  //!
+  //! Compute the squared ratios minimized by S0 and S1 for the particles accepted by the given filter, by scanning nSteps
+  //! directions of the transverse plane. The result is approximate: the minimum lies between two scanned directions.
+  //!
+  void calculateWithScan(unsigned int iParticleFilter, double & s0, double & s1);
+
+  //!
+  //! Compute the squared ratios minimized by S0 and S1 for the particles accepted by the given filter exactly. The sums of
+  //! |n x p| are concave between the directions of the particles, so their minimum lies along one of these directions: the
+  //! particles are sorted in azimuth (modulo pi) and all the directions are evaluated in a single pass with running sums.
+  //!
+  void calculateExact(unsigned int iParticleFilter, double & s0, double & s1);
+
   
   bool setEvent;   //!< Whether this task instance sets spherocity properties stored in the EventProperty record of the current event.
   bool fillS0;     //!< Whether the regular spherocity observable S0 should be analyzed and filled by this task.
   bool fillS1;     //!< Whether the unit vector spherocity observable S1 should be analyzed and filled by this task.
   bool fillS1VsS0; //!< Whether two-dimensional S1 vs S0 histograms should be filled.
+  bool   exact;    //!< Whether the exact algorithm is used rather than the scan of nSteps directions (kept for validation).
   int    nSteps;   //!< Number of azimuthal steps used in the calculation of the transverse spherocity.
   double stepSize; //!< Two-pi/nSteps.
 
+  vector<double> particlePx;  //!< px of the particles of the current event
+  vector<double> particlePy;  //!< py of the particles of the current event
+  vector<double> particlePt;  //!< pt of the particles of the current event
+
+  //!
+  //! Accepted particle of the exact algorithm: azimuth modulo pi, momentum and unit vector reflected into the upper half plane.
+  //!
+  struct Direction
+  {
+    double phi;
+    double px, py;
+    double ux, uy;
+    bool operator<(const Direction & other) const { return phi<other.phi; }
+  };
+  vector<Direction> directions;
+
   ClassDef(TransverseSpherocityAnalyzer,0)
 };
 
@@ -273,6 +273,7 @@ void IdentityAnalyzer::analyzeEvent()
   Event & event = *eventStreams[0];
   vector<Particle*> & particles = event.getParticles();
   Size_t nParticles = particles.size();
+  fillParticleFilterMasks(event);
   for (int iEventFilter=0; iEventFilter<nEventFilters; iEventFilter++ )
     {
     if (!eventFilters[iEventFilter]->accept(event)) continue;
@@ -282,12 +283,13 @@ void IdentityAnalyzer::analyzeEvent()
     unsigned int  index;
     for (unsigned int iParticle1=0; iParticle1<nParticles; iParticle1++)
       {
+      if (!isAcceptedByAny(iParticle1)) continue;
       Particle & particle1 = *(particles[iParticle1]);
       //bool accepted = false;
       for (int iParticleFilter1=0; iParticleFilter1<nParticleFilters; iParticleFilter1++ )
         {
 
-        if (particleFilters[iParticleFilter1]->accept(particle1))
+        if (isAccepted(iParticle1,iParticleFilter1))
           {
           //cout << " ACCEPTED" << endl;
           incrementNParticlesAccepted(iEventFilter,iParticleFilter1);
@@ -311,14 +313,14 @@ void IdentityAnalyzer::analyzeEvent()
       for (unsigned int iParticle2=0; iParticle2<nParticles; iParticle2++)
         {
         if (iParticle1==iParticle2) continue;
+        if (!isAcceptedByAny(iParticle2)) continue;
         Particle & particle2 = *(particles[iParticle2]);
         for (int iParticleFilter1=0; iParticleFilter1<nParticleFilters; iParticleFilter1++ )
           {
-          bool accept1 = particleFilters[iParticleFilter1]->accept(particle1);
+          if (!isAccepted(iParticle1,iParticleFilter1)) continue;
           for (int iParticleFilter2=0; iParticleFilter2<nParticleFilters; iParticleFilter2++ )
             {
-            bool accept2 = particleFilters[iParticleFilter2]->accept(particle2);
-            if (accept1 & accept2)
+            if (isAccepted(iParticle2,iParticleFilter2))
               {
               index = basePair + iParticleFilter1*nParticleFilters + iParticleFilter2;
               ParticlePairHistos * histos = (ParticlePairHistos *)  histogramManager.getGroup(1,index);
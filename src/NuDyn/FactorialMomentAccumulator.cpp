@@ -0,0 +1,241 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#include <algorithm>
+#include <map>
+#include <functional>
+#include "FactorialMomentAccumulator.hpp"
+#include "Exceptions.hpp"
+using CAP::FactorialMomentAccumulator;
+
+ClassImp(FactorialMomentAccumulator);
+
+FactorialMomentAccumulator::FactorialMomentAccumulator(unsigned int _nFilters, unsigned int _maxOrder, unsigned int _nCells)
+:
+nFilters(0),
+maxOrder(0),
+nCells(0),
+nMoments(0),
+stride(0),
+orderFirst(),
+momentOrder(),
+momentParent(),
+momentFilter(),
+momentOffset(),
+products(),
+cumulantFirst(),
+termCoefficient(),
+termFirst(),
+termFactors(),
+sums(),
+cellFilled(),
+filledCells()
+{
+  initialize(_nFilters,_maxOrder,_nCells);
+}
+
+//!
+//! Builds the product table order by order: the products of order k are obtained by appending each filter a>=last to each product
+//! of order k-1 (the empty product for k=1), which lists them in lexicographic order.
+//!
+void FactorialMomentAccumulator::initialize(unsigned int _nFilters, unsigned int _maxOrder, unsigned int _nCells)
+{
+  if (_nFilters<1 || _maxOrder<1)
+    throw CAP::Exception("nFilters<1 || maxOrder<1","FactorialMomentAccumulator::initialize()");
+  nFilters = _nFilters;
+  maxOrder = _maxOrder;
+  nCells   = _nCells;
+
+  // entry 0 of the product table is the empty product
+  vector<unsigned int> lastFilter(1,0);
+  vector<unsigned int> runLength(1,0);
+  momentParent.assign(1,0);
+  momentFilter.assign(1,0);
+  momentOffset.assign(1,0.0);
+  momentOrder.clear();
+  orderFirst.clear();
+  unsigned int firstParent = 0;
+  unsigned int lastParent  = 0;
+  for (unsigned int order=1; order<=maxOrder; order++)
+    {
+    orderFirst.push_back(momentParent.size()-1);
+    for (unsigned int parent=firstParent; parent<=lastParent; parent++)
+      {
+      for (unsigned int filter=lastFilter[parent]; filter<nFilters; filter++)
+        {
+        unsigned int run = (filter==lastFilter[parent]) ? runLength[parent] : 0;
+        momentParent.push_back(parent);
+        momentFilter.push_back(filter);
+        momentOffset.push_back(double(run));
+        lastFilter.push_back(filter);
+        runLength.push_back(run+1);
+        momentOrder.push_back(order);
+        }
+      }
+    firstParent = lastParent+1;
+    lastParent  = momentParent.size()-1;
+    }
+  nMoments = momentParent.size()-1;
+  orderFirst.push_back(nMoments);
+  products.assign(nMoments+1,0.0);
+  stride = 2 + 2*nMoments;
+  sums.assign(size_t(nCells)*stride,0.0);
+  cellFilled.assign(nCells,0);
+  filledCells.clear();
+  cumulantFirst.clear();
+  termCoefficient.clear();
+  termFirst.clear();
+  termFactors.clear();
+}
+
+TString FactorialMomentAccumulator::getLabel(unsigned int iMoment) const
+{
+  TString label = "";
+  for (unsigned int k=iMoment+1; k>0; k=momentParent[k])
+    {
+    TString filter = "";
+    filter += momentFilter[k];
+    label.Prepend(filter);
+    }
+  return label;
+}
+
+void FactorialMomentAccumulator::getSequence(unsigned int iMoment, vector<unsigned int> & sequence) const
+{
+  sequence.clear();
+  for (unsigned int k=iMoment+1; k>0; k=momentParent[k]) sequence.push_back(momentFilter[k]);
+  std::reverse(sequence.begin(),sequence.end());
+}
+
+//!
+//! The partitions of the k positions of a sequence are enumerated as restricted growth strings: position i goes to block
+//! block[i] <= 1 + the largest block of the positions before it. The blocks of a partition are subsequences of the sequence,
+//! hence moments of lower order. Terms with the same factors are merged.
+//!
+void FactorialMomentAccumulator::initializeCumulants()
+{
+  std::map<vector<unsigned int>,unsigned int> momentIndex;
+  vector< vector<unsigned int> > sequences(nMoments);
+  for (unsigned int iMoment=0; iMoment<nMoments; iMoment++)
+    {
+    getSequence(iMoment,sequences[iMoment]);
+    momentIndex[sequences[iMoment]] = iMoment;
+    }
+  cumulantFirst.clear();
+  termCoefficient.clear();
+  termFirst.clear();
+  termFactors.clear();
+  vector<double> blockCoefficient(maxOrder+1,1.0);
+  for (unsigned int nBlocks=2; nBlocks<=maxOrder; nBlocks++) blockCoefficient[nBlocks] = -double(nBlocks-1)*blockCoefficient[nBlocks-1];
+  for (unsigned int iMoment=0; iMoment<nMoments; iMoment++)
+    {
+    const vector<unsigned int> & sequence = sequences[iMoment];
+    unsigned int order = sequence.size();
+    std::map<vector<unsigned int>,double> terms;
+    vector<unsigned int> block(order,0);
+    vector< vector<unsigned int> > blocks;
+    vector<unsigned int> factors;
+    std::function<void(unsigned int,unsigned int)> partition = [&](unsigned int position, unsigned int nBlocks)
+    {
+    if (position==order)
+      {
+      blocks.assign(nBlocks,vector<unsigned int>());
+      for (unsigned int k=0; k<order; k++) blocks[block[k]].push_back(sequence[k]);
+      factors.clear();
+      for (auto & b : blocks) factors.push_back(momentIndex[b]);
+      std::sort(factors.begin(),factors.end());
+      terms[factors] += blockCoefficient[nBlocks];
+      return;
+      }
+    for (unsigned int b=0; b<=nBlocks && b<order; b++)
+      {
+      block[position] = b;
+      partition(position+1, b==nBlocks ? nBlocks+1 : nBlocks);
+      }
+    };
+    block[0] = 0;
+    partition(1,1);
+    cumulantFirst.push_back(termCoefficient.size());
+    for (auto & term : terms)
+      {
+      termCoefficient.push_back(term.second);
+      termFirst.push_back(termFactors.size());
+      termFactors.insert(termFactors.end(),term.first.begin(),term.first.end());
+      }
+    }
+  cumulantFirst.push_back(termCoefficient.size());
+  termFirst.push_back(termFactors.size());
+}
+
+void FactorialMomentAccumulator::calculateCumulants(const double * moments, double * cumulants) const
+{
+  if (cumulantFirst.size()!=nMoments+1)
+    throw CAP::Exception("initializeCumulants() was not called","FactorialMomentAccumulator::calculateCumulants()");
+  for (unsigned int iMoment=0; iMoment<nMoments; iMoment++)
+    {
+    double cumulant = 0.0;
+    for (unsigned int iTerm=cumulantFirst[iMoment]; iTerm<cumulantFirst[iMoment+1]; iTerm++)
+      {
+      double term = termCoefficient[iTerm];
+      for (unsigned int iFactor=termFirst[iTerm]; iFactor<termFirst[iTerm+1]; iFactor++) term *= moments[termFactors[iFactor]];
+      cumulant += term;
+      }
+    cumulants[iMoment] = cumulant;
+    }
+}
+
+void FactorialMomentAccumulator::fill(unsigned int cell, const double * counts, double weight)
+{
+  calculateProducts(counts);
+  if (!cellFilled[cell])
+    {
+    cellFilled[cell] = 1;
+    filledCells.push_back(cell);
+    }
+  double * s = sums.data() + size_t(cell)*stride;
+  s[0] += weight;
+  s[1] += weight*weight;
+  s += 2;
+  const double * f = products.data()+1;
+  for (unsigned int k=0; k<nMoments; k++)
+    {
+    double wf = weight*f[k];
+    s[2*k]   += wf;
+    s[2*k+1] += wf*f[k];
+    }
+}
+
+void FactorialMomentAccumulator::add(const FactorialMomentAccumulator & other)
+{
+  if (other.nFilters!=nFilters || other.maxOrder!=maxOrder || other.nCells!=nCells)
+    throw CAP::Exception("Incompatible accumulators","FactorialMomentAccumulator::add()");
+  for (auto cell : other.filledCells)
+    {
+    if (!cellFilled[cell])
+      {
+      cellFilled[cell] = 1;
+      filledCells.push_back(cell);
+      }
+    double       * s = sums.data()       + size_t(cell)*stride;
+    const double * o = other.sums.data() + size_t(cell)*stride;
+    for (unsigned int k=0; k<stride; k++) s[k] += o[k];
+    }
+}
+
+void FactorialMomentAccumulator::reset()
+{
+  for (auto cell : filledCells)
+    {
+    std::fill(sums.begin()+size_t(cell)*stride, sums.begin()+size_t(cell+1)*stride, 0.0);
+    cellFilled[cell] = 0;
+    }
+  filledCells.clear();
+}
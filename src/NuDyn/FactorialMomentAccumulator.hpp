@@ -0,0 +1,145 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#ifndef CAP__FactorialMomentAccumulator
+#define CAP__FactorialMomentAccumulator
+#include <vector>
+#include "TString.h"
+#include "TObject.h"
+using namespace std;
+
+namespace CAP
+{
+
+//!
+//! Accumulates the mixed factorial moments of the multiplicities n_a of nFilters species, up to order maxOrder, in a set of cells
+//! (e.g., the bins of a multiplicity vs rapidity range profile).
+//!
+//! The moments of order k are the products of falling factorials n_a(n_a-1)..(n_a-j_a+1) with sum_a j_a = k. They are listed order
+//! by order, each order in the lexicographic order of the non decreasing filter sequences i1<=i2<=..<=ik, e.g., for 2 filters:
+//! 0, 1, 00, 01, 11, 000, 001, 011, 111, etc. Each moment is its parent (the sequence without its last filter) times one factor,
+//! (n_a - j) where a is the last filter and j the number of times a appears in the parent, so all the moments of a cell are
+//! computed with one multiplication each from a precomputed product table.
+//!
+//! The raw sums of each cell are stored contiguously: sum w, sum w^2, then sum w f and sum w f^2 for each moment f.
+//!
+class FactorialMomentAccumulator
+{
+public:
+
+  FactorialMomentAccumulator(unsigned int nFilters=2, unsigned int maxOrder=4, unsigned int nCells=1);
+  virtual ~FactorialMomentAccumulator() {}
+
+  //!
+  //! Set the number of filters, the maximum order, and the number of cells, and reset the sums.
+  //!
+  void initialize(unsigned int nFilters, unsigned int maxOrder, unsigned int nCells);
+
+  unsigned int getNFilters() const  { return nFilters; }
+  unsigned int getMaxOrder() const  { return maxOrder; }
+  unsigned int getNCells() const    { return nCells;   }
+  unsigned int getNMoments() const  { return nMoments; }
+
+  //!
+  //! Index of the first moment of the given order (1 to maxOrder+1, the latter giving the number of moments).
+  //!
+  unsigned int getFirstMoment(unsigned int order) const { return orderFirst[order-1]; }
+
+  //!
+  //! Order of the given moment, and its filter sequence, e.g., "011".
+  //!
+  unsigned int getOrder(unsigned int iMoment) const { return momentOrder[iMoment]; }
+  TString getLabel(unsigned int iMoment) const;
+  void getSequence(unsigned int iMoment, vector<unsigned int> & sequence) const;
+
+  //!
+  //! Compute all the moments of the given multiplicities (one per filter).
+  //!
+  inline void calculateMoments(const double * counts, double * moments) const
+  {
+  calculateProducts(counts);
+  for (unsigned int k=0; k<nMoments; k++) moments[k] = products[k+1];
+  }
+
+  //!
+  //! Build the tables used by calculateCumulants(). Their size grows as the number of partitions of the filter sequences (203 for
+  //! order 6), so they are only built on demand.
+  //!
+  void initializeCumulants();
+
+  //!
+  //! Compute the factorial cumulants of the given moments (in the order of the moments). The cumulant of a filter sequence is the
+  //! sum, over the partitions of the sequence into b blocks, of (-1)^(b-1) (b-1)! times the product of the moments of the blocks,
+  //! e.g., F_2^{01} = f_2^{01} - f_1^{0} f_1^{1}. Requires initializeCumulants().
+  //!
+  void calculateCumulants(const double * moments, double * cumulants) const;
+
+  //!
+  //! Add the moments of the given multiplicities (one per filter) to the sums of the given cell.
+  //!
+  void fill(unsigned int cell, const double * counts, double weight=1.0);
+
+  //!
+  //! Add the sums of the given accumulator, which must have the same configuration, to this accumulator.
+  //!
+  void add(const FactorialMomentAccumulator & other);
+
+  //!
+  //! Set all the sums to zero.
+  //!
+  void reset();
+
+  //!
+  //! Cells filled since the last reset, and the sums of a cell (see class description for the layout).
+  //!
+  const vector<unsigned int> & getFilledCells() const { return filledCells; }
+  const double * getSums(unsigned int cell) const     { return sums.data() + size_t(cell)*stride; }
+
+protected:
+
+  //!
+  //! Fill the product table: products[0] is the empty product (1) and products[1+iMoment] the moments.
+  //!
+  inline void calculateProducts(const double * counts) const
+  {
+  const unsigned int * parent = momentParent.data();
+  const unsigned int * filter = momentFilter.data();
+  const double       * offset = momentOffset.data();
+  double             * table  = products.data();
+  table[0] = 1.0;
+  for (unsigned int k=1; k<=nMoments; k++) table[k] = table[parent[k]]*(counts[filter[k]] - offset[k]);
+  }
+
+  unsigned int nFilters;
+  unsigned int maxOrder;
+  unsigned int nCells;
+  unsigned int nMoments;
+  unsigned int stride;                 //!< number of sums per cell
+  vector<unsigned int> orderFirst;     //!< first moment of each order
+  vector<unsigned int> momentOrder;    //!< order of each moment
+  vector<unsigned int> momentParent;   //!< parent of each entry of the product table
+  vector<unsigned int> momentFilter;   //!< filter of the factor of each entry of the product table
+  vector<double>       momentOffset;   //!< offset of the factor of each entry of the product table
+  mutable vector<double> products;     //!< product table: 1, then the moments
+  vector<unsigned int> cumulantFirst;  //!< first term of the cumulant of each moment, then the number of terms
+  vector<double>       termCoefficient;//!< coefficient of each term of the cumulants
+  vector<unsigned int> termFirst;      //!< first factor of each term, then the number of factors
+  vector<unsigned int> termFactors;    //!< moment of each factor of the terms
+  vector<double>       sums;
+  vector<char>         cellFilled;
+  vector<unsigned int> filledCells;
+
+  ClassDef(FactorialMomentAccumulator,0)
+};
+
+} // namespace CAP
+
+#endif /* CAP__FactorialMomentAccumulator */
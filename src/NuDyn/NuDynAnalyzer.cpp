@@ -9,6 +9,7 @@
  * Author: Claude Pruneau,   04/01/2022
  *
  * *********************************************************************/
+#include <algorithm>
 #include "NuDynAnalyzer.hpp"
 #include "NuDynHistos.hpp"
 #include "NuDynDerivedHistos.hpp"
@@ -20,11 +21,20 @@ NuDynAnalyzer::NuDynAnalyzer(const String & _name,
                              const Configuration & _configuration)
 :
 EventTask(_name, _configuration),
-multiplicityType(1)
+multiplicityType(1),
+maxOrder(4),
+nAccepted()
 {
   appendClassName("NuDynAnalyzer");
 }
 
+CAP::Task * NuDynAnalyzer::clone() const
+{
+  NuDynAnalyzer * task = new NuDynAnalyzer(getName(),configuration);
+  configureClone(task);
+  return task;
+}
+
 void NuDynAnalyzer::setDefaultConfiguration()
 {
   EventTask::setDefaultConfiguration();
@@ -35,6 +45,7 @@ void NuDynAnalyzer::setDefaultConfiguration()
   addParameter("EventsUseStream1",  false);
   addParameter("InputType",         1);
   addParameter("PairOnly",          true);
+  addParameter("MaxOrder",          4);
   addParameter("nBins_mult",        200);
   addParameter("Min_mult",          0.0);
   addParameter("Max_mult",          200.0);
@@ -47,6 +58,7 @@ void NuDynAnalyzer::configure()
 {
   EventTask::configure();
   multiplicityType = getValueInt("InputType");
+  maxOrder         = getValueInt("MaxOrder");
   nBins_rapidity   = getValueInt("nBins_rapidity");
   min_rapidity     = getValueDouble("Min_rapidity");
   max_rapidity     = getValueDouble("Max_rapidity");
@@ -63,6 +75,7 @@ void NuDynAnalyzer::configure()
     printItem("HistogramsCreate");
     printItem("HistogramsExport");
     printItem("InputType",     multiplicityType);
+    printItem("MaxOrder",      maxOrder);
     printItem("nBins_rapidity",nBins_rapidity);
     printItem("min_rapidity",  min_rapidity);
     printItem("max_rapidity",  max_rapidity);
@@ -101,8 +114,9 @@ void NuDynAnalyzer::createHistograms()
     printItem("nParticleFilters", int(nParticleFilters));
     cout << endl;
     }
-  partFilterName = particleFilters[0]->getName();
-  partFilterName += particleFilters[1]->getName();
+  partFilterName = "";
+  for (unsigned int iParticleFilter=0; iParticleFilter<nParticleFilters; iParticleFilter++)
+    partFilterName += particleFilters[iParticleFilter]->getName();
 
   for (unsigned int iEventFilter=0; iEventFilter<nEventFilters; iEventFilter++ )
     {
@@ -111,7 +125,7 @@ void NuDynAnalyzer::createHistograms()
     histoName      += evtFilterName;
     histoName      += "_";
     histoName      += partFilterName;
-    NuDynHistos * nuDynHistos = new NuDynHistos(this,histoName,configuration);
+    NuDynHistos * nuDynHistos = new NuDynHistos(this,histoName,configuration,nParticleFilters,maxOrder);
     nuDynHistos->createHistograms();
     histogramManager.addGroupInSet(0,nuDynHistos);
     }
@@ -139,8 +153,9 @@ void NuDynAnalyzer::importHistograms(TFile & inputFile)
     printItem("nParticleFilters", int(nParticleFilters));
     cout << endl;
     }
-  partFilterName = particleFilters[0]->getName();
-  partFilterName += particleFilters[1]->getName();
+  partFilterName = "";
+  for (unsigned int iParticleFilter=0; iParticleFilter<nParticleFilters; iParticleFilter++)
+    partFilterName += particleFilters[iParticleFilter]->getName();
 
   for (unsigned int iEventFilter=0; iEventFilter<nEventFilters; iEventFilter++ )
     {
@@ -149,7 +164,7 @@ void NuDynAnalyzer::importHistograms(TFile & inputFile)
     histoName      += evtFilterName;
     histoName      += "_";
     histoName      += partFilterName;
-    NuDynHistos * nuDynHistos = new NuDynHistos(this,histoName,configuration);
+    NuDynHistos * nuDynHistos = new NuDynHistos(this,histoName,configuration,nParticleFilters,maxOrder);
     nuDynHistos->importHistograms(inputFile);
     histogramManager.addGroupInSet(0,nuDynHistos);
     }
@@ -160,51 +175,76 @@ void NuDynAnalyzer::importHistograms(TFile & inputFile)
 void NuDynAnalyzer::analyzeEvent()
 {
   unsigned int nEventFilters    = eventFilters.size();
-  //unsigned int nParticleFilters = particleFilters.size();
+  unsigned int nParticleFilters = particleFilters.size();
+  unsigned int nBins_rapidity   = deltaRapidtyBin.size();
   Event * event = eventStreams[0];
   resetNParticlesAcceptedEvent();
+  fillParticleFilterMasks(*event);
   for (unsigned int iEventFilter=0; iEventFilter<nEventFilters; iEventFilter++ )
     {
     if (!eventFilters[iEventFilter]->accept(*event)) continue;
     incrementNEventsAccepted(iEventFilter); // count eventStreams used to fill histograms and for scaling at the end..
 
-    int nBins_rapidity = deltaRapidtyBin.size();
-    vector<double> nAccepted0(nBins_rapidity,0.0);
-    vector<double> nAccepted1(nBins_rapidity,0.0);
-    double rapidity;
+    // number of particles per filter and rapidity bin: bin iY holds deltaRapidtyBin[iY-1] <= |y| < deltaRapidtyBin[iY]
+    nAccepted.assign(nParticleFilters*nBins_rapidity,0.0);
     for (unsigned long  iParticle=0; iParticle<event->getNParticles(); iParticle++)
       {
       Particle & particle = * event->getParticleAt(iParticle);
-      if (particleFilters[0]->accept(particle))
-        {
-        incrementNParticlesAccepted(iEventFilter,0);
-        rapidity = fabs(particle.getMomentum().Rapidity());
-        for (int iY=0; iY<nBins_rapidity; iY++)
-          {
-          if (rapidity<deltaRapidtyBin[iY]) nAccepted0[iY]++;
-          }
-        }
-      if (particleFilters[1]->accept(particle))
+      double rapidity = fabs(particle.getMomentum().Rapidity());
+      unsigned int iY = std::upper_bound(deltaRapidtyBin.begin(),deltaRapidtyBin.end(),rapidity) - deltaRapidtyBin.begin();
+      for (unsigned int iParticleFilter=0; iParticleFilter<nParticleFilters; iParticleFilter++)
         {
-        incrementNParticlesAccepted(iEventFilter,1);
-        rapidity = fabs(particle.getMomentum().Rapidity());
-        for (int iY=0; iY<nBins_rapidity; iY++)
-          {
-          if (rapidity<deltaRapidtyBin[iY]) nAccepted1[iY]++;
-          }
+        if (!isAccepted(iParticle,iParticleFilter)) continue;
+        incrementNParticlesAccepted(iEventFilter,iParticleFilter);
+        if (iY<nBins_rapidity) nAccepted[iParticleFilter*nBins_rapidity+iY]++;
         }
       }
     EventProperties ep = * event->getEventProperties();
     NuDynHistos * nuDynHistos = (NuDynHistos *)  histogramManager.getGroup(0,iEventFilter);
     switch ( multiplicityType )
       {
-        case 0: nuDynHistos->fill(ep.fractionalXSection, nAccepted0, nAccepted1, 1.0); break;
-        case 1: nuDynHistos->fill(ep.refMultiplicity,    nAccepted0, nAccepted1, 1.0); break;
-        case 2: nuDynHistos->fill(ep.refMultiplicity,    nAccepted0, nAccepted1, 1.0); break;
+        case 0: nuDynHistos->fill(ep.fractionalXSection, nAccepted, 1.0); break;
+        case 1: nuDynHistos->fill(ep.refMultiplicity,    nAccepted, 1.0); break;
+        case 2: nuDynHistos->fill(ep.refMultiplicity,    nAccepted, 1.0); break;
       }
     }
 }
 
+void NuDynAnalyzer::saveMoments()
+{
+  if (!histosCreate || histogramManager.getNSets()<1) return;
+  unsigned int nGroups = histogramManager.getSet(0).size();
+  for (unsigned int iGroup=0; iGroup<nGroups; iGroup++)
+    ((NuDynHistos *) histogramManager.getGroup(0,iGroup))->saveMoments();
+}
+
+void NuDynAnalyzer::exportHistograms(TFile & outputFile)
+{
+  saveMoments();
+  EventTask::exportHistograms(outputFile);
+}
+
+void NuDynAnalyzer::exportHistograms(ofstream & outputFile)
+{
+  saveMoments();
+  EventTask::exportHistograms(outputFile);
+}
+
+void NuDynAnalyzer::merge(const Task & task)
+{
+  EventTask::merge(task);
+  const NuDynAnalyzer * analyzer = dynamic_cast<const NuDynAnalyzer*>(&task);
+  if (!analyzer)
+    throw TaskException("Given task is not a NuDynAnalyzer","NuDynAnalyzer::merge(const Task & task)");
+  if (!histosCreate) return;
+  unsigned int nGroups = histogramManager.getSet(0).size();
+  for (unsigned int iGroup=0; iGroup<nGroups; iGroup++)
+    {
+    NuDynHistos * histos = (NuDynHistos *) histogramManager.getGroup(0,iGroup);
+    histos->addMoments(*(const NuDynHistos *) analyzer->histogramManager.getGroup(0,iGroup));
+    }
+}
+
 void NuDynAnalyzer::createDerivedHistograms()
 {
   if (reportStart(__FUNCTION__))
@@ -220,21 +260,20 @@ void NuDynAnalyzer::createDerivedHistograms()
     printItem("nParticleFilters", int(nParticleFilters));
     cout << endl;
     }
+  String partFilterName = "";
+  for (unsigned int iParticleFilter=0; iParticleFilter<nParticleFilters; iParticleFilter++)
+    partFilterName += particleFilters[iParticleFilter]->getName();
   NuDynDerivedHistos * histos;
   for (unsigned int iEventFilter=0; iEventFilter<nEventFilters; iEventFilter++ )
     {
     String evtFilterName = eventFilters[iEventFilter]->getName();
-    for (unsigned int iParticleFilter=0; iParticleFilter<nParticleFilters; iParticleFilter++ )
-      {
-      String partFilterName = particleFilters[iParticleFilter]->getName();
-      String histoName  = prefixName;
-      histoName += evtFilterName;
-      histoName += "_";
-      histoName += partFilterName;
-      histos = new NuDynDerivedHistos(this,histoName,configuration);
-      histos->createHistograms();
-      histogramManager.addGroupInSet(1,histos);
-      }
+    String histoName  = prefixName;
+    histoName += evtFilterName;
+    histoName += "_";
+    histoName += partFilterName;
+    histos = new NuDynDerivedHistos(this,histoName,configuration,nParticleFilters,maxOrder);
+    histos->createHistograms();
+    histogramManager.addGroupInSet(1,histos);
     }
   if (reportEnd(__FUNCTION__))
     ;
@@ -261,19 +300,15 @@ void NuDynAnalyzer::calculateDerivedHistograms()
     }
   NuDynHistos        * baseHistos;
   NuDynDerivedHistos * derivedHistos;
-  unsigned index;
+  saveMoments();
 
   //!Mode 1: Running rigth after Analysis: base histograms pointers  are copied from analyzer to baseSingleHistograms
   //!Mode 2: Running as standalone: base histograms are loaded from file.
   for (unsigned int iEventFilter=0; iEventFilter<nEventFilters; iEventFilter++ )
     {
-    for (unsigned int iParticleFilter=0; iParticleFilter<nParticleFilters; iParticleFilter++ )
-      {
-      index = iEventFilter*nParticleFilters + iParticleFilter;
-      baseHistos    = (NuDynHistos *) histogramManager.getGroup(0,index);
-      derivedHistos = (NuDynDerivedHistos *) histogramManager.getGroup(1,index);
-      derivedHistos->calculateDerivedHistograms(baseHistos);
-      }
+    baseHistos    = (NuDynHistos *) histogramManager.getGroup(0,iEventFilter);
+    derivedHistos = (NuDynDerivedHistos *) histogramManager.getGroup(1,iEventFilter);
+    derivedHistos->calculateDerivedHistograms(baseHistos);
     }
   if (reportEnd(__FUNCTION__))
     { }
@@ -50,7 +50,12 @@ public:
   //!DTOR
   //!
   virtual ~NuDynAnalyzer() {}
-  
+
+  //!
+  //! Returns a configured clone of this task used for multithreaded execution.
+  //!
+  virtual Task * clone() const;
+
   //!
   //! Sets the default  values of the configuration parameters used by this task
   //!
@@ -85,6 +90,23 @@ public:
 
   virtual void calculateDerivedHistograms();
 
+  //!
+  //! Add the moments accumulated by the histogram groups to their profiles (see NuDynHistos::saveMoments).
+  //!
+  virtual void saveMoments();
+
+  //!
+  //! Save the accumulated moments, then export the histograms.
+  //!
+  virtual void exportHistograms(TFile & outputFile);
+  virtual void exportHistograms(ofstream & outputFile);
+  using EventTask::exportHistograms;
+
+  //!
+  //! Merge the histograms, and the moments accumulated but not yet saved, of the given task (a clone of this task).
+  //!
+  virtual void merge(const Task & task);
+
 protected:
   int    multiplicityType; //!< variable used to select which event property is used to differential studies of the moments. This variable is set the class parameter "inputType".
   int    nBins_rapidity;
@@ -92,6 +114,8 @@ protected:
   double max_rapidity;
   double width_rapidity;
   vector<double> deltaRapidtyBin;
+  int    maxOrder;         //!< highest order of the factorial moments (parameter MaxOrder)
+  vector<double> nAccepted; //!< number of accepted particles per filter and rapidity bin
 
 
   ClassDef(NuDynAnalyzer,0)
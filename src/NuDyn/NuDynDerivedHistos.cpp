@@ -16,22 +16,18 @@ ClassImp(NuDynDerivedHistos);
 
 NuDynDerivedHistos::NuDynDerivedHistos(Task * _parent,
                                        const String & _name,
-                                       const Configuration & _configuration)
+                                       const Configuration & _configuration,
+                                       unsigned int _nFilters,
+                                       unsigned int _maxOrder)
 :
 HistogramGroup(_parent,_name,_configuration),
-h_F2(),
-h_F3(),
-h_F4(),
-h_R2(),
-h_R3(),
-h_R4(),
-h_nudyn(),
-h_F2_vsMult(),
-h_F3_vsMult(),
-h_F4_vsMult(),
-h_R2_vsMult(),
-h_R3_vsMult(),
-h_R4_vsMult(),
+nFilters(_nFilters),
+maxOrder(_maxOrder),
+multiplicityType(1),
+pairOnly(false),
+layout(),
+h_Fk_vsMult(),
+h_Rk_vsMult(),
 h_nudyn_vsMult()
 {
 
@@ -40,31 +36,28 @@ h_nudyn_vsMult()
 // for now use the same boundaries for eta and y histogram
 void NuDynDerivedHistos::createHistograms()
 {
-  const TString & bn  = getName();
-  const TString & ptn = getParentName();
-  const TString & ppn = getParentPathName();
-  const Configuration & configuration = getConfiguration();
-  nFilters         = configuration.getValueInt(ppn,"nFilters");
-  multiplicityType = configuration.getValueInt(ppn,"multiplicityType");
+  if (reportStart(__FUNCTION__))
+    ;
+  const String & bn  = getName();
+  const String & ptn = getParentName();
+  const String & ppn = getParentPathName();
+  multiplicityType = configuration.getValueInt(ppn,"InputType");
   pairOnly         = configuration.getValueBool(ppn,"PairOnly");
   int nBins_mult   = configuration.getValueInt(ppn,"nBins_mult");
   double min_mult  = configuration.getValueInt(ppn,"Min_mult");
   double max_mult  = configuration.getValueInt(ppn,"Max_mult");
-
   int    nBins_rapidity = configuration.getValueInt(ppn,"nBins_rapidity");
   double min_rapidity   = configuration.getValueDouble(ppn,"Min_rapidity");
   double max_rapidity   = configuration.getValueDouble(ppn,"Max_rapidity");
-  double width_rapidity = (max_rapidity-min_rapidity)/double(nBins_rapidity);
 
-
-  TString suffix = "";
-  TString xTitle = "";
-  
+  String suffix = "";
+  String xTitle = "";
+  String yTitle = "Rapidity";
   switch (multiplicityType)
     {
-      case 0: suffix = "_vsCent"; xTitle = "%"; break;
-      case 1: suffix = "_vsMult"; xTitle = "mult_{Tot}";  break;
-      case 2: suffix = "_vsMult"; xTitle = "mult_{acc}";  break;
+      case 0: suffix = "vsCent"; xTitle = "%"; break;
+      case 1: suffix = "vsMult"; xTitle = "mult_{Tot}";  break;
+      case 2: suffix = "vsMult"; xTitle = "mult_{acc}";  break;
     }
 
   if (reportInfo(__FUNCTION__))
@@ -74,74 +67,41 @@ void NuDynDerivedHistos::createHistograms()
     cout << "  NuDyn:Parent Path Name....................: " << ppn << endl;
     cout << "  NuDyn:Histo Base Name.....................: " << bn << endl;
     cout << "  NuDyn:nFilters............................: " << nFilters <<  endl;
+    cout << "  NuDyn:maxOrder............................: " << maxOrder <<  endl;
     cout << "  NuDyn:multiplicityType....................: " << multiplicityType << endl;
     cout << "  NuDyn:pairOnly............................: " << pairOnly << endl;
+    cout << "  NuDyn:nBins_mult..........................: " << nBins_mult << endl;
     cout << "  NuDyn:nBins_rapidity......................: " << nBins_rapidity << endl;
-    cout << "  NuDyn:min_rapidity........................: " << min_rapidity << endl;
-    cout << "  NuDyn:max_rapidity........................: " << max_rapidity << endl;
-    cout << "  NuDyn:width_rapidity......................: " << width_rapidity << endl;
     }
 
-  String name;
-  String title;
-
-  for (int i1=0; i1<nFilters; i1++)
+  layout.initialize(nFilters,pairOnly ? std::min(maxOrder,2u) : maxOrder,1);
+  layout.initializeCumulants();
+  for (unsigned int iMoment=0; iMoment<layout.getNMoments(); iMoment++)
     {
-    for (int i2=i1; i2<nFilters; i2++)
+    unsigned int order = layout.getOrder(iMoment);
+    if (order<2) continue;
+    String label = layout.getLabel(iMoment);
+    String name  = "F"; name += order; name += "_"; name += label;
+    String title = "F_{"; title += order; title += "}^{"; title += label; title += "}";
+    h_Fk_vsMult.push_back( createHistogram(createName(bn,name,suffix),nBins_mult,min_mult,max_mult,nBins_rapidity,min_rapidity,max_rapidity,xTitle,yTitle,title) );
+    name  = "R"; name += order; name += "_"; name += label;
+    title = "R_{"; title += order; title += "}^{"; title += label; title += "}";
+    h_Rk_vsMult.push_back( createHistogram(createName(bn,name,suffix),nBins_mult,min_mult,max_mult,nBins_rapidity,min_rapidity,max_rapidity,xTitle,yTitle,title) );
+    }
+  if (layout.getMaxOrder()>=2)
+    {
+    for (unsigned int a=0; a<nFilters; a++)
       {
-      name = bn; name += "_"; name += "F2"; name += "_"; name += i1; name += i2;
-      title = "F_{2}^{"; title += i1; title += i2; title += "}";
-      h_F2.push_back(createHistogram(name, 1,min_mult,max_mult,xTitle, title));
-      name = bn; name += "_"; name += "R2"; name += "_"; name += i1; name += i2;
-      title = "R_{2}^{"; title += i1; title += i2; title += "}";
-      h_R2.push_back(createHistogram(name, 1,min_mult,max_mult,xTitle,title));
-      name = bn; name += "_"; name += "nudyn"; name += "_"; name += i1; name += i2;
-      title = "#nu_{#rm dyn}^{"; title += i1; title += i2; title += "}";
-      h_nudyn.push_back(createHistogram(name, 1,min_mult,max_mult,xTitle, title));
-      name = bn; name += "_"; name += "F2"; name += "_"; name += i1; name += i2;
-      title = "F_{2}^{"; title += i1; title += i2; title += "}";
-      h_F2_vsMult.push_back(createHistogram(name,nBins_mult,min_mult,  max_mult, xTitle,title));
-      name = bn; name += "_"; name += "R2"; name += "_"; name += i1; name += i2;
-      title = "R_{2}^{"; title += i1; title += i2; title += "}";
-      h_R2_vsMult.push_back(createHistogram(name,nBins_mult,min_mult,  max_mult, xTitle,title));
-      name = bn; name += "_"; name += "nudyn"; name += "_"; name += i1; name += i2;
-      title = "#nu_{#rm dyn}^{"; title += i1; title += i2; title += "}";
-      h_nudyn_vsMult.push_back(createHistogram(name,nBins_mult,min_mult,max_mult,xTitle,title));
-       
-      if (pairOnly) continue;
-      for (int i3=i2; i3<nFilters; i3++)
+      for (unsigned int b=a+1; b<nFilters; b++)
         {
-        name = bn; name += "_"; name += "F3"; name += "_"; name += i1; name += i2; name += i3;
-        title = "F_{3}^{"; title += i1; title += i2; title += i3; title += "}";
-        h_F3.push_back(createHistogram(name, 1,min_mult,max_mult,xTitle,title));
-        name = bn; name += "_"; name += "R3"; name += "_"; name += i1; name += i2; name += i3;
-        title = "R_{3}^{"; title += i1; title += i2; title += i3;  title += "}";
-        h_R3.push_back(createHistogram(name, 1,min_mult,max_mult,xTitle,title));
-        name = bn; name += "_"; name += "F3"; name += "_"; name += i1; name += i2; name += i3;
-        title = "F_{3}^{"; title += i1; title += i2; title += i3;  title += "}";
-        h_F3_vsMult.push_back( createHistogram(name,nBins_mult,min_mult,  max_mult,xTitle,title));
-        name = bn; name += "_"; name += "R3"; name += "_"; name += i1; name += i2; name += i3;
-        title = "R_{3}^{"; title += i1; title += i2; title += i3;  title += "}";
-        h_R3_vsMult.push_back( createHistogram(name,nBins_mult,min_mult,  max_mult,xTitle,title));
-        
-        for (int i4=i3; i4<nFilters; i4++)
-          {
-          name = bn; name += "_"; name += "F4"; name += "_"; name += i1; name += i2; name += i3;name += i4;
-          title = "F_{4}^{"; title += i1; title += i2; title += i3; title += i4; title += "}";
-          h_F4.push_back( createHistogram(name, 1,min_mult,max_mult,xTitle,title));
-          name = bn; name += "_"; name += "R4"; name += "_"; name += i1; name += i2; name += i3;name += i4;
-          title = "R_{4}^{"; title += i1; title += i2; title += i3; title += i4; title += "}";
-          h_R4.push_back( createHistogram(name, 1,min_mult,max_mult,xTitle,title));
-          name = bn; name += "_"; name += "F4"; name += "_"; name += i1; name += i2; name += i3;name += i4;
-          title = "F_{4}^{"; title += i1; title += i2; title += i3; title += i4; title += "}";
-          h_F4_vsMult.push_back( createHistogram(name,nBins_mult,min_mult,  max_mult,xTitle,title));
-          name = bn; name += "_"; name += "R4"; name += "_"; name += i1; name += i2; name += i3;name += i4;
-          title = "R_{4}^{"; title += i1; title += i2; title += i3; title += i4; title += "}";
-          h_R4_vsMult.push_back( createHistogram(name,nBins_mult,min_mult,  max_mult,xTitle,title));
-          }
+        String name  = "nudyn_"; name += a; name += b;
+        String title = "#nu_{#rm dyn}^{"; title += a; title += b; title += "}";
+        h_nudyn_vsMult.push_back( createHistogram(createName(bn,name,suffix),nBins_mult,min_mult,max_mult,nBins_rapidity,min_rapidity,max_rapidity,xTitle,yTitle,title) );
         }
       }
     }
+  if (reportEnd(__FUNCTION__))
+    ;
 }
 
 //________________________________________________________________________
@@ -150,71 +110,38 @@ void NuDynDerivedHistos::importHistograms(TFile & inputFile)
   if (reportStart(__FUNCTION__))
     ;
   const String & bn  = getName();
-  const String & ptn = getParentName();
-  const String & ppn = getParentPathName();  nFilters         = configuration.getValueInt(ppn,"nFilters");
-  multiplicityType = configuration.getValueInt(ppn,"multiplicityType");
+  const String & ppn = getParentPathName();
+  multiplicityType = configuration.getValueInt(ppn,"InputType");
   pairOnly         = configuration.getValueBool(ppn,"PairOnly");
 
   String suffix = "";
-  String xTitle = "";
-  switch ( multiplicityType )
+  switch (multiplicityType)
     {
-      case 0: suffix = "_vsCent"; xTitle = "%"; break;
-      case 1: suffix = "_vsMult"; xTitle = "mult_{Tot}";  break;
-      case 2: suffix = "_vsMult"; xTitle = "mult_{acc}";  break;
+      case 0: suffix = "vsCent"; break;
+      case 1: suffix = "vsMult"; break;
+      case 2: suffix = "vsMult"; break;
     }
 
-  if (reportInfo(__FUNCTION__))
+  layout.initialize(nFilters,pairOnly ? std::min(maxOrder,2u) : maxOrder,1);
+  layout.initializeCumulants();
+  for (unsigned int iMoment=0; iMoment<layout.getNMoments(); iMoment++)
     {
-    cout << endl;
-    cout << "  NuDyn:Parent Task Name....................: " << ptn << endl;
-    cout << "  NuDyn:Parent Path Name....................: " << ppn << endl;
-    cout << "  NuDyn:Histo Base Name.....................: " << bn << endl;
-    cout << "  NuDyn:nFilters............................: " << nFilters <<  endl;
-    cout << "  NuDyn:multiplicityType....................: " << multiplicityType << endl;
-    cout << "  NuDyn:pairOnly............................: " << pairOnly << endl;
+    unsigned int order = layout.getOrder(iMoment);
+    if (order<2) continue;
+    String label = layout.getLabel(iMoment);
+    String name  = "F"; name += order; name += "_"; name += label;
+    h_Fk_vsMult.push_back( loadH2(inputFile,createName(bn,name,suffix)) );
+    name  = "R"; name += order; name += "_"; name += label;
+    h_Rk_vsMult.push_back( loadH2(inputFile,createName(bn,name,suffix)) );
     }
-
-  String name;
-  String title;
-  for (int i1=0; i1<nFilters; i1++)
+  if (layout.getMaxOrder()>=2)
     {
-    for (int i2=i1; i2<nFilters; i2++)
+    for (unsigned int a=0; a<nFilters; a++)
       {
-      name = bn; name += "_"; name += "F2"; name += "_"; name += i1; name += i2;
-      h_F2.push_back(loadH1(inputFile,name));
-      name = bn; name += "_"; name += "R2"; name += "_"; name += i1; name += i2;
-      h_R2.push_back(loadH1(inputFile,name));
-      name = bn; name += "_"; name += "nudyn"; name += "_"; name += i1; name += i2;
-      h_nudyn.push_back(loadH1(inputFile,name));
-      name = bn; name += "_"; name += "F2"; name += "_"; name += i1; name += i2;
-      h_F2_vsMult.push_back(loadH1(inputFile,name));
-      name = bn; name += "_"; name += "R2"; name += "_"; name += i1; name += i2;
-      h_R2_vsMult.push_back(loadH1(inputFile,name));
-      name = bn; name += "_"; name += "nudyn"; name += "_"; name += i1; name += i2;
-      h_nudyn_vsMult.push_back(loadH1(inputFile,name));
-      if (pairOnly) continue;
-      for (int i3=i2; i3<nFilters; i3++)
+      for (unsigned int b=a+1; b<nFilters; b++)
         {
-        name = bn; name += "_"; name += "F3"; name += "_"; name += i1; name += i2; name += i3;
-        h_F3.push_back(loadH1(inputFile,name));
-        name = bn; name += "_"; name += "R3"; name += "_"; name += i1; name += i2; name += i3;
-        h_R3.push_back(loadH1(inputFile,name));
-        name = bn; name += "_"; name += "F3"; name += "_"; name += i1; name += i2; name += i3;
-        h_F3_vsMult.push_back(loadH1(inputFile,name));
-        name = bn; name += "_"; name += "R3"; name += "_"; name += i1; name += i2; name += i3;
-        h_R3_vsMult.push_back(loadH1(inputFile,name));
-        for (int i4=i3; i4<nFilters; i4++)
-          {
-          name = bn; name += "_"; name += "F4"; name += "_"; name += i1; name += i2; name += i3;name += i4;
-          h_F4.push_back(loadH1(inputFile,name));
-          name = bn; name += "_"; name += "R4"; name += "_"; name += i1; name += i2; name += i3;name += i4;
-          h_R4.push_back(loadH1(inputFile,name));
-          name = bn; name += "_"; name += "F4"; name += "_"; name += i1; name += i2; name += i3;name += i4;
-          h_F4_vsMult.push_back(loadH1(inputFile,name));
-          name = bn; name += "_"; name += "R4"; name += "_"; name += i1; name += i2; name += i3;name += i4;
-          h_R4_vsMult.push_back(loadH1(inputFile,name));
-          }
+        String name  = "nudyn_"; name += a; name += b;
+        h_nudyn_vsMult.push_back( loadH2(inputFile,createName(bn,name,suffix)) );
         }
       }
     }
@@ -222,67 +149,75 @@ void NuDynDerivedHistos::importHistograms(TFile & inputFile)
     ;
 }
 
+//!
+//! The cumulants of each (mult,rapidity) cell are computed from the moments of the cell. The moments of layout are the first
+//! moments of those of the base histograms, which may extend to a higher order.
+//!
 void NuDynDerivedHistos::calculateDerivedHistograms(NuDynHistos* baseHistos)
 {
-  // h_r2_11 = <n1(n1-1)>/<n1><n1>
-  // h_r2_22 = <n2(n2-1)>/<n2><n2>
-  // h_r2_12 = <n1(n2-1)>/<n1><n2>
-  // h_nudyn_12 = h_r2_11 + h_r2_22 -2*h_r2_12
-  
   NuDynHistos & source = *baseHistos;
-  int k1 = 0;
-  int k2 = 0;
-  int k3 = 0;
-  int k4 = 0;
-  for (int i1=0; i1<nFilters; i1++)
+  unsigned int nMoments = layout.getNMoments();
+  if (source.nFilters!=nFilters || source.h_fk_vsMult.size()<nMoments)
+    throw CAP::Exception("Base histograms do not match the derived histograms","NuDynDerivedHistos::calculateDerivedHistograms()");
+  if (layout.getMaxOrder()<2) return;
+
+  unsigned int first2 = layout.getFirstMoment(2);
+  vector< vector<unsigned int> > sequences(nMoments);
+  for (unsigned int iMoment=0; iMoment<nMoments; iMoment++) layout.getSequence(iMoment,sequences[iMoment]);
+  // index of the moment of order 2 of filters a<=b
+  vector<unsigned int> index2(nFilters*nFilters);
+  for (unsigned int iMoment=first2; iMoment<layout.getFirstMoment(3); iMoment++)
+    index2[sequences[iMoment][0]*nFilters+sequences[iMoment][1]] = iMoment;
+
+  vector<double> moments(nMoments);
+  vector<double> cumulants(nMoments);
+  vector<double> ratios(nMoments);
+  vector<double> ratioErrors(nMoments);
+  TProfile2D * reference = source.h_fk_vsMult[0];
+  for (int iX=1; iX<=reference->GetNbinsX(); iX++)
     {
-    for (int i2=i1; i2<nFilters; i2++)
+    for (int iY=1; iY<=reference->GetNbinsY(); iY++)
       {
-      int index12 = index2(i1,i2);
-      calculateF2R2(source.h_f1[i1],source.h_f1[i2],source.h_f2[k2], h_F2[k2], h_R2[k2]);
-      calculateF2R2(source.h_f1_vsMult[i1],source.h_f1_vsMult[i2],source.h_f2_vsMult[k2], h_F2_vsMult[k2], h_R2_vsMult[k2]);
-     
-      if (pairOnly) continue;
-      
-      for (int i3=i2; i3<nFilters; i3++)
+      int cell = reference->GetBin(iX,iY);
+      for (unsigned int iMoment=0; iMoment<nMoments; iMoment++) moments[iMoment] = source.h_fk_vsMult[iMoment]->GetBinContent(cell);
+      layout.calculateCumulants(moments.data(),cumulants.data());
+      for (unsigned int iMoment=first2; iMoment<nMoments; iMoment++)
+        {
+        // the moments of order 1 are those of the filters, in order
+        double normalization = 1.0;
+        for (unsigned int filter : sequences[iMoment]) normalization *= moments[filter];
+        double cumulant = 0.0;
+        double error    = 0.0;
+        ratios[iMoment]      = 0.0;
+        ratioErrors[iMoment] = 0.0;
+        if (normalization>1.0E-20)
+          {
+          cumulant = cumulants[iMoment];
+          error    = source.h_fk_vsMult[iMoment]->GetBinError(cell);
+          ratios[iMoment]      = cumulant/normalization;
+          ratioErrors[iMoment] = error/normalization;
+          }
+        h_Fk_vsMult[iMoment-first2]->SetBinContent(iX,iY,cumulant);
+        h_Fk_vsMult[iMoment-first2]->SetBinError(iX,iY,error);
+        h_Rk_vsMult[iMoment-first2]->SetBinContent(iX,iY,ratios[iMoment]);
+        h_Rk_vsMult[iMoment-first2]->SetBinError(iX,iY,ratioErrors[iMoment]);
+        }
+      unsigned int iPair = 0;
+      for (unsigned int a=0; a<nFilters; a++)
         {
-        int index13 = index2(i1,i3);
-        int index23 = index2(i2,i3);
-        int index123 = index3(i1,i2,i3);
-        calculateF3R3(source.h_f1[i1],source.h_f1[i2],source.h_f1[i3],
-                      source.h_f2[index12],source.h_f2[index13],source.h_f2[index23],
-                      source.h_f3[k3],
-                      h_F3[k3], h_R3[k3]);
-        calculateF3R3(source.h_f1_vsMult[i1],source.h_f1_vsMult[i2],source.h_f1_vsMult[i3],
-                      source.h_f2_vsMult[index12],source.h_f2_vsMult[index13],source.h_f2_vsMult[index23],
-                      source.h_f3_vsMult[k3],
-                      h_F3_vsMult[k3], h_R3_vsMult[k3]);
-        for (int i4=i3; i4<nFilters; i4++)
+        unsigned int aa = index2[a*nFilters+a];
+        for (unsigned int b=a+1; b<nFilters; b++)
           {
-          int index14 = index2(i1,i4);
-          int index24 = index2(i2,i4);
-          int index34 = index2(i3,i4);
-          int index124 = index3(i1,i2,i4);
-          int index134 = index3(i1,i3,i4);
-          int index234 = index3(i2,i3,i4);
-          calculateF4R4(source.h_f1[i1],source.h_f1[i2],source.h_f1[i3],source.h_f1[i4],
-                        source.h_f2[index12],source.h_f2[index13],source.h_f2[index14],
-                        source.h_f2[index23],source.h_f2[index24],source.h_f2[index34],
-                        source.h_f3[index123],source.h_f3[index124],source.h_f3[index134],source.h_f3[index234],
-                        source.h_f4[k4],
-                        h_F4[k4], h_R4[k4]);
-          calculateF4R4(source.h_f1_vsMult[i1],source.h_f1_vsMult[i2],source.h_f1_vsMult[i3],source.h_f1_vsMult[i4],
-                        source.h_f2_vsMult[index12], source.h_f2_vsMult[index13], source.h_f2_vsMult[index14],
-                        source.h_f2_vsMult[index23], source.h_f2_vsMult[index24], source.h_f2_vsMult[index34],
-                        source.h_f3_vsMult[index123],source.h_f3_vsMult[index124],source.h_f3_vsMult[index134],source.h_f3_vsMult[index234],
-                        source.h_f4_vsMult[k4],
-                        h_F4_vsMult[k4], h_R4_vsMult[k4]);
-          k4++;
+          unsigned int ab = index2[a*nFilters+b];
+          unsigned int bb = index2[b*nFilters+b];
+          double nudyn  = 0.0;
+          double enudyn = 0.0;
+          calculateNudyn(ratios[aa],ratioErrors[aa],ratios[ab],ratioErrors[ab],ratios[bb],ratioErrors[bb],nudyn,enudyn);
+          h_nudyn_vsMult[iPair]->SetBinContent(iX,iY,nudyn);
+          h_nudyn_vsMult[iPair]->SetBinError(iX,iY,enudyn);
+          iPair++;
           }
-        k3++;
         }
-      k2++;
       }
-    k1++;
     }
 }
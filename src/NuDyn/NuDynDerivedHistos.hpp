@@ -17,13 +17,25 @@
 namespace CAP
 {
 
+//!
+//! Factorial cumulants F_k, normalized cumulants R_k, and nu_dyn vs (mult,rapidity) of the moments accumulated by NuDynHistos.
+//!
+//! The cumulants are computed for all the filter sequences of order 2 to maxOrder (2 only if PairOnly is set), in the order and
+//! with the labels of FactorialMomentAccumulator, e.g., F2_01 = f2_01 - f1_0 f1_1. R_k is F_k divided by the product of the f1 of
+//! the filters of the sequence, and nu_dyn^{ab} = R2_aa + R2_bb - 2 R2_ab for each pair of filters a < b.
+//!
+//! The errors are those of the top moment only (e.g., of f2_01 for F2_01): the full uncertainties of the cumulants call for
+//! sub-samples.
+//!
 class NuDynDerivedHistos : public HistogramGroup
 {
 public:
 
   NuDynDerivedHistos(Task * _parent,
                      const String & _name,
-                     const Configuration & _configuration);
+                     const Configuration & _configuration,
+                     unsigned int _nFilters=2,
+                     unsigned int _maxOrder=4);
   virtual ~NuDynDerivedHistos() {} 
   void createHistograms();
   void importHistograms(TFile & inputFile);
@@ -32,30 +44,18 @@ public:
   ////////////////////////////////////////////////////////////////////////////
   // Data Members - HistogramGroup
   ////////////////////////////////////////////////////////////////////////////
-  // n1 number of particles satisfying filter 1
-  // n2 number of particles satisfying filter 2
-  // h_Fj  = cumulants of order "j"
-  // h_Rj  = normalized cumulants of order "j"
+  // h_Fk  = cumulants of order "k"
+  // h_Rk  = normalized cumulants of order "k"
 
-  int  nFilters;
-  int  multiplicityType;
+  unsigned int nFilters;
+  unsigned int maxOrder;
+  unsigned int multiplicityType;
   bool pairOnly;
 
-  vector<TH1 *> h_F2;
-  vector<TH1 *> h_F3;
-  vector<TH1 *> h_F4;
-  vector<TH1 *> h_R2;
-  vector<TH1 *> h_R3;
-  vector<TH1 *> h_R4;
-  vector<TH1 *> h_nudyn;
-
-  vector<TH1 *> h_F2_vsMult;
-  vector<TH1 *> h_F3_vsMult;
-  vector<TH1 *> h_F4_vsMult;
-  vector<TH1 *> h_R2_vsMult;
-  vector<TH1 *> h_R3_vsMult;
-  vector<TH1 *> h_R4_vsMult;
-  vector<TH1 *> h_nudyn_vsMult;
+  FactorialMomentAccumulator layout;  //!< order and labels of the moments, and their cumulants
+  vector<TH2 *> h_Fk_vsMult;          //!< cumulants of the moments of order 2 and more of layout
+  vector<TH2 *> h_Rk_vsMult;          //!< normalized cumulants of the moments of order 2 and more of layout
+  vector<TH2 *> h_nudyn_vsMult;       //!< nu_dyn of the pairs of filters a<b, in lexicographic order
 
   ClassDef(NuDynDerivedHistos,0)
 };
@@ -63,6 +63,3 @@ public:
 } // namespace CAP
 
 #endif /* CAP__NuDynDerivedHistos  */
-
-
-
@@ -17,11 +17,14 @@ ClassImp(NuDynHistos);
 
 NuDynHistos::NuDynHistos(Task * _parent,
                          const String & _name,
-                         const Configuration & _configuration)
+                         const Configuration & _configuration,
+                         unsigned int _nFilters,
+                         unsigned int _maxOrder)
 :
 HistogramGroup(_parent,_name,_configuration),
 h_eventStreams(0),
-nFilters(0),
+nFilters(_nFilters),
+maxOrder(_maxOrder),
 multiplicityType(0),
 pairOnly(0),
 deltaRapidtyBin(),
@@ -33,7 +36,11 @@ h_eventStreams_vsMult(nullptr),
 h_f1_vsMult(),
 h_f2_vsMult(),
 h_f3_vsMult(),
-h_f4_vsMult()
+h_f4_vsMult(),
+h_fk_vsMult(),
+accumulator(_nFilters,_maxOrder,1),
+rapidityCellOffset(),
+counts()
 {
   appendClassName("NuDynHistos");
 }
@@ -51,7 +58,7 @@ void NuDynHistos::createHistograms()
   const String & bn  = getName();
   const String & ptn = getParentName();
   const String & ppn = getParentPathName();
-  multiplicityType = configuration.getValueInt(ppn,"multiplicityType");
+  multiplicityType = configuration.getValueInt(ppn,"InputType");
   int nBins_mult   = configuration.getValueInt(ppn,"nBins_mult");
   double min_mult  = configuration.getValueInt(ppn,"Min_mult");
   double max_mult  = configuration.getValueInt(ppn,"Max_mult");
@@ -66,6 +73,8 @@ void NuDynHistos::createHistograms()
     cout << "  NuDyn:Parent Task Name....................: " << ptn << endl;
     cout << "  NuDyn:Parent Path Name....................: " << ppn << endl;
     cout << "  NuDyn:Histo Base Name.....................: " << bn << endl;
+    cout << "  NuDyn:nFilters............................: " << nFilters <<  endl;
+    cout << "  NuDyn:maxOrder............................: " << maxOrder <<  endl;
     cout << "  NuDyn:multiplicityType....................: " << multiplicityType << endl;
     cout << "  NuDyn:pairOnly............................: " << pairOnly << endl;
     cout << "  NuDyn:nBins_mult..........................: " << nBins_mult << endl;
@@ -96,37 +105,24 @@ void NuDynHistos::createHistograms()
   h_eventStreams        = createHistogram(createName(bn,"NeventStreams"),10,0.0,10, "Streams","n_{Events}");
   h_eventStreams_vsMult = createHistogram(createName(bn,"NeventStreams",suffix),nBins_mult,min_mult,  max_mult, "mult",  "n_{Events}");
 
-//  h_f1.push_back(        createProfile(createName(bn,"f1_0"), 10,0.0,10, "Streams", "f_{1}^{0}")  );
-//  h_f1.push_back(        createProfile(createName(bn,"f1_1"), 10,0.0,10, "Streams", "f_{1}^{1}")  );
-  h_f1_vsMult.push_back( createProfile(createName(bn,"f1_0",suffix),nBins_mult,min_mult,max_mult,nBins_rapidity,min_rapidity,max_rapidity,xTitle, yTitle,"f_{1}^{0}")  );
-  h_f1_vsMult.push_back( createProfile(createName(bn,"f1_1",suffix),nBins_mult,min_mult,max_mult,nBins_rapidity,min_rapidity,max_rapidity,xTitle, yTitle,"f_{1}^{1}")  );
-
-//  h_f2.push_back(        createProfile(createName(bn,"f2_00"), 10,0.0,10, "Streams", "f_{2}^{00}") );
-//  h_f2.push_back(        createProfile(createName(bn,"f2_01"), 10,0.0,10, "Streams", "f_{2}^{01}") );
-//  h_f2.push_back(        createProfile(createName(bn,"f2_11"), 10,0.0,10, "Streams", "f_{2}^{11}") );
-  h_f2_vsMult.push_back( createProfile(createName(bn,"f2_00",suffix),nBins_mult,min_mult,max_mult,nBins_rapidity,min_rapidity,max_rapidity,xTitle, yTitle,"f_{2}^{00}")  );
-  h_f2_vsMult.push_back( createProfile(createName(bn,"f2_01",suffix),nBins_mult,min_mult,max_mult,nBins_rapidity,min_rapidity,max_rapidity,xTitle, yTitle,"f_{2}^{01}")  );
-  h_f2_vsMult.push_back( createProfile(createName(bn,"f2_11",suffix),nBins_mult,min_mult,max_mult,nBins_rapidity,min_rapidity,max_rapidity,xTitle, yTitle,"f_{2}^{11}")  );
-
-//  h_f3.push_back(        createProfile(createName(bn,"f3_000"), 10,0.0,10, "Streams", "f_{3}^{000}") );
-//  h_f3.push_back(        createProfile(createName(bn,"f3_001"), 10,0.0,10, "Streams", "f_{3}^{001}") );
-//  h_f3.push_back(        createProfile(createName(bn,"f3_011"), 10,0.0,10, "Streams", "f_{3}^{011}") );
-//  h_f3.push_back(        createProfile(createName(bn,"f3_111"), 10,0.0,10, "Streams", "f_{3}^{111}") );
-  h_f3_vsMult.push_back( createProfile(createName(bn,"f3_000",suffix),nBins_mult,min_mult,max_mult,nBins_rapidity,min_rapidity,max_rapidity,xTitle, yTitle,"f_{3}^{000}")  );
-  h_f3_vsMult.push_back( createProfile(createName(bn,"f3_001",suffix),nBins_mult,min_mult,max_mult,nBins_rapidity,min_rapidity,max_rapidity,xTitle, yTitle,"f_{3}^{001}")  );
-  h_f3_vsMult.push_back( createProfile(createName(bn,"f3_011",suffix),nBins_mult,min_mult,max_mult,nBins_rapidity,min_rapidity,max_rapidity,xTitle, yTitle,"f_{3}^{011}")  );
-  h_f3_vsMult.push_back( createProfile(createName(bn,"f3_111",suffix),nBins_mult,min_mult,max_mult,nBins_rapidity,min_rapidity,max_rapidity,xTitle, yTitle,"f_{3}^{111}")  );
+  accumulator.initialize(nFilters,maxOrder,1);
+  for (unsigned int iMoment=0; iMoment<accumulator.getNMoments(); iMoment++)
+    {
+    unsigned int order = accumulator.getOrder(iMoment);
+    String label = accumulator.getLabel(iMoment);
+    String name  = "f"; name += order; name += "_"; name += label;
+    String title = "f_{"; title += order; title += "}^{"; title += label; title += "}";
+    h_fk_vsMult.push_back( createProfile(createName(bn,name,suffix),nBins_mult,min_mult,max_mult,nBins_rapidity,min_rapidity,max_rapidity,xTitle, yTitle,title) );
+    }
+  setMomentLists();
 
-//  h_f4.push_back(        createProfile(createName(bn,"f4_0000"), 10,0.0,10, "Streams", "f_{4}^{0000}") );
-//  h_f4.push_back(        createProfile(createName(bn,"f4_0001"), 10,0.0,10, "Streams", "f_{4}^{0001}") );
-//  h_f4.push_back(        createProfile(createName(bn,"f4_0011"), 10,0.0,10, "Streams", "f_{4}^{0011}") );
-//  h_f4.push_back(        createProfile(createName(bn,"f4_0111"), 10,0.0,10, "Streams", "f_{4}^{0111}") );
-//  h_f4.push_back(        createProfile(createName(bn,"f4_1111"), 10,0.0,10, "Streams", "f_{4}^{1111}") );
-  h_f4_vsMult.push_back( createProfile(createName(bn,"f4_0000",suffix),nBins_mult,min_mult,max_mult,nBins_rapidity,min_rapidity,max_rapidity,xTitle, yTitle,"f_{4}^{0000}") );
-  h_f4_vsMult.push_back( createProfile(createName(bn,"f4_0001",suffix),nBins_mult,min_mult,max_mult,nBins_rapidity,min_rapidity,max_rapidity,xTitle, yTitle,"f_{4}^{0001}") );
-  h_f4_vsMult.push_back( createProfile(createName(bn,"f4_0011",suffix),nBins_mult,min_mult,max_mult,nBins_rapidity,min_rapidity,max_rapidity,xTitle, yTitle,"f_{4}^{0011}") );
-  h_f4_vsMult.push_back( createProfile(createName(bn,"f4_0111",suffix),nBins_mult,min_mult,max_mult,nBins_rapidity,min_rapidity,max_rapidity,xTitle, yTitle,"f_{4}^{0111}") );
-  h_f4_vsMult.push_back( createProfile(createName(bn,"f4_1111",suffix),nBins_mult,min_mult,max_mult,nBins_rapidity,min_rapidity,max_rapidity,xTitle, yTitle,"f_{4}^{1111}") );
+  // the moments are accumulated per profile bin
+  TProfile2D * profile = h_fk_vsMult[0];
+  accumulator.initialize(nFilters,maxOrder,profile->GetNcells());
+  rapidityCellOffset.clear();
+  for (int iY=0; iY<nBins_rapidity; iY++)
+    rapidityCellOffset.push_back(profile->GetBin(0,profile->GetYaxis()->FindBin(deltaRapidtyBin[iY])));
+  counts.assign(nFilters,0.0);
 
   if (reportEnd(__FUNCTION__))
     ;
@@ -141,7 +137,7 @@ void NuDynHistos::importHistograms(TFile & inputFile)
   const String & ptn = getParentName();
   const String & ppn = getParentPathName();
   const Configuration & configuration = getConfiguration();
-  multiplicityType = configuration.getValueInt(ppn,"multiplicityType");
+  multiplicityType = configuration.getValueInt(ppn,"InputType");
   int nBins_mult   = configuration.getValueInt(ppn,"nBins_mult");
   double min_mult  = configuration.getValueInt(ppn,"Min_mult");
   double max_mult  = configuration.getValueInt(ppn,"Max_mult");
@@ -173,92 +169,78 @@ void NuDynHistos::importHistograms(TFile & inputFile)
   h_eventStreams        = loadProfile2D(inputFile, createName(bn,"NeventStreams"));
   h_eventStreams_vsMult = loadProfile2D(inputFile, createName(bn,"NeventStreams"));
 
-//  h_f1.push_back(        loadProfile2D(inputFile,createName(bn,"f1_0"));
-//  h_f1.push_back(        loadProfile2D(inputFile,createName(bn,"f1_1"));
-  h_f1_vsMult.push_back( loadProfile2D(inputFile,createName(bn,"f1_0",suffix)));
-  h_f1_vsMult.push_back( loadProfile2D(inputFile,createName(bn,"f1_1",suffix)));
-
-//  h_f2.push_back(        loadProfile2D(inputFile,createName(bn,"f2_00")));
-//  h_f2.push_back(        loadProfile2D(inputFile,createName(bn,"f2_01")));
-//  h_f2.push_back(        loadProfile2D(inputFile,createName(bn,"f2_11")));
-  h_f2_vsMult.push_back( loadProfile2D(inputFile,createName(bn,"f2_00",suffix)));
-  h_f2_vsMult.push_back( loadProfile2D(inputFile,createName(bn,"f2_01",suffix)));
-  h_f2_vsMult.push_back( loadProfile2D(inputFile,createName(bn,"f2_11",suffix)));
-
-//  h_f3.push_back(        loadProfile2D(inputFile,createName(bn,"f3_000")));
-//  h_f3.push_back(        loadProfile2D(inputFile,createName(bn,"f3_001")));
-//  h_f3.push_back(        loadProfile2D(inputFile,createName(bn,"f3_011")));
-//  h_f3.push_back(        loadProfile2D(inputFile,createName(bn,"f3_111")));
-  h_f3_vsMult.push_back( loadProfile2D(inputFile,createName(bn,"f3_000",suffix)));
-  h_f3_vsMult.push_back( loadProfile2D(inputFile,createName(bn,"f3_001",suffix)));
-  h_f3_vsMult.push_back( loadProfile2D(inputFile,createName(bn,"f3_011",suffix)));
-  h_f3_vsMult.push_back( loadProfile2D(inputFile,createName(bn,"f3_111",suffix)));
-
-//  h_f4.push_back(        loadProfile2D(inputFile,createName(bn,"f4_0000")));
-//  h_f4.push_back(        loadProfile2D(inputFile,createName(bn,"f4_0001")));
-//  h_f4.push_back(        loadProfile2D(inputFile,createName(bn,"f4_0011")));
-//  h_f4.push_back(        loadProfile2D(inputFile,createName(bn,"f4_0111")));
-//  h_f4.push_back(        loadProfile2D(inputFile,createName(bn,"f4_1111")));
-  h_f4_vsMult.push_back( loadProfile2D(inputFile,createName(bn,"f4_0000",suffix)));
-  h_f4_vsMult.push_back( loadProfile2D(inputFile,createName(bn,"f4_0001",suffix)));
-  h_f4_vsMult.push_back( loadProfile2D(inputFile,createName(bn,"f4_0011",suffix)));
-  h_f4_vsMult.push_back( loadProfile2D(inputFile,createName(bn,"f4_0111",suffix)));
-  h_f4_vsMult.push_back( loadProfile2D(inputFile,createName(bn,"f4_1111",suffix)));
+  accumulator.initialize(nFilters,maxOrder,1);
+  for (unsigned int iMoment=0; iMoment<accumulator.getNMoments(); iMoment++)
+    {
+    String name  = "f"; name += accumulator.getOrder(iMoment); name += "_"; name += accumulator.getLabel(iMoment);
+    h_fk_vsMult.push_back( loadProfile2D(inputFile,createName(bn,name,suffix)) );
+    }
+  setMomentLists();
 
   if (reportEnd(__FUNCTION__))
     ;
 }
 
 
-void NuDynHistos::fill(double mult, vector<double> & nAccepted0, vector<double> & nAccepted1,  double weight __attribute__((unused)))
+void NuDynHistos::setMomentLists()
+{
+  vector<TProfile2D *> * lists[4] = { &h_f1_vsMult, &h_f2_vsMult, &h_f3_vsMult, &h_f4_vsMult };
+  for (unsigned int order=1; order<=4; order++)
+    {
+    lists[order-1]->clear();
+    if (order>maxOrder) continue;
+    lists[order-1]->assign(h_fk_vsMult.begin()+accumulator.getFirstMoment(order),h_fk_vsMult.begin()+accumulator.getFirstMoment(order+1));
+    }
+}
+
+void NuDynHistos::fill(double mult, const vector<double> & nAccepted, double weight)
 {
   h_eventStreams->Fill(mult);
   h_eventStreams_vsMult->Fill(mult);
-  double n1_0, n1_1;
-  double n2_00, n2_01, n2_11;
-  double n3_000, n3_001, n3_011, n3_111;
-  double n4_0000, n4_0001, n4_0011, n4_0111, n4_1111;
-  double deltaY;
+  unsigned int nBins_rapidity = rapidityCellOffset.size();
+  unsigned int multCell = h_fk_vsMult[0]->GetXaxis()->FindBin(mult);
+  counts.assign(nFilters,0.0);
+  for (unsigned int iY=0; iY<nBins_rapidity; iY++)
+    {
+    for (unsigned int iFilter=0; iFilter<nFilters; iFilter++) counts[iFilter] += nAccepted[iFilter*nBins_rapidity+iY];
+    accumulator.fill(multCell+rapidityCellOffset[iY],counts.data(),weight);
+    }
+}
 
-  for (unsigned int iY=0; iY<nAccepted0.size(); iY++)
+//!
+//! The sums are added to the arrays of the profiles: sum of w*f (bin content), sum of w*f^2, sum of w (bin entries), and
+//! sum of w^2 when the profile stores it. The statistics of the profiles are then recomputed from their bins.
+//!
+void NuDynHistos::saveMoments()
+{
+  const vector<unsigned int> & cells = accumulator.getFilledCells();
+  if (cells.empty()) return;
+  for (unsigned int iMoment=0; iMoment<h_fk_vsMult.size(); iMoment++)
     {
-    if (iY>0)
+    TProfile2D * profile = h_fk_vsMult[iMoment];
+    TArrayD & sumWF    = *profile;
+    TArrayD & sumWF2   = *profile->GetSumw2();
+    TArrayD & binSumW2 = *profile->GetBinSumw2();
+    for (auto cell : cells)
       {
-      nAccepted0[iY] += nAccepted0[iY-1];
-      nAccepted1[iY] += nAccepted1[iY-1];
+      const double * sums = accumulator.getSums(cell);
+      sumWF[cell]  += sums[2+2*iMoment];
+      sumWF2[cell] += sums[3+2*iMoment];
+      profile->SetBinEntries(cell,profile->GetBinEntries(cell)+sums[0]);
+      if (binSumW2.fN>0) binSumW2[cell] += sums[1];
       }
-    n1_0    = nAccepted0[iY];
-    n1_1    = nAccepted1[iY];
-    n2_00   = n1_0 * (n1_0 - 1);
-    n2_01   = n1_0 * n1_1;
-    n2_11   = n1_1 * (n1_1 - 1);
-    n3_000  = n1_0 * (n1_0 - 1) * (n1_0 - 2);
-    n3_001  = n1_0 * (n1_0 - 1) * n1_1;
-    n3_011  = n1_0 * n1_1 * (n1_1 - 1);
-    n3_111  = n1_1 * (n1_1 - 1) * (n1_1 - 2);
-    n4_0000  = n1_0 * (n1_0 - 1) * (n1_0 - 2) * (n1_0 - 3);
-    n4_0001  = n1_0 * (n1_0 - 1) * (n1_0 - 2) * n1_1;
-    n4_0011  = n1_0 * (n1_0 - 1) * n1_1 * (n1_1 - 1);
-    n4_0111  = n1_0 * n1_1 * (n1_1 - 1) * (n1_1 - 2);
-    n4_1111  = n1_1 * (n1_1 - 1) * (n1_1 - 2) * (n1_1 - 3);
-    deltaY = deltaRapidtyBin[iY];
-    h_f1[0]->Fill(mult,deltaY,n1_0);
-    h_f1[1]->Fill(mult,deltaY,n1_1);
-
-    h_f2[0]->Fill(mult,deltaY,n2_00);
-    h_f2[1]->Fill(mult,deltaY,n2_01);
-    h_f2[2]->Fill(mult,deltaY,n2_11);
-
-    h_f3[0]->Fill(mult,deltaY,n3_000);
-    h_f3[1]->Fill(mult,deltaY,n3_001);
-    h_f3[2]->Fill(mult,deltaY,n3_011);
-    h_f3[3]->Fill(mult,deltaY,n3_111);
-
-    h_f4[0]->Fill(mult,deltaY,n4_0000);
-    h_f4[1]->Fill(mult,deltaY,n4_0001);
-    h_f4[2]->Fill(mult,deltaY,n4_0011);
-    h_f4[3]->Fill(mult,deltaY,n4_0111);
-    h_f4[4]->Fill(mult,deltaY,n4_1111);
+    profile->ResetStats();
     }
+  accumulator.reset();
+}
+
+void NuDynHistos::addMoments(const NuDynHistos & other)
+{
+  accumulator.add(other.accumulator);
 }
 
+void NuDynHistos::reset()
+{
+  HistogramGroup::reset();
+  accumulator.reset();
+}
@@ -13,13 +13,14 @@
 #define CAP__NuDynHistos
 #include "HistogramGroup.hpp"
 #include "Configuration.hpp"
+#include "FactorialMomentAccumulator.hpp"
 
 namespace CAP
 {
 
 
 //!
-//! Calculate lowest moments up to order 4
+//! Calculate factorial moments up to order maxOrder (4 by default)
 //! The calculation is carried out for N distinct types (species) of particles (N distinct filters)
 //!
 //! Let the species be: a, b, c, etc
@@ -28,6 +29,9 @@ namespace CAP
 //! Third order moments: f_3(a,a,a), f_3(a,a,b), f_3(a,a,c), f(a,a,d), f(a,b,b), etc
 //! Fourth order moments: f_4(a,a,a,a), f_(a,a,a,b), f_4(a,a,b,b), etc
 //!
+//! The moments of all orders are computed by a FactorialMomentAccumulator which sums them per (mult,rapidity) bin. The sums
+//! are added to the profiles by saveMoments(), called by NuDynAnalyzer before the profiles are exported, merged, or used.
+//!
 //!// ================================================================================
 // Naming convention
 // ================================================================================
@@ -55,11 +59,39 @@ public:
 
   NuDynHistos(Task * _parent,
               const String & _name,
-              const Configuration & _configuration);
+              const Configuration & _configuration,
+              unsigned int _nFilters=2,
+              unsigned int _maxOrder=4);
   virtual ~NuDynHistos();
   virtual void createHistograms();
   virtual void importHistograms(TFile & inputFile);
-  virtual void fill(double mult, vector<double> & nAccepted0, vector<double> & nAccepted1,  double weight);
+
+  //!
+  //! Accumulate the moments of an event. nAccepted holds the number of particles accepted by each filter in each rapidity bin,
+  //! nAccepted[iFilter*nBins_rapidity+iY], i.e., with deltaRapidtyBin[iY-1] <= |y| < deltaRapidtyBin[iY]. The moments are computed
+  //! for the cumulated multiplicities |y| < deltaRapidtyBin[iY].
+  //!
+  virtual void fill(double mult, const vector<double> & nAccepted, double weight);
+
+  //!
+  //! Add the accumulated sums to the moment profiles and reset the sums.
+  //!
+  virtual void saveMoments();
+
+  //!
+  //! Add the sums accumulated, but not yet saved, by the given group to this group.
+  //!
+  virtual void addMoments(const NuDynHistos & other);
+
+  //!
+  //! Reset the histograms and the accumulated sums.
+  //!
+  virtual void reset();
+
+  //!
+  //! Point h_f1_vsMult.. h_f4_vsMult to the moments of order 1 to 4 of h_fk_vsMult.
+  //!
+  void setMomentLists();
 
   ////////////////////////////////////////////////////////////////////////////
   // Data Members - HistogramGroup
@@ -89,6 +121,7 @@ public:
   // Min bias all included
   TH1 * h_eventStreams;
   unsigned int nFilters;
+  unsigned int maxOrder;
   unsigned int multiplicityType;
   bool pairOnly;
   vector<double> deltaRapidtyBin;
@@ -103,6 +136,11 @@ public:
   vector<TProfile2D *> h_f2_vsMult;
   vector<TProfile2D *> h_f3_vsMult;
   vector<TProfile2D *> h_f4_vsMult;
+  vector<TProfile2D *> h_fk_vsMult;  //!< all moments, in the order of FactorialMomentAccumulator; h_f1_vsMult.. h_f4_vsMult list those of order 1 to 4
+
+  FactorialMomentAccumulator accumulator;
+  vector<unsigned int> rapidityCellOffset;  //!< offset of the profile bins of each rapidity bin
+  vector<double> counts;                    //!< cumulated multiplicity of each filter
  
   ClassDef(NuDynHistos,0)
 };
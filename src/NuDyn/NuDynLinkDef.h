@@ -4,6 +4,7 @@
 #pragma link off all functions;
 #pragma link C++ class CAP::NuDynAnalyzer+;
 #pragma link C++ class CAP::NuDynHistos+;
+#pragma link C++ class CAP::FactorialMomentAccumulator+;
 #pragma link C++ class CAP::NuDynDerivedHistos+;
 #pragma link C++ class CAP::NuDynDerivedHistogramCalculator+;
 #pragma link C++ class CAP::NuDynPlotter+;
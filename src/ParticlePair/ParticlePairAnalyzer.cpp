@@ -23,12 +23,30 @@ ParticlePairAnalyzer::ParticlePairAnalyzer(const String & _name,
 EventTask(_name, _configuration),
 fillEta(true),
 fillY(false),
-fillP2(false)
+fillP2(false),
+fillDigitized(true),
+filteredParticles(),
+filteredDigits(),
+mixingEnabled(false),
+mixingDepth(10),
+mixingClassVariable(0),
+nBins_mixingClass(10),
+min_mixingClass(0.0),
+max_mixingClass(1000.0),
+mixingPool(),
+nEventsMixed()
 {
   appendClassName("ParticlePairAnalyzer");
 
 }
 
+CAP::Task * ParticlePairAnalyzer::clone() const
+{
+  ParticlePairAnalyzer * task = new ParticlePairAnalyzer(getName(),configuration);
+  configureClone(task);
+  return task;
+}
+
 void ParticlePairAnalyzer::setDefaultConfiguration()
 {
   EventTask::setDefaultConfiguration();
@@ -41,6 +59,13 @@ void ParticlePairAnalyzer::setDefaultConfiguration()
   addParameter("FillEta",           fillEta);
   addParameter("FillY",             fillY);
   addParameter("FillP2",            fillP2);
+  addParameter("FillDigitized",     fillDigitized);
+  addParameter("MixingEnabled",     mixingEnabled);
+  addParameter("MixingDepth",       mixingDepth);
+  addParameter("MixingClassVariable", "Multiplicity");
+  addParameter("nBins_MixingClass", nBins_mixingClass);
+  addParameter("Min_MixingClass",   min_mixingClass);
+  addParameter("Max_MixingClass",   max_mixingClass);
   addParameter("nBins_n1",          100);
   addParameter("Min_n1",            0.0);
   addParameter("Max_n1",            100.0);
@@ -93,7 +118,21 @@ void ParticlePairAnalyzer::configure()
   fillEta = getValueBool("FillEta");
   fillY   = getValueBool("FillY");
   fillP2  = getValueBool("FillP2");
-
+  fillDigitized = getValueBool("FillDigitized");
+  mixingEnabled = getValueBool("MixingEnabled");
+  mixingDepth   = getValueInt("MixingDepth");
+  nBins_mixingClass = getValueInt("nBins_MixingClass");
+  min_mixingClass   = getValueDouble("Min_MixingClass");
+  max_mixingClass   = getValueDouble("Max_MixingClass");
+  String mixingClassName = getValueString("MixingClassVariable");
+  if (mixingClassName.EqualTo("Multiplicity"))         mixingClassVariable = 0;
+  else if (mixingClassName.EqualTo("RefMultiplicity")) mixingClassVariable = 1;
+  else if (mixingClassName.EqualTo("ImpactParameter")) mixingClassVariable = 2;
+  else if (mixingClassName.EqualTo("Other"))           mixingClassVariable = 3;
+  else throw TaskException("Unknown MixingClassVariable: "+mixingClassName,"ParticlePairAnalyzer::configure()");
+  if (mixingEnabled && !fillDigitized) throw TaskException("MixingEnabled requires FillDigitized","ParticlePairAnalyzer::configure()");
+  if (mixingEnabled && (mixingDepth<1 || nBins_mixingClass<1 || max_mixingClass<=min_mixingClass))
+    throw TaskException("Invalid mixing depth or class range","ParticlePairAnalyzer::configure()");
 
   if (reportInfo(__FUNCTION__))
     {
@@ -108,6 +147,13 @@ void ParticlePairAnalyzer::configure()
     printItem("FillEta",fillEta);
     printItem("FillY",fillY);
     printItem("FillP2",fillP2);
+    printItem("FillDigitized",fillDigitized);
+    printItem("MixingEnabled",mixingEnabled);
+    printItem("MixingDepth",mixingDepth);
+    printItem("MixingClassVariable");
+    printItem("nBins_MixingClass",nBins_mixingClass);
+    printItem("Min_MixingClass",min_mixingClass);
+    printItem("Max_MixingClass",max_mixingClass);
     printItem("nBins_n1");
     printItem("Min_n1");
     printItem("Max_n1");
@@ -149,21 +195,23 @@ void ParticlePairAnalyzer::configure()
     printItem("Max_DeltaP");
     cout << endl;
     }
-  for (unsigned int k=0; k<particleFilters.size(); k++)
-    {
-    vector<ParticleDigit*> list;
-    filteredParticles.push_back(list);
-    }
 }
 
 void ParticlePairAnalyzer::initialize()
 {
-  EventTask::initialize();
-  for (unsigned int k=0; k<particleFilters.size(); k++)
+  // events imported as views carry no Particle objects: only the digitized path reads them.
+  Task * loop = getParent();
+  for (unsigned int iTask=0; !fillDigitized && loop && iTask<loop->getNSubTasks(); iTask++)
     {
-    vector<ParticleDigit*> list;
-    filteredParticles.push_back(list);
+    EventTask * task = dynamic_cast<EventTask*>(loop->getSubTaskAt(iTask));
+    if (task && task->isImportingEventViews())
+      throw TaskException(task->getName()+" imports events as views (EventsImportCAPView), which requires FillDigitized","ParticlePairAnalyzer::initialize()");
     }
+  EventTask::initialize();
+  filteredParticles.assign(particleFilters.size(),vector<ParticleDigit*>());
+  filteredDigits.assign(particleFilters.size(),ParticleDigitBuffer());
+  nEventsMixed.assign(nEventFilters,0);
+  if (mixingEnabled) mixingPool.initialize(nEventFilters*nBins_mixingClass,particleFilters.size(),mixingDepth);
 }
 
 void ParticlePairAnalyzer::initializeHistogramManager()
@@ -172,6 +220,8 @@ void ParticlePairAnalyzer::initializeHistogramManager()
   histogramManager.addSet("pair");
   histogramManager.addSet("singleDerived");
   histogramManager.addSet("pairDerived");
+  histogramManager.addSet("pairMixed");
+  histogramManager.addSet("pairMixedDerived");
 }
 
 
@@ -220,6 +270,19 @@ void ParticlePairAnalyzer::createHistograms()
         histogramManager.addGroupInSet(1,histos);
         }
       }
+    if (!mixingEnabled) continue;
+    // mixed-event pairs
+    for (int iParticleFilter1=0; iParticleFilter1<nParticleFilters; iParticleFilter1++ )
+      {
+      String pfn1 = particleFilters[iParticleFilter1]->getName();
+      for (int iParticleFilter2=0; iParticleFilter2<nParticleFilters; iParticleFilter2++ )
+        {
+        String pfn2 = particleFilters[iParticleFilter2]->getName();
+        histos = new ParticlePairHistos(this,createName(bn,efn,pfn1,pfn2,"Mixed"),configuration);
+        histos->createHistograms();
+        histogramManager.addGroupInSet(4,histos);
+        }
+      }
     }
   if (reportEnd(__FUNCTION__))
     ;
@@ -235,6 +298,7 @@ void ParticlePairAnalyzer::importHistograms(TFile & inputFile)
   fillEta = getValueBool("FillEta");
   fillY   = getValueBool("FillY");
   fillP2  = getValueBool("FillP2");
+  mixingEnabled = getValueBool("MixingEnabled");
 
   if (reportInfo(__FUNCTION__))
     {
@@ -273,6 +337,19 @@ void ParticlePairAnalyzer::importHistograms(TFile & inputFile)
         histogramManager.addGroupInSet(1,histos);
         }
       }
+    if (!mixingEnabled) continue;
+    // mixed-event pairs
+    for (int iParticleFilter1=0; iParticleFilter1<nParticleFilters; iParticleFilter1++ )
+      {
+      String pfn1 = particleFilters[iParticleFilter1]->getName();
+      for (int iParticleFilter2=0; iParticleFilter2<nParticleFilters; iParticleFilter2++ )
+        {
+        String pfn2 = particleFilters[iParticleFilter2]->getName();
+        histos = new ParticlePairHistos(this,createName(bn,efn,pfn1,pfn2,"Mixed"),configuration);
+        histos->importHistograms(inputFile);
+        histogramManager.addGroupInSet(4,histos);
+        }
+      }
     }
   if (reportEnd(__FUNCTION__))
     ;
@@ -283,8 +360,12 @@ void ParticlePairAnalyzer::analyzeEvent()
 {
   Event & event = *eventStreams[0];
   vector<Particle*> & particles = event.getParticles();
-  unsigned int nParticles = particles.size();
-  if (false)
+  // events imported as views (see EventCAPView) carry no Particle objects: their kinematics are read from the view columns.
+  const EventCAPView * view = event.getView();
+  unsigned int nParticles = view ? view->getNParticles() : particles.size();
+  if (view && !fillDigitized) throw TaskException("Events imported as views require FillDigitized","ParticlePairAnalyzer::analyzeEvent()");
+  fillParticleFilterMasks(event);
+  if (fillDigitized)
     {
     //Is this event accepted by this task's event filters?
     bool analyzeThisEvent = false;
@@ -313,48 +394,57 @@ void ParticlePairAnalyzer::analyzeEvent()
     // times..
     // The histo instance fetched here is used for digitization only. So
     // we use instance [0];
-    ParticlePairHistos * histos = (ParticlePairHistos *) histogramManager.getGroup(0,0);
+    ParticlePairHistos * histos = (ParticlePairHistos *) histogramManager.getGroup(1,0);
     unsigned int nParticleFilters = particleFilters.size();
-    for (unsigned int iParticleFilter=0; iParticleFilter<nParticleFilters; iParticleFilter++ ) filteredParticles[iParticleFilter].clear();
+    for (unsigned int iParticleFilter=0; iParticleFilter<nParticleFilters; iParticleFilter++ )
+      {
+      filteredParticles[iParticleFilter].clear();
+      filteredDigits[iParticleFilter].clear();
+      }
+    // every particle accepted by a filter is digitized: all of them enter the single-particle histograms, while only those within
+    // the ranges of the pair histograms enter the digit buffers used to fill pairs.
+    ParticleDb * particleDb = ParticleDb::getDefaultParticleDb();
+    int nDigitized = 0;
     for (unsigned int iParticle=0; iParticle<nParticles; iParticle++)
       {
-      Particle & particle = * (particles[iParticle]);
-      float pt, e, phi;
-      int iPt, iPhi, iEta, iY;
-      ParticleDigit * pd;
-      bool digitized = false;
+      if (!isAcceptedByAny(iParticle)) continue;
+      ParticleDigit * pd = factory->getNextObject();
+      ParticleType  * type;
+      if (view)
+        {
+        type    = view->getType(iParticle);
+        pd->pt  = view->getPt(iParticle);
+        pd->e   = view->e[iParticle];
+        pd->phi = view->getPhi(iParticle);
+        pd->eta = view->getEta(iParticle);
+        pd->y   = view->getRapidity(iParticle);
+        }
+      else
+        {
+        LorentzVector & momentum = particles[iParticle]->getMomentum();
+        type    = particles[iParticle]->getTypePtr();
+        pd->pt  = momentum.Pt();
+        pd->e   = momentum.E();
+        pd->phi = momentum.Phi();
+        pd->eta = momentum.Eta();
+        pd->y   = momentum.Rapidity();
+        }
+      if (pd->phi<0.0) pd->phi += CAP::Math::twoPi();
+      pd->typeIndex = particleDb->findIndexForType(type);
+      pd->iPt       = histos->getPtBinFor(pd->pt);
+      pd->iPhi      = histos->getPhiBinFor(pd->phi);
+      pd->iEta      = fillEta ? histos->getEtaBinFor(pd->eta) : 0;
+      pd->iY        = fillY   ? histos->getYBinFor(pd->y)     : 0;
+      bool paired   = pd->iPt!=0 && pd->iPhi!=0 && (pd->iEta!=0 || pd->iY!=0);
+      if (paired) nDigitized++;
       for (unsigned int iParticleFilter=0; iParticleFilter<nParticleFilters; iParticleFilter++ )
         {
-        if (particleFilters[iParticleFilter]->accept(particle))
-          {
-          if (!digitized)
-            {
-            LorentzVector & momentum = particle.getMomentum();
-            pt        = momentum.Pt();
-            e         = momentum.E();
-            phi       = momentum.Phi();
-            if (phi<0.0) phi += CAP::Math::twoPi();
-            iPt       = histos->getPtBinFor(pt);
-            if (iPt==0) continue;
-            iPhi      = histos->getPhiBinFor(phi);
-            if (iPhi==0) continue;
-            iEta = fillEta ? histos->getEtaBinFor(momentum.Eta())    : 0;
-            iY   = fillY   ? histos->getYBinFor(momentum.Rapidity()) : 0;
-            if (iEta==0 && iY==0) continue;
-            pd        = factory->getNextObject();
-            pd->iY    = iY;
-            pd->iEta  = iEta;
-            pd->iPt   = iPt;
-            pd->iPhi  = iPhi;
-            pd->pt    = pt;
-            pd->e     = e;
-            digitized = true; // so no need to digitize this particle again..
-            }
-          filteredParticles[iParticleFilter].push_back(pd);
-          //if (reportInfo("ParticlePairAnalyzer",getName(),"HistogramsCreate()")) cout << " -- 7 --" << endl;
-          } // particle accepted by filter
-        } //particle loop
-      } // particle filter loop
+        if (!isAccepted(iParticle,iParticleFilter)) continue;
+        filteredParticles[iParticleFilter].push_back(pd);
+        if (paired) filteredDigits[iParticleFilter].add(iParticle,*pd);
+        } // particle filter loop
+      } // particle loop
+    int iMixingClass = mixingEnabled ? getMixingClass(event,nDigitized) : -1;
     //if (reportInfo("ParticlePairAnalyzer",getName(),"HistogramsCreate()")) cout << " -- 8 --" << endl;
     // use the filtered particles to fill the histos for the accepted event filters
     for (unsigned int jEventFilter=0; jEventFilter<eventFilterPassed.size(); jEventFilter++ )
@@ -366,20 +456,46 @@ void ParticlePairAnalyzer::analyzeEvent()
       unsigned int  index;
       for (unsigned int iParticleFilter1=0; iParticleFilter1<nParticleFilters; iParticleFilter1++ )
         {
-        incrementNParticlesAccepted(iEventFilter,iParticleFilter1);
+        for (unsigned int k=0; k<filteredParticles[iParticleFilter1].size(); k++) incrementNParticlesAccepted(iEventFilter,iParticleFilter1);
         //if (reportInfo("ParticlePairAnalyzer",getName(),"HistogramsCreate()")) cout << " -- 10 --" << endl;
         index = baseSingle + iParticleFilter1;
         ParticleSingleHistos * histos = (ParticleSingleHistos *) histogramManager.getGroup(0,index);
-        histos->fill(filteredParticles[iParticleFilter1],1.0);
+        double totalEnergy = 0.0;
+        for (ParticleDigit * pd : filteredParticles[iParticleFilter1])
+          {
+          histos->fill(pd->pt,pd->eta,pd->phi,pd->y,pd->typeIndex,1.0);
+          totalEnergy += pd->e;
+          }
+        histos->fillMultiplicity(filteredParticles[iParticleFilter1].size(),totalEnergy,1.0);
         for (unsigned int iParticleFilter2=0; iParticleFilter2<nParticleFilters; iParticleFilter2++ )
           {
           //if (reportInfo("ParticlePairAnalyzer",getName(),"HistogramsCreate()")) cout << " -- 11 --" << endl;
           index = basePair + iParticleFilter1*nParticleFilters + iParticleFilter2;
           ParticlePairHistos * histos = (ParticlePairHistos *)  histogramManager.getGroup(1,index);
-          histos->fill(filteredParticles[iParticleFilter1],filteredParticles[iParticleFilter2],iParticleFilter1==iParticleFilter2,1.0);
+          histos->fill(filteredDigits[iParticleFilter1],filteredDigits[iParticleFilter2],iParticleFilter1==iParticleFilter2,1.0);
           //if (reportInfo("ParticlePairAnalyzer",getName(),"HistogramsCreate()")) cout << " -- 13 --" << endl;
           }
         }
+      if (iMixingClass<0) continue;
+      // pair the digits of this event with those of the pooled events of the same class, in both orders so that particle 1 is
+      // taken from the current and the pooled events alike, then add this event to the pool
+      int iPool   = iEventFilter*nBins_mixingClass + iMixingClass;
+      int nPooled = mixingPool.getNEvents(iPool);
+      for (int iPooled=0; iPooled<nPooled; iPooled++)
+        {
+        for (unsigned int iParticleFilter1=0; iParticleFilter1<nParticleFilters; iParticleFilter1++ )
+          {
+          for (unsigned int iParticleFilter2=0; iParticleFilter2<nParticleFilters; iParticleFilter2++ )
+            {
+            index = basePair + iParticleFilter1*nParticleFilters + iParticleFilter2;
+            ParticlePairHistos * histos = (ParticlePairHistos *)  histogramManager.getGroup(4,index);
+            histos->fill(filteredDigits[iParticleFilter1],mixingPool.getDigits(iPool,iPooled,iParticleFilter2),false,1.0);
+            histos->fill(mixingPool.getDigits(iPool,iPooled,iParticleFilter1),filteredDigits[iParticleFilter2],false,1.0);
+            }
+          }
+        }
+      nEventsMixed[iEventFilter] += 2*nPooled;
+      mixingPool.add(iPool,filteredDigits);
       }
     }
   else
@@ -391,22 +507,26 @@ void ParticlePairAnalyzer::analyzeEvent()
       unsigned int  baseSingle   = iEventFilter*nParticleFilters;
       unsigned int  basePair     = iEventFilter*nParticleFilters*nParticleFilters;
       unsigned int  index;
+      vector<double> nAccepted(nParticleFilters,0.0);
+      vector<double> totalEnergy(nParticleFilters,0.0);
       for (unsigned int iParticle1=0; iParticle1<nParticles; iParticle1++)
         {
+        if (!isAcceptedByAny(iParticle1)) continue;
         Particle & particle1 = *(particles[iParticle1]);
         //bool accepted = false;
         for (int iParticleFilter1=0; iParticleFilter1<nParticleFilters; iParticleFilter1++ )
           {
 
-          if (particleFilters[iParticleFilter1]->accept(particle1))
+          if (isAccepted(iParticle1,iParticleFilter1))
             {
             //cout << " ACCEPTED" << endl;
             incrementNParticlesAccepted(iEventFilter,iParticleFilter1);
             index = baseSingle + iParticleFilter1;
             ParticleSingleHistos * histos = (ParticleSingleHistos *)  histogramManager.getGroup(0,index);
             histos->fill(particle1,1.0);
+            nAccepted[iParticleFilter1]++;
+            totalEnergy[iParticleFilter1] += particle1.getMomentum().E();
             //accepted = true;
-            break; // mutually exclusive tests...
             }
           }
 //        cout << "Accepted:" << accepted << endl;
@@ -422,14 +542,14 @@ void ParticlePairAnalyzer::analyzeEvent()
         for (unsigned int iParticle2=0; iParticle2<nParticles; iParticle2++)
           {
           if (iParticle1==iParticle2) continue;
+          if (!isAcceptedByAny(iParticle2)) continue;
           Particle & particle2 = *(particles[iParticle2]);
           for (int iParticleFilter1=0; iParticleFilter1<nParticleFilters; iParticleFilter1++ )
             {
-            bool accept1 = particleFilters[iParticleFilter1]->accept(particle1);
+            if (!isAccepted(iParticle1,iParticleFilter1)) continue;
             for (int iParticleFilter2=0; iParticleFilter2<nParticleFilters; iParticleFilter2++ )
               {
-              bool accept2 = particleFilters[iParticleFilter2]->accept(particle2);
-              if (accept1 & accept2)
+              if (isAccepted(iParticle2,iParticleFilter2))
                 {
                 index = basePair + iParticleFilter1*nParticleFilters + iParticleFilter2;
                 ParticlePairHistos * histos = (ParticlePairHistos *)  histogramManager.getGroup(1,index);
@@ -439,6 +559,11 @@ void ParticlePairAnalyzer::analyzeEvent()
             }
           }
         }
+      for (int iParticleFilter=0; iParticleFilter<nParticleFilters; iParticleFilter++ )
+        {
+        ParticleSingleHistos * histos = (ParticleSingleHistos *)  histogramManager.getGroup(0,baseSingle + iParticleFilter);
+        histos->fillMultiplicity(nAccepted[iParticleFilter],totalEnergy[iParticleFilter],1.0);
+        }
       }
     }
 }
@@ -482,11 +607,76 @@ void ParticlePairAnalyzer::scaleHistograms()
         printItem("no scaling performed");
         }
       }
+    if (!mixingEnabled) continue;
+    if (nEventsMixed[iEventFilter]>0)
+      {
+      scalingFactor = 1.0/double(nEventsMixed[iEventFilter]);
+      for (int iParticleFilter1=0; iParticleFilter1<nParticleFilters; iParticleFilter1++ )
+        {
+        for (int iParticleFilter2=0; iParticleFilter2<nParticleFilters; iParticleFilter2++ )
+          {
+          index = iEventFilter*nParticleFilters*nParticleFilters + iParticleFilter1*nParticleFilters + iParticleFilter2;
+          histogramManager.getGroup(4,index)->scale(scalingFactor);
+          }
+        }
+      }
+    else
+      {
+      if (reportWarning(__FUNCTION__))
+        {
+        cout << endl;
+        printItem("iEventFilter",iEventFilter);
+        printItem("nEventsMixed[iEventFilter]",nEventsMixed[iEventFilter]);
+        printItem("no scaling of mixed-event pairs performed");
+        }
+      }
     }
   if (reportEnd(__FUNCTION__))
     ;
 }
 
+void ParticlePairAnalyzer::reset()
+{
+  EventTask::reset();
+  nEventsMixed.assign(nEventFilters,0);
+}
+
+void ParticlePairAnalyzer::clear()
+{
+  EventTask::clear();
+  nEventsMixed.assign(nEventFilters,0);
+  mixingPool.clear();
+}
+
+void ParticlePairAnalyzer::merge(const Task & task)
+{
+  EventTask::merge(task);
+  const ParticlePairAnalyzer * analyzer = dynamic_cast<const ParticlePairAnalyzer*>(&task);
+  if (!analyzer)
+    throw TaskException("Given task is not a ParticlePairAnalyzer","ParticlePairAnalyzer::merge(const Task & task)");
+  for (unsigned int iFilter=0; iFilter<nEventsMixed.size() && iFilter<analyzer->nEventsMixed.size(); iFilter++)
+    nEventsMixed[iFilter] += analyzer->nEventsMixed[iFilter];
+}
+
+int ParticlePairAnalyzer::getMixingClass(const Event & event, int multiplicity) const
+{
+  double value;
+  const EventProperties * properties = event.getEventProperties();
+  if (mixingClassVariable==0)
+    value = multiplicity;
+  else if (!properties)
+    return -1;
+  else if (mixingClassVariable==1)
+    value = properties->refMultiplicity;
+  else if (mixingClassVariable==2)
+    value = properties->impactParameter;
+  else
+    value = properties->other;
+  if (value<min_mixingClass || value>=max_mixingClass) return -1;
+  int iClass = int(double(nBins_mixingClass)*(value-min_mixingClass)/(max_mixingClass-min_mixingClass));
+  return (iClass<nBins_mixingClass) ? iClass : nBins_mixingClass-1;
+}
+
 void ParticlePairAnalyzer::createDerivedHistograms()
 {
   if (reportStart(__FUNCTION__))
@@ -535,6 +725,19 @@ void ParticlePairAnalyzer::createDerivedHistograms()
         histogramManager.addGroupInSet(3,histos);
         }
       }
+    if (!mixingEnabled) continue;
+    // mixed-event pairs
+    for (int iParticleFilter1=0; iParticleFilter1<nParticleFilters; iParticleFilter1++ )
+      {
+      String pfn1 = particleFilters[iParticleFilter1]->getName();
+      for (int iParticleFilter2=0; iParticleFilter2<nParticleFilters; iParticleFilter2++ )
+        {
+        String pfn2 = particleFilters[iParticleFilter2]->getName();
+        histos = new ParticlePairDerivedHistos(this,createName(bn,efn,pfn1,pfn2,"Mixed"),configuration);
+        histos->createHistograms();
+        histogramManager.addGroupInSet(5,histos);
+        }
+      }
     }
   if (reportEnd(__FUNCTION__))
     ;
@@ -616,6 +819,12 @@ void ParticlePairAnalyzer::calculateDerivedHistograms()
           printItem("dPairHistos",dPairHistos->getName());
           }
         dPairHistos->calculatePairDerivedHistograms(*bSingleHistos1,*bSingleHistos2,*dSingleHistos1,*dSingleHistos2,*bPairHistos,binCorrPP);
+        if (!mixingEnabled) continue;
+        //! Mixed-event pairs are normalized per event pair like same-event pairs are normalized per event, so their R2 vanishes
+        //! wherever the acceptance factorizes.
+        bPairHistos = (ParticlePairHistos *) histogramManager.getGroup(4,index);
+        dPairHistos = (ParticlePairDerivedHistos *) histogramManager.getGroup(5,index);
+        dPairHistos->calculatePairDerivedHistograms(*bSingleHistos1,*bSingleHistos2,*dSingleHistos1,*dSingleHistos2,*bPairHistos,binCorrPP);
         }
       }
     }
@@ -13,6 +13,8 @@
 #define CAP__ParticlePairAnalyzer
 #include "EventTask.hpp"
 #include "ParticleDigit.hpp"
+#include "ParticleDigitBuffer.hpp"
+#include "ParticleDigitMixingPool.hpp"
 using CAP::EventTask;
 using CAP::Configuration;
 using CAP::EventFilter;
@@ -32,6 +34,16 @@ namespace CAP
 //! - fillEta [true]: whether to fill histograms  vs. pseudorapidity "eta"
 //! - fillY [false]: whether to fill histograms  vs. rapidity "y"
 //! - fillP2 [false]: whether to fill histograms used in the determination of P2 and G2 pT correlators
+//! - fillDigitized [true]: whether to digitize the particles once per event and fill the pair histograms from the digits (fast) rather than
+//!   pair by pair from the particle momenta (slow). Both produce the same single-particle and pair histograms: every particle accepted by a
+//!   particle filter enters the single-particle histograms of that filter, and only the particles within the pair acceptance (pt range,
+//!   and eta or y range) form pairs. Events imported as views of a CAP event file (see EventCAPView) are only analyzed by the digitized
+//!   path: initialize() throws if a task of the same event loop imports views while fillDigitized is false.
+//! - MixingEnabled [false]: whether to also fill mixed-event pair histograms (requires FillDigitized). The particles of the current event
+//!   are paired with the particles of the last MixingDepth events of the same event filter and event class, kept in a ParticleDigitMixingPool.
+//!   Same-event and mixed-event pairs are filled from the same digits. Each event pair is filled in both orders (particle 1 from the
+//!   current event, then from the pooled event) and the mixed-event histograms are scaled by twice the number of event pairs mixed. Their
+//!   derived histograms (R2, etc.) are computed from the same single-particle histograms as the same-event ones.
 //!
 //! The following parameters specify  the configuration of histograms filled by this task (default values in brackets):
 //!
@@ -55,6 +67,13 @@ namespace CAP
 //!  + nBins_phi [36]: Number of bins
 //!  + min_phi [0.0]: Minimum value
 //!  + max_phi [2pi]: Maximum value
+//! - Event classes used for event mixing
+//!  + MixingDepth [10]: Number of events kept per event class
+//!  + MixingClassVariable [Multiplicity]: Event property used to sort events in classes: Multiplicity (number of particles digitized in the
+//!    event), RefMultiplicity, ImpactParameter, or Other (e.g., a vertex position or event plane angle stored by the event reader)
+//!  + nBins_MixingClass [10]: Number of classes; events outside the range below are not mixed
+//!  + Min_MixingClass [0.0]: Minimum value
+//!  + Max_MixingClass [1000.0]: Maximum value
 //!
 class ParticlePairAnalyzer : public EventTask
 {
@@ -76,7 +95,12 @@ public:
   //! DTOR
   //!
   virtual ~ParticlePairAnalyzer() {}
-  
+
+  //!
+  //! Returns a configured clone of this task used for multithreaded execution.
+  //!
+  virtual Task * clone() const;
+
   //!
   //! Sets the default  values of the configuration parameters used by this task
   //!
@@ -112,13 +136,33 @@ public:
 
   virtual void calculateDerivedHistograms();
 
+  virtual void reset();
+  virtual void clear();
+  virtual void merge(const Task & task);
+
 protected:
+
+  //!
+  //! Returns the mixing class of the given event, or -1 if the event is outside the range of the classes.
+  //!
+  int getMixingClass(const Event & event, int multiplicity) const;
   
   bool fillEta; //!< whether to fill pseudorapidity histograms (set from configuration at initialization)
   bool fillY;   //!< whether to fill rapidity histograms (set from configuration at initialization)
   bool fillP2;  //!< whether to fill P2 and G2 related histograms  (set from configuration at initialization)
-  
+  bool fillDigitized; //!< whether to fill the pair histograms from particle digits (set from configuration at initialization)
+
   vector< vector<ParticleDigit*> > filteredParticles;
+  vector<ParticleDigitBuffer>      filteredDigits;
+
+  bool   mixingEnabled;        //!< whether to fill mixed-event pair histograms (set from configuration at initialization)
+  int    mixingDepth;          //!< number of events kept per mixing class
+  int    mixingClassVariable;  //!< 0: multiplicity, 1: reference multiplicity, 2: impact parameter, 3: other
+  int    nBins_mixingClass;
+  double min_mixingClass;
+  double max_mixingClass;
+  ParticleDigitMixingPool mixingPool;  //!< class iEventFilter*nBins_mixingClass + iClass holds the events of event filter iEventFilter
+  vector<long>  nEventsMixed;          //!< number of event pairs mixed, per event filter
 
    ClassDef(ParticlePairAnalyzer,0)
 };
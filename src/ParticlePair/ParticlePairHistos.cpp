@@ -72,7 +72,18 @@ h_DptDpt_yY(nullptr),
 h_n2_DetaDphi(nullptr),
 h_DptDpt_DetaDphi(nullptr),
 h_n2_DyDphi(nullptr),
-h_DptDpt_DyDphi(nullptr)
+h_DptDpt_DyDphi(nullptr),
+a_n2_ptpt(nullptr),
+a_n2_phiPhi(nullptr),
+a_DptDpt_phiPhi(nullptr),
+a_n2_etaEta(nullptr),
+a_DptDpt_etaEta(nullptr),
+a_n2_DetaDphi(nullptr),
+a_DptDpt_DetaDphi(nullptr),
+a_n2_yY(nullptr),
+a_DptDpt_yY(nullptr),
+a_n2_DyDphi(nullptr),
+a_DptDpt_DyDphi(nullptr)
 {
   appendClassName("ParticlePairHistos");
 }
@@ -233,6 +244,7 @@ void ParticlePairHistos::createHistograms()
   //                                     nBins_DeltaP,  min_DeltaP, max_DeltaP,
   //                                     "p_{s}","p_{o}", "p_{l}","n_{2}");
   //    }
+  createAccumulators();
 
   if ( reportEnd(__FUNCTION__))
     { }
@@ -288,176 +300,173 @@ void ParticlePairHistos::importHistograms(TFile & inputFile)
       h_DptDpt_DyDphi = loadH2(inputFile, CAP::createName(bn,"ptpt_DyDphi"));
       }
     }
+  createAccumulators();
   if (reportEnd(__FUNCTION__))
     ;
 }
 
-void ParticlePairHistos::fill(vector<ParticleDigit*> & particle1, vector<ParticleDigit*> & particle2, bool same, double weight)
+void ParticlePairHistos::createAccumulators()
 {
-//  double nPairs    = 0;
-//  double nPairsEta = 0;
-//  double nPairsY   = 0;
-//  int iG;
-//
-//  for (unsigned int iPart1=0; iPart1<particle1.size(); iPart1++)
-//    {
-//    float pt1 = particle1[iPart1]->pt;
-//    float dpt1 = pt1; // - avgPt1
-//    unsigned int iPt_1  = particle1[iPart1]->iPt;
-//    unsigned int iPhi_1 = particle1[iPart1]->iPhi;
-//    unsigned int iEta_1 = particle1[iPart1]->iEta;
-//    unsigned int iY_1   = particle1[iPart1]->iY;
-//
-//    for (unsigned int iPart2=(same?iPart1+1: 0); iPart2<particle2.size(); iPart2++)
-//      {
-//      float pt2 = particle2[iPart2]->pt;
-//      float dpt2 = pt2; // - avgPt2
-//      unsigned int iPt_2  = particle2[iPart2]->iPt;
-//      unsigned int iPhi_2 = particle2[iPart2]->iPhi;
-//      unsigned int iEta_2 = particle2[iPart2]->iEta;
-//      unsigned int iY_2   = particle2[iPart2]->iY;
-//
-//      nPairs++;
-//      iG = h_n2_ptpt->GetBin(iPt_1,iPt_2);
-//      h_n2_ptpt->AddBinContent(iG,  weight);
-//
-//      iG = h_n2_phiPhi->GetBin(iPhi_1,iPhi_2);
-//      h_n2_phiPhi->AddBinContent(iG,  weight);
-//      if (fillP2)
-//        {
-//        h_DptDpt_phiPhi ->AddBinContent(iG,weight*dpt1*dpt2);
-//        }
-//      if (same)
-//        {
-//        nPairs++;
-//        iG = h_n2_ptpt->GetBin(iPt_2,iPt_1);
-//        h_n2_ptpt->AddBinContent(iG,  weight);
-//        iG = h_n2_phiPhi->GetBin(iPhi_2,iPhi_1);
-//        h_n2_phiPhi->AddBinContent(iG,  weight);
-//        if (fillP2)
-//          {
-//          h_DptDpt_phiPhi->AddBinContent(iG,weight*pt1*pt2);
-//          }
-//        }
-//
-//      if (fillEta && iEta_1!=0 && iEta_2!=0 )
-//        {
-//        nPairsEta++;
-//        // delta-eta maps onto a 2n-1 range i.e., 0 to 2n-2
-//        int iDeltaEta  = iEta_1-iEta_2 + nBins_eta-1;
-//        int iDeltaPhi  = iPhi_1-iPhi_2;
-//        if (iDeltaPhi < 0) iDeltaPhi += nBins_phi;
-//
-//        iG = h_n2_etaEta->GetBin(iEta_1,iEta_2);
-//        h_n2_etaEta->AddBinContent(iG,weight);
-//        if (fillP2)
-//          {
-//          h_DptDpt_etaEta->AddBinContent(iG,weight*pt1*pt2);
-//          }
-//
-//        iG = h_n2_DetaDphi->GetBin(iDeltaEta+1,iDeltaPhi+1);
-//        h_n2_DetaDphi->AddBinContent(iG,weight);
-//        if (fillP2)
-//          {
-//          h_DptDpt_DetaDphi->AddBinContent(iG,weight*pt1*pt2);
-//          }
-//        if (same)
-//          {
-//          nPairsEta++;
-//          // delta-eta maps onto a 2n-1 range i.e., 0 to 2n-2
-//          iDeltaEta  = iEta_2-iEta_1 + nBins_eta-1;
-//          iDeltaPhi  = iPhi_2-iPhi_1;
-//          if (iDeltaPhi < 0) iDeltaPhi += nBins_phi;
-//          iG = h_n2_etaEta->GetBin(iEta_2,iEta_1);
-//          h_n2_etaEta->AddBinContent(iG,weight);
-//          if (fillP2)
-//            {
-//            h_DptDpt_etaEta->AddBinContent(iG,weight*pt1*pt2);
-//            }
-//
-//          iG = h_n2_DetaDphi->GetBin(iDeltaEta+1,iDeltaPhi+1);
-//          h_n2_DetaDphi->AddBinContent(iG,weight);
-//          if (fillP2)
-//            {
-//            h_DptDpt_DetaDphi->AddBinContent(iG,weight*pt1*pt2);
-//            }
-//          }
-//        }
-//
-//      if (fillY && iY_1!=0 && iY_2!=0 )
-//        {
-//        nPairsY++;
-//        int iDeltaY    = iY_1-iY_2 + nBins_y-1;
-//        int iDeltaPhi  = iPhi_1-iPhi_2;
-//        if (iDeltaPhi < 0) iDeltaPhi += nBins_phi;
-//
-//        iG = h_n2_yY->GetBin(iY_1,iY_2);
-//        h_n2_yY->AddBinContent(iG,weight);
-//        if (fillP2)
-//          {
-//          h_DptDpt_yY->AddBinContent(iG,weight*pt1*pt2);
-//          }
-//
-//        iG = h_n2_DyDphi->GetBin(iDeltaY+1,iDeltaPhi+1);
-//        h_n2_DyDphi  ->AddBinContent(iG,weight);
-//        if (fillP2)
-//          {
-//          h_DptDpt_DyDphi->AddBinContent(iG,weight*pt1*pt2);
-//          }
-//        if (same)
-//          {
-//          nPairsY++;
-//          int iDeltaY   = iY_2-iY_1 + nBins_y-1;
-//          int iDeltaPhi  = iPhi_2-iPhi_1;
-//          if (iDeltaPhi < 0) iDeltaPhi += nBins_phi;
-//
-//          iG = h_n2_yY->GetBin(iY_1,iY_2);
-//          h_n2_yY->AddBinContent(iG,weight);
-//          if (fillP2)
-//            {
-//            h_DptDpt_yY->AddBinContent(iG,weight*pt1*pt2);
-//            }
-//
-//          iG = h_n2_DyDphi->GetBin(iDeltaY+1,iDeltaPhi+1);
-//          h_n2_DyDphi  ->AddBinContent(iG,weight);
-//          if (fillP2)
-//            {
-//            h_DptDpt_DyDphi->AddBinContent(iG,weight*pt1*pt2);
-//            }
-//          }
-//        }
-//      }
-//    }
-//
-//  // Update number of entries
-//  h_n2_ptpt->SetEntries(h_n2_ptpt->GetEntries()+nPairs);
-//  h_n2_phiPhi->SetEntries(h_n2_phiPhi->GetEntries()+nPairs);
-//  if (fillP2)
-//    {
-//    h_DptDpt_phiPhi->SetEntries(h_DptDpt_phiPhi->GetEntries()+nPairs);
-//    }
-//  if (fillEta)
-//    {
-//    h_n2_etaEta->SetEntries(h_n2_etaEta->GetEntries()+nPairsEta);
-//    h_n2_DetaDphi->SetEntries(h_n2_DetaDphi->GetEntries()+nPairsEta);
-//    if (fillP2)
-//      {
-//      h_DptDpt_etaEta->SetEntries(h_DptDpt_etaEta->GetEntries()+nPairsEta);
-//      h_DptDpt_DetaDphi->SetEntries(h_DptDpt_DetaDphi->GetEntries()+nPairsEta);
-//      }
-//    }
-//
-//  if (fillY)
-//    {
-//    h_n2_yY->SetEntries(h_n2_yY->GetEntries()+nPairsY);
-//    h_n2_DyDphi->SetEntries(h_n2_DyDphi->GetEntries()+nPairsY);
-//    if (fillP2)
-//      {
-//      h_DptDpt_yY->SetEntries(h_DptDpt_yY->GetEntries()+nPairsY);
-//      h_DptDpt_DyDphi->SetEntries(h_DptDpt_DyDphi->GetEntries()+nPairsY);
-//      }
-//    }
-//  h_n2->Fill(double(nPairs),weight);
+  a_n2_ptpt   = createAccumulator(h_n2_ptpt);
+  a_n2_phiPhi = createAccumulator(h_n2_phiPhi);
+  if (fillP2) a_DptDpt_phiPhi = createAccumulator(h_DptDpt_phiPhi);
+  if (fillEta)
+    {
+    a_n2_etaEta   = createAccumulator(h_n2_etaEta);
+    a_n2_DetaDphi = createAccumulator(h_n2_DetaDphi);
+    if (fillP2)
+      {
+      a_DptDpt_etaEta   = createAccumulator(h_DptDpt_etaEta);
+      a_DptDpt_DetaDphi = createAccumulator(h_DptDpt_DetaDphi);
+      }
+    }
+  if (fillY)
+    {
+    a_n2_yY     = createAccumulator(h_n2_yY);
+    a_n2_DyDphi = createAccumulator(h_n2_DyDphi);
+    if (fillP2)
+      {
+      a_DptDpt_yY     = createAccumulator(h_DptDpt_yY);
+      a_DptDpt_DyDphi = createAccumulator(h_DptDpt_DyDphi);
+      }
+    }
+}
+
+void ParticlePairHistos::fill(const ParticleDigitBuffer & digits1, const ParticleDigitBuffer & digits2, bool same, double weight)
+{
+  unsigned int n1 = digits1.size();
+  unsigned int n2 = digits2.size();
+  if (n1<1 || n2<1) return;
+
+  const int   * iPart1 = digits1.iParticle.data();
+  const int   * iPt1   = digits1.iPt.data();
+  const int   * iPhi1  = digits1.iPhi.data();
+  const int   * iEta1  = digits1.iEta.data();
+  const int   * iY1    = digits1.iY.data();
+  const float * pt1    = digits1.pt.data();
+  const int   * iPart2 = digits2.iParticle.data();
+  const int   * iPt2   = digits2.iPt.data();
+  const int   * iPhi2  = digits2.iPhi.data();
+  const int   * iEta2  = digits2.iEta.data();
+  const int   * iY2    = digits2.iY.data();
+  const float * pt2    = digits2.pt.data();
+
+  // accumulator arrays: the global bin of (ix,iy) is ix + (nx+2)*iy
+  double * n2PtPt        = a_n2_ptpt->getArray();
+  double * n2PhiPhi      = a_n2_phiPhi->getArray();
+  double * ptptPhiPhi    = fillP2 ? a_DptDpt_phiPhi->getArray() : nullptr;
+  double * n2EtaEta      = fillEta ? a_n2_etaEta->getArray() : nullptr;
+  double * n2DetaDphi    = fillEta ? a_n2_DetaDphi->getArray() : nullptr;
+  double * ptptEtaEta    = (fillEta && fillP2) ? a_DptDpt_etaEta->getArray() : nullptr;
+  double * ptptDetaDphi  = (fillEta && fillP2) ? a_DptDpt_DetaDphi->getArray() : nullptr;
+  double * n2YY          = fillY ? a_n2_yY->getArray() : nullptr;
+  double * n2DyDphi      = fillY ? a_n2_DyDphi->getArray() : nullptr;
+  double * ptptYY        = (fillY && fillP2) ? a_DptDpt_yY->getArray() : nullptr;
+  double * ptptDyDphi    = (fillY && fillP2) ? a_DptDpt_DyDphi->getArray() : nullptr;
+  const int stridePt     = nBins_pt+2;
+  const int stridePhi    = nBins_phi+2;
+  const int strideEta    = nBins_eta+2;
+  const int strideY      = nBins_y+2;
+  const int strideDeta   = nBins_Deta+2;
+  const int strideDy     = nBins_Dy+2;
+
+  double nPairs    = 0;
+  double nPairsEta = 0;
+  double nPairsY   = 0;
+
+  // fill the pair (a,b) of particles with the given bins and pt product
+  auto fillPair = [&](int iPtA, int iPhiA, int iEtaA, int iYA, int iPtB, int iPhiB, int iEtaB, int iYB, double ptpt)
+  {
+    nPairs++;
+    n2PtPt[iPtA + stridePt*iPtB] += weight;
+    int iG = iPhiA + stridePhi*iPhiB;
+    n2PhiPhi[iG] += weight;
+    if (fillP2) ptptPhiPhi[iG] += weight*ptpt;
+    int iDeltaPhi = iPhiA-iPhiB;
+    if (iDeltaPhi < 0) iDeltaPhi += nBins_phi;
+    if (fillEta && iEtaA!=0 && iEtaB!=0)
+      {
+      nPairsEta++;
+      // delta-eta maps onto a 2n-1 range i.e., 0 to 2n-2
+      int iDeltaEta = iEtaA-iEtaB + nBins_eta-1;
+      int iGEta     = iEtaA + strideEta*iEtaB;
+      int iGDelta   = (iDeltaEta+1) + strideDeta*(iDeltaPhi+1);
+      n2EtaEta[iGEta]     += weight;
+      n2DetaDphi[iGDelta] += weight;
+      if (fillP2)
+        {
+        ptptEtaEta[iGEta]     += weight*ptpt;
+        ptptDetaDphi[iGDelta] += weight*ptpt;
+        }
+      }
+    if (fillY && iYA!=0 && iYB!=0)
+      {
+      nPairsY++;
+      int iDeltaY = iYA-iYB + nBins_y-1;
+      int iGY     = iYA + strideY*iYB;
+      int iGDelta = (iDeltaY+1) + strideDy*(iDeltaPhi+1);
+      n2YY[iGY]         += weight;
+      n2DyDphi[iGDelta] += weight;
+      if (fillP2)
+        {
+        ptptYY[iGY]         += weight*ptpt;
+        ptptDyDphi[iGDelta] += weight*ptpt;
+        }
+      }
+  };
+
+  for (unsigned int i1=0; i1<n1; i1++)
+    {
+    const int   a_iPart = iPart1[i1];
+    const int   a_iPt   = iPt1[i1];
+    const int   a_iPhi  = iPhi1[i1];
+    const int   a_iEta  = iEta1[i1];
+    const int   a_iY    = iY1[i1];
+    const float a_pt    = pt1[i1];
+    if (same)
+      {
+      // same particle list: each unordered pair is visited once and filled in both orders
+      for (unsigned int i2=i1+1; i2<n2; i2++)
+        {
+        double ptpt = a_pt*pt2[i2];
+        fillPair(a_iPt,a_iPhi,a_iEta,a_iY,iPt2[i2],iPhi2[i2],iEta2[i2],iY2[i2],ptpt);
+        fillPair(iPt2[i2],iPhi2[i2],iEta2[i2],iY2[i2],a_iPt,a_iPhi,a_iEta,a_iY,ptpt);
+        }
+      }
+    else
+      {
+      for (unsigned int i2=0; i2<n2; i2++)
+        {
+        if (iPart2[i2]==a_iPart) continue; // particle accepted by both filters
+        fillPair(a_iPt,a_iPhi,a_iEta,a_iY,iPt2[i2],iPhi2[i2],iEta2[i2],iY2[i2],a_pt*pt2[i2]);
+        }
+      }
+    }
+
+  // Update number of entries
+  a_n2_ptpt->addEntries(nPairs);
+  a_n2_phiPhi->addEntries(nPairs);
+  if (fillP2) a_DptDpt_phiPhi->addEntries(nPairs);
+  if (fillEta)
+    {
+    a_n2_etaEta->addEntries(nPairsEta);
+    a_n2_DetaDphi->addEntries(nPairsEta);
+    if (fillP2)
+      {
+      a_DptDpt_etaEta->addEntries(nPairsEta);
+      a_DptDpt_DetaDphi->addEntries(nPairsEta);
+      }
+    }
+  if (fillY)
+    {
+    a_n2_yY->addEntries(nPairsY);
+    a_n2_DyDphi->addEntries(nPairsY);
+    if (fillP2)
+      {
+      a_DptDpt_yY->addEntries(nPairsY);
+      a_DptDpt_DyDphi->addEntries(nPairsY);
+      }
+    }
 }
 
 void ParticlePairHistos::fill(Particle & particle1, Particle & particle2, double weight)
@@ -490,7 +499,7 @@ void ParticlePairHistos::fill(Particle & particle1, Particle & particle2, double
 //  cout <<  "pt2:" << pt2 << " phi2:" << phi2 << " y2:" << y2 << " iPt2: " << iPt2 << " iPhi2:" <<  iPhi2 << " iY2:" <<  iY2 << endl;
 
   if (iPt1==0  || iPt2==0)  return;
-  if (iPhi1==0 || iPhi1==0) return;
+  if (iPhi1==0 || iPhi2==0) return;
   if (iEta1==0 && iY1==0) return;
   if (iEta2==0 && iY2==0) return;
   int iDeltaEta  = iEta1-iEta2 + nBins_eta-1;
@@ -498,45 +507,43 @@ void ParticlePairHistos::fill(Particle & particle1, Particle & particle2, double
   int iDeltaPhi  = iPhi1-iPhi2;
   if (iDeltaPhi < 0) iDeltaPhi += nBins_phi;
   //cout <<  "iDeltaY:" << iDeltaY << " iDeltaPhi: " << iDeltaPhi << endl;
-  fillP2 = false;
-  fillY  = true;
 
-  iGPtPt   = h_n2_ptpt->GetBin(iPt1,iPt2);
-  iGPhiPhi = h_n2_phiPhi->GetBin(iPhi1,iPhi2);
+  iGPtPt   = a_n2_ptpt->getBin(iPt1,iPt2);
+  iGPhiPhi = a_n2_phiPhi->getBin(iPhi1,iPhi2);
 
-  h_n2_ptpt   ->AddBinContent(iGPtPt,    weight);  h_n2_ptpt  ->SetEntries(h_n2_ptpt  ->GetEntries()+1);
-  h_n2_phiPhi ->AddBinContent(iGPhiPhi,  weight);  h_n2_phiPhi->SetEntries(h_n2_phiPhi->GetEntries()+1);
+  a_n2_ptpt   ->add(iGPtPt,    weight);  a_n2_ptpt  ->addEntries(1);
+  a_n2_phiPhi ->add(iGPhiPhi,  weight);  a_n2_phiPhi->addEntries(1);
 
   if (fillP2)
     {
-    h_DptDpt_phiPhi->AddBinContent(iGPhiPhi,weight*pt1*pt2);
-    h_DptDpt_phiPhi->SetEntries(h_DptDpt_phiPhi->GetEntries()+1);
+    a_DptDpt_phiPhi->add(iGPhiPhi,weight*pt1*pt2);
+    a_DptDpt_phiPhi->addEntries(1);
     }
 
   if (fillEta && iEta1!=0 && iEta2!=0 )
     {
-    iGEtaEta           = h_n2_etaEta->GetBin(iEta1,iEta2);
-    iGDeltaEtaDeltaPhi = h_n2_DetaDphi->GetBin(iDeltaEta+1,iDeltaPhi+1);
-    h_n2_etaEta->AddBinContent(iGEtaEta,weight);             h_n2_etaEta  ->SetEntries(h_n2_etaEta  ->GetEntries()+1);
-    h_n2_DetaDphi->AddBinContent(iGDeltaEtaDeltaPhi,weight); h_n2_DetaDphi->SetEntries(h_n2_DetaDphi->GetEntries()+1);
+    iGEtaEta           = a_n2_etaEta->getBin(iEta1,iEta2);
+    iGDeltaEtaDeltaPhi = a_n2_DetaDphi->getBin(iDeltaEta+1,iDeltaPhi+1);
+    a_n2_etaEta->add(iGEtaEta,weight);             a_n2_etaEta  ->addEntries(1);
+    a_n2_DetaDphi->add(iGDeltaEtaDeltaPhi,weight); a_n2_DetaDphi->addEntries(1);
 
     if (fillP2)
       {
-      h_DptDpt_etaEta   ->AddBinContent(iGEtaEta,           weight*pt1*pt2); h_DptDpt_etaEta->SetEntries(h_DptDpt_etaEta    ->GetEntries()+1);
-      h_DptDpt_DetaDphi ->AddBinContent(iGDeltaEtaDeltaPhi, weight*pt1*pt2); h_DptDpt_DetaDphi->SetEntries(h_DptDpt_DetaDphi->GetEntries()+1);
+      a_DptDpt_etaEta   ->add(iGEtaEta,           weight*pt1*pt2); a_DptDpt_etaEta  ->addEntries(1);
+      a_DptDpt_DetaDphi ->add(iGDeltaEtaDeltaPhi, weight*pt1*pt2); a_DptDpt_DetaDphi->addEntries(1);
       }
     }
 
   if (fillY && iY1!=0 && iY2!=0 )
     {
-    iGYY             = h_n2_yY->GetBin(iY1,iY2);
-    iGDeltaYDeltaPhi = h_n2_DyDphi->GetBin(iDeltaY+1,iDeltaPhi+1);
-    h_n2_yY      ->AddBinContent(iGYY,weight);              h_n2_yY      ->SetEntries(h_n2_yY      ->GetEntries()+1);
-    h_n2_DyDphi  ->AddBinContent(iGDeltaYDeltaPhi,weight);  h_n2_DyDphi  ->SetEntries(h_n2_DyDphi  ->GetEntries()+1);
+    iGYY             = a_n2_yY->getBin(iY1,iY2);
+    iGDeltaYDeltaPhi = a_n2_DyDphi->getBin(iDeltaY+1,iDeltaPhi+1);
+    a_n2_yY      ->add(iGYY,weight);              a_n2_yY      ->addEntries(1);
+    a_n2_DyDphi  ->add(iGDeltaYDeltaPhi,weight);  a_n2_DyDphi  ->addEntries(1);
     if (fillP2)
       {
-      h_DptDpt_yY     ->AddBinContent(iGYY, weight*pt1*pt2);               h_DptDpt_yY ->SetEntries(   h_DptDpt_yY     ->GetEntries()+1);
-      h_DptDpt_DyDphi ->AddBinContent(iGDeltaEtaDeltaPhi, weight*pt1*pt2); h_DptDpt_DyDphi->SetEntries(h_DptDpt_DyDphi->GetEntries()+1);
+      a_DptDpt_yY     ->add(iGYY, weight*pt1*pt2);             a_DptDpt_yY    ->addEntries(1);
+      a_DptDpt_DyDphi ->add(iGDeltaYDeltaPhi, weight*pt1*pt2); a_DptDpt_DyDphi->addEntries(1);
       }
     }
 }
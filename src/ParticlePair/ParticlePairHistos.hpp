@@ -15,6 +15,7 @@
 #include "HistogramGroup.hpp"
 #include "Particle.hpp"
 #include "ParticleDigit.hpp"
+#include "ParticleDigitBuffer.hpp"
 
 namespace CAP
 {
@@ -31,7 +32,13 @@ public:
   virtual void createHistograms();
   virtual void importHistograms(TFile & inputFile);
 
-  virtual void fill(vector<ParticleDigit*> & particle1, vector<ParticleDigit*> & particle2, bool same, double weight);
+  //!
+  //! Fill the pair histograms with all pairs formed by the digits of the two given buffers. Set same to true if the two
+  //! buffers are the same instance (same particle filter): each pair is then visited once and filled in both orders.
+  //! Bins are accumulated into the dense accumulators of this group (see HistogramAccumulator) and flushed into the histograms at scale/export time.
+  //! As the pair by pair fill, this method does not fill the pair multiplicity histogram h_n2.
+  //!
+  virtual void fill(const ParticleDigitBuffer & digits1, const ParticleDigitBuffer & digits2, bool same, double weight);
   virtual void fill(Particle & particle1, Particle & particle2, double weight);
 
   inline int getPtBinFor(float v) const
@@ -144,6 +151,25 @@ public:
 
   TH3 * h_n2_DeltaP;
 
+  HistogramAccumulator * a_n2_ptpt;
+  HistogramAccumulator * a_n2_phiPhi;
+  HistogramAccumulator * a_DptDpt_phiPhi;
+  HistogramAccumulator * a_n2_etaEta;
+  HistogramAccumulator * a_DptDpt_etaEta;
+  HistogramAccumulator * a_n2_DetaDphi;
+  HistogramAccumulator * a_DptDpt_DetaDphi;
+  HistogramAccumulator * a_n2_yY;
+  HistogramAccumulator * a_DptDpt_yY;
+  HistogramAccumulator * a_n2_DyDphi;
+  HistogramAccumulator * a_DptDpt_DyDphi;
+
+protected:
+
+  //!
+  //! Create the accumulators of the pair histograms filled by this group.
+  //!
+  void createAccumulators();
+
   ClassDef(ParticlePairHistos,0)
 };
 
@@ -30,6 +30,13 @@ EventTask(_name,_configuration)
   appendClassName("ParticleSingleAnalyzer");
 }
 
+Task * ParticleSingleAnalyzer::clone() const
+{
+  ParticleSingleAnalyzer * task = new ParticleSingleAnalyzer(getName(),configuration);
+  configureClone(task);
+  return task;
+}
+
 void ParticleSingleAnalyzer::setDefaultConfiguration()
 {
   EventTask::setDefaultConfiguration();
@@ -221,9 +228,12 @@ void ParticleSingleAnalyzer::analyzeEvent()
   // but it may not have  pairs. If so skip out.
   // Doing the checks in this order guarantees the accepted
   // event count is correct for normalization purposes.
-  unsigned int nParticles = event.getNParticles();
+  // events imported as views (see EventCAPView) carry no Particle objects: their kinematics are read from the view columns.
+  const EventCAPView * view = event.getView();
+  unsigned int nParticles = view ? view->getNParticles() : event.getNParticles();
   // cout << "ParticleSingleAnalyzer::analyzeEvent() nParticles:" << nParticles << endl;
   if (nParticles<1) return;
+  fillParticleFilterMasks(event);
 
   vector<double> nAccepted(nParticleFilters,0.0);
   vector<double> totalEnergy(nParticleFilters,0.0);
@@ -246,27 +256,40 @@ void ParticleSingleAnalyzer::analyzeEvent()
     resetNParticlesAcceptedEvent();
     for (unsigned int iParticle=0; iParticle<nParticles; iParticle++)
       {
-      Particle & particle = * event.getParticleAt(iParticle);
       double  pt,e,phi;
       int iPt, iPhi, iEta, iY;
       ParticleDigit * pd;
       bool digitized = false;
       for (int iParticleFilter=0; iParticleFilter<nParticleFilters; iParticleFilter++ )
         {
-        if (particleFilters[iParticleFilter]->accept(particle))
+        if (isAccepted(iParticle,iParticleFilter))
           {
           incrementNParticlesAccepted(iEventFilter,iParticleFilter);
           if (!digitized)
             {
-            LorentzVector & momentum = particle.getMomentum();
-            pt     = momentum.Pt();
-            e      = momentum.E();
-            phi    = momentum.Phi();
+            double eta, y;
+            if (view)
+              {
+              pt     = view->getPt(iParticle);
+              e      = view->e[iParticle];
+              phi    = view->getPhi(iParticle);
+              eta    = view->getEta(iParticle);
+              y      = view->getRapidity(iParticle);
+              }
+            else
+              {
+              LorentzVector & momentum = event.getParticleAt(iParticle)->getMomentum();
+              pt     = momentum.Pt();
+              e      = momentum.E();
+              phi    = momentum.Phi();
+              eta    = momentum.Eta();
+              y      = momentum.Rapidity();
+              }
             if (phi<0.0) phi += CAP::Math::twoPi();
             iPt    = histos->getPtBinFor(pt);
             iPhi   = histos->getPhiBinFor(phi);
-            iEta   = histos->getEtaBinFor(momentum.Eta());
-            iY     = histos->getYBinFor(momentum.Rapidity());
+            iEta   = histos->getEtaBinFor(eta);
+            iY     = histos->getYBinFor(y);
             pd     = factory->getNextObject();
             pd->iY   = iY;
             pd->iEta = iEta;
@@ -307,14 +330,22 @@ void ParticleSingleAnalyzer::analyzeEvent()
    ParticleSingleHistos * histos = (ParticleSingleHistos *) histogramManager.getGroup(0,index);
    for (unsigned int iParticle=0; iParticle<nParticles; iParticle++)
       {
-      Particle & particle = * event.getParticleAt(iParticle);
       //particle.printProperties();
-      if (particleFilters[iParticleFilter]->accept(particle))
+      if (isAccepted(iParticle,iParticleFilter))
         {
         incrementNParticlesAccepted(0,0);
         nAccepted[iParticleFilter]++;
-        totalEnergy[iParticleFilter] += particle.getMomentum().E();
-        histos->fill(particle,1.0);
+        if (view)
+          {
+          totalEnergy[iParticleFilter] += view->e[iParticle];
+          histos->fill(view->getPt(iParticle),view->getEta(iParticle),view->getPhi(iParticle),view->getRapidity(iParticle),view->typeIndex[iParticle],1.0);
+          }
+        else
+          {
+          Particle & particle = * event.getParticleAt(iParticle);
+          totalEnergy[iParticleFilter] += particle.getMomentum().E();
+          histos->fill(particle,1.0);
+          }
         }
       }
     histos->fillMultiplicity(nAccepted[iParticleFilter],totalEnergy[iParticleFilter],1.0);
@@ -369,10 +369,16 @@ void ParticleSingleHistos::fill(vector<ParticleDigit*> & particles, double weigh
 void ParticleSingleHistos::fill(Particle & particle, double weight)
 {
   LorentzVector & momentum = particle.getMomentum();
-  float pt   = momentum.Pt();
-  float eta  = momentum.Eta();
-  float phi  = momentum.Phi();
-  float rapidity = momentum.Rapidity();
+  int typeIndex = ParticleDb::getDefaultParticleDb()->findIndexForType(particle.getTypePtr());
+  fill(momentum.Pt(), momentum.Eta(), momentum.Phi(), momentum.Rapidity(), typeIndex, weight);
+}
+
+void ParticleSingleHistos::fill(double _pt, double _eta, double _phi, double _rapidity, int typeIndex, double weight)
+{
+  float pt   = _pt;
+  float eta  = _eta;
+  float phi  = _phi;
+  float rapidity = _rapidity;
   if (phi<0) phi += CAP::Math::twoPi();
 
   if (useEffCorrection)
@@ -422,8 +428,7 @@ void ParticleSingleHistos::fill(Particle & particle, double weight)
     if (fillP2) h_spt_phiY->Fill(rapidity,phi,weight*pt);
     }
 
-  double pdgIndex = ParticleDb::getDefaultParticleDb()->findIndexForType(particle.getTypePtr());
-  h_pdgId->Fill(pdgIndex);
+  h_pdgId->Fill(double(typeIndex));
 }
 
 //!
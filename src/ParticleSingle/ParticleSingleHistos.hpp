@@ -32,6 +32,12 @@ public:
   virtual void loadCalibration(TFile & inputFile);
   virtual void fill(vector<ParticleDigit*> & particles, double weight);
   virtual void fill(Particle & particle, double weight);
+
+  //!
+  //! Fill the histograms with a particle of the given kinematics and type index (in the default particle database). Used for particles
+  //! of events imported as views (see EventCAPView).
+  //!
+  virtual void fill(double pt, double eta, double phi, double rapidity, int typeIndex, double weight);
   virtual void fillMultiplicity(double nAccepted, double totalEnergy, double weight);
   
   inline int getPtBinFor(float v) const
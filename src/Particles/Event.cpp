@@ -23,7 +23,8 @@ particles(),
 eventProperties(new EventProperties() ),
 //b(-9999.0),
 nucleusA(new Nucleus()),
-nucleusB(new Nucleus())
+nucleusB(new Nucleus()),
+view(nullptr)
 //binaryMoments(new CollisionGeometryMoments()),
 //participantMoments(new CollisionGeometryMoments())
 {
@@ -53,6 +54,7 @@ void Event::clear()
   eventNumber     = 0;
   //b               = -99999;
   particles.clear();
+  view = nullptr;
   if (nucleusA) nucleusA->clear();
   if (nucleusB) nucleusB->clear();
 //  if (binaryMoments) binaryMoments->reset();
@@ -70,6 +72,7 @@ void Event::reset()
   eventNumber   = 0;
   //b             = -99999;
   particles.clear();
+  view = nullptr;
   if (nucleusA) nucleusA->reset();
   if (nucleusB) nucleusB->reset();
 //  if (binaryMoments) binaryMoments->reset();
@@ -192,7 +195,7 @@ void Event::printProperties(ostream & output)
    }
  }
 
-vector<Event*> Event::eventStreamsStore;
+thread_local vector<Event*> Event::eventStreamsStore;
 
 Event * Event::getEventStream(unsigned int index)
 {
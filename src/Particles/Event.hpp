@@ -20,6 +20,8 @@
 namespace CAP
 {
 
+class EventCAPView;
+
 //!
 //! Class encupsalting all components of events (real data or monte carlo)
 //!
@@ -151,6 +153,17 @@ protected:
   EventProperties * getEventProperties() { return eventProperties; }
   EventProperties * getEventProperties() const { return eventProperties; }
 
+  //!
+  //! Attach the given columnar view of the particles of this event (see EventCAPMappedReader). An event carrying a view has no
+  //! Particle objects: analyzers supporting views must use the view rather than getParticles(). The view is detached by clear() and reset().
+  //!
+  void setView(const EventCAPView * _view) { view = _view; }
+
+  //!
+  //! Return the columnar view of the particles of this event, or a null pointer if the particles of this event are Particle objects.
+  //!
+  const EventCAPView * getView() const { return view; }
+
   static Event * getEventStream(unsigned int index);
   static unsigned int getNEventStreams();
   static void resetEventStreams();
@@ -177,10 +190,14 @@ protected:
   //double b;
   Nucleus * nucleusA;
   Nucleus * nucleusB;
+  const EventCAPView * view;
   //CollisionGeometryMoments * binaryMoments;
   //CollisionGeometryMoments * participantMoments;
 
-  static vector<Event*> eventStreamsStore;
+  //!
+  //! Event streams are thread local: each thread running an event chain (see TaskIterator) owns its own streams.
+  //!
+  static thread_local vector<Event*> eventStreamsStore;
 
   ClassDef(Event,0)
 
@@ -0,0 +1,426 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#include <cstring>
+#include "EventCAPChunk.hpp"
+
+using CAP::EventCAPChunk;
+using CAP::ParticleType;
+
+ClassImp(EventCAPChunk);
+
+//!
+//! Pad the given size up to the alignment of the columns of the encoded chunk.
+//!
+static inline size_t alignColumn(size_t size)
+{
+  return (size + CAP::EventCAPChunk::columnAlignment - 1) & ~size_t(CAP::EventCAPChunk::columnAlignment - 1);
+}
+
+//!
+//! Append the given column at the end of the given buffer, after padding the buffer to the column alignment.
+//!
+template <class T>
+static void putColumn(vector<char> & buffer, const vector<T> & column)
+{
+  size_t nBytes = column.size()*sizeof(T);
+  size_t offset = alignColumn(buffer.size());
+  buffer.resize(offset+nBytes,0);
+  if (nBytes>0) memcpy(buffer.data()+offset, column.data(), nBytes);
+}
+
+//!
+//! Read a column of n values at the given (aligned) position of the buffer and advance the position. Returns false if the buffer is too short.
+//!
+template <class T>
+static bool getColumn(const char * buffer, size_t size, size_t & position, vector<T> & column, size_t n)
+{
+  size_t nBytes = n*sizeof(T);
+  position = alignColumn(position);
+  if (position+nBytes>size) return false;
+  column.resize(n);
+  if (nBytes>0) memcpy(column.data(), buffer+position, nBytes);
+  position += nBytes;
+  return true;
+}
+
+EventCAPChunk::EventCAPChunk()
+:
+eventNumber(),
+eventNParticles(),
+eventNModelParameters(),
+projectilePdgCode(),
+targetPdgCode(),
+zProjectile(),
+aProjectile(),
+nPartProjectile(),
+zTarget(),
+aTarget(),
+nPartTarget(),
+nParticipantsTotal(),
+nBinaryTotal(),
+particlesCounted(),
+particlesAccepted(),
+impactParameter(),
+fractionalXSection(),
+refMultiplicity(),
+other(),
+modelParameters(),
+pdgCode(),
+px(),
+py(),
+pz(),
+e(),
+x(),
+y(),
+z(),
+t(),
+live(),
+pid(),
+sourceIndex(),
+nParents(),
+nChildren(),
+links(),
+firstParticle(),
+firstLink(),
+firstModelParameter(),
+particleIndex(),
+eventParticles()
+{
+}
+
+void EventCAPChunk::clear()
+{
+  eventNumber.clear();
+  eventNParticles.clear();
+  eventNModelParameters.clear();
+  projectilePdgCode.clear();
+  targetPdgCode.clear();
+  zProjectile.clear();
+  aProjectile.clear();
+  nPartProjectile.clear();
+  zTarget.clear();
+  aTarget.clear();
+  nPartTarget.clear();
+  nParticipantsTotal.clear();
+  nBinaryTotal.clear();
+  particlesCounted.clear();
+  particlesAccepted.clear();
+  impactParameter.clear();
+  fractionalXSection.clear();
+  refMultiplicity.clear();
+  other.clear();
+  modelParameters.clear();
+  pdgCode.clear();
+  px.clear();
+  py.clear();
+  pz.clear();
+  e.clear();
+  x.clear();
+  y.clear();
+  z.clear();
+  t.clear();
+  live.clear();
+  pid.clear();
+  sourceIndex.clear();
+  nParents.clear();
+  nChildren.clear();
+  links.clear();
+  firstParticle.clear();
+  firstLink.clear();
+  firstModelParameter.clear();
+}
+
+void EventCAPChunk::add(const Event & event)
+{
+  const vector<Particle*> & particles = event.getParticles();
+  unsigned int nParticles = particles.size();
+  const EventProperties * properties = event.getEventProperties();
+
+  eventNumber.push_back(event.getEventNumber());
+  eventNParticles.push_back(nParticles);
+  if (properties)
+    {
+    eventNModelParameters.push_back(properties->modelParameters.size());
+    projectilePdgCode.push_back(properties->projectileType ? properties->projectileType->getPdgCode() : 0);
+    targetPdgCode.push_back(properties->targetType ? properties->targetType->getPdgCode() : 0);
+    zProjectile.push_back(properties->zProjectile);
+    aProjectile.push_back(properties->aProjectile);
+    nPartProjectile.push_back(properties->nPartProjectile);
+    zTarget.push_back(properties->zTarget);
+    aTarget.push_back(properties->aTarget);
+    nPartTarget.push_back(properties->nPartTarget);
+    nParticipantsTotal.push_back(properties->nParticipantsTotal);
+    nBinaryTotal.push_back(properties->nBinaryTotal);
+    particlesCounted.push_back(properties->particlesCounted);
+    particlesAccepted.push_back(properties->particlesAccepted);
+    impactParameter.push_back(properties->impactParameter);
+    fractionalXSection.push_back(properties->fractionalXSection);
+    refMultiplicity.push_back(properties->refMultiplicity);
+    other.push_back(properties->other);
+    modelParameters.insert(modelParameters.end(),properties->modelParameters.begin(),properties->modelParameters.end());
+    }
+  else
+    {
+    eventNModelParameters.push_back(0);
+    projectilePdgCode.push_back(0);
+    targetPdgCode.push_back(0);
+    zProjectile.push_back(0);
+    aProjectile.push_back(0);
+    nPartProjectile.push_back(0);
+    zTarget.push_back(0);
+    aTarget.push_back(0);
+    nPartTarget.push_back(0);
+    nParticipantsTotal.push_back(0);
+    nBinaryTotal.push_back(0);
+    particlesCounted.push_back(0);
+    particlesAccepted.push_back(0);
+    impactParameter.push_back(0.0);
+    fractionalXSection.push_back(0.0);
+    refMultiplicity.push_back(0.0);
+    other.push_back(0.0);
+    }
+
+  particleIndex.clear();
+  for (unsigned int iParticle=0; iParticle<nParticles; iParticle++) particleIndex[particles[iParticle]] = iParticle;
+
+  for (unsigned int iParticle=0; iParticle<nParticles; iParticle++)
+    {
+    const Particle & particle = *particles[iParticle];
+    const LorentzVector & momentum = particle.getMomentum();
+    const LorentzVector & position = particle.getPosition();
+    ParticleType * type = particle.getTypePtr();
+    pdgCode.push_back(type ? type->getPdgCode() : 0);
+    px.push_back(momentum.Px());
+    py.push_back(momentum.Py());
+    pz.push_back(momentum.Pz());
+    e.push_back(momentum.E());
+    x.push_back(position.X());
+    y.push_back(position.Y());
+    z.push_back(position.Z());
+    t.push_back(position.T());
+    live.push_back(particle.isLive() ? 1 : 0);
+    pid.push_back(particle.getPid());
+    sourceIndex.push_back(particle.getSourceIndex());
+    const vector<Particle*> & parents  = particle.getParents();
+    const vector<Particle*> & children = particle.getChildren();
+    nParents.push_back(parents.size());
+    nChildren.push_back(children.size());
+    for (unsigned int k=0; k<parents.size(); k++)
+      {
+      auto found = particleIndex.find(parents[k]);
+      links.push_back(found==particleIndex.end() ? -1 : found->second);
+      }
+    for (unsigned int k=0; k<children.size(); k++)
+      {
+      auto found = particleIndex.find(children[k]);
+      links.push_back(found==particleIndex.end() ? -1 : found->second);
+      }
+    }
+}
+
+ParticleType * EventCAPChunk::findType(int pdgCode, ParticleDb & particleDb)
+{
+  if (pdgCode==0) return nullptr;
+  if (pdgCode<1000000) return particleDb.findPdgCode(pdgCode);
+  if (pdgCode==ParticleType::getInteractionType()->getPdgCode())   return ParticleType::getInteractionType();
+  if (pdgCode==ParticleType::getPPInteractionType()->getPdgCode()) return ParticleType::getPPInteractionType();
+  if (pdgCode==ParticleType::getPNInteractionType()->getPdgCode()) return ParticleType::getPNInteractionType();
+  if (pdgCode==ParticleType::getNNInteractionType()->getPdgCode()) return ParticleType::getNNInteractionType();
+  if (pdgCode==ParticleType::getDecayModeType()->getPdgCode())     return ParticleType::getDecayModeType();
+  if (pdgCode==ParticleType::getNucleusType()->getPdgCode())       return ParticleType::getNucleusType();
+  return particleDb.findPdgCode(pdgCode);
+}
+
+void EventCAPChunk::get(unsigned int iEvent, Event & event, Factory<Particle> & factory, ParticleDb & particleDb)
+{
+  Size_t first      = firstParticle[iEvent];
+  Size_t linkIndex  = firstLink[iEvent];
+  unsigned int nParticles = eventNParticles[iEvent];
+
+  event.setEventNumber(eventNumber[iEvent]);
+  EventProperties * properties = event.getEventProperties();
+  if (properties)
+    {
+    properties->projectileType     = findType(projectilePdgCode[iEvent],particleDb);
+    properties->targetType         = findType(targetPdgCode[iEvent],particleDb);
+    properties->zProjectile        = zProjectile[iEvent];
+    properties->aProjectile        = aProjectile[iEvent];
+    properties->nPartProjectile    = nPartProjectile[iEvent];
+    properties->zTarget            = zTarget[iEvent];
+    properties->aTarget            = aTarget[iEvent];
+    properties->nPartTarget        = nPartTarget[iEvent];
+    properties->nParticipantsTotal = nParticipantsTotal[iEvent];
+    properties->nBinaryTotal       = nBinaryTotal[iEvent];
+    properties->particlesCounted   = particlesCounted[iEvent];
+    properties->particlesAccepted  = particlesAccepted[iEvent];
+    properties->impactParameter    = impactParameter[iEvent];
+    properties->fractionalXSection = fractionalXSection[iEvent];
+    properties->refMultiplicity    = refMultiplicity[iEvent];
+    properties->other              = other[iEvent];
+    auto begin = modelParameters.begin() + firstModelParameter[iEvent];
+    properties->modelParameters.assign(begin, begin + eventNModelParameters[iEvent]);
+    }
+
+  eventParticles.resize(nParticles);
+  for (unsigned int iParticle=0; iParticle<nParticles; iParticle++)
+    {
+    Size_t k = first + iParticle;
+    Particle * particle = factory.getNextObject();
+    particle->clear();
+    particle->set(findType(pdgCode[k],particleDb), px[k], py[k], pz[k], e[k], x[k], y[k], z[k], t[k], live[k]!=0);
+    particle->setPid(pid[k]);
+    particle->setSourceIndex(sourceIndex[k]);
+    eventParticles[iParticle] = particle;
+    event.add(particle);
+    }
+  for (unsigned int iParticle=0; iParticle<nParticles; iParticle++)
+    {
+    Size_t k = first + iParticle;
+    Particle * particle = eventParticles[iParticle];
+    for (unsigned int iLink=0; iLink<nParents[k]; iLink++, linkIndex++)
+      {
+      int index = links[linkIndex];
+      if (index>=0) particle->addParentLink(eventParticles[index]);
+      }
+    for (unsigned int iLink=0; iLink<nChildren[k]; iLink++, linkIndex++)
+      {
+      int index = links[linkIndex];
+      if (index>=0) particle->addChildLink(eventParticles[index]);
+      }
+    }
+}
+
+CAP::Size_t EventCAPChunk::getEncodedSize() const
+{
+  Size_t nEvents    = getNEvents();
+  Size_t nParticles = getNParticles();
+  return nEvents*(sizeof(ULong64_t) + 12*sizeof(UInt_t) + 2*sizeof(int) + 4*sizeof(double))
+  + modelParameters.size()*sizeof(double)
+  + nParticles*(sizeof(int) + 8*sizeof(double) + sizeof(UChar_t) + sizeof(Long64_t) + sizeof(int) + 2*sizeof(UInt_t))
+  + links.size()*sizeof(int)
+  + nColumns*columnAlignment;
+}
+
+void EventCAPChunk::encode(vector<char> & buffer) const
+{
+  buffer.reserve(buffer.size()+getEncodedSize());
+  putColumn(buffer,eventNumber);
+  putColumn(buffer,eventNParticles);
+  putColumn(buffer,eventNModelParameters);
+  putColumn(buffer,projectilePdgCode);
+  putColumn(buffer,targetPdgCode);
+  putColumn(buffer,zProjectile);
+  putColumn(buffer,aProjectile);
+  putColumn(buffer,nPartProjectile);
+  putColumn(buffer,zTarget);
+  putColumn(buffer,aTarget);
+  putColumn(buffer,nPartTarget);
+  putColumn(buffer,nParticipantsTotal);
+  putColumn(buffer,nBinaryTotal);
+  putColumn(buffer,particlesCounted);
+  putColumn(buffer,particlesAccepted);
+  putColumn(buffer,impactParameter);
+  putColumn(buffer,fractionalXSection);
+  putColumn(buffer,refMultiplicity);
+  putColumn(buffer,other);
+  putColumn(buffer,modelParameters);
+  putColumn(buffer,pdgCode);
+  putColumn(buffer,px);
+  putColumn(buffer,py);
+  putColumn(buffer,pz);
+  putColumn(buffer,e);
+  putColumn(buffer,x);
+  putColumn(buffer,y);
+  putColumn(buffer,z);
+  putColumn(buffer,t);
+  putColumn(buffer,live);
+  putColumn(buffer,pid);
+  putColumn(buffer,sourceIndex);
+  putColumn(buffer,nParents);
+  putColumn(buffer,nChildren);
+  putColumn(buffer,links);
+  buffer.resize(alignColumn(buffer.size()),0);
+}
+
+bool EventCAPChunk::decode(const char * buffer, Size_t size, unsigned int nEvents, unsigned int nParticles, unsigned int nLinks)
+{
+  Size_t p = 0;
+  bool ok = true;
+  ok = ok && getColumn(buffer,size,p,eventNumber,nEvents);
+  ok = ok && getColumn(buffer,size,p,eventNParticles,nEvents);
+  ok = ok && getColumn(buffer,size,p,eventNModelParameters,nEvents);
+  ok = ok && getColumn(buffer,size,p,projectilePdgCode,nEvents);
+  ok = ok && getColumn(buffer,size,p,targetPdgCode,nEvents);
+  ok = ok && getColumn(buffer,size,p,zProjectile,nEvents);
+  ok = ok && getColumn(buffer,size,p,aProjectile,nEvents);
+  ok = ok && getColumn(buffer,size,p,nPartProjectile,nEvents);
+  ok = ok && getColumn(buffer,size,p,zTarget,nEvents);
+  ok = ok && getColumn(buffer,size,p,aTarget,nEvents);
+  ok = ok && getColumn(buffer,size,p,nPartTarget,nEvents);
+  ok = ok && getColumn(buffer,size,p,nParticipantsTotal,nEvents);
+  ok = ok && getColumn(buffer,size,p,nBinaryTotal,nEvents);
+  ok = ok && getColumn(buffer,size,p,particlesCounted,nEvents);
+  ok = ok && getColumn(buffer,size,p,particlesAccepted,nEvents);
+  ok = ok && getColumn(buffer,size,p,impactParameter,nEvents);
+  ok = ok && getColumn(buffer,size,p,fractionalXSection,nEvents);
+  ok = ok && getColumn(buffer,size,p,refMultiplicity,nEvents);
+  ok = ok && getColumn(buffer,size,p,other,nEvents);
+  if (!ok) return false;
+
+  // offsets of the particles and model parameters of each event
+  firstParticle.resize(nEvents);
+  firstModelParameter.resize(nEvents);
+  Size_t nParticlesSum = 0;
+  Size_t nModelParametersSum = 0;
+  for (unsigned int iEvent=0; iEvent<nEvents; iEvent++)
+    {
+    firstParticle[iEvent]       = nParticlesSum;
+    firstModelParameter[iEvent] = nModelParametersSum;
+    nParticlesSum       += eventNParticles[iEvent];
+    nModelParametersSum += eventNModelParameters[iEvent];
+    }
+  if (nParticlesSum!=nParticles) return false;
+
+  ok = ok && getColumn(buffer,size,p,modelParameters,nModelParametersSum);
+  ok = ok && getColumn(buffer,size,p,pdgCode,nParticles);
+  ok = ok && getColumn(buffer,size,p,px,nParticles);
+  ok = ok && getColumn(buffer,size,p,py,nParticles);
+  ok = ok && getColumn(buffer,size,p,pz,nParticles);
+  ok = ok && getColumn(buffer,size,p,e,nParticles);
+  ok = ok && getColumn(buffer,size,p,x,nParticles);
+  ok = ok && getColumn(buffer,size,p,y,nParticles);
+  ok = ok && getColumn(buffer,size,p,z,nParticles);
+  ok = ok && getColumn(buffer,size,p,t,nParticles);
+  ok = ok && getColumn(buffer,size,p,live,nParticles);
+  ok = ok && getColumn(buffer,size,p,pid,nParticles);
+  ok = ok && getColumn(buffer,size,p,sourceIndex,nParticles);
+  ok = ok && getColumn(buffer,size,p,nParents,nParticles);
+  ok = ok && getColumn(buffer,size,p,nChildren,nParticles);
+  ok = ok && getColumn(buffer,size,p,links,nLinks);
+  if (!ok || alignColumn(p)!=size) return false;
+
+  // offsets of the links of each event, and sanity check of the link indices
+  firstLink.resize(nEvents);
+  Size_t nLinksSum = 0;
+  for (unsigned int iEvent=0; iEvent<nEvents; iEvent++)
+    {
+    firstLink[iEvent] = nLinksSum;
+    int nEventParticles = eventNParticles[iEvent];
+    Size_t first = firstParticle[iEvent];
+    Size_t nEventLinks = 0;
+    for (int iParticle=0; iParticle<nEventParticles; iParticle++) nEventLinks += nParents[first+iParticle] + nChildren[first+iParticle];
+    for (Size_t iLink=nLinksSum; iLink<nLinksSum+nEventLinks && iLink<nLinks; iLink++)
+      if (links[iLink]>=nEventParticles) return false;
+    nLinksSum += nEventLinks;
+    }
+  return nLinksSum==nLinks;
+}
@@ -0,0 +1,157 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#ifndef CAP__EventCAPChunk
+#define CAP__EventCAPChunk
+#include <vector>
+#include <unordered_map>
+#include "Aliases.hpp"
+#include "Event.hpp"
+#include "ParticleDb.hpp"
+#include "Factory.hpp"
+
+using namespace std;
+namespace CAP
+{
+
+//!
+//! Columnar block of events of the CAP binary event format (see EventCAPWriter and EventCAPReader).
+//!
+//! A chunk holds the events in columns: one array per event attribute (event number, multiplicity, event properties), one array per
+//! particle attribute (PDG code, momentum, position, live flag, pid, source index, number of parents and children) for all the
+//! particles of all the events of the chunk, and one array of parent/child links. Links are given as indices of the particles
+//! in their event: parents first then children, for each particle in sequence. A link to a particle not included in the event
+//! (e.g., a nucleon of the colliding nuclei) is stored as -1 and dropped on import.
+//!
+//! The encoded form of a chunk is the concatenation of its columns in the order of declaration below, with the
+//! byte order of the machine that wrote it (little endian on all supported platforms). Each column starts at an offset
+//! that is a multiple of columnAlignment bytes, and the encoded chunk is padded to a multiple of columnAlignment bytes, so
+//! that the columns of an uncompressed chunk can be used in place (see EventCAPMappedReader).
+//!
+class EventCAPChunk
+{
+public:
+
+  EventCAPChunk();
+  virtual ~EventCAPChunk() {}
+
+  //!
+  //! Remove all events from this chunk. The memory allocated is retained for the next chunk.
+  //!
+  void clear();
+
+  //!
+  //! Append the given event to this chunk.
+  //!
+  void add(const Event & event);
+
+  //!
+  //! Fill the given event with the event at the given index of this chunk. Particles are obtained from the given factory
+  //! and their types are looked up by PDG code in the given particle database.
+  //!
+  void get(unsigned int iEvent, Event & event, Factory<Particle> & factory, ParticleDb & particleDb);
+
+  inline unsigned int getNEvents() const    { return eventNumber.size(); }
+  inline unsigned int getNParticles() const { return pdgCode.size();     }
+  inline unsigned int getNLinks() const     { return links.size();       }
+
+  //!
+  //! Upper bound on the number of bytes of the encoded chunk, including the padding of the columns.
+  //!
+  Size_t getEncodedSize() const;
+
+  //!
+  //! Encode the columns of this chunk at the end of the given buffer.
+  //!
+  void encode(vector<char> & buffer) const;
+
+  //!
+  //! Decode the given buffer into this chunk. The counts of events, particles, and links are those recorded in the chunk header.
+  //! Returns false if the content of the buffer is inconsistent with these counts.
+  //!
+  bool decode(const char * buffer, Size_t size, unsigned int nEvents, unsigned int nParticles, unsigned int nLinks);
+
+  //!
+  //! Return the type with the given PDG code. Codes of the interaction, decay mode, and nucleus types, which are not part of
+  //! the particle database, are mapped onto the corresponding singletons of the class ParticleType.
+  //!
+  static ParticleType * findType(int pdgCode, ParticleDb & particleDb);
+
+  //!
+  //! Alignment (in bytes) of the columns of the encoded chunk.
+  //!
+  static const unsigned int columnAlignment = 8;
+
+  //!
+  //! Number of columns of the encoded chunk.
+  //!
+  static const unsigned int nColumns = 35;
+
+protected:
+
+  // event columns
+  vector<ULong64_t> eventNumber;
+  vector<UInt_t>    eventNParticles;
+  vector<UInt_t>    eventNModelParameters;
+  vector<int>       projectilePdgCode;
+  vector<int>       targetPdgCode;
+  vector<UInt_t>    zProjectile;
+  vector<UInt_t>    aProjectile;
+  vector<UInt_t>    nPartProjectile;
+  vector<UInt_t>    zTarget;
+  vector<UInt_t>    aTarget;
+  vector<UInt_t>    nPartTarget;
+  vector<UInt_t>    nParticipantsTotal;
+  vector<UInt_t>    nBinaryTotal;
+  vector<UInt_t>    particlesCounted;
+  vector<UInt_t>    particlesAccepted;
+  vector<double>    impactParameter;
+  vector<double>    fractionalXSection;
+  vector<double>    refMultiplicity;
+  vector<double>    other;
+  vector<double>    modelParameters;
+
+  // particle columns
+  vector<int>       pdgCode;
+  vector<double>    px;
+  vector<double>    py;
+  vector<double>    pz;
+  vector<double>    e;
+  vector<double>    x;
+  vector<double>    y;
+  vector<double>    z;
+  vector<double>    t;
+  vector<UChar_t>   live;
+  vector<Long64_t>  pid;
+  vector<int>       sourceIndex;
+  vector<UInt_t>    nParents;
+  vector<UInt_t>    nChildren;
+
+  // link column
+  vector<int>       links;
+
+  // read positions: offsets of the first particle, link, and model parameter of each event
+  vector<Size_t>    firstParticle;
+  vector<Size_t>    firstLink;
+  vector<Size_t>    firstModelParameter;
+
+  // particle index look up used while adding an event
+  unordered_map<const Particle*,int> particleIndex;
+
+  // particles of the event being read, used to resolve the links
+  vector<Particle*> eventParticles;
+
+  ClassDef(EventCAPChunk,0)
+};
+
+}
+
+#endif /* CAP__EventCAPChunk */
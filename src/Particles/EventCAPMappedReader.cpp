@@ -0,0 +1,396 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "RZip.h"
+#include "Exceptions.hpp"
+#include "EventCAPMappedReader.hpp"
+#include "EventCAPWriter.hpp"
+
+using CAP::EventCAPMappedReader;
+using CAP::EventCAPWriter;
+using CAP::EventCAPChunk;
+
+ClassImp(EventCAPMappedReader);
+
+//!
+//! Size of the file header and of a chunk header of the CAP event format (see EventCAPWriter).
+//!
+static const size_t fileHeaderSize  = 8 + 2*sizeof(UInt_t);
+static const size_t chunkHeaderSize = 4 + 5*sizeof(UInt_t) + 2*sizeof(ULong64_t);
+
+template <class T>
+static inline T getValue(const char * data)
+{
+  T value;
+  memcpy(&value,data,sizeof(T));
+  return value;
+}
+
+EventCAPMappedReader::EventCAPMappedReader()
+:
+fileName(),
+fileDescriptor(-1),
+mapped(nullptr),
+mappedSize(0),
+particleDb(nullptr),
+indexed(false),
+nEventsTotal(0),
+dataBegin(0),
+dataEnd(0),
+nextChunkOffset(0),
+nextEvent(0),
+lastEvent(-1),
+chunkOffsets(),
+chunkFirstEvents(),
+chunkData(nullptr),
+chunkSize(0),
+decompressed(),
+chunkNEvents(0),
+chunkEventIndex(0),
+eventNumber(nullptr),
+eventNParticles(nullptr),
+eventNModelParameters(nullptr),
+projectilePdgCode(nullptr),
+targetPdgCode(nullptr),
+zProjectile(nullptr),
+aProjectile(nullptr),
+nPartProjectile(nullptr),
+zTarget(nullptr),
+aTarget(nullptr),
+nPartTarget(nullptr),
+nParticipantsTotal(nullptr),
+nBinaryTotal(nullptr),
+particlesCounted(nullptr),
+particlesAccepted(nullptr),
+impactParameter(nullptr),
+fractionalXSection(nullptr),
+refMultiplicity(nullptr),
+other(nullptr),
+modelParameters(nullptr),
+pdgCode(nullptr),
+px(nullptr),
+py(nullptr),
+pz(nullptr),
+e(nullptr),
+live(nullptr),
+firstParticle(),
+firstModelParameter(),
+types(),
+typeIndices(),
+typeCache(),
+view()
+{
+}
+
+EventCAPMappedReader::~EventCAPMappedReader()
+{
+  close();
+}
+
+void EventCAPMappedReader::open(const String & _fileName, ParticleDb & _particleDb)
+{
+  close();
+  fileName   = _fileName;
+  particleDb = &_particleDb;
+  typeCache.clear();
+  fileDescriptor = ::open(fileName.Data(), O_RDONLY);
+  if (fileDescriptor<0) throw FileException(fileName,"Unable to open file for reading","EventCAPMappedReader::open()");
+  struct stat fileStatus;
+  if (fstat(fileDescriptor,&fileStatus)!=0 || fileStatus.st_size<Long64_t(fileHeaderSize))
+    {
+    close();
+    throw FileException(_fileName,"Not a CAP event file","EventCAPMappedReader::open()");
+    }
+  mappedSize = fileStatus.st_size;
+  void * address = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+  if (address==MAP_FAILED)
+    {
+    close();
+    throw FileException(_fileName,"Unable to map file","EventCAPMappedReader::open()");
+    }
+  mapped = static_cast<const char*>(address);
+  madvise(address, mappedSize, MADV_SEQUENTIAL);
+
+  if (memcmp(mapped,EventCAPWriter::fileMagic,8)!=0)
+    {
+    close();
+    throw FileException(_fileName,"Not a CAP event file","EventCAPMappedReader::open()");
+    }
+  if (getValue<UInt_t>(mapped+8)!=EventCAPWriter::formatVersion)
+    {
+    close();
+    throw FileException(_fileName,"Unsupported format version","EventCAPMappedReader::open()");
+    }
+  dataBegin       = fileHeaderSize;
+  nextChunkOffset = dataBegin;
+  nextEvent       = 0;
+  lastEvent       = -1;
+  readIndex();
+}
+
+void EventCAPMappedReader::readIndex()
+{
+  indexed      = false;
+  nEventsTotal = 0;
+  dataEnd      = mappedSize;
+  chunkOffsets.clear();
+  chunkFirstEvents.clear();
+  const ULong64_t trailerSize = 2*sizeof(ULong64_t) + 8;
+  if (mappedSize < fileHeaderSize+trailerSize) return;
+
+  const char * trailer = mapped + mappedSize - trailerSize;
+  if (memcmp(trailer+2*sizeof(ULong64_t),EventCAPWriter::endMagic,8)!=0) return;
+  ULong64_t indexOffset = getValue<ULong64_t>(trailer);
+  ULong64_t nEvents     = getValue<ULong64_t>(trailer+sizeof(ULong64_t));
+  if (indexOffset+4+sizeof(ULong64_t)>mappedSize-trailerSize) return;
+  if (memcmp(mapped+indexOffset,EventCAPWriter::indexMagic,4)!=0) return;
+  ULong64_t nChunks = getValue<ULong64_t>(mapped+indexOffset+4);
+  const char * entry = mapped+indexOffset+4+sizeof(ULong64_t);
+  if (nChunks>(mappedSize-trailerSize-indexOffset)/(2*sizeof(ULong64_t))) return;
+  chunkOffsets.resize(nChunks);
+  chunkFirstEvents.resize(nChunks);
+  for (ULong64_t iChunk=0; iChunk<nChunks; iChunk++, entry += 2*sizeof(ULong64_t))
+    {
+    chunkOffsets[iChunk]     = getValue<ULong64_t>(entry);
+    chunkFirstEvents[iChunk] = getValue<ULong64_t>(entry+sizeof(ULong64_t));
+    }
+  indexed      = true;
+  nEventsTotal = nEvents;
+  dataEnd      = indexOffset;
+}
+
+bool EventCAPMappedReader::mapChunk(ULong64_t offset)
+{
+  chunkNEvents    = 0;
+  chunkEventIndex = 0;
+  if (offset+4>dataEnd) return false;
+  const char * header = mapped + offset;
+  if (memcmp(header,EventCAPWriter::chunkMagic,4)!=0)
+    {
+    if (memcmp(header,EventCAPWriter::indexMagic,4)==0) return false;
+    throw FileException(fileName,"Corrupted chunk header","EventCAPMappedReader::mapChunk()");
+    }
+  // the writer of a file without index may have stopped in the middle of its last chunk: the data end at the previous chunk.
+  if (offset+chunkHeaderSize>dataEnd)
+    {
+    if (!indexed) return false;
+    throw FileException(fileName,"Truncated chunk header","EventCAPMappedReader::mapChunk()");
+    }
+  UInt_t    nEvents      = getValue<UInt_t>(header+4);
+  UInt_t    nParticles   = getValue<UInt_t>(header+8);
+  UInt_t    isCompressed = getValue<UInt_t>(header+16);
+  ULong64_t rawSize      = getValue<ULong64_t>(header+24);
+  ULong64_t storedSize   = getValue<ULong64_t>(header+32);
+  const char * stored    = header + chunkHeaderSize;
+  if (offset+chunkHeaderSize+storedSize>dataEnd)
+    {
+    if (!indexed) return false;
+    throw FileException(fileName,"Truncated chunk","EventCAPMappedReader::mapChunk()");
+    }
+  nextChunkOffset = offset + chunkHeaderSize + storedSize + EventCAPWriter::getPadding(storedSize);
+
+  if (isCompressed)
+    {
+    decompressed.resize((rawSize+sizeof(ULong64_t)-1)/sizeof(ULong64_t));
+    unsigned char * target = reinterpret_cast<unsigned char*>(decompressed.data());
+    ULong64_t sourcePosition = 0;
+    ULong64_t targetPosition = 0;
+    while (sourcePosition<storedSize)
+      {
+      int sourceSize = 0;
+      int targetSize = 0;
+      // the compression algorithms do not modify their input: the mapping is read only.
+      unsigned char * source = reinterpret_cast<unsigned char*>(const_cast<char*>(stored+sourcePosition));
+      if (storedSize-sourcePosition<9 || R__unzip_header(&sourceSize, source, &targetSize)!=0
+          || sourcePosition+sourceSize>storedSize || targetPosition+targetSize>rawSize)
+        throw FileException(fileName,"Corrupted compressed chunk","EventCAPMappedReader::mapChunk()");
+      int nOut = 0;
+      R__unzip(&sourceSize, source, &targetSize, target+targetPosition, &nOut);
+      if (nOut!=targetSize) throw FileException(fileName,"Chunk decompression failed","EventCAPMappedReader::mapChunk()");
+      sourcePosition += sourceSize;
+      targetPosition += nOut;
+      }
+    if (targetPosition!=rawSize) throw FileException(fileName,"Corrupted compressed chunk","EventCAPMappedReader::mapChunk()");
+    chunkData = reinterpret_cast<const char*>(decompressed.data());
+    }
+  else
+    {
+    if (rawSize!=storedSize) throw FileException(fileName,"Corrupted chunk sizes","EventCAPMappedReader::mapChunk()");
+    chunkData = stored;
+    }
+  chunkSize = rawSize;
+
+  // the columns are in the order written by EventCAPChunk::encode()
+  size_t p = 0;
+  bool ok = true;
+  ok = ok && (eventNumber           = getColumn<ULong64_t>(p,nEvents));
+  ok = ok && (eventNParticles       = getColumn<UInt_t>(p,nEvents));
+  ok = ok && (eventNModelParameters = getColumn<UInt_t>(p,nEvents));
+  ok = ok && (projectilePdgCode     = getColumn<int>(p,nEvents));
+  ok = ok && (targetPdgCode         = getColumn<int>(p,nEvents));
+  ok = ok && (zProjectile           = getColumn<UInt_t>(p,nEvents));
+  ok = ok && (aProjectile           = getColumn<UInt_t>(p,nEvents));
+  ok = ok && (nPartProjectile       = getColumn<UInt_t>(p,nEvents));
+  ok = ok && (zTarget               = getColumn<UInt_t>(p,nEvents));
+  ok = ok && (aTarget               = getColumn<UInt_t>(p,nEvents));
+  ok = ok && (nPartTarget           = getColumn<UInt_t>(p,nEvents));
+  ok = ok && (nParticipantsTotal    = getColumn<UInt_t>(p,nEvents));
+  ok = ok && (nBinaryTotal          = getColumn<UInt_t>(p,nEvents));
+  ok = ok && (particlesCounted      = getColumn<UInt_t>(p,nEvents));
+  ok = ok && (particlesAccepted     = getColumn<UInt_t>(p,nEvents));
+  ok = ok && (impactParameter       = getColumn<double>(p,nEvents));
+  ok = ok && (fractionalXSection    = getColumn<double>(p,nEvents));
+  ok = ok && (refMultiplicity       = getColumn<double>(p,nEvents));
+  ok = ok && (other                 = getColumn<double>(p,nEvents));
+  if (!ok) throw FileException(fileName,"Corrupted chunk content","EventCAPMappedReader::mapChunk()");
+
+  firstParticle.resize(nEvents);
+  firstModelParameter.resize(nEvents);
+  Size_t nParticlesSum = 0;
+  Size_t nModelParametersSum = 0;
+  for (unsigned int iEvent=0; iEvent<nEvents; iEvent++)
+    {
+    firstParticle[iEvent]       = nParticlesSum;
+    firstModelParameter[iEvent] = nModelParametersSum;
+    nParticlesSum       += eventNParticles[iEvent];
+    nModelParametersSum += eventNModelParameters[iEvent];
+    }
+  if (nParticlesSum!=nParticles) throw FileException(fileName,"Corrupted chunk content","EventCAPMappedReader::mapChunk()");
+
+  ok = ok && (modelParameters = getColumn<double>(p,nModelParametersSum));
+  ok = ok && (pdgCode         = getColumn<int>(p,nParticles));
+  ok = ok && (px              = getColumn<double>(p,nParticles));
+  ok = ok && (py              = getColumn<double>(p,nParticles));
+  ok = ok && (pz              = getColumn<double>(p,nParticles));
+  ok = ok && (e               = getColumn<double>(p,nParticles));
+  // x, y, z, t are not used by the views
+  ok = ok && getColumn<double>(p,4*size_t(nParticles));
+  ok = ok && (live            = getColumn<UChar_t>(p,nParticles));
+  if (!ok) throw FileException(fileName,"Corrupted chunk content","EventCAPMappedReader::mapChunk()");
+
+  // look up the types once for the whole chunk
+  types.resize(nParticles);
+  typeIndices.resize(nParticles);
+  for (unsigned int iParticle=0; iParticle<nParticles; iParticle++)
+    {
+    int code = pdgCode[iParticle];
+    auto found = typeCache.find(code);
+    if (found==typeCache.end())
+      {
+      ParticleType * type = EventCAPChunk::findType(code,*particleDb);
+      int index = type ? particleDb->findIndexForType(type) : -1;
+      found = typeCache.emplace(code,std::make_pair(type,index)).first;
+      }
+    types[iParticle]       = found->second.first;
+    typeIndices[iParticle] = found->second.second;
+    }
+  chunkNEvents = nEvents;
+  return true;
+}
+
+bool EventCAPMappedReader::read(Event & event)
+{
+  if (!isOpen()) throw FileException(fileName,"File is not open","EventCAPMappedReader::read()");
+  if (lastEvent>=0 && nextEvent>=lastEvent) return false;
+  while (chunkEventIndex>=chunkNEvents)
+    {
+    if (!mapChunk(nextChunkOffset)) return false;
+    }
+  unsigned int iEvent = chunkEventIndex++;
+  nextEvent++;
+  Size_t first = firstParticle[iEvent];
+
+  event.setEventNumber(eventNumber[iEvent]);
+  EventProperties * properties = event.getEventProperties();
+  if (properties)
+    {
+    properties->projectileType     = EventCAPChunk::findType(projectilePdgCode[iEvent],*particleDb);
+    properties->targetType         = EventCAPChunk::findType(targetPdgCode[iEvent],*particleDb);
+    properties->zProjectile        = zProjectile[iEvent];
+    properties->aProjectile        = aProjectile[iEvent];
+    properties->nPartProjectile    = nPartProjectile[iEvent];
+    properties->zTarget            = zTarget[iEvent];
+    properties->aTarget            = aTarget[iEvent];
+    properties->nPartTarget        = nPartTarget[iEvent];
+    properties->nParticipantsTotal = nParticipantsTotal[iEvent];
+    properties->nBinaryTotal       = nBinaryTotal[iEvent];
+    properties->particlesCounted   = particlesCounted[iEvent];
+    properties->particlesAccepted  = particlesAccepted[iEvent];
+    properties->impactParameter    = impactParameter[iEvent];
+    properties->fractionalXSection = fractionalXSection[iEvent];
+    properties->refMultiplicity    = refMultiplicity[iEvent];
+    properties->other              = other[iEvent];
+    const double * begin = modelParameters + firstModelParameter[iEvent];
+    properties->modelParameters.assign(begin, begin + eventNModelParameters[iEvent]);
+    }
+
+  view.eventNumber = eventNumber[iEvent];
+  view.nParticles  = eventNParticles[iEvent];
+  view.px          = px + first;
+  view.py          = py + first;
+  view.pz          = pz + first;
+  view.e           = e  + first;
+  view.pdgCode     = pdgCode + first;
+  view.typeIndex   = typeIndices.data() + first;
+  view.type        = types.data() + first;
+  view.live        = live + first;
+  event.setView(&view);
+  return true;
+}
+
+void EventCAPMappedReader::seekEvent(long eventIndex)
+{
+  if (!isOpen()) throw FileException(fileName,"File is not open","EventCAPMappedReader::seekEvent()");
+  if (!indexed)  throw FileException(fileName,"File has no index","EventCAPMappedReader::seekEvent()");
+  if (eventIndex<0 || eventIndex>=nEventsTotal) throw FileException(fileName,"Event index out of range","EventCAPMappedReader::seekEvent()");
+  // last chunk whose first event is not after the requested event
+  unsigned int iChunk = std::upper_bound(chunkFirstEvents.begin(),chunkFirstEvents.end(),ULong64_t(eventIndex)) - chunkFirstEvents.begin() - 1;
+  if (!mapChunk(chunkOffsets[iChunk])) throw FileException(fileName,"Unable to read chunk","EventCAPMappedReader::seekEvent()");
+  chunkEventIndex = eventIndex - chunkFirstEvents[iChunk];
+  nextEvent       = eventIndex;
+}
+
+void EventCAPMappedReader::setEventRange(long first, long last)
+{
+  if (!isOpen()) throw FileException(fileName,"File is not open","EventCAPMappedReader::setEventRange()");
+  if (!indexed)  throw FileException(fileName,"File has no index","EventCAPMappedReader::setEventRange()");
+  first = std::max(first,0L);
+  last  = std::min(last,nEventsTotal);
+  if (first<last)
+    seekEvent(first);
+  else
+    nextEvent = last = first;
+  lastEvent = last;
+}
+
+void EventCAPMappedReader::close()
+{
+  if (mapped) munmap(const_cast<char*>(mapped), mappedSize);
+  if (fileDescriptor>=0) ::close(fileDescriptor);
+  fileDescriptor  = -1;
+  mapped          = nullptr;
+  mappedSize      = 0;
+  indexed         = false;
+  nEventsTotal    = 0;
+  chunkData       = nullptr;
+  chunkSize       = 0;
+  chunkNEvents    = 0;
+  chunkEventIndex = 0;
+  nextEvent       = 0;
+  lastEvent       = -1;
+  view.clear();
+}
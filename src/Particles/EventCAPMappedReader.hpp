@@ -0,0 +1,177 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#ifndef CAP__EventCAPMappedReader
+#define CAP__EventCAPMappedReader
+#include <vector>
+#include <unordered_map>
+#include "EventCAPChunk.hpp"
+#include "EventCAPView.hpp"
+
+using namespace std;
+namespace CAP
+{
+
+//!
+//! Memory mapped reader of the CAP binary event format (see EventCAPWriter for the file layout).
+//!
+//! Unlike EventCAPReader, this reader does not create Particle objects: read() fills the event number and properties of the given
+//! event and attaches to it a view (see EventCAPView) of the particle columns of the event. The columns of uncompressed chunks are
+//! used in place in the mapped file; compressed chunks are decompressed once into a buffer owned by the reader. The only
+//! per-particle work done by the reader is the look up of the particle types, once per chunk. As with EventCAPReader, a file
+//! with an index can be read from any event or over a range of events, and reading a file that was not closed stops at its last
+//! complete chunk.
+//!
+class EventCAPMappedReader
+{
+public:
+
+  EventCAPMappedReader();
+  virtual ~EventCAPMappedReader();
+
+  //!
+  //! Map the given file and load its index, if any. The types of the particles are looked up in the given particle database.
+  //!
+  void open(const String & fileName, ParticleDb & particleDb);
+
+  //!
+  //! Set the event number and properties of the given event to those of the next event of the file, and attach to the event a view of its
+  //! particles. Returns false at the end of the file.
+  //!
+  bool read(Event & event);
+
+  //!
+  //! Position the reader so that the next call to read() returns the event at the given index. The file must have an index.
+  //!
+  void seekEvent(long eventIndex);
+
+  //!
+  //! Restrict the reader to the events of index first to last-1 (see EventCAPReader::setEventRange()). The file must have an index.
+  //!
+  void setEventRange(long first, long last);
+
+  void close();
+
+  inline bool isOpen() const
+  {
+  return mapped!=nullptr;
+  }
+
+  inline bool hasIndex() const
+  {
+  return indexed;
+  }
+
+  //!
+  //! Returns the number of events of the file if it has an index, and -1 otherwise.
+  //!
+  inline long getNEvents() const
+  {
+  return indexed ? nEventsTotal : -1;
+  }
+
+  //!
+  //! Returns the view of the last event read.
+  //!
+  inline const EventCAPView & getView() const
+  {
+  return view;
+  }
+
+protected:
+
+  //!
+  //! Load the index and trailer of the file, if present.
+  //!
+  void readIndex();
+
+  //!
+  //! Locate the columns of the chunk at the given offset of the file, decompressing it if needed, and look up the types of its particles.
+  //! Returns false at the end of the data.
+  //!
+  bool mapChunk(ULong64_t offset);
+
+  //!
+  //! Returns a pointer to the column of n values at the given (aligned) position of the current chunk and advance the position. Returns
+  //! a null pointer if the chunk is too short.
+  //!
+  template <class T>
+  const T * getColumn(size_t & position, size_t n)
+  {
+  position = (position + EventCAPChunk::columnAlignment - 1) & ~size_t(EventCAPChunk::columnAlignment - 1);
+  if (position+n*sizeof(T)>chunkSize) return nullptr;
+  const T * column = reinterpret_cast<const T*>(chunkData+position);
+  position += n*sizeof(T);
+  return column;
+  }
+
+  String                fileName;
+  int                   fileDescriptor;
+  const char *          mapped;
+  ULong64_t             mappedSize;
+  ParticleDb *          particleDb;
+  bool                  indexed;
+  long                  nEventsTotal;
+  ULong64_t             dataBegin;
+  ULong64_t             dataEnd;
+  ULong64_t             nextChunkOffset;
+  long                  nextEvent;
+  long                  lastEvent;  // -1 if the reader is not restricted to a range of events
+  vector<ULong64_t>     chunkOffsets;
+  vector<ULong64_t>     chunkFirstEvents;
+
+  // current chunk
+  const char *          chunkData;
+  size_t                chunkSize;
+  vector<ULong64_t>     decompressed;  // 8 bytes words to guarantee the alignment of the columns
+  unsigned int          chunkNEvents;
+  unsigned int          chunkEventIndex;
+  const ULong64_t *     eventNumber;
+  const UInt_t *        eventNParticles;
+  const UInt_t *        eventNModelParameters;
+  const int *           projectilePdgCode;
+  const int *           targetPdgCode;
+  const UInt_t *        zProjectile;
+  const UInt_t *        aProjectile;
+  const UInt_t *        nPartProjectile;
+  const UInt_t *        zTarget;
+  const UInt_t *        aTarget;
+  const UInt_t *        nPartTarget;
+  const UInt_t *        nParticipantsTotal;
+  const UInt_t *        nBinaryTotal;
+  const UInt_t *        particlesCounted;
+  const UInt_t *        particlesAccepted;
+  const double *        impactParameter;
+  const double *        fractionalXSection;
+  const double *        refMultiplicity;
+  const double *        other;
+  const double *        modelParameters;
+  const int *           pdgCode;
+  const double *        px;
+  const double *        py;
+  const double *        pz;
+  const double *        e;
+  const UChar_t *       live;
+  vector<Size_t>        firstParticle;
+  vector<Size_t>        firstModelParameter;
+  vector<ParticleType*> types;
+  vector<int>           typeIndices;
+
+  // type and index in the particle database of the PDG codes encountered so far
+  unordered_map<int,std::pair<ParticleType*,int>> typeCache;
+  EventCAPView          view;
+
+  ClassDef(EventCAPMappedReader,0)
+};
+
+}
+
+#endif /* CAP__EventCAPMappedReader */
@@ -0,0 +1,241 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#include <cstring>
+#include <algorithm>
+#include "RZip.h"
+#include "Exceptions.hpp"
+#include "EventCAPReader.hpp"
+#include "EventCAPWriter.hpp"
+
+using CAP::EventCAPReader;
+using CAP::EventCAPWriter;
+
+ClassImp(EventCAPReader);
+
+template <class T>
+static bool readValue(std::ifstream & input, T & value)
+{
+  input.read(reinterpret_cast<char*>(&value),sizeof(T));
+  return bool(input);
+}
+
+EventCAPReader::EventCAPReader()
+:
+fileName(),
+inputFile(),
+compressedFile(false),
+indexed(false),
+nEventsTotal(0),
+dataEnd(0),
+chunk(),
+chunkEventIndex(0),
+nextEvent(0),
+lastEvent(-1),
+stored(),
+encoded(),
+chunkOffsets(),
+chunkFirstEvents()
+{
+}
+
+EventCAPReader::~EventCAPReader()
+{
+  close();
+}
+
+void EventCAPReader::open(const String & _fileName)
+{
+  close();
+  fileName = _fileName;
+  inputFile.open(fileName.Data(), std::ios::binary);
+  if (!inputFile.is_open()) throw FileException(fileName,"Unable to open file for reading","EventCAPReader::open()");
+  char magic[8];
+  UInt_t version;
+  UInt_t flags;
+  inputFile.read(magic,8);
+  if (!inputFile || memcmp(magic,EventCAPWriter::fileMagic,8)!=0)
+    throw FileException(fileName,"Not a CAP event file","EventCAPReader::open()");
+  if (!readValue(inputFile,version) || !readValue(inputFile,flags))
+    throw FileException(fileName,"Truncated file header","EventCAPReader::open()");
+  if (version!=EventCAPWriter::formatVersion)
+    throw FileException(fileName,"Unsupported format version","EventCAPReader::open()");
+  compressedFile = (flags&1)!=0;
+  ULong64_t dataBegin = inputFile.tellg();
+  readIndex();
+  inputFile.clear();
+  inputFile.seekg(dataBegin);
+  chunk.clear();
+  chunkEventIndex = 0;
+  nextEvent = 0;
+  lastEvent = -1;
+}
+
+void EventCAPReader::readIndex()
+{
+  indexed      = false;
+  nEventsTotal = 0;
+  chunkOffsets.clear();
+  chunkFirstEvents.clear();
+  inputFile.seekg(0,std::ios::end);
+  ULong64_t fileSize = inputFile.tellg();
+  dataEnd = fileSize;
+  const ULong64_t trailerSize = 2*sizeof(ULong64_t) + 8;
+  if (fileSize < 16+trailerSize) return;
+
+  ULong64_t indexOffset;
+  ULong64_t nEvents;
+  char magic[8];
+  inputFile.seekg(fileSize-trailerSize);
+  if (!readValue(inputFile,indexOffset) || !readValue(inputFile,nEvents)) return;
+  inputFile.read(magic,8);
+  if (!inputFile || memcmp(magic,EventCAPWriter::endMagic,8)!=0) return;
+  if (indexOffset>=fileSize-trailerSize) return;
+
+  ULong64_t nChunks;
+  inputFile.seekg(indexOffset);
+  inputFile.read(magic,4);
+  if (!inputFile || memcmp(magic,EventCAPWriter::indexMagic,4)!=0) return;
+  if (!readValue(inputFile,nChunks)) return;
+  chunkOffsets.resize(nChunks);
+  chunkFirstEvents.resize(nChunks);
+  for (ULong64_t iChunk=0; iChunk<nChunks; iChunk++)
+    {
+    if (!readValue(inputFile,chunkOffsets[iChunk]) || !readValue(inputFile,chunkFirstEvents[iChunk]))
+      {
+      chunkOffsets.clear();
+      chunkFirstEvents.clear();
+      return;
+      }
+    }
+  indexed      = true;
+  nEventsTotal = nEvents;
+  dataEnd      = indexOffset;
+}
+
+bool EventCAPReader::readChunk()
+{
+  ULong64_t position = inputFile.tellg();
+  if (!inputFile || position>=dataEnd) return false;
+  char magic[4];
+  UInt_t nEvents, nParticles, nLinks, isCompressed, reserved;
+  ULong64_t rawSize, storedSize;
+  inputFile.read(magic,4);
+  if (!inputFile) return false; // end of the data of a file without index
+  if (memcmp(magic,EventCAPWriter::chunkMagic,4)!=0)
+    {
+    if (memcmp(magic,EventCAPWriter::indexMagic,4)==0) return false;
+    throw FileException(fileName,"Corrupted chunk header","EventCAPReader::readChunk()");
+    }
+  bool ok = readValue(inputFile,nEvents) && readValue(inputFile,nParticles) && readValue(inputFile,nLinks);
+  ok = ok && readValue(inputFile,isCompressed) && readValue(inputFile,reserved);
+  ok = ok && readValue(inputFile,rawSize) && readValue(inputFile,storedSize);
+  // the writer of a file without index may have stopped in the middle of its last chunk: the data end at the previous chunk.
+  if (!ok)
+    {
+    if (!indexed) return false;
+    throw FileException(fileName,"Truncated chunk header","EventCAPReader::readChunk()");
+    }
+  ULong64_t dataBegin = inputFile.tellg();
+  if (dataBegin+storedSize>dataEnd)
+    {
+    if (!indexed) return false;
+    throw FileException(fileName,"Truncated chunk","EventCAPReader::readChunk()");
+    }
+
+  stored.resize(storedSize);
+  inputFile.read(stored.data(),storedSize);
+  if (!inputFile) throw FileException(fileName,"Truncated chunk","EventCAPReader::readChunk()");
+  inputFile.ignore(EventCAPWriter::getPadding(storedSize));
+
+  const char * data = stored.data();
+  if (isCompressed)
+    {
+    encoded.resize(rawSize);
+    ULong64_t source = 0;
+    ULong64_t target = 0;
+    while (source<storedSize)
+      {
+      int sourceSize = 0;
+      int targetSize = 0;
+      unsigned char * sourceData = reinterpret_cast<unsigned char*>(stored.data()+source);
+      if (storedSize-source<9 || R__unzip_header(&sourceSize, sourceData, &targetSize)!=0
+          || source+sourceSize>storedSize || target+targetSize>rawSize)
+        throw FileException(fileName,"Corrupted compressed chunk","EventCAPReader::readChunk()");
+      int nOut = 0;
+      R__unzip(&sourceSize, sourceData, &targetSize, reinterpret_cast<unsigned char*>(encoded.data()+target), &nOut);
+      if (nOut!=targetSize) throw FileException(fileName,"Chunk decompression failed","EventCAPReader::readChunk()");
+      source += sourceSize;
+      target += nOut;
+      }
+    if (target!=rawSize) throw FileException(fileName,"Corrupted compressed chunk","EventCAPReader::readChunk()");
+    data = encoded.data();
+    }
+  else if (rawSize!=storedSize)
+    {
+    throw FileException(fileName,"Corrupted chunk sizes","EventCAPReader::readChunk()");
+    }
+  if (!chunk.decode(data,rawSize,nEvents,nParticles,nLinks))
+    throw FileException(fileName,"Corrupted chunk content","EventCAPReader::readChunk()");
+  chunkEventIndex = 0;
+  return true;
+}
+
+bool EventCAPReader::read(Event & event, Factory<Particle> & factory, ParticleDb & particleDb)
+{
+  if (!isOpen()) throw FileException(fileName,"File is not open","EventCAPReader::read()");
+  if (lastEvent>=0 && nextEvent>=lastEvent) return false;
+  while (chunkEventIndex>=chunk.getNEvents())
+    {
+    if (!readChunk()) return false;
+    }
+  chunk.get(chunkEventIndex++,event,factory,particleDb);
+  nextEvent++;
+  return true;
+}
+
+void EventCAPReader::seekEvent(long eventIndex)
+{
+  if (!isOpen()) throw FileException(fileName,"File is not open","EventCAPReader::seekEvent()");
+  if (!indexed)  throw FileException(fileName,"File has no index","EventCAPReader::seekEvent()");
+  if (eventIndex<0 || eventIndex>=nEventsTotal) throw FileException(fileName,"Event index out of range","EventCAPReader::seekEvent()");
+  // last chunk whose first event is not after the requested event
+  unsigned int iChunk = std::upper_bound(chunkFirstEvents.begin(),chunkFirstEvents.end(),ULong64_t(eventIndex)) - chunkFirstEvents.begin() - 1;
+  inputFile.clear();
+  inputFile.seekg(chunkOffsets[iChunk]);
+  if (!readChunk()) throw FileException(fileName,"Unable to read chunk","EventCAPReader::seekEvent()");
+  chunkEventIndex = eventIndex - chunkFirstEvents[iChunk];
+  nextEvent = eventIndex;
+}
+
+void EventCAPReader::setEventRange(long first, long last)
+{
+  if (!isOpen()) throw FileException(fileName,"File is not open","EventCAPReader::setEventRange()");
+  if (!indexed)  throw FileException(fileName,"File has no index","EventCAPReader::setEventRange()");
+  first = std::max(first,0L);
+  last  = std::min(last,nEventsTotal);
+  if (first<last)
+    seekEvent(first);
+  else
+    nextEvent = last = first;
+  lastEvent = last;
+}
+
+void EventCAPReader::close()
+{
+  if (inputFile.is_open()) inputFile.close();
+  indexed = false;
+  nEventsTotal = 0;
+  chunk.clear();
+  chunkEventIndex = 0;
+  nextEvent = 0;
+  lastEvent = -1;
+}
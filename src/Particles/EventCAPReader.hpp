@@ -0,0 +1,111 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#ifndef CAP__EventCAPReader
+#define CAP__EventCAPReader
+#include <fstream>
+#include "EventCAPChunk.hpp"
+
+namespace CAP
+{
+
+//!
+//! Reader of the CAP binary event format (see EventCAPWriter for the file layout). Events are read sequentially, one chunk
+//! at a time. If the file was closed properly, its index is loaded on open() and seekEvent() can be used to position the
+//! reader at any event of the file, and setEventRange() to restrict the reader to a range of events. The last chunk of a file
+//! that was not closed may be incomplete: reading stops at the last complete chunk.
+//!
+class EventCAPReader
+{
+public:
+
+  EventCAPReader();
+  virtual ~EventCAPReader();
+
+  //!
+  //! Open the given file and load its index, if any.
+  //!
+  void open(const String & fileName);
+
+  //!
+  //! Fill the given event with the next event of the file. Particles are obtained from the given factory and their types
+  //! are looked up by PDG code in the given particle database. Returns false at the end of the file.
+  //!
+  bool read(Event & event, Factory<Particle> & factory, ParticleDb & particleDb);
+
+  //!
+  //! Position the reader so that the next call to read() returns the event at the given index. The file must have an index.
+  //!
+  void seekEvent(long eventIndex);
+
+  //!
+  //! Restrict the reader to the events of index first to last-1: the next call to read() returns the event at index first and read()
+  //! returns false once the event at index last-1 was read. The file must have an index. The range is clipped to the events of the file
+  //! and may be empty.
+  //!
+  void setEventRange(long first, long last);
+
+  void close();
+
+  inline bool isOpen() const
+  {
+  return inputFile.is_open();
+  }
+
+  //!
+  //! Returns true if the file has an index, i.e., it was closed properly by its writer.
+  //!
+  inline bool hasIndex() const
+  {
+  return indexed;
+  }
+
+  //!
+  //! Returns the number of events of the file if it has an index, and -1 otherwise.
+  //!
+  inline long getNEvents() const
+  {
+  return indexed ? nEventsTotal : -1;
+  }
+
+protected:
+
+  //!
+  //! Read, decompress, and decode the chunk at the current position of the file. Returns false at the end of the data.
+  //!
+  bool readChunk();
+
+  //!
+  //! Load the index and trailer of the file, if present.
+  //!
+  void readIndex();
+
+  String                fileName;
+  std::ifstream         inputFile;
+  bool                  compressedFile;
+  bool                  indexed;
+  long                  nEventsTotal;
+  ULong64_t             dataEnd;
+  EventCAPChunk         chunk;
+  unsigned int          chunkEventIndex;
+  long                  nextEvent;
+  long                  lastEvent;  // -1 if the reader is not restricted to a range of events
+  vector<char>          stored;
+  vector<char>          encoded;
+  vector<ULong64_t>     chunkOffsets;
+  vector<ULong64_t>     chunkFirstEvents;
+
+  ClassDef(EventCAPReader,0)
+};
+
+}
+
+#endif /* CAP__EventCAPReader */
@@ -0,0 +1,39 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#include "EventCAPReaderTask.hpp"
+using CAP::EventCAPReaderTask;
+using CAP::String;
+
+ClassImp(EventCAPReaderTask);
+
+EventCAPReaderTask::EventCAPReaderTask(const String & _name,
+                                       const Configuration & _configuration)
+:
+EventTask(_name, _configuration)
+{
+  appendClassName("EventCAPReaderTask");
+}
+
+CAP::Task * EventCAPReaderTask::clone() const
+{
+  EventCAPReaderTask * task = new EventCAPReaderTask(getName(),configuration);
+  configureClone(task);
+  return task;
+}
+
+void EventCAPReaderTask::setDefaultConfiguration()
+{
+  EventTask::setDefaultConfiguration();
+  addParameter("EventsUseStream0", true);
+  addParameter("EventsImport",     true);
+  addParameter("EventsImportCAP",  true);
+}
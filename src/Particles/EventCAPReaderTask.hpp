@@ -0,0 +1,60 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#ifndef CAP__EventCAPReaderTask
+#define CAP__EventCAPReaderTask
+#include "EventTask.hpp"
+
+namespace CAP
+{
+
+//!
+//! Task reading the events of a CAP event file (see EventCAPWriter) into the first event stream, one event per execution. The file
+//! is EventsImportFile in the folder EventsImportPath. Events are imported as Particle objects or, if EventsImportCAPView is true, as
+//! views of the memory mapped file. The end of data is posted at the end of the file.
+//!
+//! The task can be cloned: when the event loop of TaskIterator runs on several threads, each clone reads its own contiguous share of
+//! the events of the file (see EventTask::importEventCAP()). The file must then have an index, i.e., it must have been closed by its writer.
+//!
+class EventCAPReaderTask : public EventTask
+{
+public:
+
+  //!
+  //! Detailed CTOR
+  //!
+  //! @param _name Name given to task instance
+  //! @param _configuration Configuration used to run this task
+  //!
+  EventCAPReaderTask(const String & _name,
+                     const Configuration & _configuration);
+
+  //!
+  //! DTOR
+  //!
+  virtual ~EventCAPReaderTask() {}
+
+  //!
+  //! Create a configured but uninitialized copy of this task (see Task::clone()).
+  //!
+  virtual Task * clone() const;
+
+  //!
+  //! Sets the default  values of the configuration parameters used by this task
+  //!
+  virtual void setDefaultConfiguration();
+
+  ClassDef(EventCAPReaderTask,0)
+};
+
+}
+
+#endif /* CAP__EventCAPReaderTask */
@@ -0,0 +1,43 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#include "EventCAPView.hpp"
+using CAP::EventCAPView;
+
+ClassImp(EventCAPView);
+
+EventCAPView::EventCAPView()
+:
+eventNumber(0),
+nParticles(0),
+px(nullptr),
+py(nullptr),
+pz(nullptr),
+e(nullptr),
+pdgCode(nullptr),
+typeIndex(nullptr),
+type(nullptr),
+live(nullptr)
+{  }
+
+void EventCAPView::clear()
+{
+  eventNumber = 0;
+  nParticles  = 0;
+  px          = nullptr;
+  py          = nullptr;
+  pz          = nullptr;
+  e           = nullptr;
+  pdgCode     = nullptr;
+  typeIndex   = nullptr;
+  type        = nullptr;
+  live        = nullptr;
+}
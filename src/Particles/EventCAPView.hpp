@@ -0,0 +1,108 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#ifndef CAP__EventCAPView
+#define CAP__EventCAPView
+#include <cmath>
+#include "Aliases.hpp"
+#include "ParticleType.hpp"
+
+namespace CAP
+{
+
+//!
+//! Columnar view of the particles of one event read from a CAP event file by EventCAPMappedReader. The view exposes
+//! the particle columns of the event (momentum components, energy, type, and live flag) in place, without creating
+//! Particle objects. The columns are owned by the reader and remain valid until the next event is read.
+//!
+//! An event carrying a view (see Event::getView()) has no particles. Analyzers supporting views read the kinematics
+//! and types of the particles with the accessors below.
+//!
+class EventCAPView
+{
+public:
+
+  EventCAPView();
+  virtual ~EventCAPView() {}
+
+  //!
+  //! Detach the view from its columns.
+  //!
+  void clear();
+
+  inline unsigned int getNParticles() const
+  {
+  return nParticles;
+  }
+
+  inline double getPt(unsigned int iParticle) const
+  {
+  return std::sqrt(px[iParticle]*px[iParticle] + py[iParticle]*py[iParticle]);
+  }
+
+  //!
+  //! Azimuth of the particle in the range [-pi,pi], as returned by LorentzVector::Phi().
+  //!
+  inline double getPhi(unsigned int iParticle) const
+  {
+  return (px[iParticle]==0.0 && py[iParticle]==0.0) ? 0.0 : std::atan2(py[iParticle],px[iParticle]);
+  }
+
+  //!
+  //! Pseudorapidity of the particle, as returned by LorentzVector::Eta().
+  //!
+  inline double getEta(unsigned int iParticle) const
+  {
+  double p = std::sqrt(px[iParticle]*px[iParticle] + py[iParticle]*py[iParticle] + pz[iParticle]*pz[iParticle]);
+  double cosTheta = p==0.0 ? 1.0 : pz[iParticle]/p;
+  if (cosTheta*cosTheta<1.0) return -0.5*std::log((1.0-cosTheta)/(1.0+cosTheta));
+  if (pz[iParticle]==0.0) return 0.0;
+  return pz[iParticle]>0.0 ? 10e10 : -10e10;
+  }
+
+  //!
+  //! Rapidity of the particle, as returned by LorentzVector::Rapidity().
+  //!
+  inline double getRapidity(unsigned int iParticle) const
+  {
+  return 0.5*std::log((e[iParticle]+pz[iParticle])/(e[iParticle]-pz[iParticle]));
+  }
+
+  //!
+  //! Type of the particle. The type may be null for particles whose PDG code is unknown.
+  //!
+  inline ParticleType * getType(unsigned int iParticle) const
+  {
+  return type[iParticle];
+  }
+
+  inline bool isLive(unsigned int iParticle) const
+  {
+  return live[iParticle]!=0;
+  }
+
+  ULong64_t              eventNumber;
+  unsigned int           nParticles;
+  const double *         px;
+  const double *         py;
+  const double *         pz;
+  const double *         e;
+  const int *            pdgCode;
+  const int *            typeIndex;   //!< index of the type of the particle in the particle database (see ParticleDb::findIndexForType()), -1 if not found
+  ParticleType * const * type;
+  const UChar_t *        live;
+
+  ClassDef(EventCAPView,0)
+};
+
+}
+
+#endif /* CAP__EventCAPView */
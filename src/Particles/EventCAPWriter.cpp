@@ -0,0 +1,157 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#include "RZip.h"
+#include "Compression.h"
+#include "Exceptions.hpp"
+#include "EventCAPWriter.hpp"
+
+using CAP::EventCAPWriter;
+
+ClassImp(EventCAPWriter);
+
+const char         EventCAPWriter::fileMagic[9]  = "CAPEVT01";
+const char         EventCAPWriter::endMagic[9]   = "CAPEND01";
+const char         EventCAPWriter::chunkMagic[5] = "CHNK";
+const char         EventCAPWriter::indexMagic[5] = "INDX";
+const unsigned int EventCAPWriter::formatVersion = 2;
+
+//!
+//! Largest block compressed in one call of the ROOT compression algorithms.
+//!
+static const int maxZipBlockSize = 0xffffff;
+
+template <class T>
+static void writeValue(std::ofstream & output, const T & value)
+{
+  output.write(reinterpret_cast<const char*>(&value),sizeof(T));
+}
+
+EventCAPWriter::EventCAPWriter()
+:
+fileName(),
+outputFile(),
+compressionLevel(0),
+eventsPerChunk(100),
+nEventsWritten(0),
+chunk(),
+encoded(),
+compressed(),
+chunkOffsets(),
+chunkFirstEvents()
+{
+}
+
+EventCAPWriter::~EventCAPWriter()
+{
+  if (isOpen()) close();
+}
+
+void EventCAPWriter::open(const String & _fileName, int _compressionLevel, unsigned int _eventsPerChunk)
+{
+  if (isOpen()) close();
+  fileName         = _fileName;
+  compressionLevel = _compressionLevel;
+  eventsPerChunk   = _eventsPerChunk>0 ? _eventsPerChunk : 1;
+  nEventsWritten   = 0;
+  chunk.clear();
+  chunkOffsets.clear();
+  chunkFirstEvents.clear();
+  outputFile.open(fileName.Data(), std::ios::binary | std::ios::trunc);
+  if (!outputFile.is_open()) throw FileException(fileName,"Unable to open file for writing","EventCAPWriter::open()");
+  UInt_t flags = compressionLevel>0 ? 1 : 0;
+  outputFile.write(fileMagic,8);
+  writeValue(outputFile,UInt_t(formatVersion));
+  writeValue(outputFile,flags);
+}
+
+void EventCAPWriter::write(const Event & event)
+{
+  if (!isOpen()) throw FileException(fileName,"File is not open","EventCAPWriter::write()");
+  chunk.add(event);
+  if (chunk.getNEvents()>=eventsPerChunk) writeChunk();
+}
+
+void EventCAPWriter::writeChunk()
+{
+  unsigned int nEvents = chunk.getNEvents();
+  if (nEvents<1) return;
+  encoded.clear();
+  chunk.encode(encoded);
+  ULong64_t rawSize    = encoded.size();
+  ULong64_t storedSize = rawSize;
+  UInt_t    isCompressed = 0;
+  const char * stored  = encoded.data();
+
+  if (compressionLevel>0 && rawSize>0)
+    {
+    // compress block by block; give up (store raw) as soon as a block does not compress.
+    compressed.resize(rawSize);
+    ULong64_t source = 0;
+    ULong64_t target = 0;
+    bool ok = true;
+    while (ok && source<rawSize)
+      {
+      int sourceSize = int(std::min<ULong64_t>(rawSize-source,maxZipBlockSize));
+      int targetSize = int(std::min<ULong64_t>(rawSize-target,maxZipBlockSize));
+      int nOut = 0;
+      R__zipMultipleAlgorithm(compressionLevel, &sourceSize, encoded.data()+source, &targetSize, compressed.data()+target, &nOut,
+                              ROOT::RCompressionSetting::EAlgorithm::kUseGlobal);
+      if (nOut<=0) ok = false;
+      source += sourceSize;
+      target += nOut;
+      }
+    if (ok && target<rawSize)
+      {
+      storedSize   = target;
+      stored       = compressed.data();
+      isCompressed = 1;
+      }
+    }
+
+  chunkOffsets.push_back(ULong64_t(outputFile.tellp()));
+  chunkFirstEvents.push_back(nEventsWritten);
+  outputFile.write(chunkMagic,4);
+  writeValue(outputFile,UInt_t(nEvents));
+  writeValue(outputFile,UInt_t(chunk.getNParticles()));
+  writeValue(outputFile,UInt_t(chunk.getNLinks()));
+  writeValue(outputFile,isCompressed);
+  writeValue(outputFile,UInt_t(0)); // reserved
+  writeValue(outputFile,rawSize);
+  writeValue(outputFile,storedSize);
+  outputFile.write(stored,storedSize);
+  // keep the next chunk aligned
+  static const char padding[EventCAPChunk::columnAlignment] = {0};
+  outputFile.write(padding,getPadding(storedSize));
+  if (!outputFile.good()) throw FileException(fileName,"Error while writing chunk","EventCAPWriter::writeChunk()");
+  nEventsWritten += nEvents;
+  chunk.clear();
+}
+
+void EventCAPWriter::close()
+{
+  if (!isOpen()) return;
+  writeChunk();
+  ULong64_t indexOffset = outputFile.tellp();
+  outputFile.write(indexMagic,4);
+  writeValue(outputFile,ULong64_t(chunkOffsets.size()));
+  for (unsigned int iChunk=0; iChunk<chunkOffsets.size(); iChunk++)
+    {
+    writeValue(outputFile,chunkOffsets[iChunk]);
+    writeValue(outputFile,chunkFirstEvents[iChunk]);
+    }
+  writeValue(outputFile,indexOffset);
+  writeValue(outputFile,ULong64_t(nEventsWritten));
+  outputFile.write(endMagic,8);
+  bool good = outputFile.good();
+  outputFile.close();
+  if (!good) throw FileException(fileName,"Error while writing index","EventCAPWriter::close()");
+}
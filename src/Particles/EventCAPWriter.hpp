@@ -0,0 +1,111 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#ifndef CAP__EventCAPWriter
+#define CAP__EventCAPWriter
+#include <fstream>
+#include "EventCAPChunk.hpp"
+
+namespace CAP
+{
+
+//!
+//! Writer of the CAP binary event format. Events are written in chunks of a fixed number of events (see EventCAPChunk),
+//! optionally compressed with the ROOT compression algorithms. The file layout is:
+//!
+//! - file header: magic "CAPEVT01" (8 bytes), format version (UInt_t), flags (UInt_t);
+//! - chunks: magic "CHNK" (4 bytes), number of events, particles, and links (3 x UInt_t), compression flag (UInt_t), a reserved
+//!   word (UInt_t), size of the encoded chunk (ULong64_t), size stored in the file (ULong64_t), followed by the stored bytes
+//!   padded to a multiple of EventCAPChunk::columnAlignment bytes;
+//! - index: magic "INDX", number of chunks (ULong64_t), and for each chunk its file offset and the index of its first event (2 x ULong64_t);
+//! - trailer: offset of the index and total number of events (2 x ULong64_t), and magic "CAPEND01".
+//!
+//! The index and trailer are written by close(). A file that was not closed properly can still be read sequentially.
+//! The header and chunk headers are multiples of EventCAPChunk::columnAlignment bytes long so that the columns of
+//! uncompressed chunks are aligned in the file.
+//!
+class EventCAPWriter
+{
+public:
+
+  EventCAPWriter();
+
+  //!
+  //! DTOR: the file is closed if it is still open.
+  //!
+  virtual ~EventCAPWriter();
+
+  //!
+  //! Open (create) the given file.
+  //! @param fileName name of the file to create.
+  //! @param compressionLevel compression level (1-9) of the chunks, 0 for no compression.
+  //! @param eventsPerChunk number of events grouped in a chunk.
+  //!
+  void open(const String & fileName, int compressionLevel=1, unsigned int eventsPerChunk=100);
+
+  //!
+  //! Append the given event to the file. The event is written when the chunk it belongs to is complete.
+  //!
+  void write(const Event & event);
+
+  //!
+  //! Write the last (incomplete) chunk, the index, and the trailer, and close the file.
+  //!
+  void close();
+
+  inline bool isOpen() const
+  {
+  return outputFile.is_open();
+  }
+
+  inline long getNEventsWritten() const
+  {
+  return nEventsWritten;
+  }
+
+  static const char         fileMagic[9];
+  static const char         endMagic[9];
+  static const char         chunkMagic[5];
+  static const char         indexMagic[5];
+  static const unsigned int formatVersion;
+
+  //!
+  //! Number of padding bytes written after a chunk of the given stored size.
+  //!
+  static inline unsigned int getPadding(ULong64_t storedSize)
+  {
+  return (EventCAPChunk::columnAlignment - storedSize%EventCAPChunk::columnAlignment) % EventCAPChunk::columnAlignment;
+  }
+
+protected:
+
+  //!
+  //! Encode, compress, and write the current chunk.
+  //!
+  void writeChunk();
+
+  String                fileName;
+  std::ofstream         outputFile;
+  int                   compressionLevel;
+  unsigned int          eventsPerChunk;
+  long                  nEventsWritten;
+  EventCAPChunk         chunk;
+  vector<char>          encoded;
+  vector<char>          compressed;
+  vector<ULong64_t>     chunkOffsets;
+  vector<ULong64_t>     chunkFirstEvents;
+
+  ClassDef(EventCAPWriter,0)
+};
+
+}
+
+#endif /* CAP__EventCAPWriter */
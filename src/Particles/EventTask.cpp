@@ -23,9 +23,15 @@ EventTask::EventTask()
 :
 Task(),
 eventsCreate             (false),
+eventsCreateCAP          (false),
+eventsCreateNative       (false),
 eventsRequested          (false),
 eventsConvertToCAP       (false),
+eventsConvertToNative    (false),
 eventsImport             (false),
+eventsImportCAP          (false),
+eventsImportCAPView      (false),
+eventsImportNative       (false),
 eventsImportTree         (""),
 eventsImportPath         (""),
 eventsImportFile         (""),
@@ -37,6 +43,8 @@ eventsExportFile         (""),
 eventsExportTree         (""),
 eventsExportNative       (false),
 eventsExportCAP          (false),
+eventsExportCAPCompression(1),
+eventsExportCAPChunkSize (100),
 eventsExportMaxPerFile   (false),
 eventsUseStream0         (false),
 eventsUseStream1         (false),
@@ -60,6 +68,10 @@ calibsExportPath         (""),
 calibsExportFile         (""),
 particleDb(nullptr),
 particleFactory(nullptr),
+eventCAPReader(nullptr),
+eventCAPMappedReader(nullptr),
+eventCAPWriter(nullptr),
+eventsImportShare(1),
 eventStreams(),
 nEventFilters(0),
 nParticleFilters(0),
@@ -69,7 +81,9 @@ nEventsAccepted(),
 nEventsAcceptedTotal(),
 nParticlesAcceptedEvent(),
 nParticlesAccepted(),
-nParticlesAcceptedTotal()
+nParticlesAcceptedTotal(),
+particleFilterMasks(),
+nParticleFilterMaskWords(0)
 {
   appendClassName("EventTask");
 }
@@ -82,9 +96,15 @@ EventTask::EventTask(const String & _name,
 :
 Task(_name,_configuration),
 eventsCreate             (false),
+eventsCreateCAP          (false),
+eventsCreateNative       (false),
 eventsRequested          (false),
 eventsConvertToCAP       (false),
+eventsConvertToNative    (false),
 eventsImport             (false),
+eventsImportCAP          (false),
+eventsImportCAPView      (false),
+eventsImportNative       (false),
 eventsImportTree         (""),
 eventsImportPath         (""),
 eventsImportFile         (""), 
@@ -96,6 +116,8 @@ eventsExportFile         (""),
 eventsExportTree         (""),
 eventsExportNative       (false),
 eventsExportCAP          (false),
+eventsExportCAPCompression(1),
+eventsExportCAPChunkSize (100),
 eventsExportMaxPerFile   (false),
 eventsUseStream0         (false),
 eventsUseStream1         (false),
@@ -119,6 +141,10 @@ calibsExportPath         (""),
 calibsExportFile         (""),
 particleDb(nullptr),
 particleFactory(nullptr),
+eventCAPReader(nullptr),
+eventCAPMappedReader(nullptr),
+eventCAPWriter(nullptr),
+eventsImportShare(1),
 eventStreams(),
 nEventFilters(0),
 nParticleFilters(0),
@@ -128,11 +154,19 @@ nEventsAccepted(),
 nEventsAcceptedTotal(),
 nParticlesAcceptedEvent(),
 nParticlesAccepted(),
-nParticlesAcceptedTotal()
+nParticlesAcceptedTotal(),
+particleFilterMasks(),
+nParticleFilterMaskWords(0)
 {
   appendClassName("EventTask");
 }
 
+EventTask::~EventTask()
+{
+  delete eventCAPReader;
+  delete eventCAPMappedReader;
+  delete eventCAPWriter;
+}
 
 //!
 //! Initialize the configuration parameter of the EventTask to their default value;
@@ -144,6 +178,8 @@ void EventTask::setDefaultConfiguration()
   addParameter("EventsRequested",             eventsRequested);
   addParameter("EventsConvertToCAP",          eventsConvertToCAP);
   addParameter("EventsImport",                eventsImport);
+  addParameter("EventsImportCAP",             eventsImportCAP);
+  addParameter("EventsImportCAPView",         eventsImportCAPView);
   addParameter("EventsImportTree",            eventsImportTree);
   addParameter("EventsImportPath",            eventsImportPath);
   addParameter("EventsImportFile",            eventsImportFile);
@@ -155,6 +191,8 @@ void EventTask::setDefaultConfiguration()
   addParameter("EventsExportTree",            eventsExportTree);
   addParameter("EventsExportNative",          eventsExportNative);
   addParameter("EventsExportCAP",             eventsExportCAP);
+  addParameter("EventsExportCAPCompression",  eventsExportCAPCompression);
+  addParameter("EventsExportCAPChunkSize",    eventsExportCAPChunkSize);
   addParameter("EventsExportMaxPerFile",      eventsExportMaxPerFile);
   addParameter("EventsUseStream0",            eventsUseStream0);
   addParameter("EventsUseStream1",            eventsUseStream1);
@@ -189,6 +227,8 @@ void EventTask::configure()
   eventsRequested          = getValueBool(  "EventsRequested");
   eventsConvertToCAP       = getValueBool(  "EventsConvertToCAP");
   eventsImport             = getValueBool(  "EventsImport");
+  eventsImportCAP          = getValueBool(  "EventsImportCAP");
+  eventsImportCAPView      = getValueBool(  "EventsImportCAPView");
   eventsImportTree         = getValueString("EventsImportTree");
   eventsImportPath         = getValueString("EventsImportPath");
   eventsImportFile         = getValueString("EventsImportFile");
@@ -200,6 +240,8 @@ void EventTask::configure()
   eventsExportTree         = getValueString("EventsExportTree");
   eventsExportNative       = getValueBool(  "EventsExportNative");
   eventsExportCAP          = getValueBool(  "EventsExportCAP");
+  eventsExportCAPCompression = getValueInt( "EventsExportCAPCompression");
+  eventsExportCAPChunkSize = getValueInt(   "EventsExportCAPChunkSize");
   eventsExportMaxPerFile   = getValueLong(  "EventsExportMaxPerFile");
   eventsUseStream0         = getValueBool(  "EventsUseStream0");
   eventsUseStream1         = getValueBool(  "EventsUseStream1");
@@ -230,6 +272,8 @@ void EventTask::configure()
     printItem("EventsRequested",         eventsRequested);
     printItem("EventsConvertToCAP",      eventsConvertToCAP);
     printItem("EventsImport",            eventsImport);
+    printItem("EventsImportCAP",         eventsImportCAP);
+    printItem("EventsImportCAPView",     eventsImportCAPView);
     printItem("EventsImportTree",        eventsImportTree);
     printItem("EventsImportPath",        eventsImportPath);
     printItem("EventsImportFile",        eventsImportFile);
@@ -241,6 +285,8 @@ void EventTask::configure()
     printItem("EventsExportTree",        eventsExportTree);
     printItem("EventsExportNative",      eventsExportNative);
     printItem("EventsExportCAP",         eventsExportCAP);
+    printItem("EventsExportCAPCompression",eventsExportCAPCompression);
+    printItem("EventsExportCAPChunkSize",eventsExportCAPChunkSize);
     printItem("EventsExportMaxPerFile",  eventsExportMaxPerFile);
     printItem("EventsUseStream0",        eventsUseStream0);
     printItem("EventsUseStream1",        eventsUseStream1);
@@ -303,8 +349,56 @@ void EventTask::initializeFilters()
 //virtual void initializeEventNative();
 
 void EventTask::initializeEventGenerator() {}
-void EventTask::initializeEventReader() {}
-void EventTask::initializeEventWriter() {}
+
+//!
+//! Open the CAP event file to read if EventsImportCAP is true. The file is EventsImportFile in the folder EventsImportPath,
+//! with the extension ".cap" added if missing. If EventsImportCAPView is true, the file is memory mapped and the particles of the
+//! events are imported as columnar views rather than Particle objects (see EventCAPMappedReader).
+//!
+void EventTask::initializeEventReader()
+{
+  if (!eventsImportCAP) return;
+  String fileName = eventsImportPath;
+  if (fileName.Length()>0 && !fileName.EndsWith("/")) fileName += "/";
+  fileName += eventsImportFile;
+  if (!fileName.EndsWith(".cap")) fileName += ".cap";
+  if (reportInfo(__FUNCTION__)) cout << "Importing events from CAP file: " << fileName << endl;
+  if (eventsImportCAPView)
+    {
+    if (!eventCAPMappedReader) eventCAPMappedReader = new EventCAPMappedReader();
+    eventCAPMappedReader->open(fileName,*particleDb);
+    }
+  else
+    {
+    if (!eventCAPReader) eventCAPReader = new EventCAPReader();
+    eventCAPReader->open(fileName);
+    }
+  eventsImportShare = 1;
+}
+
+//!
+//! Create the CAP event file to write if EventsExportCAP is true. The file is EventsExportFile in the folder EventsExportPath,
+//! with the extension ".cap". Clones executed on worker threads (see TaskIterator) write their own file, tagged with their thread index.
+//!
+void EventTask::initializeEventWriter()
+{
+  if (!eventsExportCAP) return;
+  if (eventsExportFile.Length()<1) throw TaskException("EventsExportFile must be set to export events","EventTask::initializeEventWriter()");
+  if (eventsExportPath.Length()>2) gSystem->mkdir(eventsExportPath,1);
+  String fileName = eventsExportPath;
+  if (fileName.Length()>0 && !fileName.EndsWith("/")) fileName += "/";
+  fileName += eventsExportFile;
+  if (fileName.EndsWith(".cap")) fileName.Remove(fileName.Length()-4);
+  if (getThreadIndex()>0)
+    {
+    fileName += "_Thread";
+    fileName += getThreadIndex();
+    }
+  fileName += ".cap";
+  if (reportInfo(__FUNCTION__)) cout << "Exporting events to CAP file: " << fileName << endl;
+  if (!eventCAPWriter) eventCAPWriter = new EventCAPWriter();
+  eventCAPWriter->open(fileName,eventsExportCAPCompression,eventsExportCAPChunkSize);
+}
 
 void EventTask::initializeParticleFactory()
 {
@@ -402,12 +496,17 @@ void EventTask::finalizeEventGenerator()
 
 void EventTask::finalizeEventReader()
 {
-
+  if (eventCAPReader) eventCAPReader->close();
+  if (eventCAPMappedReader) eventCAPMappedReader->close();
 }
 
 void EventTask::finalizeEventWriter()
 {
-
+  if (eventCAPWriter && eventCAPWriter->isOpen())
+    {
+    eventCAPWriter->close();
+    if (reportInfo(__FUNCTION__)) cout << "Events exported: " << eventCAPWriter->getNEventsWritten() << endl;
+    }
 }
 
 
@@ -525,6 +624,65 @@ void EventTask::clear()
 }
 
 
+bool EventTask::isThreadShareable() const
+{
+  return (!eventsImport || (eventsImportCAP && !eventsImportNative)) && Task::isThreadShareable();
+}
+
+void EventTask::merge(const Task & task)
+{
+  if (reportStart(__FUNCTION__))
+    ;
+  const EventTask * eventTask = dynamic_cast<const EventTask*>(&task);
+  if (!eventTask)
+    throw TaskException("Given task is not an EventTask","EventTask::merge(const Task & task)");
+  if (eventTask->nEventFilters!=nEventFilters || eventTask->nParticleFilters!=nParticleFilters)
+    throw TaskException("Incompatible number of event or particle filters","EventTask::merge(const Task & task)");
+  Task::merge(task);
+  for (int iFilter=0; iFilter<nEventFilters; iFilter++)
+    {
+    nEventsAccepted[iFilter]      += eventTask->nEventsAccepted[iFilter];
+    nEventsAcceptedTotal[iFilter] += eventTask->nEventsAcceptedTotal[iFilter];
+    }
+  for (unsigned int k=0; k<nParticlesAccepted.size(); k++)
+    {
+    nParticlesAccepted[k]      += eventTask->nParticlesAccepted[k];
+    nParticlesAcceptedTotal[k] += eventTask->nParticlesAcceptedTotal[k];
+    }
+  if (reportEnd(__FUNCTION__))
+    ;
+}
+
+void EventTask::fillParticleFilterMasks(Event & event)
+{
+  unsigned int nFilters   = particleFilters.size();
+  const EventCAPView * view = event.getView();
+  unsigned int nParticles = view ? view->getNParticles() : event.getNParticles();
+  nParticleFilterMaskWords = (nFilters+63)/64;
+  particleFilterMasks.assign(nParticles*nParticleFilterMaskWords,0);
+  if (view)
+    {
+    for (unsigned int iParticle=0; iParticle<nParticles; iParticle++)
+      {
+      ULong64_t * mask = &particleFilterMasks[iParticle*nParticleFilterMaskWords];
+      for (unsigned int iParticleFilter=0; iParticleFilter<nFilters; iParticleFilter++)
+        {
+        if (particleFilters[iParticleFilter]->accept(*view,iParticle)) mask[iParticleFilter>>6] |= ULong64_t(1) << (iParticleFilter&63);
+        }
+      }
+    return;
+    }
+  for (unsigned int iParticle=0; iParticle<nParticles; iParticle++)
+    {
+    const Particle & particle = *event.getParticleAt(iParticle);
+    ULong64_t * mask = &particleFilterMasks[iParticle*nParticleFilterMaskWords];
+    for (unsigned int iParticleFilter=0; iParticleFilter<nFilters; iParticleFilter++)
+      {
+      if (particleFilters[iParticleFilter]->accept(particle)) mask[iParticleFilter>>6] |= ULong64_t(1) << (iParticleFilter&63);
+      }
+    }
+}
+
 void EventTask::initializeNParticlesAccepted()
 {
   int n = nEventFilters*nParticleFilters;
@@ -788,11 +946,63 @@ void EventTask::clearEventNative()
 
 }
 
-void EventTask::importEventCAP() {}
+//!
+//! Read the next event of the CAP event file into the first event stream of this task. All the particles of the event are imported,
+//! with their parent/child relations, unless EventsImportCAPView is true in which case the event carries a view of its particles.
+//! The end of data is posted when the end of the file is reached.
+//!
+//! When the events are analyzed on several threads (see TaskIterator), the events of the file are split, using its index, in contiguous
+//! ranges of (nearly) equal size: the instance executed on thread i of n reads the events of index i*N/n to (i+1)*N/n-1 and posts the end
+//! of data after the last of them.
+//!
+void EventTask::importEventCAP()
+{
+  if ((!eventCAPReader && !eventCAPMappedReader) || getNEventStreams()<1) throw TaskException("CAP event import is not initialized","EventTask::importEventCAP()");
+  if (eventsImportShare!=getThreadCount())
+    {
+    eventsImportShare = getThreadCount();
+    long nEvents = eventCAPMappedReader ? eventCAPMappedReader->getNEvents() : eventCAPReader->getNEvents();
+    if (nEvents<0) throw TaskException("The CAP event file has no index: its events cannot be shared between threads. Set nThreads to 1.","EventTask::importEventCAP()");
+    long first = nEvents*getThreadIndex()/eventsImportShare;
+    long last  = nEvents*(getThreadIndex()+1)/eventsImportShare;
+    if (eventCAPMappedReader)
+      eventCAPMappedReader->setEventRange(first,last);
+    else
+      eventCAPReader->setEventRange(first,last);
+    }
+  Event & event = *getEventStream(0);
+  event.reset();
+  bool read;
+  if (eventCAPMappedReader)
+    read = eventCAPMappedReader->read(event);
+  else
+    {
+    particleFactory->reset();
+    read = eventCAPReader->read(event,*particleFactory,*particleDb);
+    }
+  if (!read)
+    {
+    postTaskEod();
+    return;
+    }
+  if (nEventFilters>0) incrementNEventsAccepted(0);
+}
+
 void EventTask::importEventNative() {}
 void EventTask::convertEventCAPToNative() {}
 void EventTask::convertEventNativeToCAP() {}
-void EventTask::exportEventCAP() {}
+
+//!
+//! Append the event of the first event stream of this task to the CAP event file.
+//!
+void EventTask::exportEventCAP()
+{
+  if (!eventCAPWriter || getNEventStreams()<1) throw TaskException("CAP event export is not initialized","EventTask::exportEventCAP()");
+  Event & event = *getEventStream(0);
+  if (event.getView()) throw TaskException("Events imported as views cannot be exported","EventTask::exportEventCAP()");
+  eventCAPWriter->write(event);
+}
+
 void EventTask::exportEventNative() {}
 
 
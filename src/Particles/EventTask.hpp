@@ -18,6 +18,9 @@
 #include "ParticleType.hpp"
 #include "ParticleDb.hpp"
 #include "HistogramGroup.hpp"
+#include "EventCAPReader.hpp"
+#include "EventCAPMappedReader.hpp"
+#include "EventCAPWriter.hpp"
 
 namespace CAP
 {
@@ -38,6 +41,7 @@ protected:
   bool   eventsConvertToNative;
   bool   eventsImport;
   bool   eventsImportCAP;
+  bool   eventsImportCAPView;
   bool   eventsImportNative;
   String eventsImportTree;
   String eventsImportPath;
@@ -50,6 +54,8 @@ protected:
   String eventsExportTree;
   bool   eventsExportNative;
   bool   eventsExportCAP;
+  int    eventsExportCAPCompression;
+  int    eventsExportCAPChunkSize;
   long   eventsExportMaxPerFile;
   bool   eventsUseStream0;
   bool   eventsUseStream1;
@@ -83,6 +89,20 @@ protected:
   //! Pointer to a factory of entities of type Particle.
   //!
   Factory<Particle> *  particleFactory;
+
+  //!
+  //! Reader and writer of events in the CAP binary format, used if EventsImportCAP or EventsExportCAP are true. The memory mapped
+  //! reader is used instead of eventCAPReader if EventsImportCAPView is also true.
+  //!
+  EventCAPReader * eventCAPReader;
+  EventCAPMappedReader * eventCAPMappedReader;
+  EventCAPWriter * eventCAPWriter;
+
+  //!
+  //! Number of threads sharing the events of the CAP event file read by this task, as of the last event read (see importEventCAP()).
+  //!
+  int eventsImportShare;
+
   //!
   //! Array of pointers to streams (potentially) used by this EventTask.
   //!
@@ -139,6 +159,17 @@ protected:
   //!
   vector<long> nParticlesAcceptedTotal;
 
+  //!
+  //! Particle filter masks of the particles of the current event. Bit iParticleFilter%64 of word iParticle*nParticleFilterMaskWords+iParticleFilter/64
+  //! is set if particle iParticle is accepted by particle filter iParticleFilter. See fillParticleFilterMasks().
+  //!
+  vector<ULong64_t> particleFilterMasks;
+
+  //!
+  //! Number of 64 bits words used to store the mask of one particle.
+  //!
+  unsigned int nParticleFilterMaskWords;
+
 public:
 
   //!
@@ -156,7 +187,7 @@ public:
 
   //!
   //! dtor
-  virtual ~EventTask() {}
+  virtual ~EventTask();
   
   //!
   //! Initialize the configuration parameter of the EventTask to their default value;
@@ -234,6 +265,52 @@ public:
   //!
   virtual void clear();
 
+  //!
+  //! Add the histograms, event counters, and particle counters accumulated by the given task (typically a clone of this task
+  //! executed on a separate thread) to those held by this task.
+  //!
+  virtual void merge(const Task & task);
+
+  //!
+  //! Returns false if this task imports its events from an input other than a CAP event file: the clones would all read the same input.
+  //!
+  virtual bool isThreadShareable() const;
+
+  //!
+  //! Returns true if this task imports the events of a CAP event file as views (EventsImportCAPView): the events it produces carry
+  //! no Particle objects.
+  //!
+  bool isImportingEventViews() const
+  {
+  return eventsImport && eventsImportCAP && eventsImportCAPView;
+  }
+
+  //!
+  //! Evaluate the particle filters of this task once for each particle of the given event and store the results in the particle filter masks.
+  //! Analyzers call this method once per event and then use isAccepted() in their (pair, angular scan, etc) loops rather than calling
+  //! ParticleFilter::accept() repeatedly for the same particle. If the event carries a view (see Event::getView()), the particles
+  //! of the view are filtered.
+  //!
+  void fillParticleFilterMasks(Event & event);
+
+  //!
+  //! Returns true if the particle at the given index of the event last passed to fillParticleFilterMasks() is accepted by the given particle filter.
+  //!
+  inline bool isAccepted(unsigned int iParticle, unsigned int iParticleFilter) const
+  {
+  return (particleFilterMasks[iParticle*nParticleFilterMaskWords+(iParticleFilter>>6)] >> (iParticleFilter&63)) & 1;
+  }
+
+  //!
+  //! Returns true if the particle at the given index of the event last passed to fillParticleFilterMasks() is accepted by at least one particle filter.
+  //!
+  inline bool isAcceptedByAny(unsigned int iParticle) const
+  {
+  const ULong64_t * mask = &particleFilterMasks[iParticle*nParticleFilterMaskWords];
+  for (unsigned int iWord=0; iWord<nParticleFilterMaskWords; iWord++) if (mask[iWord]) return true;
+  return false;
+  }
+
   virtual void initializeNParticlesAccepted();
   virtual void incrementNParticlesAccepted(int iEventFilter=0, int iParticleFilter=0);
   virtual void resetNParticlesAcceptedEvent();
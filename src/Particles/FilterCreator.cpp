@@ -429,6 +429,7 @@ void FilterCreator::addParticleFilters(unsigned int type, vector<ParticleFilter*
   if (n<1)  throw TaskException("filters.size()<1","FilterCreator::addParticleFilters(vector<ParticleFilter*>  filters)");
   for (int k=0; k<n; k++)
     {
+    if (particleDb) filters[k]->compile(*particleDb);
     switch (type)
       {
         case 0: particleFiltersModel->push_back(filters[k]);
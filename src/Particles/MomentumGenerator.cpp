@@ -11,6 +11,7 @@
  * *********************************************************************/
 #include "MathConstants.hpp"
 #include "MomentumGenerator.hpp"
+#include "RandomStream.hpp"
 using CAP::MomentumGenerator;
 using namespace CAP::Math;
 
@@ -140,6 +141,7 @@ histograms()
 
 void  MomentumGenerator::generate(LorentzVector & momentum)
 {
+  TRandom * random = CAP::RandomStream::getRandomStream();
   double px, py, pz, pt, mt, p, e, ptSq;
   double phi, cosTh, y;
   switch (generatorType)
@@ -147,9 +149,9 @@ void  MomentumGenerator::generate(LorentzVector & momentum)
       case IsotropicGaussP:
       // generate isotropic distribution
       // p is Gaussian distributed
-      phi   = twoPi()*gRandom->Rndm( );
-      cosTh = -1.0 + 2.0*gRandom->Rndm( );
-      p     = fabs(gRandom->Gaus(0.0,parameters[0]));
+      phi   = twoPi()*random->Rndm( );
+      cosTh = -1.0 + 2.0*random->Rndm( );
+      p     = fabs(random->Gaus(0.0,parameters[0]));
       e     = sqrt(mass*mass + p*p);
       pt    = p*sqrt(1.0-cosTh*cosTh);
       px    = pt*cos(phi);
@@ -162,9 +164,9 @@ void  MomentumGenerator::generate(LorentzVector & momentum)
       // generate isotropic distribution
       // p is exponential distributed
       // exp( -t/tau )
-      phi   = twoPi()*gRandom->Rndm( );
-      cosTh = -1.0 + 2.0*gRandom->Rndm( );
-      p     = gRandom->Exp(parameters[0]);
+      phi   = twoPi()*random->Rndm( );
+      cosTh = -1.0 + 2.0*random->Rndm( );
+      p     = random->Exp(parameters[0]);
       e     = sqrt(mass*mass + p*p);
       pt    = p*sqrt(1.0-cosTh*cosTh);
       px    = pt*cos(phi);
@@ -176,9 +178,9 @@ void  MomentumGenerator::generate(LorentzVector & momentum)
       case IsotropicUniformP:
       // generate isotropic distribution
       // p is uniform distributed
-      phi   = twoPi()*gRandom->Rndm( );
-      cosTh = -1.0 + 2.0*gRandom->Rndm( );
-      p     = parameters[0] + gRandom->Rndm()*parameters[1];
+      phi   = twoPi()*random->Rndm( );
+      cosTh = -1.0 + 2.0*random->Rndm( );
+      p     = parameters[0] + random->Rndm()*parameters[1];
       e     = sqrt(mass*mass + p*p);
       pt    = p*sqrt(1.0-cosTh*cosTh);
       px    = pt*cos(phi);
@@ -190,9 +192,9 @@ void  MomentumGenerator::generate(LorentzVector & momentum)
       case IsotropicUniformDensity:
       // generate isotropic distribution
       // uniform density
-      phi   = twoPi()*gRandom->Rndm( );
-      cosTh = -1.0 + 2.0*gRandom->Rndm( );
-      p     = parameters[0] + gRandom->Rndm()*parameters[1];
+      phi   = twoPi()*random->Rndm( );
+      cosTh = -1.0 + 2.0*random->Rndm( );
+      p     = parameters[0] + random->Rndm()*parameters[1];
       e     = sqrt(mass*mass + p*p);
       pt    = p*sqrt(1.0-cosTh*cosTh);
       px    = pt*cos(phi);
@@ -204,9 +206,9 @@ void  MomentumGenerator::generate(LorentzVector & momentum)
       case IsotropicMaxwellP:
       // generate isotropic distribution
       // Maxwell Boltzmann
-      px = gRandom->Gaus(0.0,parameters[0] );
-      py = gRandom->Gaus(0.0,parameters[0] );
-      pz = gRandom->Gaus(0.0,parameters[0] );
+      px = random->Gaus(0.0,parameters[0] );
+      py = random->Gaus(0.0,parameters[0] );
+      pz = random->Gaus(0.0,parameters[0] );
       e  = sqrt(mass*mass + px*px + py*py + pz*pz);
       momentum.SetPxPyPzE (px,py,pz,e);
       break;
@@ -230,13 +232,13 @@ void  MomentumGenerator::generate(LorentzVector & momentum)
       // parameters[0] : minimum rapidity
       // parameters[1] : width of rapidity window
       // parameters[2] : width of Gauss pt
-      phi   = twoPi()*gRandom->Rndm( );
-      px    = gRandom->Gaus(0.0,parameters[2] );
-      py    = gRandom->Gaus(0.0,parameters[2] );
+      phi   = twoPi()*random->Rndm( );
+      px    = random->Gaus(0.0,parameters[2] );
+      py    = random->Gaus(0.0,parameters[2] );
       ptSq  = px*px + py*py;
       pt    = sqrt(ptSq);
       mt    = sqrt(mass*mass + ptSq);
-      y     = parameters[1]+parameters[2]*gRandom->Rndm( );
+      y     = parameters[1]+parameters[2]*random->Rndm( );
       e     = mt*cosh(y);
       pz    = mt*sinh(y);
       px    = pt*cos(phi);
@@ -249,10 +251,10 @@ void  MomentumGenerator::generate(LorentzVector & momentum)
       // parameters[0] : minimum rapidity
       // parameters[1] : width of rapidity window
       // parameters[2] : exponential slope
-      phi   = twoPi()*gRandom->Rndm( );
-      pt    = gRandom->Exp(parameters[2]);
+      phi   = twoPi()*random->Rndm( );
+      pt    = random->Exp(parameters[2]);
       mt    = sqrt(mass*mass + pt*pt);
-      y     = parameters[0]+parameters[1]*gRandom->Rndm( );
+      y     = parameters[0]+parameters[1]*random->Rndm( );
       e     = mt*cosh(y);
       pz    = mt*sinh(y);
       px    = pt*cos(phi);
@@ -265,12 +267,12 @@ void  MomentumGenerator::generate(LorentzVector & momentum)
       // parameters[0] : minimum rapidity
       // parameters[1] : width of rapidity window
       // parameters[2] : Gauss Width
-      pt    = histograms[0]->GetRandom();
-      phi   = twoPi()*gRandom->Rndm( );
+      pt    = histograms[0]->GetRandom(random);
+      phi   = twoPi()*random->Rndm( );
       px    = pt*cos(phi);
       py    = pt*sin(phi);
       mt    = sqrt(mass*mass+pt*pt);
-      y     = parameters[0]+parameters[1]*gRandom->Rndm( );
+      y     = parameters[0]+parameters[1]*random->Rndm( );
       e     = mt*cosh(y);
       pz    = mt*sinh(y);
       momentum.SetPxPyPzE (px,py,pz,e);
@@ -245,7 +245,7 @@ double Particle::distanceXY(Particle * otherParticle)  const
 }
 
 int Particle::factorySize = 5000;
-Factory<Particle> * Particle::factory = 0;
+thread_local Factory<Particle> * Particle::factory = 0;
 Factory<Particle> * Particle::getFactory()
 {
   if (!factory)
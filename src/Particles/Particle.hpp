@@ -470,6 +470,11 @@ public:
   //!
   void setParents(const vector<Particle*> &  parents);
 
+  //!
+  //!Append the given particle to the parents of this particle. Unlike setParent(s), the momentum and position of this particle are not modified.
+  //!
+  void addParentLink(Particle * parent) { parents.push_back(parent); }
+
   //!
   //!Return true if this particle has children.
   //!
@@ -525,6 +530,11 @@ public:
   //!
   void addChildren(const vector<Particle*> &  children);
 
+  //!
+  //!Append the given particle to the children of this particle. Unlike addChild(ren), the position of the child is not modified.
+  //!
+  void addChildLink(Particle * child) { children.push_back(child); }
+
   //!
   //!Return true if this particle is a nucleon-nucleon interaction.
   //!
@@ -579,7 +589,10 @@ public:
 
 public:
   static int factorySize;
-  static Factory<Particle> * factory;
+  //!
+  //! The particle factory is thread local: each thread running an event chain (see TaskIterator) owns its own factory.
+  //!
+  static thread_local Factory<Particle> * factory;
   static Factory<Particle> * getFactory();
   static void resetFactory();
 
@@ -31,10 +31,59 @@ ClassImp(ParticleDb);
 
 ParticleDb::ParticleDb()
 :
-Collection<ParticleType>()
+Collection<ParticleType>(),
+pdgCodeIndex(),
+privateCodeIndex(),
+nameIndex(),
+nIndexed(0),
+indexMutex(),
+frozen(false),
+unknownTypes()
 {
 }
 
+void ParticleDb::updateIndices()
+{
+  unsigned int n = objects.size();
+  if (nIndexed>n) nIndexed = 0;
+  if (nIndexed==0)
+    {
+    pdgCodeIndex.clear();
+    privateCodeIndex.clear();
+    nameIndex.clear();
+    pdgCodeIndex.reserve(2*n);
+    privateCodeIndex.reserve(2*n);
+    nameIndex.reserve(2*n);
+    }
+  // emplace does not replace existing entries: the first type with a given key is retained, as in a linear search.
+  for (unsigned int iPart=nIndexed; iPart<n; iPart++)
+    {
+    ParticleType * type = objects[iPart];
+    pdgCodeIndex.emplace(type->getPdgCode(),iPart);
+    privateCodeIndex.emplace(type->getPrivateCode(),iPart);
+    nameIndex.emplace(std::string(type->getName().Data()),iPart);
+    }
+  nIndexed = n;
+}
+
+void ParticleDb::clearIndices()
+{
+  if (isFrozen()) throw Exception("Indices of a frozen collection cannot be cleared","ParticleDb::clearIndices()");
+  std::unique_lock<std::shared_mutex> lock(indexMutex);
+  nIndexed = 0;
+  pdgCodeIndex.clear();
+  privateCodeIndex.clear();
+  nameIndex.clear();
+}
+
+void ParticleDb::freeze()
+{
+  std::unique_lock<std::shared_mutex> lock(indexMutex);
+  if (isFrozen()) return;
+  updateIndices();
+  frozen.store(true,std::memory_order_release);
+}
+
 // ================================================================================================
 // read in ParticleType information from pdg data file
 // ================================================================================================
@@ -169,6 +218,7 @@ Collection<ParticleType>()
 
 void ParticleDb::sortByMass()
 {
+  if (isFrozen()) throw Exception("A frozen collection cannot be sorted","ParticleDb::sortByMass()");
   cout << "<D> ParticleDb::sortHadronListByHadronMass() Collection size:"
   << size() << endl;
   //double m1, m2;
@@ -188,6 +238,7 @@ void ParticleDb::sortByMass()
     j--;
     }
   }
+  clearIndices();
 }
 
 void ParticleDb::resolveTypes()
@@ -260,7 +311,12 @@ ParticleDb *  ParticleDb::extractCollection(int option)
 
 int ParticleDb::findIndexForType(ParticleType * type)
 {
-  for (unsigned int iPart = 0; iPart < size(); iPart++)
+  std::shared_lock<std::shared_mutex> lock(indexMutex,std::defer_lock);
+  if (!isFrozen()) lock.lock();
+  // the index of a type is usually its position in the collection
+  int index = type ? type->getIndex() : -1;
+  if (index>=0 && index<int(objects.size()) && objects[index]==type) return index;
+  for (unsigned int iPart = 0; iPart < objects.size(); iPart++)
     {
     if (type == objects[iPart]) return iPart;
     }
@@ -269,55 +325,56 @@ int ParticleDb::findIndexForType(ParticleType * type)
 
 int ParticleDb::findIndexForName(const CAP::String & name)
 {
-  for (unsigned int iPart = 0; iPart < size(); iPart++)
-    {
-    if (objects[iPart]->getName().EqualTo(name)) return iPart;
-    }
-  return -1;
+  return findInIndex(nameIndex,std::string(name.Data()));
 }
 
 
 int ParticleDb::findIndexForPdgCode(int pdgCode)
 {
-  for (unsigned int iPart = 0; iPart < size(); iPart++)
-  {
-  if (pdgCode == objects[iPart]->getPdgCode()) return iPart;
-  }
-  return -1;
+  return findInIndex(pdgCodeIndex,pdgCode);
 }
 
 int ParticleDb::findIndexForPrivateCode(int privateCode)
 {
-  for (unsigned int iPart = 0; iPart < size(); iPart++)
-  {
-  if (privateCode == objects[iPart]->getPdgCode()) return iPart;
-  }
-  return -1;
+  return findInIndex(privateCodeIndex,privateCode);
 }
 
 bool ParticleDb::containsTypeNamed(CAP::String name)
 {
-  for (unsigned int iPart = 0; iPart < size(); iPart++)
-    {
-    if (objects[iPart]->getName().EqualTo(name)) return true;
-    }
-  return false;
+  return findIndexForName(name)>=0;
 }
 
 ParticleType * ParticleDb::findPdgCode(int pdgCode)
 {
-  for (unsigned int iPart = 0; iPart<size(); iPart++)
-  {
-  if (pdgCode == objects[iPart]->getPdgCode())
-    return objects[iPart];
-  }
+  ParticleType * type;
+  if (findInIndex(pdgCodeIndex,pdgCode,&type)>=0) return type;
+
   // code not found in the current table.
   // create new type and add to the table.
+  std::unique_lock<std::shared_mutex> lock(indexMutex);
+  if (isFrozen())
+    {
+    auto it = unknownTypes.find(pdgCode);
+    if (it!=unknownTypes.end()) return it->second;
+    }
+  else
+    {
+    updateIndices();
+    if (lookUp(pdgCodeIndex,pdgCode,&type)>=0) return type; // added by another thread meanwhile
+    }
   ParticleType * newType = new ParticleType();
   newType->setName("unknown");
   newType->setTitle("unknown");
   newType->setPdgCode(pdgCode);
-  push_back(newType);
+  if (isFrozen())
+    {
+    unknownTypes.emplace(pdgCode,newType);
+    }
+  else
+    {
+    push_back(newType);
+    updateIndices();
+    }
   cout << endl
   <<" ------------------------------------------------ Added new type with pdgCode=" << pdgCode << endl;
   return newType;
@@ -325,31 +382,30 @@ ParticleType * ParticleDb::findPdgCode(int pdgCode)
 
 ParticleType * ParticleDb::findPrivateCode(int privateCode)
 {
-  unsigned int n = size();
-  for (unsigned int iPart = 0; iPart<n; iPart++)
-  {
-  if (privateCode == objects[iPart]->getPdgCode()) objects[iPart];
-  }
-  return nullptr;
+  ParticleType * type;
+  findInIndex(privateCodeIndex,privateCode,&type);
+  return type;
 }
 
 void ParticleDb::addParticleType(ParticleType * particleType)
 {
+  std::unique_lock<std::shared_mutex> lock(indexMutex);
+  if (isFrozen()) throw Exception("Types cannot be added to a frozen collection","ParticleDb::addParticleType()");
   append(particleType);
 }
 
 ParticleType * ParticleDb::getParticleType(String name)
 {
-  int index = findIndexForName(name);
-  if (index>=0)
-    return objects[index];
-  else
-    return nullptr;
+  ParticleType * type;
+  findInIndex(nameIndex,std::string(name.Data()),&type);
+  return type;
 }
 
 
 ParticleType * ParticleDb::getParticleType(unsigned int index)
 {
+  std::shared_lock<std::shared_mutex> lock(indexMutex,std::defer_lock);
+  if (!isFrozen()) lock.lock();
   if (index<objects.size())
     return objects[index];
   else
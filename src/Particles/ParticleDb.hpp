@@ -19,6 +19,10 @@
 #include <fstream>
 #include <vector>
 #include <iomanip>
+#include <unordered_map>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
 #include "Collection.hpp"
 #include "ParticleType.hpp"
 
@@ -30,8 +34,79 @@ namespace CAP
 
 class ParticleType;
 
+//!
+//! Collection of particle types. Look ups by PDG code, private code, and name are carried out with hash indices built on first use
+//! and extended as types are added to the collection (including the "unknown" types added by findPdgCode()). The indices are rebuilt
+//! if the collection is sorted. Look ups may be performed concurrently by several threads.
+//!
+//! Once the collection is complete, freeze() indexes it and fixes its content: the look ups of a frozen collection read the
+//! collection and its indices without taking any lock. Types can no longer be added to, or reordered in, a frozen collection.
+//! The "unknown" types findPdgCode() creates for codes it does not find are then kept aside, under the lock, and have no position
+//! in the collection. ParticleDbManager and ParticleDbParser freeze the collections they load.
+//!
 class ParticleDb : public Collection<ParticleType>
 {
+protected:
+
+  //!
+  //! Index of the first type with a given PDG code, private code, or name.
+  //!
+  std::unordered_map<int,int>         pdgCodeIndex;         //!
+  std::unordered_map<int,int>         privateCodeIndex;     //!
+  std::unordered_map<std::string,int> nameIndex;            //!
+
+  //!
+  //! Number of types of the collection currently indexed.
+  //!
+  unsigned int nIndexed;
+
+  //!
+  //! Guards the indices and the collection until it is frozen: types are appended (by addParticleType() and findPdgCode()) under an
+  //! exclusive lock, and looked up by index or position under a shared lock. Once frozen, it only guards unknownTypes.
+  //!
+  mutable std::shared_mutex indexMutex;  //!
+
+  //!
+  //! True once freeze() was called: the collection and its indices no longer change.
+  //!
+  std::atomic<bool> frozen;  //!
+
+  //!
+  //! Types created by findPdgCode() for unknown PDG codes after the collection was frozen.
+  //!
+  std::unordered_map<int,ParticleType*> unknownTypes;  //!
+
+  //!
+  //! Index the types added to the collection since the last call. The caller must hold an exclusive lock on indexMutex.
+  //!
+  void updateIndices();
+
+  //!
+  //! Returns the position of the type with given key in the given index (or -1), and optionally the type itself (or nullptr).
+  //! The indices are updated if needed.
+  //!
+  template <typename K>
+  int findInIndex(const std::unordered_map<K,int> & index, const K & key, ParticleType ** type=nullptr)
+  {
+  if (frozen.load(std::memory_order_acquire)) return lookUp(index,key,type);
+    {
+    std::shared_lock<std::shared_mutex> lock(indexMutex);
+    if (nIndexed==objects.size()) return lookUp(index,key,type);
+    }
+  std::unique_lock<std::shared_mutex> lock(indexMutex);
+  updateIndices();
+  return lookUp(index,key,type);
+  }
+
+  template <typename K>
+  inline int lookUp(const std::unordered_map<K,int> & index, const K & key, ParticleType ** type)
+  {
+  auto it = index.find(key);
+  int position = (it==index.end()) ? -1 : it->second;
+  if (type) *type = (position>=0) ? objects[position] : nullptr;
+  return position;
+  }
+
 public:
 
   // const String& _name, bool _ownership, Severity logLevel
@@ -40,6 +115,24 @@ public:
 //  void readFromFile(const String & inputFileName);
 //  void writeToFile(const String &  outputFileName, bool printDecayProperties=true);
   void sortByMass();
+
+  //!
+  //! Discard the PDG code, private code, and name indices. They are rebuilt on the next look up. Call this method after modifying the
+  //! codes or names of types already in the collection.
+  //!
+  void clearIndices();
+
+  //!
+  //! Index the collection and fix its content: look ups no longer take any lock. Call this method once all the types are added,
+  //! before the collection is shared by several threads.
+  //!
+  void freeze();
+
+  bool isFrozen() const
+  {
+  return frozen.load(std::memory_order_acquire);
+  }
+
   ParticleDb * extractCollection(int option);
   int findIndexForType(ParticleType * type);
   int findIndexForName(const String & name);
@@ -53,6 +146,10 @@ public:
   void resolveTypes();
   void mapAntiParticleIndices();
   void setupDecayGenerator();
+
+  //!
+  //! Returns the type with the given PDG code. If no such type exists, an "unknown" type is created with this code and added to the collection.
+  //!
   ParticleType * findPdgCode(int pdgCode);
   ParticleType * findPrivateCode(int privateCode);
 
@@ -61,10 +158,7 @@ public:
   ParticleType * getParticleType(unsigned int index);
   ParticleType * operator[](unsigned int index)
   {
-  if (index<objects.size())
-    return objects[index];
-  else
-    return nullptr;
+  return getParticleType(index);
   }
 
   vector<int> getListOfPdgCodes();
@@ -456,6 +456,7 @@ void ParticleDbManager::importParticleDb()
   inputFileDecays.close();
   particleDb->mapAntiParticleIndices();
   particleDb->setupDecayGenerator();
+  particleDb->freeze();
   //dbAnalyzer();
 }
 
@@ -140,6 +140,7 @@ int  ParticleDbParser::readChunShen(ParticleDb    & _particleDb,
     cout << "Total number of particles read: " <<  particleDb->getNumberOfTypes() << endl;
   particleDb->resolveTypes();
   particleDb->sortByMass();
+  particleDb->freeze();
 }
 
 }
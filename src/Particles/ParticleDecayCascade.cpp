@@ -0,0 +1,317 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#include <cmath>
+#include <algorithm>
+#include "MathConstants.hpp"
+#include "ParticleDecayCascade.hpp"
+
+using CAP::ParticleDecayCascade;
+using CAP::Particle;
+
+ClassImp(ParticleDecayCascade);
+
+ParticleDecayCascade::ParticleDecayCascade()
+:
+random(nullptr),
+disable2Prong(false),
+disable3Prong(false),
+batch2(),
+batch3(),
+generation(),
+nextGeneration(),
+decayed(),
+produced(),
+undecayed(),
+undecayedNChildren()
+{
+  batch2.nChildren = 2;
+  batch3.nChildren = 3;
+}
+
+void ParticleDecayCascade::Batch::clear()
+{
+  parents.clear();
+  modes.clear();
+  px.clear(); py.clear(); pz.clear(); e.clear();
+  x.clear();  y.clear();  z.clear();  t.clear();
+  lifeTime.clear();
+}
+
+void ParticleDecayCascade::Batch::add(Particle * parent, ParticleDecayMode * mode)
+{
+  LorentzVector & momentum = parent->getMomentum();
+  LorentzVector & position = parent->getPosition();
+  parents.push_back(parent);
+  modes.push_back(mode);
+  px.push_back(momentum.Px());
+  py.push_back(momentum.Py());
+  pz.push_back(momentum.Pz());
+  e.push_back(momentum.E());
+  x.push_back(position.X());
+  y.push_back(position.Y());
+  z.push_back(position.Z());
+  t.push_back(position.T());
+  lifeTime.push_back(parent->getType().getLifeTime());
+}
+
+//!
+//! Size the output arrays, gather the children masses, and reserve nRandom random numbers per parent.
+//!
+void ParticleDecayCascade::Batch::prepare(unsigned int nRandom)
+{
+  unsigned int n = size();
+  childMass.resize(nChildren*n);
+  childPx.resize(nChildren*n);
+  childPy.resize(nChildren*n);
+  childPz.resize(nChildren*n);
+  childE.resize(nChildren*n);
+  decayX.resize(n);
+  decayY.resize(n);
+  decayZ.resize(n);
+  decayT.resize(n);
+  random.resize(nRandom*n);
+  for (unsigned int iChild=0; iChild<nChildren; iChild++)
+    for (unsigned int iParent=0; iParent<n; iParent++)
+      childMass[iChild*n+iParent] = modes[iParent]->getChildType(iChild).getMass();
+}
+
+void ParticleDecayCascade::decay(const vector<Particle*> & particles, Factory<Particle> & factory)
+{
+  TRandom & generator = *getRandomGenerator();
+  decayed.clear();
+  produced.clear();
+  undecayed.clear();
+  undecayedNChildren.clear();
+  generation.assign(particles.begin(),particles.end());
+  while (generation.size()>0)
+    {
+    batch2.clear();
+    batch3.clear();
+    for (Particle * particle : generation)
+      {
+      if (particle->isStable()) continue;
+      ParticleDecayMode & mode = particle->getType().generateDecayMode();
+      int nChildren = mode.getNChildren();
+      if (nChildren==2 && !disable2Prong)
+        batch2.add(particle,&mode);
+      else if (nChildren==3 && !disable3Prong)
+        batch3.add(particle,&mode);
+      else
+        {
+        undecayed.push_back(particle);
+        undecayedNChildren.push_back(nChildren);
+        }
+      }
+    nextGeneration.clear();
+    if (batch2.size()>0)
+      {
+      decay2(batch2,generator);
+      addChildren(batch2,factory,nextGeneration);
+      }
+    if (batch3.size()>0)
+      {
+      decay3(batch3,generator);
+      addChildren(batch3,factory,nextGeneration);
+      }
+    generation.swap(nextGeneration);
+    }
+}
+
+//!
+//! Isotropic two-body decays in the parent rest frame, boosted to the lab frame. Same kinematics as ParticleDecayer::decay2.
+//!
+void ParticleDecayCascade::decay2(Batch & b, TRandom & generator)
+{
+  unsigned int n = b.size();
+  b.prepare(3);
+  generator.RndmArray(3*n, b.random.data());
+  const double * uTime  = b.random.data();
+  const double * uPhi   = uTime + n;
+  const double * uTheta = uPhi  + n;
+  const double * m1 = b.childMass.data();
+  const double * m2 = m1 + n;
+  double * p1x = b.childPx.data(); double * p2x = p1x + n;
+  double * p1y = b.childPy.data(); double * p2y = p1y + n;
+  double * p1z = b.childPz.data(); double * p2z = p1z + n;
+  double * e1  = b.childE.data();  double * e2  = e1  + n;
+  for (unsigned int i=0; i<n; i++)
+    {
+    double massSq   = b.e[i]*b.e[i] - b.px[i]*b.px[i] - b.py[i]*b.py[i] - b.pz[i]*b.pz[i];
+    double mp       = std::sqrt(std::max(massSq,0.0));
+    double minMass  = m1[i] + m2[i];
+    if (mp < minMass) mp = 1.02*minMass;
+    double vx       = b.px[i]/b.e[i];
+    double vy       = b.py[i]/b.e[i];
+    double vz       = b.pz[i]/b.e[i];
+    double v2       = vx*vx + vy*vy + vz*vz;
+    double gamma    = 1.0/std::sqrt(1.0 - v2);
+    double gamma2   = v2>0.0 ? (gamma-1.0)/v2 : 0.0;
+    double timeToDecay = -3.0E23 * gamma * b.lifeTime[i] * std::log(uTime[i]); // fm
+    b.decayX[i] = b.x[i] + vx*timeToDecay;
+    b.decayY[i] = b.y[i] + vy*timeToDecay;
+    b.decayZ[i] = b.z[i] + vz*timeToDecay;
+    b.decayT[i] = b.t[i] + timeToDecay;
+
+    double temp     = mp*mp - m1[i]*m1[i] - m2[i]*m2[i];
+    double p_lrf    = std::sqrt(temp*temp - 4*m1[i]*m1[i]*m2[i]*m2[i])/(2*mp);
+    double phi      = Math::twoPi()*uPhi[i];
+    double cosTheta = 2.0*uTheta[i] - 1.0;
+    double sinTheta = std::sqrt(1.0 - cosTheta*cosTheta);
+    double qx       = p_lrf*sinTheta*std::cos(phi);
+    double qy       = p_lrf*sinTheta*std::sin(phi);
+    double qz       = p_lrf*cosTheta;
+    double e1_lrf   = std::sqrt(p_lrf*p_lrf + m1[i]*m1[i]);
+    double e2_lrf   = std::sqrt(p_lrf*p_lrf + m2[i]*m2[i]);
+    double vq       = vx*qx + vy*qy + vz*qz;
+    // child 2 is emitted opposite to child 1: its projection on the velocity is -vq
+    p1x[i] = qx + (gamma2*vq  + gamma*e1_lrf)*vx;
+    p1y[i] = qy + (gamma2*vq  + gamma*e1_lrf)*vy;
+    p1z[i] = qz + (gamma2*vq  + gamma*e1_lrf)*vz;
+    e1[i]  = gamma*(e1_lrf + vq);
+    p2x[i] = -qx + (-gamma2*vq + gamma*e2_lrf)*vx;
+    p2y[i] = -qy + (-gamma2*vq + gamma*e2_lrf)*vy;
+    p2z[i] = -qz + (-gamma2*vq + gamma*e2_lrf)*vz;
+    e2[i]  = gamma*(e2_lrf - vq);
+    }
+}
+
+//!
+//! Three-body decays: the energies of children 1 and 2 and their relative angle are sampled by rejection (one parent at a time),
+//! the orientation of the decay plane, the decay time, and the boost are then computed for the whole batch. Same kinematics as
+//! ParticleDecayer::decay3.
+//!
+void ParticleDecayCascade::decay3(Batch & b, TRandom & generator)
+{
+  unsigned int n = b.size();
+  b.prepare(7);
+  generator.RndmArray(4*n, b.random.data());
+  const double * uTime  = b.random.data();
+  const double * uPhi   = uTime  + n;
+  const double * uKsi   = uPhi   + n;
+  const double * uTheta = uKsi   + n;
+  // the rest of the random array holds the rest-frame momenta of children 1 and 2 and the cosine of their relative angle
+  double * p1_lrf  = b.random.data() + 4*n;
+  double * p2_lrf  = p1_lrf + n;
+  double * cos12   = p2_lrf + n;
+  const double * m1 = b.childMass.data();
+  const double * m2 = m1 + n;
+  const double * m3 = m2 + n;
+  double * p1x = b.childPx.data(); double * p2x = p1x + n; double * p3x = p2x + n;
+  double * p1y = b.childPy.data(); double * p2y = p1y + n; double * p3y = p2y + n;
+  double * p1z = b.childPz.data(); double * p2z = p1z + n; double * p3z = p2z + n;
+  double * e1  = b.childE.data();  double * e2  = e1  + n; double * e3  = e2  + n;
+
+  for (unsigned int i=0; i<n; i++)
+    {
+    double massSq  = b.e[i]*b.e[i] - b.px[i]*b.px[i] - b.py[i]*b.py[i] - b.pz[i]*b.pz[i];
+    double mp      = std::sqrt(std::max(massSq,0.0));
+    double minMass = m1[i] + m2[i] + m3[i];
+    if (mp < minMass) mp = 1.02*minMass;
+    double deltaM  = mp - minMass;
+    double e1_lrf, e2_lrf, e3_lrf;
+    do {
+      do {
+        e1_lrf = generator.Rndm()*deltaM + m1[i];
+        e2_lrf = generator.Rndm()*deltaM + m2[i];
+      } while (e1_lrf + e2_lrf > mp);
+      p1_lrf[i] = std::sqrt(e1_lrf*e1_lrf - m1[i]*m1[i]);
+      p2_lrf[i] = std::sqrt(e2_lrf*e2_lrf - m2[i]*m2[i]);
+      e3_lrf    = mp - e1_lrf - e2_lrf;
+      cos12[i]  = (e3_lrf*e3_lrf - p1_lrf[i]*p1_lrf[i] - p2_lrf[i]*p2_lrf[i] - m3[i]*m3[i])/(2.*p1_lrf[i]*p2_lrf[i]);
+    } while (cos12[i] < - 1.0 || cos12[i] > 1.0);
+    }
+
+  for (unsigned int i=0; i<n; i++)
+    {
+    double vx       = b.px[i]/b.e[i];
+    double vy       = b.py[i]/b.e[i];
+    double vz       = b.pz[i]/b.e[i];
+    double v2       = vx*vx + vy*vy + vz*vz;
+    double gamma    = 1.0/std::sqrt(1.0 - v2);
+    double gamma2   = v2>0.0 ? (gamma-1.0)/v2 : 0.0;
+    double timeToDecay = -3.0E23 * gamma * b.lifeTime[i] * std::log(uTime[i]); // fm
+    b.decayX[i] = b.x[i] + vx*timeToDecay;
+    b.decayY[i] = b.y[i] + vy*timeToDecay;
+    b.decayZ[i] = b.z[i] + vz*timeToDecay;
+    b.decayT[i] = b.t[i] + timeToDecay;
+
+    double tp2x      = p2_lrf[i]*std::sqrt(1. - cos12[i]*cos12[i]);
+    double tp2z      = p2_lrf[i]*cos12[i];
+    double tp3x      = - tp2x;
+    double tp3z      = - (p1_lrf[i] + tp2z);
+    double phi       = Math::twoPi()*uPhi[i];
+    double ksi       = Math::twoPi()*uKsi[i];
+    double cos_theta = 2.0*uTheta[i] - 1.0;
+    double sin_phi   = std::sin(phi);
+    double cos_phi   = std::cos(phi);
+    double sin_ksi   = std::sin(ksi);
+    double cos_ksi   = std::cos(ksi);
+    double sin_theta = std::sqrt(1. - cos_theta*cos_theta);
+    double rxx = cos_phi*cos_theta*cos_ksi - sin_phi*sin_ksi;
+    double ryx = -cos_phi*cos_theta*sin_ksi - sin_phi*cos_ksi;
+    double rzx = cos_phi*sin_theta;
+
+    double q1x = - p1_lrf[i]*sin_theta*cos_ksi;
+    double q1y = p1_lrf[i]*sin_theta*sin_ksi;
+    double q1z = p1_lrf[i]*cos_theta;
+    double q2x = tp2x*rxx - tp2z*sin_theta*cos_ksi;
+    double q2y = tp2x*ryx + tp2z*sin_theta*sin_ksi;
+    double q2z = tp2x*rzx + tp2z*cos_theta;
+    double q3x = tp3x*rxx - tp3z*sin_theta*cos_ksi;
+    double q3y = tp3x*ryx + tp3z*sin_theta*sin_ksi;
+    double q3z = tp3x*rzx + tp3z*cos_theta;
+    double f1  = std::sqrt(m1[i]*m1[i] + q1x*q1x + q1y*q1y + q1z*q1z);
+    double f2  = std::sqrt(m2[i]*m2[i] + q2x*q2x + q2y*q2y + q2z*q2z);
+    double f3  = std::sqrt(m3[i]*m3[i] + q3x*q3x + q3y*q3y + q3z*q3z);
+    double vq1 = vx*q1x + vy*q1y + vz*q1z;
+    double vq2 = vx*q2x + vy*q2y + vz*q2z;
+    double vq3 = vx*q3x + vy*q3y + vz*q3z;
+
+    p1x[i] = q1x + (gamma2*vq1 + gamma*f1)*vx;
+    p1y[i] = q1y + (gamma2*vq1 + gamma*f1)*vy;
+    p1z[i] = q1z + (gamma2*vq1 + gamma*f1)*vz;
+    e1[i]  = gamma*(f1 + vq1);
+    p2x[i] = q2x + (gamma2*vq2 + gamma*f2)*vx;
+    p2y[i] = q2y + (gamma2*vq2 + gamma*f2)*vy;
+    p2z[i] = q2z + (gamma2*vq2 + gamma*f2)*vz;
+    e2[i]  = gamma*(f2 + vq2);
+    p3x[i] = q3x + (gamma2*vq3 + gamma*f3)*vx;
+    p3y[i] = q3y + (gamma2*vq3 + gamma*f3)*vy;
+    p3z[i] = q3z + (gamma2*vq3 + gamma*f3)*vz;
+    e3[i]  = gamma*(f3 + vq3);
+    }
+}
+
+//!
+//! Create the children of a decayed batch, flag the parents as decayed, and queue the children for the next generation.
+//!
+void ParticleDecayCascade::addChildren(Batch & b, Factory<Particle> & factory, vector<Particle*> & next)
+{
+  unsigned int n = b.size();
+  for (unsigned int iParent=0; iParent<n; iParent++)
+    {
+    Particle * parent = b.parents[iParent];
+    for (unsigned int iChild=0; iChild<b.nChildren; iChild++)
+      {
+      unsigned int k = iChild*n + iParent;
+      Particle * child = factory.getNextObject();
+      child->setType(&b.modes[iParent]->getChildType(iChild));
+      child->setLive(true);
+      child->getMomentum().SetPxPyPzE(b.childPx[k],b.childPy[k],b.childPz[k],b.childE[k]);
+      child->getPosition().SetXYZT(b.decayX[iParent],b.decayY[iParent],b.decayZ[iParent],b.decayT[iParent]);
+      produced.push_back(child);
+      next.push_back(child);
+      }
+    parent->setDecayed(true);
+    decayed.push_back(parent);
+    }
+}
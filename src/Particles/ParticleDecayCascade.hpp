@@ -0,0 +1,128 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#ifndef CAP__ParticleDecayCascade
+#define CAP__ParticleDecayCascade
+#include <vector>
+#include "TRandom.h"
+#include "RandomStream.hpp"
+#include "Factory.hpp"
+#include "Particle.hpp"
+#include "ParticleDecayMode.hpp"
+
+using namespace std;
+
+namespace CAP
+{
+
+//!\brief Breadth-first decay of all the unstable particles of an event
+//!
+//!\details
+//!# ParticleDecayCascade
+//!
+//!The unstable particles given to decay() form the first generation of the cascade. A decay mode is generated for each of them and
+//!the particles are grouped by number of children. Each group is decayed in a single pass over structure-of-arrays buffers (parent
+//!momenta, positions, life times, and children masses) with the random numbers of the whole group drawn at once. The unstable
+//!children form the next generation, and so on until only stable particles remain. The kinematics are those of ParticleDecayer
+//!(isotropic two-body decays, three-body decays sampled by rejection, exponential decay time in the parent frame) and so are the
+//!output distributions; only the order in which random numbers are consumed differs.
+//!
+//!Children are obtained from the given factory. Decayed parents are flagged (Particle::setDecayed). Parents whose generated mode
+//!has fewer than two or more than three children, or whose two- or three-body decays are disabled, are left untouched and listed
+//!with the number of children of their generated mode (see getUndecayed and getUndecayedNChildren).
+//!
+class ParticleDecayCascade
+{
+public:
+
+  ParticleDecayCascade();
+  virtual ~ParticleDecayCascade() {}
+
+  //!
+  //! Set the random generator used by this cascade. By default (null generator), the stream of the calling thread is used (see RandomStream).
+  //!
+  void setRandomGenerator(TRandom * _random) { random = _random; }
+  TRandom * getRandomGenerator() { return random ? random : RandomStream::getRandomStream(); }
+
+  //!
+  //! Disable two- or three-body decays: parents that generate such modes are listed as undecayed.
+  //!
+  void setDisable2Prong(bool disable) { disable2Prong = disable; }
+  void setDisable3Prong(bool disable) { disable3Prong = disable; }
+
+  //!
+  //! Decay the given particles and, generation by generation, their unstable children. Stable particles in the list are ignored.
+  //!
+  void decay(const vector<Particle*> & particles, Factory<Particle> & factory);
+
+  //!
+  //! Parents decayed by the last call to decay(), generation by generation.
+  //!
+  const vector<Particle*> & getDecayed() const   { return decayed;  }
+
+  //!
+  //! Children produced by the last call to decay(), generation by generation, in the order they were created.
+  //!
+  const vector<Particle*> & getProduced() const  { return produced; }
+
+  //!
+  //! Unstable particles left undecayed by the last call to decay() and the number of children of the mode generated for each of them.
+  //!
+  const vector<Particle*> & getUndecayed() const          { return undecayed;          }
+  const vector<int>       & getUndecayedNChildren() const { return undecayedNChildren; }
+
+protected:
+
+  //!
+  //! Parents of a generation with the same number of children, stored as structure of arrays. The children arrays are indexed
+  //! [iChild*size()+iParent].
+  //!
+  struct Batch
+  {
+    unsigned int               nChildren;
+    vector<Particle*>          parents;
+    vector<ParticleDecayMode*> modes;
+    vector<double> px, py, pz, e;
+    vector<double> x, y, z, t;
+    vector<double> lifeTime;
+    vector<double> childMass;
+    vector<double> childPx, childPy, childPz, childE;
+    vector<double> decayX, decayY, decayZ, decayT;
+    vector<double> random;
+
+    unsigned int size() const { return parents.size(); }
+    void clear();
+    void add(Particle * parent, ParticleDecayMode * mode);
+    void prepare(unsigned int nRandom);
+  };
+
+  void decay2(Batch & batch, TRandom & generator);
+  void decay3(Batch & batch, TRandom & generator);
+  void addChildren(Batch & batch, Factory<Particle> & factory, vector<Particle*> & nextGeneration);
+
+  TRandom * random;
+  bool      disable2Prong;
+  bool      disable3Prong;
+  Batch     batch2;
+  Batch     batch3;
+  vector<Particle*> generation;
+  vector<Particle*> nextGeneration;
+  vector<Particle*> decayed;
+  vector<Particle*> produced;
+  vector<Particle*> undecayed;
+  vector<int>       undecayedNChildren;
+
+  ClassDef(ParticleDecayCascade,0)
+};
+
+}
+
+#endif  // CAP__ParticleDecayCascade
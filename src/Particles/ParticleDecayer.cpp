@@ -26,7 +26,7 @@ double ParticleDecayer::twoPi = 2.0*3.1415927;
 
 ParticleDecayer::ParticleDecayer()
 :
-random(gRandom)
+random(nullptr)
 {
 }
 
@@ -40,6 +40,7 @@ void  ParticleDecayer::decay2(ParticleType   & parentType,
                               LorentzVector  & p2,
                               LorentzVector  & r2)
 {
+  TRandom * generator = getRandomGenerator();
   double e, vx, vy, vz, mp;
   double m1, m2, minMass,tau, taup, gamma, timeToDecay;
   mp       = parentMomentum.M();
@@ -55,7 +56,7 @@ void  ParticleDecayer::decay2(ParticleType   & parentType,
   //mWidth   = parentType.getWidth();
   tau      = parentType.getLifeTime();
   taup     = gamma*tau;
-  timeToDecay = -3.0E23 * taup * log(random->Rndm()); // fm
+  timeToDecay = -3.0E23 * taup * log(generator->Rndm()); // fm
   r1 = parentPosition;
   r2 = parentPosition;
   LorentzVector shift;
@@ -84,10 +85,10 @@ void  ParticleDecayer::decay2(ParticleType   & parentType,
 
   double p_lrf = sqrt(temp*temp - 4*m1*m1*m2*m2)/(2*mp);
   // randomly pick emission angle of particle 1
-  double phi      = twoPi*random->Rndm();
+  double phi      = twoPi*generator->Rndm();
   double cosPhi   = cos(phi);
   double sinPhi   = sin(phi);
-  double cosTheta = 2.*random->Rndm() - 1.0;
+  double cosTheta = 2.*generator->Rndm() - 1.0;
   double sinTheta = sqrt(1.00 - cosTheta*cosTheta);
   // compute daughter particles' energy and momentum in the parent rest frame
   double e1_lrf   = sqrt(p_lrf*p_lrf + m1*m1);
@@ -118,6 +119,7 @@ void  ParticleDecayer::decay3(ParticleType & parentType,
                               LorentzVector & p3,
                               LorentzVector & r3)
 {
+  TRandom * generator = getRandomGenerator();
   double e, vx, vy, vz, mp;
   double m1, m2, m3, minMass,tau, taup, gamma, timeToDecay;
   double e1_lrf, e2_lrf, e3_lrf, p1_lrf, p2_lrf, cos12_lrf;
@@ -142,7 +144,7 @@ void  ParticleDecayer::decay3(ParticleType & parentType,
   //mWidth   = parentType.getWidth();
   tau      = parentType.getLifeTime();
   taup     = gamma*tau;
-  timeToDecay = -3.0E23 * taup * log(random->Rndm()); // fm
+  timeToDecay = -3.0E23 * taup * log(generator->Rndm()); // fm
   r1 = parentPosition;
   r2 = parentPosition;
   r3 = parentPosition;
@@ -156,8 +158,8 @@ void  ParticleDecayer::decay3(ParticleType & parentType,
 
   do {
     do {
-      e1_lrf = random->Rndm()*deltaM + m1;
-      e2_lrf = random->Rndm()*deltaM + m2;
+      e1_lrf = generator->Rndm()*deltaM + m1;
+      e2_lrf = generator->Rndm()*deltaM + m2;
     } while (e1_lrf + e2_lrf > mp);
     p1_lrf = sqrt(e1_lrf*e1_lrf - m1*m1);
     p2_lrf = sqrt(e2_lrf*e2_lrf - m2*m2);
@@ -170,9 +172,9 @@ void  ParticleDecayer::decay3(ParticleType & parentType,
   double tp2_lrf_z = p2_lrf*cos12_lrf;
   double tp3_lrf_x = - tp2_lrf_x;
   double tp3_lrf_z = - (p1_lrf + tp2_lrf_z);
-  double phi       = twoPi*random->Rndm();
-  double ksi       = twoPi*random->Rndm();
-  double cos_theta = 2.0*random->Rndm() - 1.0;
+  double phi       = twoPi*generator->Rndm();
+  double ksi       = twoPi*generator->Rndm();
+  double cos_theta = 2.0*generator->Rndm() - 1.0;
   double sin_phi   = sin(phi);
   double cos_phi   = cos(phi);
   double sin_ksi   = sin(ksi);
@@ -229,6 +231,7 @@ void ParticleDecayer::decay4(ParticleType & parentType,
                              LorentzVector & r4
                              )
 {
+  TRandom * generator = getRandomGenerator();
   double e, vx, vy, vz, mp;
   //double mWidth;
   double m1, m2, m3, m4, minMass,tau, taup, gamma, lifeTime;
@@ -254,7 +257,7 @@ void ParticleDecayer::decay4(ParticleType & parentType,
   //mWidth   = parentType.getWidth();
   tau      = parentType.getLifeTime();
   taup     = gamma*tau;
-  lifeTime = -3.0E23 * taup * log(random->Rndm()); // fm
+  lifeTime = -3.0E23 * taup * log(generator->Rndm()); // fm
   r1 = parentPosition;
   r2 = parentPosition;
   r3 = parentPosition;
@@ -14,6 +14,7 @@
 #include <iostream>
 #include <iomanip>
 #include "TRandom.h"
+#include "RandomStream.hpp"
 #include "Particle.hpp"
 
 using namespace std;
@@ -26,8 +27,11 @@ class ParticleDecayer
 public:
   ParticleDecayer();
   virtual ~ParticleDecayer() {}
+  //!
+  //! Set the random generator used by this decayer. By default (null generator), the stream of the calling thread is used (see RandomStream).
+  //!
   void setRandomGenerator(TRandom * _random) { random = _random; }
-  TRandom * getRandomGenerator() { return random; }
+  TRandom * getRandomGenerator() { return random ? random : RandomStream::getRandomStream(); }
 
   void decay2(ParticleType   & parentType,
               LorentzVector  & parentMomentum,
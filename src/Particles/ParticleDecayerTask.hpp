@@ -11,7 +11,7 @@
  * *********************************************************************/
 #ifndef CAP__ParticleDecayerTask
 #define CAP__ParticleDecayerTask
-#include "ParticleDecayer.hpp"
+#include "ParticleDecayCascade.hpp"
 #include "EventTask.hpp"
 #include "Event.hpp"
 #include "Particle.hpp"
@@ -32,7 +32,7 @@ class ParticleDecayerTask : public EventTask
 
 protected:
   
-  ParticleDecayer decayer; //!< Particle decay handler
+  ParticleDecayCascade decayer; //!< Particle decay handler
 
 public:
 
@@ -66,7 +66,7 @@ public:
   //!
   //!Getthe decay handle (decayer) used by this task.
   //!
-  ParticleDecayer & getParticleDecayer() { return decayer;}
+  ParticleDecayCascade & getParticleDecayer() { return decayer;}
 
   ClassDef(ParticleDecayerTask,0)
 };
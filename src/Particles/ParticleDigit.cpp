@@ -30,7 +30,8 @@ pt(0),
 phi(0),
 eta(0),
 y(0),
-e(0)
+e(0),
+typeIndex(-1)
 {  }
 
 ParticleDigit::ParticleDigit(unsigned int _iY,
@@ -51,7 +52,8 @@ pt(_pt),
 phi(_phi),
 eta(_eta),
 y(_y),
-e(_e)
+e(_e),
+typeIndex(-1)
 {  }
 
 ParticleDigit::~ParticleDigit()
@@ -67,7 +69,8 @@ pt(other.pt),
 phi(other.phi),
 eta(other.eta),
 y(other.y),
-e(other.e)
+e(other.e),
+typeIndex(other.typeIndex)
 {  }
 
 ParticleDigit & ParticleDigit::operator=(const ParticleDigit & other)
@@ -83,6 +86,7 @@ ParticleDigit & ParticleDigit::operator=(const ParticleDigit & other)
     eta  = other.eta;
     y    = other.y;
     e    = other.e;
+    typeIndex = other.typeIndex;
     }
   return *this;
 }
@@ -100,6 +104,7 @@ void ParticleDigit::reset()
   eta  = 0.0;
   y    = 0.0;
   e    = 0.0;
+  typeIndex = -1;
 }
 
 
@@ -119,11 +124,12 @@ void ParticleDigit::printProperties(ostream & output)
   output << "             eta: " << eta << endl;
   output << "               y: " << y << endl;
   output << "               e: " << e  << endl;
+  output << "       typeIndex: " << typeIndex << endl;
 }
 
 
 int ParticleDigit::factorySize = 5000;
-Factory<ParticleDigit> * ParticleDigit::factory = 0;
+thread_local Factory<ParticleDigit> * ParticleDigit::factory = 0;
 Factory<ParticleDigit> * ParticleDigit::getFactory()
 {
   if (!factory)
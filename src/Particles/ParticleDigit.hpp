@@ -49,9 +49,10 @@ public:
   float eta;
   float y;
   float e;
+  int   typeIndex; //!< position of the type of the particle in the default particle database (-1 if unknown)
 
   static int factorySize;
-  static Factory<ParticleDigit> * factory;
+  static thread_local Factory<ParticleDigit> * factory;
   static Factory<ParticleDigit> * getFactory();
 
 
@@ -0,0 +1,35 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#include "ParticleDigitBuffer.hpp"
+using CAP::ParticleDigitBuffer;
+
+ClassImp(ParticleDigitBuffer);
+
+ParticleDigitBuffer::ParticleDigitBuffer()
+:
+iParticle(),
+iPt(),
+iPhi(),
+iEta(),
+iY(),
+pt()
+{  }
+
+void ParticleDigitBuffer::clear()
+{
+  iParticle.clear();
+  iPt.clear();
+  iPhi.clear();
+  iEta.clear();
+  iY.clear();
+  pt.clear();
+}
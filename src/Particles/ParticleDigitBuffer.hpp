@@ -0,0 +1,66 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#ifndef CAP__ParticleDigitBuffer
+#define CAP__ParticleDigitBuffer
+#include <vector>
+#include "ParticleDigit.hpp"
+
+using namespace std;
+namespace CAP
+{
+//!
+//! Structure-of-arrays buffer of particle digits used in pair loops. The bin indices and transverse momenta of the particles
+//! are stored in contiguous arrays so that pair kernels (see ParticlePairHistos::fill()) scan them without pointer chasing.
+//! The index of each particle in its event is also stored so that a particle accepted by two filters is not paired with itself.
+//!
+class ParticleDigitBuffer
+{
+public:
+
+  ParticleDigitBuffer();
+  virtual ~ParticleDigitBuffer() {}
+
+  //!
+  //! Remove all digits from this buffer. The memory allocated is retained for the next event.
+  //!
+  void clear();
+
+  //!
+  //! Add the given digit of the particle at the given index in its event.
+  //!
+  inline void add(int index, const ParticleDigit & digit)
+  {
+  iParticle.push_back(index);
+  iPt.push_back(digit.iPt);
+  iPhi.push_back(digit.iPhi);
+  iEta.push_back(digit.iEta);
+  iY.push_back(digit.iY);
+  pt.push_back(digit.pt);
+  }
+
+  inline unsigned int size() const
+  {
+  return iParticle.size();
+  }
+
+  vector<int>   iParticle;
+  vector<int>   iPt;
+  vector<int>   iPhi;
+  vector<int>   iEta;
+  vector<int>   iY;
+  vector<float> pt;
+
+  ClassDef(ParticleDigitBuffer,0)
+};
+}
+
+#endif /* CAP__ParticleDigitBuffer */
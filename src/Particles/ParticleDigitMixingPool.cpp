@@ -0,0 +1,58 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#include "ParticleDigitMixingPool.hpp"
+using CAP::ParticleDigitMixingPool;
+using CAP::ParticleDigitBuffer;
+
+ClassImp(ParticleDigitMixingPool);
+
+ParticleDigitMixingPool::ParticleDigitMixingPool()
+:
+nClasses(0),
+nFilters(0),
+depth(0),
+nEvents(),
+next(),
+slots()
+{  }
+
+void ParticleDigitMixingPool::initialize(int _nClasses, int _nFilters, int _depth)
+{
+  nClasses = (_nClasses>0) ? _nClasses : 0;
+  nFilters = (_nFilters>0) ? _nFilters : 0;
+  depth    = (_depth>0)    ? _depth    : 0;
+  nEvents.assign(nClasses,0);
+  next.assign(nClasses,0);
+  slots.assign(nClasses*depth*nFilters,ParticleDigitBuffer());
+}
+
+void ParticleDigitMixingPool::clear()
+{
+  nEvents.assign(nClasses,0);
+  next.assign(nClasses,0);
+  for (auto & slot : slots) slot.clear();
+}
+
+void ParticleDigitMixingPool::add(int iClass, const vector<ParticleDigitBuffer> & digits)
+{
+  if (iClass<0 || iClass>=nClasses || depth<1) return;
+  int iEvent = next[iClass];
+  for (int iFilter=0; iFilter<nFilters; iFilter++)
+    {
+    ParticleDigitBuffer & slot = slots[(iClass*depth + iEvent)*nFilters + iFilter];
+    // vector assignments reuse the memory of the replaced event
+    slot = digits[iFilter];
+    slot.iParticle.assign(slot.iParticle.size(),-1);
+    }
+  next[iClass] = (iEvent+1)%depth;
+  if (nEvents[iClass]<depth) nEvents[iClass]++;
+}
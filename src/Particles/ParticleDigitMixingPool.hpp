@@ -0,0 +1,83 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#ifndef CAP__ParticleDigitMixingPool
+#define CAP__ParticleDigitMixingPool
+#include <vector>
+#include "ParticleDigitBuffer.hpp"
+
+using namespace std;
+namespace CAP
+{
+//!
+//! Pool of past events used to form mixed-event pairs. Events are sorted in classes (e.g., bins of multiplicity, vertex position,
+//! or event plane angle) and each class holds the digits of the last depth events added to it, one ParticleDigitBuffer per particle
+//! filter. The events of a class are kept in a ring: adding an event to a full class replaces its oldest event, and the memory of
+//! the replaced buffers is reused. The pool never holds more than nClasses x depth events, and holds no Particle objects.
+//!
+//! The particle indices of stored digits are set to -1 so that they never match the index of a particle of the current event
+//! (see ParticlePairHistos::fill()).
+//!
+class ParticleDigitMixingPool
+{
+public:
+
+  ParticleDigitMixingPool();
+  virtual ~ParticleDigitMixingPool() {}
+
+  //!
+  //! Set the number of classes, of particle filters, and of events kept per class, and remove all events.
+  //!
+  void initialize(int nClasses, int nFilters, int depth);
+
+  //!
+  //! Remove all events. The memory allocated is retained.
+  //!
+  void clear();
+
+  //!
+  //! Add the digits of an event (one buffer per particle filter) to the given class.
+  //!
+  void add(int iClass, const vector<ParticleDigitBuffer> & digits);
+
+  //!
+  //! Returns the number of events held by the given class.
+  //!
+  inline int getNEvents(int iClass) const
+  {
+  return nEvents[iClass];
+  }
+
+  //!
+  //! Returns the digits of filter iFilter of the event iEvent (0 to getNEvents(iClass)-1) of the given class.
+  //!
+  inline const ParticleDigitBuffer & getDigits(int iClass, int iEvent, int iFilter) const
+  {
+  return slots[(iClass*depth + iEvent)*nFilters + iFilter];
+  }
+
+  inline int getNClasses() const { return nClasses; }
+  inline int getDepth() const    { return depth;    }
+
+protected:
+
+  int nClasses;
+  int nFilters;
+  int depth;
+  vector<int> nEvents;               //!< number of events held by each class
+  vector<int> next;                  //!< slot of each class replaced by the next event
+  vector<ParticleDigitBuffer> slots; //!< [(iClass*depth + iEvent)*nFilters + iFilter]
+
+  ClassDef(ParticleDigitMixingPool,0)
+};
+}
+
+#endif /* CAP__ParticleDigitMixingPool */
@@ -10,6 +10,8 @@
  *
  * *********************************************************************/
 // #include <TMath.h>
+#include <cmath>
+#include <limits>
 #include "ParticleFilter.hpp"
 using CAP::Filter;
 using CAP::Particle;
@@ -20,16 +22,100 @@ ClassImp(Filter<Particle>);
 
 ClassImp(ParticleFilter);
 
+//!
+//! Returns the kinematic variable selected by the given subtype of a kinematic (type 5) condition.
+//!
+static inline double getKinematicValue(const CAP::LorentzVector & momentum, int subtype)
+{
+  switch (subtype)
+    {
+      case 0: return momentum.P();   // momentum
+      case 1: return momentum.Pt();  // transverse momentum
+      case 2: return momentum.E();   // energy
+      case 3: return momentum.Px();  // p_x
+      case 4: return momentum.Py();  // p_y
+      case 5: return momentum.Pz();  // p_z
+      case 6: return momentum.Phi(); // phi azimuth
+      case 7: return momentum.Eta(); // pseudo rapidity
+      case 8: return momentum.Rapidity(); // rapidity
+    }
+  return 0.0;
+}
+
+//!
+//! Returns the kinematic variable selected by the given subtype of a kinematic (type 5) condition for the given particle of a view.
+//!
+static inline double getKinematicValue(const CAP::EventCAPView & view, unsigned int iParticle, int subtype)
+{
+  switch (subtype)
+    {
+      case 0: return std::sqrt(view.px[iParticle]*view.px[iParticle] + view.py[iParticle]*view.py[iParticle] + view.pz[iParticle]*view.pz[iParticle]);
+      case 1: return view.getPt(iParticle);
+      case 2: return view.e[iParticle];
+      case 3: return view.px[iParticle];
+      case 4: return view.py[iParticle];
+      case 5: return view.pz[iParticle];
+      case 6: return view.getPhi(iParticle);
+      case 7: return view.getEta(iParticle);
+      case 8: return view.getRapidity(iParticle);
+    }
+  return 0.0;
+}
+
+//!
+//! Fill the kinematic values flagged in the given bit mask, at the offsets of their subtypes, for the given momentum.
+//!
+static inline void fillKinematicValues(const CAP::LorentzVector & momentum, unsigned int variables, double * values)
+{
+  if (variables & (1<<0)) values[0] = momentum.P();
+  if (variables & (1<<1)) values[1] = momentum.Pt();
+  if (variables & (1<<2)) values[2] = momentum.E();
+  if (variables & (1<<3)) values[3] = momentum.Px();
+  if (variables & (1<<4)) values[4] = momentum.Py();
+  if (variables & (1<<5)) values[5] = momentum.Pz();
+  if (variables & (1<<6)) values[6] = momentum.Phi();
+  if (variables & (1<<7)) values[7] = momentum.Eta();
+  if (variables & (1<<8)) values[8] = momentum.Rapidity();
+  values[9] = 0.0;
+}
+
+//!
+//! Fill the kinematic values flagged in the given bit mask, at the offsets of their subtypes, for the given particle of a view.
+//!
+static inline void fillKinematicValues(const CAP::EventCAPView & view, unsigned int iParticle, unsigned int variables, double * values)
+{
+  if (variables & (1<<0)) values[0] = std::sqrt(view.px[iParticle]*view.px[iParticle] + view.py[iParticle]*view.py[iParticle] + view.pz[iParticle]*view.pz[iParticle]);
+  if (variables & (1<<1)) values[1] = view.getPt(iParticle);
+  if (variables & (1<<2)) values[2] = view.e[iParticle];
+  if (variables & (1<<3)) values[3] = view.px[iParticle];
+  if (variables & (1<<4)) values[4] = view.py[iParticle];
+  if (variables & (1<<5)) values[5] = view.pz[iParticle];
+  if (variables & (1<<6)) values[6] = view.getPhi(iParticle);
+  if (variables & (1<<7)) values[7] = view.getEta(iParticle);
+  if (variables & (1<<8)) values[8] = view.getRapidity(iParticle);
+  values[9] = 0.0;
+}
+
 ParticleFilter::ParticleFilter()
 :
-Filter<Particle>()
+Filter<Particle>(),
+compiled(false),
+typeAcceptance(),
+compiledTypes(),
+kinematicCuts(),
+kinematicVariables(0)
 {
   // no ops
 }
 
 ParticleFilter::ParticleFilter(const ParticleFilter & otherFilter)
 :
-Filter<Particle>(otherFilter)
+Filter<Particle>(otherFilter),
+compiled(otherFilter.compiled),
+typeAcceptance(otherFilter.typeAcceptance),
+compiledTypes(otherFilter.compiledTypes),
+kinematicCuts(otherFilter.kinematicCuts),
+kinematicVariables(otherFilter.kinematicVariables)
 {
  // no ops
 }
@@ -39,47 +125,136 @@ ParticleFilter & ParticleFilter::operator=(const ParticleFilter & otherFilter)
   if (this!=&otherFilter)
     {
     Filter<Particle>::operator=(otherFilter);
+    compiled            = otherFilter.compiled;
+    typeAcceptance      = otherFilter.typeAcceptance;
+    compiledTypes       = otherFilter.compiledTypes;
+    kinematicCuts       = otherFilter.kinematicCuts;
+    kinematicVariables  = otherFilter.kinematicVariables;
     }
   return *this;
 }
 
+void ParticleFilter::compile(ParticleDb & particleDb)
+{
+  int nTypes   = particleDb.getNumberOfTypes();
+  int maxIndex = -1;
+  for (int iType=0; iType<nTypes; iType++)
+    {
+    int index = particleDb.getParticleType(iType)->getIndex();
+    if (index>maxIndex) maxIndex = index;
+    }
+  typeAcceptance.assign(maxIndex+1,0);
+  vector<const ParticleType *> types(maxIndex+1,nullptr);
+  vector<int> nTypesWithIndex(maxIndex+1,0);
+  for (int iType=0; iType<nTypes; iType++)
+    {
+    int index = particleDb.getParticleType(iType)->getIndex();
+    if (index>=0) nTypesWithIndex[index]++;
+    }
+  for (int iType=0; iType<nTypes; iType++)
+    {
+    const ParticleType & type = *particleDb.getParticleType(iType);
+    int index = type.getIndex();
+    // types sharing an index are not compiled: accept() evaluates their conditions directly
+    if (index<0 || nTypesWithIndex[index]>1) continue;
+    types[index]          = &type;
+    typeAcceptance[index] = (acceptType(type,false) ? 1 : 0) | (acceptType(type,true) ? 2 : 0);
+    }
+  // filters compiled against the same types share their table, so that the tables of many filters (e.g., one filter per
+  // type) stay in cache
+  static std::mutex sharedTypesMutex;
+  static std::shared_ptr<const vector<const ParticleType *>> sharedTypes;
+  std::lock_guard<std::mutex> lock(sharedTypesMutex);
+  if (!sharedTypes || *sharedTypes!=types) sharedTypes = std::make_shared<const vector<const ParticleType *>>(std::move(types));
+  compiledTypes = sharedTypes;
+  kinematicCuts.clear();
+  kinematicVariables = 0;
+  for (unsigned int k=0; k<conditions.size(); k++)
+    {
+    Condition & condition = *conditions[k];
+    if (condition.filterType!=5) continue;
+    KinematicCut cut;
+    cut.offset = (condition.filterSubtype>=0 && condition.filterSubtype<nKinematicValues-1) ? condition.filterSubtype : nKinematicValues-1;
+    ConditionOr * conditionOr = dynamic_cast<ConditionOr*>(&condition);
+    if (conditionOr)
+      {
+      // the ranges of ConditionOr include their upper bounds
+      cut.minimum  = conditionOr->minimum;
+      cut.maximum  = std::nextafter(conditionOr->maximum,  std::numeric_limits<double>::infinity());
+      cut.minimum2 = conditionOr->minimum2;
+      cut.maximum2 = std::nextafter(conditionOr->maximum2, std::numeric_limits<double>::infinity());
+      }
+    else
+      {
+      cut.minimum  = condition.minimum;
+      cut.maximum  = condition.maximum;
+      cut.minimum2 = 1.0;
+      cut.maximum2 = 0.0;
+      }
+    kinematicCuts.push_back(cut);
+    if (cut.offset<nKinematicValues-1) kinematicVariables |= 1u<<cut.offset;
+    }
+  compiled = true;
+}
 
 bool ParticleFilter::accept(const Particle & particle)
 {
-  //cout << " ParticleFilter::accept(const Particle & particle): "  << endl;
-  const LorentzVector & momentum1 = particle.getMomentum();
-//  double pt1   = momentum1.Pt();
-//  double e1    = momentum1.E();
-//  double phi1  = momentum1.Phi();
-//  double eta1  = momentum1.Eta();
-//  double y1    = momentum1.Rapidity();
-  //cout << "particle: " << particle.getType().getName() << "  y1: " << y1 << "  phi1: " << phi1 << " pt1: " << pt1 << endl;
+  if (compiled)
+    {
+    if (!((getTypeAcceptance(particle.getType()) >> (particle.isLive() ? 1 : 0)) & 1)) return false;
+    if (kinematicCuts.empty()) return true;
+    double values[nKinematicValues];
+    fillKinematicValues(particle.getMomentum(),kinematicVariables,values);
+    return acceptKinematicCuts(values);
+    }
+  if (getNConditions()<1) return true;
+  return acceptType(particle.getType(),particle.isLive()) && acceptKinematics(particle.getMomentum());
+}
 
+bool ParticleFilter::accept(const EventCAPView & view, unsigned int iParticle)
+{
+  ParticleType * type = view.getType(iParticle);
+  if (!type) return false;
+  if (getNConditions()<1) return true;
+  bool live = view.isLive(iParticle);
+  if (compiled)
+    {
+    if (!((getTypeAcceptance(*type) >> (live ? 1 : 0)) & 1)) return false;
+    if (kinematicCuts.empty()) return true;
+    double values[nKinematicValues];
+    fillKinematicValues(view,iParticle,kinematicVariables,values);
+    return acceptKinematicCuts(values);
+    }
+  if (!acceptType(*type,live)) return false;
   unsigned int nConditions = getNConditions();
-  if (nConditions<1) return true;
+  for (unsigned int k = 0; k<nConditions; k++)
+    {
+    Condition & condition = *(conditions[k]);
+    if (condition.filterType!=5) continue;
+    if (!condition.accept(getKinematicValue(view,iParticle,condition.filterSubtype))) return false;
+    }
+  return true;
+}
 
-  double value     = 0.0;
+bool ParticleFilter::acceptType(const ParticleType & type, bool live)
+{
+  unsigned int nConditions = getNConditions();
   bool   accepting = false;
-  ParticleType & type = particle.getType();
-
-  //cout << "ParticleFilter::accept() nConditions = " << nConditions << endl;
 
   for (unsigned int k = 0; k<nConditions; k++)
     {
     Condition & condition = *(conditions[k]);
     unsigned int filterType    = condition.filterType;
     unsigned int filterSubType = condition.filterSubtype;
-    //cout << "filterType: " << filterType << "   filterSubType: " << filterSubType << endl;
     switch (filterType)
       {
         case 0: // live or not to be considered at all
         switch (filterSubType)
           {
-            case  0: accepting = !particle.isLive(); break;  // decayed or removed particles only
-            case  1: accepting = particle.isLive(); break;   // undecayed particles only
+            case  0: accepting = !live; break;  // decayed or removed particles only
+            case  1: accepting = live; break;   // undecayed particles only
             case  2: accepting = 1; break;                   // all
           }
-        //if (!accepting) return false;
         break;
 
         case 1: // Charge, Neutral, Plus, or Minus
@@ -92,32 +267,15 @@ bool ParticleFilter::accept(const Particle & particle)
               case  2: accepting = (charge<0);  break;  // accepts -ve only
               case  3: accepting = (charge>0);  break;  // accepts +ve only
             }
-          //if (!accepting) return false;
           }
         break;
 
         case 2: // PDG Code
-        {
         accepting = condition.accept(type.getPdgCode());
-//        int pdg = type.getPdgCode();
-//        if (pdg==-211)
-//          {
-//          cout
-//          << "            filterType: " << condition.filterType
-//          << " filterSubtype: " << condition.filterSubtype
-//          << "  minimum: " << condition.minimum
-//          << "  maximum: " << condition.maximum
-//          << endl;
-//          //cout << "particle: " << particle.getType().getName() << "  y1: " << y1 << "  phi1: " << phi1 << " pt1: " << pt1 << endl;
-//          cout << "       case 2: accepting: " << accepting << endl;
-//          }
-        }
-        //if (!accepting) return false;
         break;
 
         case 3: // Particle index
         accepting = condition.accept(type.getIndex());
-        //if (!accepting) return false;
         break;
 
         case 4: // Type selection
@@ -211,26 +369,22 @@ bool ParticleFilter::accept(const Particle & particle)
         //if (!accepting) return false;
         break;
 
-        case 5: // kinematic selection/filtering
-        const LorentzVector & momentum = particle.getMomentum();
-        switch (filterSubType)
-          {
-            case 0: value = momentum.P();   break;    // momentum
-            case 1: value = momentum.Pt();  break;   // transverse momentum
-            case 2: value = momentum.E();   break;    // energy
-            case 3: value = momentum.Px();  break;   // p_x
-            case 4: value = momentum.Py();  break;   // p_y
-            case 5: value = momentum.Pz();  break;   // p_z
-            case 6: value = momentum.Phi(); break;   // phi azimuth
-            case 7: value = momentum.Eta(); break;   // pseudo rapidity
-            case 8: value = momentum.Rapidity(); break;   // rapidity
-          }
-        accepting = conditions[k]->accept(value);
-        //cout << "k:" << k << " case 5: filterSubType: " << filterSubType << " value:" << value << " accepting:" << accepting << endl;
-        //if (!accepting) return false;
-        break;
+        default: // kinematic conditions are evaluated by acceptKinematics()
+        continue;
       }
     if (!accepting)  return false;
     }
   return true;
 }
+
+bool ParticleFilter::acceptKinematics(const LorentzVector & momentum)
+{
+  unsigned int nConditions = getNConditions();
+  for (unsigned int k = 0; k<nConditions; k++)
+    {
+    Condition & condition = *(conditions[k]);
+    if (condition.filterType!=5) continue;
+    if (!condition.accept(getKinematicValue(momentum,condition.filterSubtype))) return false;
+    }
+  return true;
+}
@@ -11,12 +11,27 @@
  * *********************************************************************/
 #ifndef CAP__ParticleFilter
 #define CAP__ParticleFilter
+#include <memory>
+#include <mutex>
 #include "Particle.hpp"
+#include "ParticleDb.hpp"
+#include "EventCAPView.hpp"
 #include "Filter.hpp"
 
 namespace CAP
 {
 
+//!
+//! Particle filter defined by a list of conditions, all of which must be satisfied for a particle to be accepted.
+//!
+//! Conditions of types 0 to 4 (live/decayed status, charge, PDG code, type index, and type selection) depend only on the
+//! type of the particle and its live status. Once compiled against a particle type database (see compile()), the filter
+//! stores the outcome of these conditions in a table indexed by ParticleType::getIndex() so that accept() reduces to a
+//! table look up followed by the kinematic (type 5) conditions. Types not found in the table (e.g., types added to the
+//! database after compilation) are handled by evaluating the conditions directly. The compiled kinematic conditions are
+//! stored as ranges of the variables of a flat array of kinematic values, filled once per particle with the variables the
+//! filter uses, and are all evaluated without branching.
+//!
 class ParticleFilter : public Filter<Particle>
 {
 public:
@@ -27,8 +42,83 @@ public:
   virtual ~ParticleFilter() {}
   virtual bool accept(const Particle & particle);
 
+  //!
+  //! Returns true if the particle at the given index of the given view is accepted by this filter. Particles of unknown type are rejected.
+  //!
+  bool accept(const EventCAPView & view, unsigned int iParticle);
+
+  //!
+  //! Compile the type dependent conditions of this filter for all the types of the given database. Call this method
+  //! after all the conditions of the filter have been added.
+  //!
+  void compile(ParticleDb & particleDb);
+
+  //!
+  //! Returns true if this filter has been compiled.
+  //!
+  bool isCompiled() const { return compiled; }
+
+  //!
+  //! Evaluate the conditions of types 0 to 4 for the given type and live status.
+  //!
+  bool acceptType(const ParticleType & type, bool live);
+
+  //!
+  //! Evaluate the kinematic conditions (type 5) for the given momentum.
+  //!
+  bool acceptKinematics(const LorentzVector & momentum);
+
+protected:
+
+  //!
+  //! Compiled kinematic condition: the value at the given offset of the array of kinematic values must lie in [minimum,maximum)
+  //! or [minimum2,maximum2). The second range is empty for conditions with a single range.
+  //!
+  struct KinematicCut
+  {
+  int    offset;
+  double minimum;
+  double maximum;
+  double minimum2;
+  double maximum2;
+  };
+
+  //!
+  //! Number of kinematic values: p, pt, E, px, py, pz, phi, eta, y, and a zero used by conditions of unknown subtype.
+  //!
+  static const int nKinematicValues = 10;
+
+  //!
+  //! Returns true if the given kinematic values satisfy all the compiled kinematic conditions.
+  //!
+  inline bool acceptKinematicCuts(const double * values) const
+  {
+  bool accepting = true;
+  for (const KinematicCut & cut : kinematicCuts)
+    {
+    double value = values[cut.offset];
+    accepting &= ((value>=cut.minimum) & (value<cut.maximum)) | ((value>=cut.minimum2) & (value<cut.maximum2));
+    }
+  return accepting;
+  }
+
+  //!
+  //! Returns the acceptance flags of the given type: bit 0 is set if decayed (not live) particles of this type are accepted, bit 1
+  //! if live particles are accepted.
+  //!
+  inline unsigned char getTypeAcceptance(const ParticleType & type)
+  {
+  int index = type.getIndex();
+  if (index>=0 && index<int(typeAcceptance.size()) && (*compiledTypes)[index]==&type) return typeAcceptance[index];
+  return (acceptType(type,false) ? 1 : 0) | (acceptType(type,true) ? 2 : 0);
+  }
+
+  bool compiled;
+  vector<unsigned char>        typeAcceptance;
+  std::shared_ptr<const vector<const ParticleType *>> compiledTypes; //!< type of each index of typeAcceptance, shared by the filters compiled against the same types
+  vector<KinematicCut>         kinematicCuts;       //!< compiled kinematic conditions
+  unsigned int                 kinematicVariables;  //!< bit k is set if the compiled kinematic conditions use the kinematic value k
 
- 
   ClassDef(ParticleFilter,0)
 };
 
@@ -13,8 +13,18 @@
 #pragma link C++ class CAP::Particle+;
 #pragma link C++ class CAP::ParticleDecayMode+;
 #pragma link C++ class CAP::ParticleDecayer+;
+#pragma link C++ class CAP::ParticleDecayCascade+;
 #pragma link C++ class CAP::ParticleDecayerTask+;
 #pragma link C++ class CAP::ParticleDigit+;
+#pragma link C++ class CAP::ParticleDigitBuffer+;
+#pragma link C++ class CAP::ParticleDigitMixingPool+;
+#pragma link C++ class CAP::EventCAPChunk+;
+#pragma link C++ class CAP::EventCAPReader+;
+#pragma link C++ class CAP::EventCAPWriter+;
+#pragma link C++ class CAP::EventCAPView+;
+#pragma link C++ class CAP::EventCAPMappedReader+;
+#pragma link C++ class CAP::EventCAPReaderTask+;
+#pragma link C++ class CAP::RootTreePrefetcher+;
 #pragma link C++ class CAP::ParticleType+;
 #pragma link C++ class CAP::ParticleDb+;
 #pragma link C++ class CAP::ParticleDbManager+;
@@ -0,0 +1,178 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#include "Exceptions.hpp"
+#include "RootTreePrefetcher.hpp"
+
+using CAP::RootTreePrefetcher;
+
+ClassImp(RootTreePrefetcher);
+
+RootTreePrefetcher::RootTreePrefetcher(TChain * _chain, unsigned int nSlots)
+:
+chain(_chain),
+names(),
+addresses(),
+branchPointers(),
+sizes(),
+elementSizes(),
+counterBranches(),
+offsets(),
+entrySize(0),
+readBuffers(),
+slots(nSlots>0 ? nSlots : 1),
+nFilled(0),
+fillIndex(0),
+readIndex(0),
+running(false),
+stopping(false),
+ended(false),
+nextEntry(0),
+entryBytes(0),
+entryTreeNumber(-1),
+stallTimer(),
+thread(),
+slotMutex(),
+slotFilled(),
+slotReleased()
+{
+}
+
+RootTreePrefetcher::~RootTreePrefetcher()
+{
+  stop();
+}
+
+void RootTreePrefetcher::addBranch(const String & name, void * address, size_t size, TBranch ** branchPointer)
+{
+  if (running) throw TaskException("Cannot add a branch while running","RootTreePrefetcher::addBranch()");
+  size_t offset = (entrySize+7) & ~size_t(7);
+  names.push_back(name);
+  addresses.push_back(address);
+  branchPointers.push_back(branchPointer);
+  sizes.push_back(size);
+  elementSizes.push_back(size);
+  counterBranches.push_back(-1);
+  offsets.push_back(offset);
+  entrySize = offset + size;
+}
+
+void RootTreePrefetcher::addBranch(const String & name, void * address, size_t elementSize, size_t capacity, const Int_t * counter, TBranch ** branchPointer)
+{
+  int counterBranch = -1;
+  for (unsigned int iBranch=0; iBranch<addresses.size(); iBranch++)
+    {
+    if (addresses[iBranch]==counter) counterBranch = iBranch;
+    }
+  if (counterBranch<0) throw TaskException("Counter branch of "+name+" is not registered","RootTreePrefetcher::addBranch()");
+  addBranch(name,address,elementSize*capacity,branchPointer);
+  elementSizes.back()    = elementSize;
+  counterBranches.back() = counterBranch;
+}
+
+void RootTreePrefetcher::start(Long64_t firstEntry)
+{
+  stop();
+  readBuffers.assign(entrySize,0);
+  for (auto & slot : slots)
+    {
+    slot.buffers.assign(entrySize,0);
+    slot.nBytes     = 0;
+    slot.treeNumber = -1;
+    slot.last       = false;
+    }
+  // the chain re-applies these addresses whenever it loads a new tree
+  for (unsigned int iBranch=0; iBranch<names.size(); iBranch++)
+    chain->SetBranchAddress(names[iBranch], readBuffers.data()+offsets[iBranch], branchPointers[iBranch]);
+  nFilled   = 0;
+  fillIndex = 0;
+  readIndex = 0;
+  stopping  = false;
+  ended     = false;
+  nextEntry = firstEntry;
+  running   = true;
+  thread    = std::thread(&RootTreePrefetcher::run,this);
+}
+
+void RootTreePrefetcher::run()
+{
+  while (true)
+    {
+      {
+      std::unique_lock<std::mutex> lock(slotMutex);
+      slotReleased.wait(lock, [this]{ return stopping || nFilled<slots.size(); });
+      if (stopping) return;
+      }
+    // the slot at fillIndex is not used by next() until it is published below
+    Slot & slot = slots[fillIndex];
+    slot.last   = chain->LoadTree(nextEntry)<0;
+    if (!slot.last)
+      {
+      slot.nBytes     = chain->GetEntry(nextEntry++);
+      slot.treeNumber = chain->GetTreeNumber();
+      slot.last       = slot.nBytes<0;
+      for (unsigned int iBranch=0; iBranch<names.size() && !slot.last; iBranch++)
+        memcpy(slot.buffers.data()+offsets[iBranch], readBuffers.data()+offsets[iBranch], getUsedSize(iBranch,readBuffers.data()));
+      }
+      {
+      std::lock_guard<std::mutex> lock(slotMutex);
+      fillIndex = (fillIndex+1) % slots.size();
+      nFilled++;
+      }
+    slotFilled.notify_one();
+    if (slot.last) return;
+    }
+}
+
+bool RootTreePrefetcher::next()
+{
+  if (!running) throw TaskException("Prefetcher is not running","RootTreePrefetcher::next()");
+  if (ended) return false;
+  std::unique_lock<std::mutex> lock(slotMutex);
+  if (nFilled==0)
+    {
+    stallTimer.startInterval();
+    slotFilled.wait(lock, [this]{ return nFilled>0; });
+    stallTimer.stopInterval();
+    }
+  lock.unlock();
+  Slot & slot = slots[readIndex];
+  if (slot.last)
+    {
+    ended = true;
+    if (slot.nBytes<0) throw TaskException("Error while reading the input tree","RootTreePrefetcher::next()");
+    return false;
+    }
+  for (unsigned int iBranch=0; iBranch<names.size(); iBranch++)
+    memcpy(addresses[iBranch], slot.buffers.data()+offsets[iBranch], getUsedSize(iBranch,slot.buffers.data()));
+  entryBytes      = slot.nBytes;
+  entryTreeNumber = slot.treeNumber;
+  lock.lock();
+  readIndex = (readIndex+1) % slots.size();
+  nFilled--;
+  lock.unlock();
+  slotReleased.notify_one();
+  return true;
+}
+
+void RootTreePrefetcher::stop()
+{
+  if (!running) return;
+    {
+    std::lock_guard<std::mutex> lock(slotMutex);
+    stopping = true;
+    }
+  slotReleased.notify_all();
+  thread.join();
+  running = false;
+  for (unsigned int iBranch=0; iBranch<names.size(); iBranch++)
+    chain->SetBranchAddress(names[iBranch], addresses[iBranch], branchPointers[iBranch]);
+}
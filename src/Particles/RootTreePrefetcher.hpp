@@ -0,0 +1,162 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#ifndef CAP__RootTreePrefetcher
+#define CAP__RootTreePrefetcher
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "TChain.h"
+#include "Aliases.hpp"
+#include "Timer.hpp"
+
+using namespace std;
+namespace CAP
+{
+
+//!
+//! Read ahead of the entries of a ROOT tree chain on a background thread.
+//!
+//! The branches to read are registered with addBranch() along with the address of the variable or array they are read into by the
+//! owner of the prefetcher (typically a RootTreeReader). Once started, the background thread reads the entries of the chain into its own
+//! buffers and copies them into a ring of slots. Each call to next() waits for the next slot to be ready, copies its content to the
+//! registered addresses, and releases the slot to the background thread. For variable size arrays, only the elements counted by the
+//! count branch of the array are copied. The chain must not be used by the owner while the prefetcher is running.
+//!
+class RootTreePrefetcher
+{
+public:
+
+  //!
+  //! CTOR
+  //! @param chain chain to read.
+  //! @param nSlots number of entries read ahead.
+  //!
+  RootTreePrefetcher(TChain * chain, unsigned int nSlots);
+
+  //!
+  //! DTOR: the background thread is stopped, if needed.
+  //!
+  virtual ~RootTreePrefetcher();
+
+  //!
+  //! Register a scalar (or fixed size array) branch read into the given address. The branch pointer, if given, is the one passed
+  //! to TChain::SetBranchAddress() by the owner.
+  //!
+  void addBranch(const String & name, void * address, size_t size, TBranch ** branchPointer=nullptr);
+
+  //!
+  //! Register a variable size array branch read into the given array of the given capacity (in number of elements). The number of elements of
+  //! each entry is the value of the given counter, which must be the address of a branch registered before this one.
+  //!
+  void addBranch(const String & name, void * address, size_t elementSize, size_t capacity, const Int_t * counter, TBranch ** branchPointer=nullptr);
+
+  //!
+  //! Start reading ahead from the given entry of the chain.
+  //!
+  void start(Long64_t firstEntry);
+
+  //!
+  //! Copy the next entry to the registered addresses. Returns false at the end of the chain.
+  //!
+  bool next();
+
+  //!
+  //! Stop the background thread and restore the branch addresses of the chain to the registered addresses.
+  //!
+  void stop();
+
+  //!
+  //! Number of bytes read (uncompressed) for the last entry returned by next().
+  //!
+  inline Long64_t getNBytes() const
+  {
+  return entryBytes;
+  }
+
+  //!
+  //! Index, in the chain, of the tree of the last entry returned by next().
+  //!
+  inline int getTreeNumber() const
+  {
+  return entryTreeNumber;
+  }
+
+  //!
+  //! Time spent by next() waiting for the background thread.
+  //!
+  inline Timer & getStallTimer()
+  {
+  return stallTimer;
+  }
+
+protected:
+
+  //!
+  //! Loop of the background thread.
+  //!
+  void run();
+
+  //!
+  //! Number of bytes of the given branch for the entry whose buffers begin at the given address.
+  //!
+  inline size_t getUsedSize(unsigned int iBranch, const char * buffers) const
+  {
+  if (counterBranches[iBranch]<0) return sizes[iBranch];
+  Int_t count;
+  memcpy(&count, buffers+offsets[counterBranches[iBranch]], sizeof(Int_t));
+  if (count<0) count = 0;
+  return std::min(size_t(count)*elementSizes[iBranch], sizes[iBranch]);
+  }
+
+  struct Slot
+  {
+    vector<char> buffers;
+    Long64_t     nBytes;
+    int          treeNumber;
+    bool         last;
+  };
+
+  TChain *          chain;
+  vector<String>    names;
+  vector<void*>     addresses;
+  vector<TBranch**> branchPointers;
+  vector<size_t>    sizes;
+  vector<size_t>    elementSizes;
+  vector<int>       counterBranches;
+  vector<size_t>    offsets;
+  size_t            entrySize;
+  vector<char>      readBuffers;
+  vector<Slot>      slots;
+  unsigned int      nFilled;
+  unsigned int      fillIndex;
+  unsigned int      readIndex;
+  bool              running;
+  bool              stopping;
+  bool              ended;
+  Long64_t          nextEntry;
+  Long64_t          entryBytes;
+  int               entryTreeNumber;
+  Timer             stallTimer;
+  std::thread       thread;
+  std::mutex        slotMutex;
+  std::condition_variable slotFilled;
+  std::condition_variable slotReleased;
+
+  ClassDef(RootTreePrefetcher,0)
+};
+
+}
+
+#endif /* CAP__RootTreePrefetcher */
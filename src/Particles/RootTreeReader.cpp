@@ -9,8 +9,116 @@
  * Author: Claude Pruneau,   04/01/2022
  *
  * *********************************************************************/
+#include "TROOT.h"
+#include "TTreeCacheUnzip.h"
 #include "RootTreeReader.hpp"
 
 //using RTR = CAP::RootTreeReader<Event,Particle,ParticleType>
 
 ClassImp(CAP::RootTreeReader);
+
+namespace CAP
+{
+
+void RootTreeReader::mapBranch(const String & name, void * address, size_t elementSize, size_t capacity, const Int_t * counter, TBranch ** branch)
+{
+  inputRootChain->SetBranchAddress(name, address, branch);
+  inputBranchNames.push_back(name);
+  if (!prefetcher) return;
+  if (counter)
+    prefetcher->addBranch(name, address, elementSize, capacity, counter, branch);
+  else
+    prefetcher->addBranch(name, address, elementSize*capacity, branch);
+}
+
+void RootTreeReader::initializeInputCache()
+{
+  if (eventsImportImplicitMT)
+    {
+    if (!ROOT::IsImplicitMTEnabled()) ROOT::EnableImplicitMT();
+    TTreeCacheUnzip::SetParallelUnzip(TTreeCacheUnzip::kEnable);
+    if (reportInfo(__FUNCTION__)) cout << "Implicit multithreading enabled with " << ROOT::GetThreadPoolSize() << " threads" << endl;
+    }
+  if (eventsImportCacheSize<=0 || inputBranchNames.size()<1) return;
+  // the cache is attached to the file of the current tree and carried over by the chain to the following files
+  inputRootChain->LoadTree(0);
+  inputRootChain->SetCacheSize(eventsImportCacheSize);
+  for (auto & name : inputBranchNames) inputRootChain->AddBranchToCache(name,kTRUE);
+  inputRootChain->StopCacheLearningPhase();
+  if (reportInfo(__FUNCTION__)) cout << "Tree cache of " << eventsImportCacheSize << " bytes for " << inputBranchNames.size() << " branches" << endl;
+}
+
+bool RootTreeReader::readEntry()
+{
+  int    previousTreeIndex = inputRootTreeIndex;
+  Timer & timer = prefetcher ? prefetcher->getStallTimer() : readTimer;
+  double stallBefore = timer.getAccumulated();
+  bool   found;
+  if (prefetcher)
+    {
+    found = prefetcher->next();
+    if (found)
+      {
+      nb = prefetcher->getNBytes();
+      setInputRootTreeIndex(prefetcher->getTreeNumber());
+      }
+    }
+  else
+    {
+    readTimer.startInterval();
+    found = LoadTree(entryIndex)>=0;
+    if (found) nb = inputRootChain->GetEntry(entryIndex);
+    readTimer.stopInterval();
+    }
+  double stall = timer.getAccumulated() - stallBefore;
+  totalStallTime += stall;
+  if (!found || inputRootTreeIndex!=previousTreeIndex)
+    {
+    reportInputFileStatistics(previousTreeIndex);
+    fileNEntries  = 0;
+    fileNBytes    = 0;
+    fileStallTime = 0.0;
+    }
+  if (!found) return false;
+  if (nb<0)
+    {
+    if (reportError(__FUNCTION__)) cout << "Error reading entry " << entryIndex << endl;
+    throw TaskException("Error reading entry","RootTreeReader::readEntry()");
+    }
+  entryIndex++;
+  nBytes        += nb;
+  fileNEntries  += 1;
+  fileNBytes    += nb;
+  fileStallTime += stall;
+  return true;
+}
+
+void RootTreeReader::reportInputFileStatistics(int treeIndex)
+{
+  if (fileNEntries<1 || treeIndex<0) return;
+  TObject * element = inputRootChain->GetListOfFiles()->At(treeIndex);
+  if (reportInfo(__FUNCTION__))
+    {
+    cout << endl;
+    printItem("File",           element ? String(element->GetTitle()) : String("unknown"));
+    printItem("Entries",        fileNEntries);
+    printItem("Bytes read",     fileNBytes);
+    printItem(prefetcher ? "Stall time (s)" : "Read time (s)", fileStallTime);
+    }
+}
+
+void RootTreeReader::finalizeEventReader()
+{
+  EventTask::finalizeEventReader();
+  if (prefetcher) prefetcher->stop();
+  reportInputFileStatistics(inputRootTreeIndex);
+  fileNEntries = 0;
+  if (reportInfo(__FUNCTION__))
+    {
+    cout << endl;
+    printItem("Total bytes read", nBytes);
+    printItem(prefetcher ? "Total stall time (s)" : "Total read time (s)", totalStallTime);
+    }
+}
+
+} // namespace CAP
@@ -18,6 +18,9 @@
 #include "TString.h"
 #include "Aliases.hpp"
 #include "EventTask.hpp"
+#include "RandomStream.hpp"
+#include "RootTreePrefetcher.hpp"
+#include "Timer.hpp"
 //#include "Event.hpp"
 //#include "Particle.hpp"
 //#include "ParticleType.hpp"
@@ -28,6 +31,11 @@ namespace CAP
 //!
 //! Abstract base class defining a ROOT Tree reader. Subclass this class to read any ROOT tree.
 //!
+//! Subclasses map the branches they read with setBranchAddress() and read entries with readEntry(). The branches so mapped are the
+//! only ones trained in the tree cache of the chain (see EventsImportCacheSize). If EventsImportPrefetch is positive, entries are read
+//! ahead of the analysis by a background thread (see RootTreePrefetcher). The bytes read and the time spent waiting for the input are
+//! reported for each file of the chain.
+//!
 //template <class Event, class Particle, class ParticleType>
 class RootTreeReader : public EventTask
 {
@@ -62,7 +70,17 @@ public:
   nEntries(0),
   nBytes(0),
   nb(0),
-  entryIndex(0)
+  entryIndex(0),
+  eventsImportPrefetch(0),
+  eventsImportCacheSize(0),
+  eventsImportImplicitMT(false),
+  inputBranchNames(),
+  prefetcher(nullptr),
+  readTimer(),
+  fileNEntries(0),
+  fileNBytes(0),
+  fileStallTime(0.0),
+  totalStallTime(0.0)
   {
   TString s = "RootTreeReader";
   MessageLogger::appendClassName(s);
@@ -73,6 +91,7 @@ public:
   //!
   virtual ~RootTreeReader()
   {
+  if (prefetcher) delete prefetcher;
   if (inputDataFile)
     {
     inputDataFile->Close();
@@ -97,6 +116,9 @@ public:
   Task::addParameter("StandaloneMode",        true);
   Task::addParameter("ClonesMaxArraySize",    10000);
   Task::addParameter("RandomizeEventPlane",   true);
+  Task::addParameter("EventsImportPrefetch",  0);
+  Task::addParameter("EventsImportCacheSize", 32*1024*1024);
+  Task::addParameter("EventsImportImplicitMT", false);
   }
   
   //!
@@ -115,6 +137,9 @@ public:
   lastFile              = Task::getValueInt(   "EventsImportFileMaxIndex");
   clonesMaxArraySize    = Task::getValueInt(   "ClonesMaxArraySize");
   randomizeEventPlane   = Task::getValueBool(  "RandomizeEventPlane");
+  eventsImportPrefetch  = Task::getValueInt(   "EventsImportPrefetch");
+  eventsImportCacheSize = Task::getValueInt(   "EventsImportCacheSize");
+  eventsImportImplicitMT= Task::getValueBool(  "EventsImportImplicitMT");
 
   inputRootChain = new TChain(dataInputTreeName);
   if (!inputRootChain)
@@ -155,7 +180,11 @@ public:
     if (reportInfo(__FUNCTION__)) cout << "Adding input file:" << fileName << endl;
     inputRootChain->Add(fileName);
     }
+  if (prefetcher) delete prefetcher;
+  prefetcher = (eventsImportPrefetch>0) ? new RootTreePrefetcher(inputRootChain,eventsImportPrefetch) : nullptr;
+  inputBranchNames.clear();
   initInputTreeMapping();
+  initializeInputCache();
   setInputRootTreeIndex(-1);
   entryIndex = 0;
   nEntries = inputRootChain->GetEntriesFast();
@@ -170,9 +199,19 @@ public:
     }
   nBytes = 0;
   nb = 0;
+  fileNEntries   = 0;
+  fileNBytes     = 0;
+  fileStallTime  = 0.0;
+  totalStallTime = 0.0;
+  if (prefetcher) prefetcher->start(entryIndex);
   if (reportEnd(__FUNCTION__))
     ;
   }
+
+  //!
+  //! Stop the prefetching of entries, if any, and report the input statistics of the last file read.
+  //!
+  virtual void finalizeEventReader();
   
   //!
   //! Execute this task based on the configuration and class variable specified at construction
@@ -195,6 +234,12 @@ public:
   }
 
 
+  //!
+  //! Size the tree cache of the chain for the branches mapped by setBranchAddress() and, if requested, enable the implicit multithreading
+  //! of ROOT so the baskets read by the cache are decompressed in parallel.
+  //!
+  virtual void initializeInputCache();
+
   //!
   //!Get pointer to the root input chain
   //!
@@ -215,8 +260,39 @@ public:
   }
   
 protected:
-  
- 
+
+  //!
+  //! Map the given branch onto the given variable. Use this method rather than TChain::SetBranchAddress() so the branch is
+  //! trained in the tree cache and read ahead when prefetching is enabled.
+  //!
+  template <class T>
+  void setBranchAddress(const String & name, T * address, TBranch ** branch)
+  {
+  mapBranch(name, address, sizeof(T), 1, nullptr, branch);
+  }
+
+  //!
+  //! Map the given variable size array branch onto the given array. The number of elements of each entry is the value of the given counter,
+  //! which must be mapped before the array.
+  //!
+  template <class T, size_t N>
+  void setBranchAddress(const String & name, T (&array)[N], const Int_t & counter, TBranch ** branch)
+  {
+  mapBranch(name, array, sizeof(T), N, &counter, branch);
+  }
+
+  void mapBranch(const String & name, void * address, size_t elementSize, size_t capacity, const Int_t * counter, TBranch ** branch);
+
+  //!
+  //! Read the next entry of the chain into the mapped variables. Returns false at the end of the chain.
+  //!
+  bool readEntry();
+
+  //!
+  //! Report the number of entries and bytes read from the file of the given index of the chain and the time spent waiting for them.
+  //!
+  void reportInputFileStatistics(int treeIndex);
+
   inline void Show(Long64_t entry)
   {
     if (!inputRootChain) return;
@@ -255,7 +331,7 @@ protected:
   
   double getRandomEventPlaneAngle() const
   {
-  return  CAP::Math::twoPi() * gRandom->Rndm();
+  return  CAP::Math::twoPi() * CAP::RandomStream::getRandomStream()->Rndm();
   }
    
   int getClonesMaxArraySize() const
@@ -286,6 +362,16 @@ protected:
   Long64_t nBytes;
   Long64_t nb;
   long entryIndex;
+  int  eventsImportPrefetch;       //! number of entries read ahead by the prefetcher, zero to read synchronously
+  long eventsImportCacheSize;      //! size of the tree cache in bytes, zero to disable it
+  bool eventsImportImplicitMT;     //! enable the implicit multithreading of ROOT (parallel decompression of baskets)
+  vector<String> inputBranchNames;
+  RootTreePrefetcher * prefetcher;
+  Timer    readTimer;              //! time spent reading entries synchronously
+  Long64_t fileNEntries;
+  Long64_t fileNBytes;
+  double   fileStallTime;
+  double   totalStallTime;
 
   ClassDef(RootTreeReader,0)
 };
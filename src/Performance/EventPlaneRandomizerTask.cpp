@@ -10,6 +10,7 @@
  *
  * *********************************************************************/
 #include "EventPlaneRandomizerTask.hpp"
+#include "RandomStream.hpp"
 using CAP::EventPlaneRandomizerTask;
 
 ClassImp(EventPlaneRandomizerTask);
@@ -30,7 +31,7 @@ void EventPlaneRandomizerTask::setDefaultConfiguration()
 
 void EventPlaneRandomizerTask::createEvent()
 {
-  double eventAngle= CAP::Math::twoPi() * gRandom->Rndm();
+  double eventAngle= CAP::Math::twoPi() * CAP::RandomStream::getRandomStream()->Rndm();
   Event * event = eventStreams[0];
   unsigned int nParticles = event->getNParticles();
   for (unsigned int iParticle = 0; iParticle < nParticles; iParticle++)
@@ -10,6 +10,7 @@
  *
  * *********************************************************************/
 #include "EventVertexRandomizerTask.hpp"
+#include "RandomStream.hpp"
 using CAP::EventVertexRandomizerTask;
 
 ClassImp(EventVertexRandomizerTask);
@@ -63,10 +64,11 @@ void EventVertexRandomizerTask::initialize()
 
 void EventVertexRandomizerTask::analyzeEvent()
 {
-  double eventX = gRandom->Gaus(rConversion*xAvg, rConversion*xRms);
-  double eventY = gRandom->Gaus(rConversion*yAvg, rConversion*yRms);
-  double eventZ = gRandom->Gaus(rConversion*zAvg, rConversion*zRms);
-  double eventT = gRandom->Gaus(tConversion*tAvg, tConversion*tRms);
+  TRandom * random = CAP::RandomStream::getRandomStream();
+  double eventX = random->Gaus(rConversion*xAvg, rConversion*xRms);
+  double eventY = random->Gaus(rConversion*yAvg, rConversion*yRms);
+  double eventZ = random->Gaus(rConversion*zAvg, rConversion*zRms);
+  double eventT = random->Gaus(tConversion*tAvg, tConversion*tRms);
   Event * event = eventStreams[0];
   unsigned int nParticles = event->getNParticles();
   for (unsigned int iParticle = 0; iParticle < nParticles; iParticle++)
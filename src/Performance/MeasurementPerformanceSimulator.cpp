@@ -23,6 +23,13 @@ allEventsUseSameFilters(true)
   appendClassName("MeasurementPerformanceSimulator");
 }
 
+CAP::Task * MeasurementPerformanceSimulator::clone() const
+{
+  MeasurementPerformanceSimulator * task = new MeasurementPerformanceSimulator(getName(),configuration);
+  configureClone(task);
+  return task;
+}
+
 void MeasurementPerformanceSimulator::setDefaultConfiguration()
 {
   EventTask::setDefaultConfiguration();
@@ -180,7 +187,6 @@ void MeasurementPerformanceSimulator::createEvent()
   unsigned int nParticles = genEvent.getNParticles();
   unsigned int firstPartFilter;
   unsigned int lastPartFilter;
-  LorentzVector recoMomentum;
   for (unsigned int iEventFilter=0; iEventFilter<nEventFilters; iEventFilter++ )
     {
     if (!eventFilters[iEventFilter]->accept(genEvent)) continue;
@@ -201,23 +207,25 @@ void MeasurementPerformanceSimulator::createEvent()
       {
       ParticleFilter  * particleFilter  = particleFilters[iParticleFilter];
       ParticlePerformanceSimulator * simulator = (ParticlePerformanceSimulator *) histogramManager.getGroup(0,iParticleFilter);
+      batchParticles.clear();
+      batchMomenta.clear();
       for (unsigned int iParticle=0; iParticle<nParticles; iParticle++)
         {
         Particle * genParticle = genEvent.getParticleAt(iParticle);
-        if (particleFilter->accept(*genParticle))
-          {
-          LorentzVector & genMomentum = genParticle->getMomentum();
-          if (!simulator->accept(genMomentum)) continue;
-          ParticleType * type = genParticle->getTypePtr();
-          LorentzVector & genPosition = genParticle->getPosition();
-          simulator->smearMomentum(genMomentum,recoMomentum);
-          Particle * recoParticle = particleFactory->getNextObject();
-          // we dont smear the position for now..
-          recoParticle->set(type,recoMomentum,genPosition,true);
-          recoParticle->setTruth(genParticle);
-          recoEvent.add(recoParticle);
-          } // particle accepted by filter
+        if (!particleFilter->accept(*genParticle)) continue;
+        batchParticles.push_back(genParticle);
+        batchMomenta.push_back(&genParticle->getMomentum());
         } //particle loop
+      simulator->acceptAndSmear(batchMomenta,batchAccepted,batchSmeared);
+      for (unsigned int iAccepted=0; iAccepted<batchAccepted.size(); iAccepted++)
+        {
+        Particle * genParticle = batchParticles[batchAccepted[iAccepted]];
+        Particle * recoParticle = particleFactory->getNextObject();
+        // we dont smear the position for now..
+        recoParticle->set(genParticle->getTypePtr(),batchSmeared[iAccepted],genParticle->getPosition(),true);
+        recoParticle->setTruth(genParticle);
+        recoEvent.add(recoParticle);
+        } // accepted particle loop
       } // particle filter loop
     } // event filter loop
 
@@ -55,7 +55,12 @@ public:
   //!DTOR
   //!
   virtual ~MeasurementPerformanceSimulator() {}
-  
+
+  //!
+  //! Returns a configured clone of this task used for multithreaded execution.
+  //!
+  virtual Task * clone() const;
+
   //!
   //! Sets the default  values of the configuration parameters used by this task
   //!
@@ -83,6 +88,11 @@ protected:
   bool  allEventsUseSameFilters;
   unsigned int nEventFilters;
   unsigned int nParticleFilters;
+
+  vector<Particle*>             batchParticles;  //!< particles of the current event accepted by the current particle filter
+  vector<const LorentzVector*>  batchMomenta;    //!< momenta of batchParticles
+  vector<unsigned int>          batchAccepted;   //!< indices, in batchParticles, of the particles accepted by the simulator
+  vector<LorentzVector>         batchSmeared;    //!< smeared momenta of the accepted particles
   ClassDef(MeasurementPerformanceSimulator,0)
 };
 
@@ -24,6 +24,13 @@ fillY(false)
   appendClassName("ParticlePerformanceAnalyzer");
 }
 
+CAP::Task * ParticlePerformanceAnalyzer::clone() const
+{
+  ParticlePerformanceAnalyzer * task = new ParticlePerformanceAnalyzer(getName(),configuration);
+  configureClone(task);
+  return task;
+}
+
 void ParticlePerformanceAnalyzer::setDefaultConfiguration()
 {
   Task::setDefaultConfiguration();
@@ -145,6 +152,7 @@ void ParticlePerformanceAnalyzer::analyzeEvent()
   Size_t nEventFilters    = eventFilters.size();
   Size_t nParticleFilters = particleFilters.size();
   Size_t nParticles      = recoEvent.getParticleCount();
+  fillParticleFilterMasks(recoEvent);
 
   for (Size_t iEventFilter=0; iEventFilter<nEventFilters; iEventFilter++ )
     {
@@ -160,7 +168,7 @@ void ParticlePerformanceAnalyzer::analyzeEvent()
       for (Size_t iParticleFilter=0; iParticleFilter<nParticleFilters; iParticleFilter++ )
         {
         //cout<< "ParticlePerformanceAnalyzer::analyzeEvent() -- 7 --" << endl;
-        if (particleFilters[iParticleFilter]->accept(recoParticle))
+        if (isAccepted(iParticle,iParticleFilter))
           {
           //cout<< "ParticlePerformanceAnalyzer::analyzeEvent() -- 8 --" << endl;
           histos->fill(recoParticle,1.0);
@@ -76,7 +76,12 @@ public:
   //!DTOR
   //!
   virtual ~ParticlePerformanceAnalyzer() {}
-  
+
+  //!
+  //! Returns a configured clone of this task used for multithreaded execution.
+  //!
+  virtual Task * clone() const;
+
   //!
   //! Sets the default  values of the configuration parameters used by this task
   //!
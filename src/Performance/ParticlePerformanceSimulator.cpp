@@ -11,6 +11,7 @@
  * *********************************************************************/
 // #include <TMath.h>
 #include "ParticlePerformanceSimulator.hpp"
+#include "RandomStream.hpp"
 using CAP::ParticlePerformanceSimulator;
 
 ClassImp(ParticlePerformanceSimulator);
@@ -31,9 +32,21 @@ biasEtaHistogram(),
 rmsEtaHistogram(),
 biasPhiHistogram(),
 rmsPhiHistogram(),
+efficienyHistogram(),
 ptFunction(),
 etaFunction(),
-phiFunction()
+phiFunction(),
+efficiencyFunction(),
+biasPtTable(),
+rmsPtTable(),
+biasEtaTable(),
+rmsEtaTable(),
+biasPhiTable(),
+rmsPhiTable(),
+efficiencyTable(),
+batchKinematics(),
+batchEfficiency(),
+batchResolution()
 {
   //  initialize();
 }
@@ -175,11 +188,10 @@ void ParticlePerformanceSimulator::initialize()
       break;
       
       case 2:
-      ptFunction  = nullptr;
-      etaFunction = nullptr;
-      phiFunction = nullptr;
+      efficiencyFunction = nullptr;
       break;
     }
+  compileTables();
 }
 
 void ParticlePerformanceSimulator::importHistograms(TFile & inputFile)
@@ -227,10 +239,22 @@ void ParticlePerformanceSimulator::importHistograms(TFile & inputFile)
       efficienyHistogram   = loadH1(inputFile,baseName+"_Eff");
       break;
     }
+  compileTables();
   if (reportEnd(__FUNCTION__))
     ;
 }
 
+void ParticlePerformanceSimulator::compileTables()
+{
+  biasPtTable.compile(biasPtHistogram);
+  rmsPtTable.compile(rmsPtHistogram);
+  biasEtaTable.compile(biasEtaHistogram);
+  rmsEtaTable.compile(rmsEtaHistogram);
+  biasPhiTable.compile(biasPhiHistogram);
+  rmsPhiTable.compile(rmsPhiHistogram);
+  efficiencyTable.compile(efficienyHistogram);
+}
+
 void ParticlePerformanceSimulator::smearMomentum(const LorentzVector &in, LorentzVector & out)
 {
   double smearedPt  = 0.0;
@@ -250,6 +274,7 @@ void ParticlePerformanceSimulator::smearMomentum(const LorentzVector &in, Lorent
 void ParticlePerformanceSimulator::smearMomentum(double pt, double eta, double phi,
                                                  double &smearedPt, double &smearedEta, double &smearedPhi)
 {
+  TRandom * random = CAP::RandomStream::getRandomStream();
   double bias;
   double rms;
   double zeroRms = 0.0001;
@@ -267,21 +292,24 @@ void ParticlePerformanceSimulator::smearMomentum(double pt, double eta, double p
       
       case 1:
       smearFromFunction(pt, eta, phi, ptFunction, bias, rms);
-      smearedPt  = gRandom->Gaus(pt+bias,rms);
+      smearedPt  = random->Gaus(pt+bias,rms);
       //cout << "pt:"<< pt<< " eta:" << eta << " phi:" << phi << " bias:" << bias << " rms:" << rms << " smearedPt" << smearedPt << endl;
       smearFromFunction(pt, eta, phi, etaFunction, bias, rms);
-      smearedEta = gRandom->Gaus(eta+bias,rms);
+      smearedEta = random->Gaus(eta+bias,rms);
       smearFromFunction(pt, eta, phi, phiFunction, bias, rms);
-      smearedPhi = gRandom->Gaus(phi+bias,rms);
+      smearedPhi = random->Gaus(phi+bias,rms);
       break;
       
       case 2:
-      smearFromHisto(pt, eta, phi, biasPtHistogram, rmsPtHistogram, bias, rms);
-      smearedPt = gRandom->Gaus(pt+bias,rms);
-      smearFromHisto(pt, eta, phi, biasEtaHistogram, rmsEtaHistogram, bias, rms);
-      smearedEta = gRandom->Gaus(eta+bias,rms);
-      smearFromHisto(pt, eta, phi, biasPhiHistogram, rmsPhiHistogram, bias, rms);
-      smearedPhi = gRandom->Gaus(phi+bias,rms);
+      bias = biasPtTable.getValue(pt,eta,phi);
+      rms  = rmsPtTable.getValue(pt,eta,phi);
+      smearedPt = random->Gaus(pt+bias,rms);
+      bias = biasEtaTable.getValue(pt,eta,phi);
+      rms  = rmsEtaTable.getValue(pt,eta,phi);
+      smearedEta = random->Gaus(eta+bias,rms);
+      bias = biasPhiTable.getValue(pt,eta,phi);
+      rms  = rmsPhiTable.getValue(pt,eta,phi);
+      smearedPhi = random->Gaus(phi+bias,rms);
       break;
     }
 }
@@ -290,37 +318,9 @@ void ParticlePerformanceSimulator::smearFromHisto(double pt, double eta, double
                                                   TH1 * biasHisto, TH1 * rmsHisto,
                                                   double & bias, double & rms)
 {
-  int bin;
-  if (biasHisto->IsA() == TH1::Class())
-    {
-    bin = biasHisto->FindBin(pt);
-    bias = biasHisto->GetBinContent(bin);
-    }
-  else  if (biasHisto->IsA() == TH2::Class())
-    {
-    bin = biasHisto->FindBin(pt,eta);
-    bias = biasHisto->GetBinContent(bin);
-    }
-  else if (biasHisto->IsA() == TH3::Class())
-    {
-    bin = biasHisto->FindBin(pt,eta,phi);
-    bias = biasHisto->GetBinContent(bin);
-    }
-  if (rmsHisto->IsA() == TH1::Class())
-    {
-    bin = rmsHisto->FindBin(pt);
-    rms = rmsHisto->GetBinContent(bin);
-    }
-  else  if (rmsHisto->IsA() == TH2::Class())
-    {
-    bin = rmsHisto->FindBin(pt,eta);
-    rms = rmsHisto->GetBinContent(bin);
-    }
-  else if (rmsHisto->IsA() == TH3::Class())
-    {
-    bin = rmsHisto->FindBin(pt,eta,phi);
-    rms = rmsHisto->GetBinContent(bin);
-    }
+  // FindBin ignores the coordinates beyond the dimension of the histogram
+  bias = biasHisto->GetBinContent(biasHisto->FindBin(pt,eta,phi));
+  rms  = rmsHisto->GetBinContent(rmsHisto->FindBin(pt,eta,phi));
 }
 
 void ParticlePerformanceSimulator::smearFromFunction(double pt, double eta, double phi,
@@ -376,25 +376,9 @@ bool ParticlePerformanceSimulator::accept(double pt, double eta, double phi)
 
 bool ParticlePerformanceSimulator::acceptFromHisto(double pt, double eta, double phi)
 {
-  int bin;
-  double efficiency = 1.0;
   bool   accepting  = false;
-  if (efficienyHistogram->IsA() == TH1::Class())
-    {
-    bin = efficienyHistogram->FindBin(pt);
-    efficiency = efficienyHistogram->GetBinContent(bin);
-    }
-  else  if (efficienyHistogram->IsA() == TH2::Class())
-    {
-    bin = efficienyHistogram->FindBin(pt,eta);
-    efficiency = efficienyHistogram->GetBinContent(bin);
-    }
-  else if (efficienyHistogram->IsA() == TH3::Class())
-    {
-    bin = efficienyHistogram->FindBin(pt,eta,phi);
-    efficiency = efficienyHistogram->GetBinContent(bin);
-    }
-  if (gRandom->Rndm()<efficiency) accepting = true;
+  double efficiency = efficiencyTable.getValue(pt,eta,phi);
+  if (CAP::RandomStream::getRandomStream()->Rndm()<efficiency) accepting = true;
   return accepting;
 }
 
@@ -402,8 +386,91 @@ bool ParticlePerformanceSimulator::acceptFromFunction(double pt, double eta, dou
 {
   bool   accepting  = false;
   double efficiency = efficiencyFunction->getEfficiency(pt,eta,phi);
-  if (gRandom->Rndm()<efficiency) accepting = true;
+  if (CAP::RandomStream::getRandomStream()->Rndm()<efficiency) accepting = true;
   return accepting;
 }
 
+void ParticlePerformanceSimulator::acceptAndSmear(const vector<const LorentzVector*> & momenta,
+                                                  vector<unsigned int> & accepted,
+                                                  vector<LorentzVector> & smeared)
+{
+  accepted.clear();
+  smeared.clear();
+  unsigned int n = momenta.size();
+  if (n<1) return;
+
+  batchKinematics.resize(4*n);
+  double * pt   = batchKinematics.data();
+  double * eta  = pt  + n;
+  double * phi  = eta + n;
+  double * mass = phi + n;
+  for (unsigned int i=0; i<n; i++)
+    {
+    const LorentzVector & momentum = *momenta[i];
+    pt[i]   = momentum.Pt();
+    eta[i]  = momentum.Eta();
+    phi[i]  = momentum.Phi();
+    mass[i] = momentum.M();
+    }
+
+  // response of all the momenta: no random numbers are drawn here.
+  batchEfficiency.resize(n);
+  double * efficiency = batchEfficiency.data();
+  switch (efficiencyOption)
+    {
+      default:
+      case 0: break;
+      case 1: for (unsigned int i=0; i<n; i++) efficiency[i] = efficiencyFunction->getEfficiency(pt[i],eta[i],phi[i]); break;
+      case 2: efficiencyTable.getValues(n,pt,eta,phi,efficiency); break;
+    }
+  batchResolution.resize(6*n);
+  double * biasPt  = batchResolution.data();
+  double * rmsPt   = biasPt  + n;
+  double * biasEta = rmsPt   + n;
+  double * rmsEta  = biasEta + n;
+  double * biasPhi = rmsEta  + n;
+  double * rmsPhi  = biasPhi + n;
+  switch (resolutionOption)
+    {
+      default:
+      case 0: break;
+      case 1:
+      for (unsigned int i=0; i<n; i++)
+        {
+        smearFromFunction(pt[i], eta[i], phi[i], ptFunction,  biasPt[i],  rmsPt[i]);
+        smearFromFunction(pt[i], eta[i], phi[i], etaFunction, biasEta[i], rmsEta[i]);
+        smearFromFunction(pt[i], eta[i], phi[i], phiFunction, biasPhi[i], rmsPhi[i]);
+        }
+      break;
+      case 2:
+      biasPtTable.getValues(n,pt,eta,phi,biasPt);
+      rmsPtTable.getValues(n,pt,eta,phi,rmsPt);
+      biasEtaTable.getValues(n,pt,eta,phi,biasEta);
+      rmsEtaTable.getValues(n,pt,eta,phi,rmsEta);
+      biasPhiTable.getValues(n,pt,eta,phi,biasPhi);
+      rmsPhiTable.getValues(n,pt,eta,phi,rmsPhi);
+      break;
+    }
 
+  // random numbers, drawn in the order of accept() and smearMomentum() called momentum by momentum
+  TRandom * random = CAP::RandomStream::getRandomStream();
+  bool drawEfficiency = efficiencyOption==1 || efficiencyOption==2;
+  bool drawResolution = resolutionOption==1 || resolutionOption==2;
+  for (unsigned int i=0; i<n; i++)
+    {
+    if (drawEfficiency && !(random->Rndm()<efficiency[i])) continue;
+    double smearedPt  = pt[i];
+    double smearedEta = eta[i];
+    double smearedPhi = phi[i];
+    if (drawResolution)
+      {
+      smearedPt  = random->Gaus(pt[i]+biasPt[i],rmsPt[i]);
+      smearedEta = random->Gaus(eta[i]+biasEta[i],rmsEta[i]);
+      smearedPhi = random->Gaus(phi[i]+biasPhi[i],rmsPhi[i]);
+      }
+    if (smearedPt<0.001) smearedPt = 0.001;
+    accepted.push_back(i);
+    smeared.emplace_back();
+    smeared.back().SetPtEtaPhiM(smearedPt,smearedEta,smearedPhi,mass[i]);
+    }
+}
@@ -12,6 +12,7 @@
 #ifndef CAP__ParticlePerformanceSimulator
 #define CAP__ParticlePerformanceSimulator
 #include "HistogramGroup.hpp"
+#include "ResponseTable.hpp"
 
 namespace CAP
 {
@@ -27,6 +28,8 @@ class ResolutionFunction;
 //!functions are used to compute resolution parameters (bias and rms) of particles. Subclass this class to add
 //!particle types as needed. 
 //!
+//!Response histograms (resolutionOption=2, efficiencyOption=2) are copied into ResponseTable lookup tables once they are loaded
+//!(compileTables), so the response of a particle is found without going through the histograms.
 //!
 class ParticlePerformanceSimulator : public HistogramGroup
 {
@@ -41,6 +44,12 @@ public:
   virtual void initialize();
   virtual void importHistograms(TFile & inputFile);
 
+  //!
+  //! Copy the response histograms into the lookup tables used by smearMomentum(), accept(), and acceptAndSmear().
+  //! Called by importHistograms(); call it again if the histograms are replaced.
+  //!
+  virtual void compileTables();
+
   virtual void smearMomentum(const LorentzVector &in, LorentzVector & out);
   virtual void smearMomentum(double pt, double eta, double phi,
                              double &smearedPt, double &smearedEta, double &smearedPhi);
@@ -55,7 +64,15 @@ public:
   bool accept(double pt, double eta, double phi);
   bool acceptFromHisto(double pt, double eta, double phi);
   bool acceptFromFunction(double pt, double eta, double phi);
-  
+
+  //!
+  //! Accept and smear the given momenta. The indices of the accepted momenta are returned in accepted and their smeared momenta
+  //! in smeared. The response of all the momenta is looked up first, then the random numbers are drawn momentum by momentum in the
+  //! order accept() and smearMomentum() draw them, so the results are identical to calling these for each momentum in turn.
+  //!
+  void acceptAndSmear(const vector<const LorentzVector*> & momenta,
+                      vector<unsigned int> & accepted,
+                      vector<LorentzVector> & smeared);
   
 protected:
   
@@ -77,6 +94,18 @@ protected:
   ResolutionFunction* etaFunction;
   ResolutionFunction* phiFunction;
   EfficiencyFunction* efficiencyFunction;
+
+  ResponseTable biasPtTable;
+  ResponseTable rmsPtTable;
+  ResponseTable biasEtaTable;
+  ResponseTable rmsEtaTable;
+  ResponseTable biasPhiTable;
+  ResponseTable rmsPhiTable;
+  ResponseTable efficiencyTable;
+
+  vector<double> batchKinematics;   //!< pt, eta, phi, and mass of the momenta of acceptAndSmear()
+  vector<double> batchEfficiency;   //!< efficiency of the momenta of acceptAndSmear()
+  vector<double> batchResolution;   //!< bias and rms of pt, eta, and phi of the momenta of acceptAndSmear()
   
   ClassDef(ParticlePerformanceSimulator,0)
 };
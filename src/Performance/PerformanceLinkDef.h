@@ -5,6 +5,7 @@
 #pragma link C++ class CAP::ParticlePerformanceAnalyzer+;
 #pragma link C++ class CAP::ParticlePerformanceHistos+;
 #pragma link C++ class CAP::ParticlePerformanceSimulator+;
+#pragma link C++ class CAP::ResponseTable+;
 #pragma link C++ class CAP::MeasurementPerformanceSimulator+;
 #pragma link C++ class CAP::ClosureCalculator+;
 #pragma link C++ class CAP::ClosureIterator+;
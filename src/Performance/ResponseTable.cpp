@@ -0,0 +1,82 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#include "ResponseTable.hpp"
+using CAP::ResponseTable;
+
+ClassImp(ResponseTable);
+
+ResponseTable::ResponseTable()
+:
+nDimensions(0),
+contents()
+{
+  clear();
+}
+
+void ResponseTable::clear()
+{
+  nDimensions = 0;
+  for (int iAxis=0; iAxis<3; iAxis++)
+    {
+    stride[iAxis]            = 0;
+    axes[iAxis].nBins        = 1;
+    axes[iAxis].minimum      = 0.0;
+    axes[iAxis].maximum      = 0.0;
+    axes[iAxis].inverseWidth = 0.0;
+    axes[iAxis].edges.clear();
+    }
+  contents.clear();
+}
+
+void ResponseTable::compile(const TH1 * histogram)
+{
+  clear();
+  if (!histogram) return;
+  nDimensions = histogram->GetDimension();
+  const TAxis * histogramAxes[3] = { histogram->GetXaxis(), histogram->GetYaxis(), histogram->GetZaxis() };
+  int nCells = 1;
+  for (int iAxis=0; iAxis<nDimensions; iAxis++)
+    {
+    const TAxis & histogramAxis = *histogramAxes[iAxis];
+    Axis & axis = axes[iAxis];
+    axis.nBins   = histogramAxis.GetNbins();
+    axis.minimum = histogramAxis.GetXmin();
+    axis.maximum = histogramAxis.GetXmax();
+    axis.inverseWidth = double(axis.nBins)/(axis.maximum-axis.minimum);
+    const TArrayD & edges = *histogramAxis.GetXbins();
+    if (edges.fN>0) axis.edges.assign(edges.GetArray(),edges.GetArray()+edges.fN);
+    stride[iAxis] = nCells;
+    nCells *= axis.nBins+2;
+    }
+  contents.resize(nCells);
+  for (int bin=0; bin<nCells; bin++) contents[bin] = histogram->GetBinContent(bin);
+}
+
+void ResponseTable::getValues(unsigned int n, const double * pt, const double * eta, const double * phi, double * values) const
+{
+  const double * data = contents.data();
+  switch (nDimensions)
+    {
+      case 1:
+      for (unsigned int i=0; i<n; i++) values[i] = data[axes[0].findBin(pt[i])];
+      break;
+
+      case 2:
+      for (unsigned int i=0; i<n; i++) values[i] = data[axes[0].findBin(pt[i]) + stride[1]*axes[1].findBin(eta[i])];
+      break;
+
+      case 3:
+      for (unsigned int i=0; i<n; i++)
+        values[i] = data[axes[0].findBin(pt[i]) + stride[1]*axes[1].findBin(eta[i]) + stride[2]*axes[2].findBin(phi[i])];
+      break;
+    }
+}
@@ -0,0 +1,100 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#ifndef CAP__ResponseTable
+#define CAP__ResponseTable
+#include <vector>
+#include <algorithm>
+#include "TH1.h"
+using namespace std;
+
+namespace CAP
+{
+
+//!
+//! Flat copy of a 1D, 2D, or 3D detector response histogram (efficiency, bias, or rms vs pt, eta, phi) used to look up the response
+//! of particles without the virtual FindBin/GetBinContent calls of the histogram. The contents, including the underflow and
+//! overflow bins, are stored in the global bin order of the histogram, and each axis keeps its range and inverse bin width so the bin
+//! of a value is found with one multiplication.
+//!
+//! Lookups return exactly the value GetBinContent(FindBin(pt,eta,phi)) returns: values that fall within 1e-9 of a bin edge, where the
+//! multiplication by the inverse width and the division used by TAxis::FindBin may round differently, are binned with the
+//! TAxis::FindBin expression, and axes with variable bins are binned by binary search of the bin edges.
+//!
+class ResponseTable
+{
+public:
+
+  ResponseTable();
+  virtual ~ResponseTable() {}
+
+  //!
+  //! Copy the axes and contents of the given histogram. A null histogram clears the table.
+  //!
+  void compile(const TH1 * histogram);
+  void clear();
+
+  bool isCompiled() const { return nDimensions>0; }
+  int  getNDimensions() const { return nDimensions; }
+
+  //!
+  //! Value of the bin of the given point. Coordinates beyond the dimension of the table are ignored.
+  //!
+  inline double getValue(double pt, double eta, double phi) const
+  {
+  int bin = axes[0].findBin(pt);
+  if (nDimensions>1) bin += stride[1]*axes[1].findBin(eta);
+  if (nDimensions>2) bin += stride[2]*axes[2].findBin(phi);
+  return contents[bin];
+  }
+
+  //!
+  //! Values of the bins of n points.
+  //!
+  void getValues(unsigned int n, const double * pt, const double * eta, const double * phi, double * values) const;
+
+protected:
+
+  struct Axis
+  {
+    int    nBins;
+    double minimum;
+    double maximum;
+    double inverseWidth;
+    vector<double> edges;   //!< bin edges of axes with variable bins, empty for axes with fixed bins
+
+    //!
+    //! Same as TAxis::FindBin(x) for axes that cannot be extended.
+    //!
+    inline int findBin(double x) const
+    {
+    if (x<minimum) return 0;
+    if (!(x<maximum)) return nBins+1;   // overflow and NaN
+    if (!edges.empty()) return int(std::upper_bound(edges.begin(),edges.end(),x)-edges.begin());
+    double u = (x-minimum)*inverseWidth;
+    int bin = int(u);
+    double f = u - bin;
+    if (f<1.0E-9 || f>1.0-1.0E-9) bin = int(nBins*(x-minimum)/(maximum-minimum));
+    return 1+bin;
+    }
+  };
+
+  int    nDimensions;
+  int    stride[3];
+  Axis   axes[3];
+  vector<double> contents;
+
+  ClassDef(ResponseTable,0)
+};
+
+} // namespace CAP
+
+#endif /* CAP__ResponseTable */
@@ -11,6 +11,7 @@
  * *********************************************************************/
 #include "StatStudyModel.hpp"
 #include "TRandom.h"
+#include "RandomStream.hpp"
 using CAP::StatStudyModel;
 
 ClassImp(StatStudyModel);
@@ -40,29 +41,51 @@ StatStudyModel::~StatStudyModel()
 
 void StatStudyModel::generate(double & nPlus, double & nMinus, double & nPlusEff, double & nMinusEff)
 {
+  TRandom * random = CAP::RandomStream::getRandomStream();
    double nPlusPlus;
    double nPlusMinus;
    double nMinusMinus;
 
-  nPlus       = int( gRandom->Gaus(nPlusAvg,sqrt(nPlusAvg))    +0.5        );
-  nMinus      = int( gRandom->Gaus(nMinusAvg,sqrt(nMinusAvg))     +0.5     );
-  nPlusPlus   = int( gRandom->Gaus(nPlusPlusAvg,sqrt(nPlusPlusAvg)) +0.5   );
-  nPlusMinus  = int( gRandom->Gaus(nPlusMinusAvg,sqrt(nPlusMinusAvg))+0.5  );
-  nMinusMinus = int( gRandom->Gaus(nMinusMinusAvg,sqrt(nMinusMinusAvg))+0.5);
+  nPlus       = int( random->Gaus(nPlusAvg,sqrt(nPlusAvg))    +0.5        );
+  nMinus      = int( random->Gaus(nMinusAvg,sqrt(nMinusAvg))     +0.5     );
+  nPlusPlus   = int( random->Gaus(nPlusPlusAvg,sqrt(nPlusPlusAvg)) +0.5   );
+  nPlusMinus  = int( random->Gaus(nPlusMinusAvg,sqrt(nPlusMinusAvg))+0.5  );
+  nMinusMinus = int( random->Gaus(nMinusMinusAvg,sqrt(nMinusMinusAvg))+0.5);
+  // the particles of each source are lost with the efficiency of their charge
+  int nKept1;
+  int nKept2;
+  nPlusEff   = binomialLoss(nPlus,plusEfficiency);
+  nMinusEff  = binomialLoss(nMinus,minusEfficiency);
+  pairLoss(nPlusPlus,plusEfficiency,plusEfficiency,nKept1,nKept2);
+  nPlusEff  += nKept1 + nKept2;
+  pairLoss(nMinusMinus,minusEfficiency,minusEfficiency,nKept1,nKept2);
+  nMinusEff += nKept1 + nKept2;
+  pairLoss(nPlusMinus,plusEfficiency,minusEfficiency,nKept1,nKept2);
+  nPlusEff  += nKept1;
+  nMinusEff += nKept2;
   nPlus  += 2.0*nPlusPlus;
   nPlus  += nPlusMinus;
   nMinus += 2.0*nMinusMinus;
   nMinus += nPlusMinus;
-  nPlusEff   = binomialLoss(nPlus,plusEfficiency);
-  nMinusEff  = binomialLoss(nMinus,minusEfficiency);
 }
 
 int StatStudyModel::binomialLoss(int nIn, double efficiency)
 {
-  int nOut = 0;
-  for (int n=0; n<nIn; n++)
-    {
-    if (gRandom->Rndm()<efficiency) nOut++;
-    }
-  return nOut;
+  return int(CAP::RandomStream::getRandomStream()->binomial(nIn,efficiency));
+}
+
+void StatStudyModel::pairLoss(int nPairs, double efficiency1, double efficiency2, int & nKept1, int & nKept2)
+{
+  // outcomes of a pair: both particles kept, only the first, only the second, none
+  double probabilities[4] =
+  {
+    efficiency1*efficiency2,
+    efficiency1*(1.0-efficiency2),
+    (1.0-efficiency1)*efficiency2,
+    (1.0-efficiency1)*(1.0-efficiency2)
+  };
+  long counts[4];
+  CAP::RandomStream::getRandomStream()->multinomial(nPairs,4,probabilities,counts);
+  nKept1 = int(counts[0]+counts[1]);
+  nKept2 = int(counts[0]+counts[2]);
 }
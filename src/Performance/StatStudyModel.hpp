@@ -30,8 +30,19 @@ public:
                  long   nEventsReq=100000);
   virtual ~StatStudyModel();
   void generate(double & nPlus, double & nMinus, double & nPlusEff, double & nMinusEff);
+
+  //!
+  //! Number of particles, out of nIn, that survive the given efficiency (binomial sampling, see RandomStream::binomial).
+  //!
   int binomialLoss(int nIn, double efficiency);
 
+  //!
+  //! Numbers of first and second particles, out of nPairs pairs, that survive the efficiencies of their species. The outcomes of
+  //! the pairs (both particles kept, only the first, only the second, none) are sampled in one multinomial draw (see
+  //! RandomStream::multinomial).
+  //!
+  void pairLoss(int nPairs, double efficiency1, double efficiency2, int & nKept1, int & nKept2);
+
   
   // Data Members
 
@@ -0,0 +1,385 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include "TROOT.h"
+#include "TSystem.h"
+#include "TNamed.h"
+#include "TKey.h"
+#include "HistogramCollection.hpp"
+#include "HierarchicalMerger.hpp"
+using CAP::HierarchicalMerger;
+
+ClassImp(HierarchicalMerger);
+
+namespace
+{
+std::mutex ioMutex;
+
+CAP::String joinFileNames(const CAP::VectorString & names)
+{
+  CAP::String joined;
+  for (auto & name : names)
+    {
+    joined += name;
+    joined += "\n";
+    }
+  return joined;
+}
+
+}
+
+HierarchicalMerger::HierarchicalMerger(const String & _name,
+                                       const Configuration & _configuration)
+:
+Task(_name,_configuration),
+mergePath(),
+appendedString("Merged"),
+fanIn(8),
+nThreads(1),
+maximumDepth(2),
+skipBadInputs(true),
+removeIntermediate(true)
+{
+  appendClassName("HierarchicalMerger");
+}
+
+void HierarchicalMerger::setDefaultConfiguration()
+{
+  Task::setDefaultConfiguration();
+  String none  = "none";
+  addParameter("HistogramsImportPath",   none);
+  addParameter("HistogramsExportPath",   none);
+  addParameter("HistogramsExportFile",   none);
+  addParameter("AppendedString",         TString("Merged"));
+  addParameter("MergePath",              none);
+  addParameter("MaximumDepth",           2);
+  addParameter("FanIn",                  8);
+  addParameter("nThreads",               1);
+  addParameter("SkipBadInputs",          true);
+  addParameter("RemoveIntermediate",     true);
+  generateKeyValuePairs("IncludedPattern",none,20);
+  generateKeyValuePairs("ExcludedPattern",none,20);
+}
+
+void HierarchicalMerger::configure()
+{
+  Task::configure();
+  setSeverity();
+  histosImportPath    = getValueString("HistogramsImportPath");
+  histosExportPath    = getValueString("HistogramsExportPath");
+  histosExportFile    = getValueString("HistogramsExportFile");
+  appendedString      = getValueString("AppendedString");
+  mergePath           = getValueString("MergePath");
+  maximumDepth        = getValueInt(   "MaximumDepth");
+  fanIn               = getValueInt(   "FanIn");
+  nThreads            = getValueInt(   "nThreads");
+  skipBadInputs       = getValueBool(  "SkipBadInputs");
+  removeIntermediate  = getValueBool(  "RemoveIntermediate");
+  if (histosExportFile.EqualTo("none")) histosExportFile = getName()+appendedString;
+  if (mergePath.EqualTo("none"))        mergePath = histosExportPath+"/"+getName()+appendedString+"Checkpoints/";
+  if (!mergePath.EndsWith("/"))         mergePath += "/";
+  if (fanIn<2)    fanIn    = 2;
+  if (nThreads<1) nThreads = 1;
+}
+
+void HierarchicalMerger::execute()
+{
+  String none  = "none";
+  VectorString includePatterns = getSelectedValues("IncludedPattern",none);
+  VectorString excludePatterns = getSelectedValues("ExcludedPattern",none);
+  VectorString selectedFiles   = listFilesInDir(histosImportPath,includePatterns,excludePatterns,true,false,maximumDepth,0);
+  VectorString inputs;
+  for (auto & fileName : selectedFiles)
+    {
+    // never merge the checkpoints or the output of a previous merge
+    if (fileName.Contains(mergePath) || fileName.Contains(histosExportFile)) continue;
+    inputs.push_back(fileName);
+    }
+  std::sort(inputs.begin(),inputs.end());
+  if (reportInfo(__FUNCTION__))
+    {
+    cout << endl;
+    printItem("HistogramsImportPath", histosImportPath);
+    printItem("HistogramsExportPath", histosExportPath);
+    printItem("HistogramsExportFile", histosExportFile);
+    printItem("MergePath",            mergePath);
+    printItem("FanIn",                fanIn);
+    printItem("nThreads",             nThreads);
+    printItem("SkipBadInputs",        skipBadInputs);
+    printItem("nInputs",              int(inputs.size()));
+    cout << endl;
+    }
+  if (inputs.size()<1) throw TaskException("No file selected for merging","HierarchicalMerger::execute()");
+  gSystem->mkdir(mergePath,1);
+  ROOT::EnableThreadSafety();
+
+  VectorString levelInputs = inputs;
+  VectorString intermediateFiles;
+  Counters previousTotal;
+  int level = 0;
+  do
+    {
+    int nNodes = (levelInputs.size()+fanIn-1)/fanIn;
+    VectorString     outputs(nNodes);
+    vector<Counters> counters(nNodes);
+    std::atomic<int>  nNodesClaimed(0);
+    std::atomic<int>  nResumed(0);
+    std::atomic<bool> done(false);
+    int nWorkers = std::min(nThreads,nNodes);
+    vector<std::exception_ptr> exceptions(nWorkers);
+    for (int iNode=0; iNode<nNodes; iNode++) outputs[iNode] = getNodeFileName(level,iNode);
+    auto run = [&](int iWorker)
+    {
+    try
+      {
+      int iNode;
+      while (!done && (iNode = nNodesClaimed++) < nNodes)
+        {
+        unsigned int first = iNode*fanIn;
+        unsigned int last  = std::min(first+fanIn,(unsigned int) levelInputs.size());
+        VectorString nodeInputs(levelInputs.begin()+first,levelInputs.begin()+last);
+        if (loadCheckpoint(outputs[iNode],nodeInputs,counters[iNode]))
+          {
+          nResumed++;
+          continue;
+          }
+        // only the grid outputs may be skipped: intermediate files are verified when written
+        counters[iNode] = mergeNode(nodeInputs,outputs[iNode],skipBadInputs && level==0);
+        }
+      }
+    catch (...)
+      {
+      exceptions[iWorker] = std::current_exception();
+      done = true;
+      }
+    };
+    vector<std::thread> threads;
+    for (int iWorker=1; iWorker<nWorkers; iWorker++) threads.emplace_back(run,iWorker);
+    run(0);
+    for (auto & thread : threads) thread.join();
+    for (int iWorker=0; iWorker<nWorkers; iWorker++)
+      {
+      if (exceptions[iWorker]) std::rethrow_exception(exceptions[iWorker]);
+      }
+
+    Counters total = counters[0];
+    for (int iNode=1; iNode<nNodes; iNode++) total.add(counters[iNode]);
+    if (level>0 && !(total==previousTotal))
+      {
+      if (reportError(__FUNCTION__))
+        cout << "Level " << level << " counts " << total.nEventsProcessed << " events instead of " << previousTotal.nEventsProcessed << endl;
+      throw TaskException("Event counters differ from those of the previous level","HierarchicalMerger::execute()");
+      }
+    if (reportInfo(__FUNCTION__))
+      {
+      cout << endl;
+      printItem("Level",            level);
+      printItem("nInputs",          int(levelInputs.size()));
+      printItem("nNodes",           nNodes);
+      printItem("nNodes resumed",   int(nResumed));
+      printItem("nInputs skipped",  total.nInputsSkipped);
+      printItem("nEventsProcessed", total.nEventsProcessed);
+      cout << endl;
+      }
+    previousTotal = total;
+    intermediateFiles.insert(intermediateFiles.end(),outputs.begin(),outputs.end());
+    levelInputs = outputs;
+    level++;
+    }
+  while (levelInputs.size()>1);
+
+  if (histosExportPath.Length()>2) gSystem->mkdir(histosExportPath,1);
+  String outputFileName = histosExportPath;
+  if (!outputFileName.EndsWith("/")) outputFileName += "/";
+  outputFileName += histosExportFile;
+  if (!outputFileName.EndsWith(".root")) outputFileName += ".root";
+  if (gSystem->CopyFile(levelInputs[0],outputFileName,kTRUE)!=0)
+    throw FileException(outputFileName,"Merged file could not be written","HierarchicalMerger::execute()");
+  if (removeIntermediate)
+    {
+    for (auto & fileName : intermediateFiles) gSystem->Unlink(fileName);
+    gSystem->Unlink(mergePath);
+    }
+  if (reportInfo(__FUNCTION__))
+    {
+    cout << endl;
+    printItem("Merged file",      outputFileName);
+    printItem("nLevels",          level);
+    printItem("nEventsProcessed", previousTotal.nEventsProcessed);
+    printItem("nInputs skipped",  previousTotal.nInputsSkipped);
+    cout << endl;
+    }
+}
+
+CAP::String HierarchicalMerger::getNodeFileName(int level, int node) const
+{
+  return mergePath + getName() + appendedString + Form("_L%02d_N%05d.root",level,node);
+}
+
+HierarchicalMerger::Counters HierarchicalMerger::readCounters(TFile & inputFile)
+{
+  Counters counters;
+  try
+    {
+    counters.nEventsProcessed = readParameter(inputFile,"nTaskExecuted");
+    }
+  catch (...)
+    {
+    counters.nEventsProcessed = readParameter(inputFile,"taskExecuted");
+    }
+  int nEventFilters = readParameter(inputFile,"nEventFilters");
+  for (int iFilter=0; iFilter<nEventFilters; iFilter++)
+    {
+    String parameterName = "EventFilter";
+    parameterName += iFilter;
+    counters.nEventsAccepted.push_back(readParameter(inputFile,parameterName));
+    }
+  // only the intermediate files of a merge record the inputs skipped
+  TParameter<Long64_t> * nSkipped = (TParameter<Long64_t> *) inputFile.Get("MergeNSkipped");
+  counters.nInputsSkipped = nSkipped ? nSkipped->GetVal() : 0;
+  delete nSkipped;
+  return counters;
+}
+
+bool HierarchicalMerger::loadCheckpoint(const String & outputFileName, const VectorString & inputs, Counters & counters)
+{
+  if (gSystem->AccessPathName(outputFileName)) return false;
+  TFile * outputFile = TFile::Open(outputFileName,"READ");
+  bool complete = false;
+  if (outputFile && outputFile->IsOpen() && !outputFile->IsZombie())
+    {
+    TNamed * mergeInputs = (TNamed*) outputFile->Get("MergeInputs");
+    if (mergeInputs && joinFileNames(inputs).EqualTo(mergeInputs->GetTitle()))
+      {
+      try
+        {
+        counters = readCounters(*outputFile);
+        complete = true;
+        }
+      catch (...)
+        {
+        complete = false;
+        }
+      }
+    delete mergeInputs;
+    }
+  delete outputFile;
+  if (!complete)
+    {
+    std::lock_guard<std::mutex> lock(ioMutex);
+    if (reportWarning(__FUNCTION__)) cout << "Checkpoint " << outputFileName << " is stale and will be rewritten" << endl;
+    }
+  return complete;
+}
+
+HierarchicalMerger::Counters HierarchicalMerger::mergeNode(const VectorString & inputs, const String & outputFileName, bool allowSkip)
+{
+  TFile * sumFile = nullptr;
+  HistogramCollection * sumCollection = nullptr;
+  Counters sumCounters;
+  long nSkipped = 0;
+  for (auto & inputFileName : inputs)
+    {
+    TFile * inputFile = nullptr;
+    HistogramCollection * collection = nullptr;
+    try
+      {
+      inputFile = openRootFile("",inputFileName,"READ");
+      Counters counters = readCounters(*inputFile);
+      if (sumCollection && counters.nEventsAccepted.size()!=sumCounters.nEventsAccepted.size())
+        throw FileException(inputFileName,"Number of event filters differs from that of the other inputs","HierarchicalMerger::mergeNode()");
+      collection = new HistogramCollection(inputFileName,getSeverityLevel());
+      collection->loadCollection(*inputFile);
+      if (sumCollection && !sumCollection->sameSizeAs(*collection))
+        throw FileException(inputFileName,"Number of histograms differs from that of the other inputs","HierarchicalMerger::mergeNode()");
+      if (!sumCollection)
+        {
+        // the histograms of the first input accumulate the sum. They are deleted when its file is closed.
+        sumFile       = inputFile;
+        sumCollection = collection;
+        sumCounters   = counters;
+        continue;
+        }
+      sumCollection->add(*collection,1.0);
+      sumCounters.add(counters);
+      }
+    catch (...)
+      {
+      if (collection!=sumCollection) delete collection;
+      if (inputFile && inputFile!=sumFile) { inputFile->Close(); delete inputFile; }
+      if (!allowSkip)
+        {
+        if (sumFile) { sumFile->Close(); delete sumFile; }
+        if (sumCollection) { sumCollection->setOwnership(0); delete sumCollection; }
+        throw;
+        }
+      std::lock_guard<std::mutex> lock(ioMutex);
+      if (reportWarning(__FUNCTION__)) cout << "Skipping unreadable or inconsistent file: " << inputFileName << endl;
+      nSkipped++;
+      continue;
+      }
+    delete collection;
+    inputFile->Close();
+    delete inputFile;
+    }
+  if (!sumCollection) throw TaskException("No readable input for "+outputFileName,"HierarchicalMerger::mergeNode()");
+  sumCounters.nInputsSkipped += nSkipped;
+
+  // written under a temporary name so an interrupted merge never leaves an incomplete checkpoint
+  String partialFileName = outputFileName;
+  partialFileName.ReplaceAll(".root",".part.root");
+  TFile * outputFile = openRootFile("",partialFileName,"RECREATE");
+  writeParameter(*outputFile,"taskExecuted",sumCounters.nEventsProcessed);
+  writeParameter(*outputFile,"nEventFilters",sumCounters.nEventsAccepted.size());
+  for (unsigned int iFilter=0; iFilter<sumCounters.nEventsAccepted.size(); iFilter++)
+    {
+    String parameterName = "EventFilter";
+    parameterName += iFilter;
+    writeParameter(*outputFile,parameterName,sumCounters.nEventsAccepted[iFilter]);
+    }
+  writeParameter(*outputFile,"MergeNSkipped",sumCounters.nInputsSkipped);
+  outputFile->cd();
+  TNamed("MergeInputs",joinFileNames(inputs).Data()).Write();
+  sumCollection->exportHistograms(*outputFile);
+  outputFile->Close();
+  delete outputFile;
+  sumFile->Close();
+  delete sumFile;
+  sumCollection->setOwnership(0);
+  delete sumCollection;
+
+  outputFile = openRootFile("",partialFileName,"READ");
+  Counters written = readCounters(*outputFile);
+  outputFile->Close();
+  delete outputFile;
+  if (!(written==sumCounters))
+    throw FileException(partialFileName,"Event counters read back differ from those written","HierarchicalMerger::mergeNode()");
+  if (gSystem->Rename(partialFileName,outputFileName)!=0)
+    throw FileException(outputFileName,"Checkpoint could not be renamed","HierarchicalMerger::mergeNode()");
+  return sumCounters;
+}
+
+void HierarchicalMerger::Counters::add(const Counters & counters)
+{
+  nEventsProcessed += counters.nEventsProcessed;
+  nInputsSkipped   += counters.nInputsSkipped;
+  for (unsigned int iFilter=0; iFilter<nEventsAccepted.size() && iFilter<counters.nEventsAccepted.size(); iFilter++)
+    nEventsAccepted[iFilter] += counters.nEventsAccepted[iFilter];
+}
+
+bool HierarchicalMerger::Counters::operator==(const Counters & counters) const
+{
+  return nEventsProcessed==counters.nEventsProcessed && nEventsAccepted==counters.nEventsAccepted && nInputsSkipped==counters.nInputsSkipped;
+}
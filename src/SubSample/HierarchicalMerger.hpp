@@ -0,0 +1,117 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#ifndef CAP__HierarchicalMerger
+#define CAP__HierarchicalMerger
+#include "Task.hpp"
+using namespace std;
+
+namespace CAP
+{
+
+//!\brief Merge (sum) the histogram files produced by many grid jobs with a k-ary reduction tree
+//!
+//!\details
+//!# HierarchicalMerger
+//!
+//!The input files are selected in the folder HistogramsImportPath (and its sub-folders down to MaximumDepth, typically the bunch and
+//!sub-bunch folders) with the IncludedPattern# and ExcludedPattern# parameters. The files are sorted by name and merged by groups of FanIn
+//!files into intermediate files, which are in turn merged by groups of FanIn files, and so on until a single file remains. It is copied to
+//!HistogramsExportPath/HistogramsExportFile. The nodes of a level are merged concurrently by nThreads workers. Each worker holds at most
+//!two collections of histograms at a time: the sum and the file being added.
+//!
+//!The event counters (taskExecuted, nEventFilters, EventFilter#) of the inputs of each node are summed and written with the histograms.
+//!The counters of each node are verified once written, and the totals of each level are verified against those of the previous level.
+//!Input files that cannot be read or whose counters or histograms are inconsistent are skipped and reported if SkipBadInputs is true.
+//!Each intermediate file records in MergeNSkipped the number of input files skipped in the merge of all the files it sums, so the
+//!output and the checkpoints resumed carry the number of files skipped since the first level.
+//!
+//!Intermediate files are written in MergePath and are renamed to their final name only once complete: they are the checkpoints of the
+//!merge. A merge that is interrupted and run again resumes from the intermediate files whose list of inputs is unchanged. The intermediate
+//!files are deleted at the end if RemoveIntermediate is true.
+//!
+class HierarchicalMerger : public Task
+{
+public:
+
+  //!
+  //! Detailed CTOR
+  //!
+  //! @param _name Name given to task instance
+  //! @param _configuration Configuration used to run this task
+  //!
+  HierarchicalMerger(const String & _name,
+                     const Configuration & _configuration);
+
+  //!
+  //! DTOR
+  //!
+  virtual ~HierarchicalMerger() {}
+
+  //!
+  //! Sets the default  values of the configuration parameters used by this task
+  //!
+  virtual void setDefaultConfiguration();
+
+  virtual void configure();
+
+  //!
+  //! Execute the merge
+  //!
+  virtual void execute();
+
+protected:
+
+  //!
+  //! Event counters of a histogram file, and number of input files skipped in the merges that produced it.
+  //!
+  struct Counters
+  {
+    long         nEventsProcessed;
+    vector<long> nEventsAccepted;
+    long         nInputsSkipped;
+
+    void add(const Counters & counters);
+    bool operator==(const Counters & counters) const;
+  };
+
+  //!
+  //! Read the event counters of the given file. Throws if they are missing.
+  //!
+  Counters readCounters(TFile & inputFile);
+
+  //!
+  //! Merge the given files into the given output file. Returns the counters of the output. Inputs that cannot be read are skipped if allowed
+  //! and added to the number of inputs skipped; otherwise a FileException is thrown.
+  //!
+  Counters mergeNode(const VectorString & inputs, const String & outputFileName, bool allowSkip);
+
+  //!
+  //! Returns true if the given output file is the complete merge of the given inputs, in which case its counters are returned.
+  //!
+  bool loadCheckpoint(const String & outputFileName, const VectorString & inputs, Counters & counters);
+
+  String getNodeFileName(int level, int node) const;
+
+  String mergePath;
+  String appendedString;
+  int    fanIn;
+  int    nThreads;
+  int    maximumDepth;
+  bool   skipBadInputs;
+  bool   removeIntermediate;
+
+  ClassDef(HierarchicalMerger,0)
+};
+
+} // namespace CAP
+
+#endif /* CAP__HierarchicalMerger */
@@ -9,6 +9,13 @@
  * Author: Claude Pruneau,   04/01/2022
  *
  * *********************************************************************/
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+#include "TROOT.h"
+#include "TKey.h"
 #include "HistogramCollection.hpp"
 #include "SubSampleStatCalculator.hpp"
 using CAP::SubSampleStatCalculator;
@@ -23,7 +30,10 @@ Task(_name,_configuration),
 nEventsProcessed(0),
 sumEventsProcessed(0),
 nEventsAccepted(nullptr),
-sumEventsAccepted(nullptr)
+sumEventsAccepted(nullptr),
+streamingMerge(false),
+nThreads(1),
+mergeQueueSize(16)
 {
   appendClassName("SubSampleStatCalculator");
 }
@@ -45,6 +55,9 @@ void SubSampleStatCalculator::setDefaultConfiguration()
   addParameter("HistogramsImportPath",     none);
   addParameter("HistogramsExportPath",    none);
   addParameter("MaximumDepth",           2);
+  addParameter("StreamingMerge",         false);
+  addParameter("nThreads",               1);
+  addParameter("MergeQueueSize",         16);
   generateKeyValuePairs("IncludedPattern",none,20);
   generateKeyValuePairs("ExcludedPattern",none,20);
   generateKeyValuePairs("InputFile",none,100);
@@ -67,6 +80,11 @@ void SubSampleStatCalculator::configure()
   appendedString      = getValueString("AppendedString");
   maximumDepth        = getValueInt(   "MaximumDepth");
   defaultGroupSize    = getValueInt(   "DefaultGroupSize");
+  streamingMerge      = getValueBool(  "StreamingMerge");
+  nThreads            = getValueInt(   "nThreads");
+  mergeQueueSize      = getValueInt(   "MergeQueueSize");
+  if (nThreads<1)       nThreads = 1;
+  if (mergeQueueSize<1) mergeQueueSize = 1;
 }
 
 void SubSampleStatCalculator::execute()
@@ -130,6 +148,11 @@ void SubSampleStatCalculator::execute()
     for (Size_t iFile=0;iFile<nFilesToSum; iFile++)
       cout << "    " << iFile << "    " << allFilesToSum[iFile] << endl;
     }
+  if (streamingMerge)
+    {
+    executeStreaming(allFilesToSum,groupSize,nGroups);
+    return;
+    }
    
    for (int iGroup =0; iGroup<nGroups; iGroup++  )
     {
@@ -254,3 +277,249 @@ void SubSampleStatCalculator::execute()
 
 }
 
+void SubSampleStatCalculator::executeStreaming(const VectorString & allFilesToSum, int groupSize, int nGroups)
+{
+  if (reportStart(__FUNCTION__))
+    ;
+  ROOT::EnableThreadSafety();
+  int nFilesToSum = allFilesToSum.size();
+  int nWorkers    = std::min(nThreads,nGroups);
+  std::atomic<int>  nGroupsClaimed(0);
+  std::atomic<bool> done(false);
+  vector<std::exception_ptr> exceptions(nWorkers);
+  auto run = [&](int iWorker)
+  {
+  try
+    {
+    int iGroup;
+    while (!done && (iGroup = nGroupsClaimed++) < nGroups)
+      {
+      int first = iGroup*groupSize;
+      int last  = (iGroup+1)*groupSize;
+      if (last>=nFilesToSum) last = nFilesToSum;
+      mergeGroup(allFilesToSum,first,last);
+      }
+    }
+  catch (...)
+    {
+    exceptions[iWorker] = std::current_exception();
+    done = true;
+    }
+  };
+  vector<std::thread> threads;
+  for (int iWorker=1; iWorker<nWorkers; iWorker++) threads.emplace_back(run,iWorker);
+  run(0);
+  for (auto & thread : threads) thread.join();
+  for (int iWorker=0; iWorker<nWorkers; iWorker++)
+    {
+    if (exceptions[iWorker]) std::rethrow_exception(exceptions[iWorker]);
+    }
+  if (reportEnd(__FUNCTION__))
+    ;
+}
+
+long SubSampleStatCalculator::readNEventsProcessed(TFile & inputFile)
+{
+  try
+    {
+    return readParameter(inputFile,"nTaskExecuted");
+    }
+  catch (...)
+    {
+    return readParameter(inputFile,"taskExecuted");
+    }
+}
+
+namespace
+{
+
+//!
+//! Item passed by the loader thread of a group to the thread folding the histograms: either the event counts of the next file
+//! (histogram==nullptr, endOfGroup==false), one histogram of the current file, or the end of the group.
+//!
+struct MergeItem
+{
+  TH1 *        histogram;
+  long         nEventsProcessed;
+  vector<long> nEventsAccepted;
+  bool         endOfGroup;
+};
+
+}
+
+void SubSampleStatCalculator::mergeGroup(const VectorString & allFilesToSum, int first, int last)
+{
+  static std::mutex ioMutex;
+  {
+  std::lock_guard<std::mutex> lock(ioMutex);
+  if (reportInfo(__FUNCTION__)) cout << "Summing files w/ index:" << first << " to " << last-1 << endl;
+  }
+  String outputFileName = histosExportFile;
+  outputFileName += appendedString;
+  outputFileName += first;
+  outputFileName += "TO";
+  outputFileName += (last-1);
+  int nInputFile = last - first+1;
+
+  // the first file of the group is loaded as a whole: its histograms accumulate the sum
+  TFile * firstFile = openRootFile("", allFilesToSum[first], "READ");
+  HistogramCollection * collectionAvg  = new HistogramCollection("Sum",getSeverityLevel());
+  collectionAvg->loadCollection(*firstFile);
+  unsigned int nHistograms = collectionAvg->size();
+  long sumProcessed = readNEventsProcessed(*firstFile);
+  int  nFilters     = readParameter(*firstFile,"nEventFilters");
+  if (nFilters<=0) throw TaskException("nEventFilters is null","SubSampleStatCalculator::mergeGroup()");
+  vector<long> sumAccepted(nFilters);
+  for (int iFilter=0; iFilter<nFilters; iFilter++)
+    {
+    String parameterName = "EventFilter";
+    parameterName += iFilter;
+    sumAccepted[iFilter] = readParameter(*firstFile,parameterName);
+    }
+
+  // the other files are read by the loader thread, one histogram at a time, while the previous ones are folded in
+  std::deque<MergeItem> queue;
+  std::mutex queueMutex;
+  std::condition_variable itemPushed;
+  std::condition_variable itemPopped;
+  bool aborted = false;
+  std::exception_ptr loaderException;
+  auto push = [&](MergeItem && item)
+  {
+  std::unique_lock<std::mutex> lock(queueMutex);
+  itemPopped.wait(lock, [&]{ return aborted || int(queue.size())<mergeQueueSize; });
+  if (aborted)
+    {
+    delete item.histogram;
+    return false;
+    }
+  queue.push_back(std::move(item));
+  itemPushed.notify_one();
+  return true;
+  };
+  auto load = [&]()
+  {
+  try
+    {
+    for (int iFile=first+1; iFile<last; iFile++)
+      {
+      TFile * inputFile = openRootFile("", allFilesToSum[iFile], "READ");
+      MergeItem counts{nullptr, readNEventsProcessed(*inputFile), vector<long>(nFilters), false};
+      for (int iFilter=0; iFilter<nFilters; iFilter++)
+        {
+        String parameterName = "EventFilter";
+        parameterName += iFilter;
+        counts.nEventsAccepted[iFilter] = readParameter(*inputFile,parameterName);
+        }
+      vector<TKey*> keys;
+      TIter keyList(inputFile->GetListOfKeys());
+      TKey * key;
+      while ((key = (TKey*)keyList()))
+        {
+        TClass * cl = gROOT->GetClass(key->GetClassName());
+        if (cl->InheritsFrom("TH1")) keys.push_back(key);
+        }
+      bool proceed = push(std::move(counts));
+      if (keys.size()!=nHistograms)
+        {
+        // same as HistogramCollection::squareDifferenceCollection(): the file counts but its histograms are ignored
+        std::lock_guard<std::mutex> lock(ioMutex);
+        if (reportError(__FUNCTION__))
+          cout << "File " << allFilesToSum[iFile] << " contains " << keys.size() << " histograms instead of " << nHistograms << endl;
+        keys.clear();
+        }
+      for (unsigned int iKey=0; iKey<keys.size() && proceed; iKey++)
+        {
+        TH1 * h = (TH1*) keys[iKey]->ReadObj();
+        if (!h) throw HistogramException("Object","Object not read","SubSampleStatCalculator::mergeGroup()");
+        h->SetDirectory(nullptr);
+        proceed = push(MergeItem{h, 0, vector<long>(), false});
+        }
+      inputFile->Close();
+      delete inputFile;
+      if (!proceed) return;
+      }
+    }
+  catch (...)
+    {
+    loaderException = std::current_exception();
+    }
+  push(MergeItem{nullptr, 0, vector<long>(), true});
+  };
+  std::thread loader(load);
+
+  try
+    {
+    int  iFile = first;
+    long nProcessed = 0;
+    unsigned int iObject = 0;
+    bool folding = false;
+    while (true)
+      {
+      MergeItem item;
+        {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        itemPushed.wait(lock, [&]{ return !queue.empty(); });
+        item = std::move(queue.front());
+        queue.pop_front();
+        }
+      itemPopped.notify_one();
+      if (item.endOfGroup) break;
+      if (!item.histogram)
+        {
+        iFile++;
+        nProcessed    = item.nEventsProcessed;
+        sumProcessed += nProcessed;
+        for (int iFilter=0; iFilter<nFilters; iFilter++) sumAccepted[iFilter] += item.nEventsAccepted[iFilter];
+        iObject = 0;
+        folding = true;
+        std::lock_guard<std::mutex> lock(ioMutex);
+        if (reportInfo(__FUNCTION__))
+          {
+          cout << endl;
+          printItem("File index",            iFile);
+          printItem("HistosImportFile",      allFilesToSum[iFile]);
+          printItem("nEventsProcessed",      nProcessed);
+          printItem("nEventsProcessed(Sum)", sumProcessed);
+          cout << endl;
+          }
+        continue;
+        }
+      // the histograms of a file are skipped after a dimension mismatch, as in HistogramCollection::squareDifferenceCollection()
+      if (folding) folding = collectionAvg->squareDifferenceHisto(iObject, item.histogram, double(sumProcessed), double(nProcessed), (iFile==(last-1)) ? nInputFile : -iFile);
+      iObject++;
+      delete item.histogram;
+      }
+    }
+  catch (...)
+    {
+      {
+      std::lock_guard<std::mutex> lock(queueMutex);
+      aborted = true;
+      for (auto & item : queue) delete item.histogram;
+      queue.clear();
+      }
+    itemPopped.notify_all();
+    loader.join();
+    throw;
+    }
+  loader.join();
+  if (loaderException) std::rethrow_exception(loaderException);
+
+  TFile * outputFile = openRootFile(histosExportPath, outputFileName, "RECREATE");
+  writeParameter(*outputFile,"taskExecuted", sumProcessed);
+  writeParameter(*outputFile,"nEventFilters", nFilters);
+  for (int iFilter=0; iFilter<nFilters; iFilter++)
+    {
+    String parameterName = "EventFilter";
+    parameterName += iFilter;
+    writeParameter(*outputFile,parameterName,sumAccepted[iFilter]);
+    }
+  collectionAvg->exportHistograms(*outputFile);
+  firstFile->Close();
+  collectionAvg->setOwnership(0);
+  delete collectionAvg;
+  outputFile->Close();
+  delete outputFile;
+  delete firstFile;
+}
@@ -33,6 +33,10 @@ namespace CAP
 //!which are then set as errors in the histograms saved on output. The name of the output file is generated based on the template name
 //!and a selected appendString name. This class should NOT be run as a subtask of a more complex task in its current form.
 //!
+//!If StreamingMerge is true, groups of files are merged concurrently by nThreads workers. Within a group, the histograms of the
+//!files are read one at a time by a loader thread while the previous ones are folded into the sum, and each histogram is deleted
+//!as soon as it is folded. At most MergeQueueSize histograms are held in addition to the sum. The output is identical to that of
+//!the sequential merge.
 //!
 //!
 class SubSampleStatCalculator : public Task
@@ -68,6 +72,21 @@ public:
   virtual void execute();
 
 protected:
+
+  //!
+  //! Merge the given files by groups of the given size with the streaming merge (see class description).
+  //!
+  void executeStreaming(const VectorString & allFilesToSum, int groupSize, int nGroups);
+
+  //!
+  //! Streaming merge of the files of index first to last-1 into one output file. Thread safe.
+  //!
+  void mergeGroup(const VectorString & allFilesToSum, int first, int last);
+
+  //!
+  //! Number of events processed recorded in the given file
+  //!
+  long readNEventsProcessed(TFile & inputFile);
   
   long nEventsProcessed;   //!< Number of events processed in the current file
   long sumEventsProcessed; //!< Sum of the number of events processes.
@@ -80,6 +99,9 @@ protected:
   int    nInputFile;
   int    maximumDepth;
   int    nEventFilters;
+  bool   streamingMerge;
+  int    nThreads;
+  int    mergeQueueSize;
   ClassDef(SubSampleStatCalculator,0)
 };
 
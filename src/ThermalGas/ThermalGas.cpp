@@ -52,6 +52,7 @@ thermalNetChargeDensity(0.0),
 thermalEnergyDensity(0.0),
 thermalEntropyDensity(0.0),
 pressure(0.0),
+decayProbabilitiesCalculated(false),
 hadronRndmSelector(nullptr)
 {
   appendClassName("ThermalGas");
@@ -265,32 +266,20 @@ void ThermalGas::calculateStableDensities()
   //
   // pair densities: rho2_stable
   // correlated pair density
+  // The double sum over hadrons of rho1_1*rho1_2 factorizes into rho1_stable[jStable1]*rho1_stable[jStable2].
   //
   for (int jStable1 = 0; jStable1 < nStablePart; jStable1++)
     {
     for (int jStable2 = 0; jStable2 < nStablePart; jStable2++)
       {
-      double rho2  = 0.0;
       double rho2c = 0.0;
       for (int kHadron1=0; kHadron1<nHadrons; kHadron1++)
         {
         ParticleThermalProperties & hadron1 = *(hadrons[kHadron1]);
-        double prob1     = hadron1.getDecayProbability(jStable1);
-        double prob12    = hadron1.getDecayProbability(jStable1,jStable2);
-        double density1  = hadron1.getNumberDensity();
-        double rho1_1    = density1*prob1;
-        rho2c +=  density1*prob12;
-        for (int kHadron2=0; kHadron2<nHadrons; kHadron2++)
-          {
-          ParticleThermalProperties & hadron2 = *(hadrons[kHadron2]);
-          double prob2     = hadron2.getDecayProbability(jStable2);
-          double density2  = hadron2.getNumberDensity();
-          double rho1_2    = density2*prob2;
-          rho2 += rho1_1 * rho1_2;
-          }
+        rho2c += hadron1.getNumberDensity()*hadron1.getDecayProbability(jStable1,jStable2);
         }
       rho2cor_stable[jStable1][jStable2] = rho2c;
-      rho2_stable[jStable1][jStable2]    = rho2;
+      rho2_stable[jStable1][jStable2]    = rho1_stable[jStable1]*rho1_stable[jStable2];
       }
     }
 
@@ -324,6 +313,7 @@ void ThermalGas::reset()
   thermalNetBaryonDensity      = 0.0;
   thermalNetStrangenessDensity = 0.0;
   thermalNetChargeDensity      = 0.0;
+  decayProbabilitiesCalculated = false;
   unsigned int nStableHadrons  = stableParticleTypes->size();
   for (unsigned int iHadron=0; iHadron<hadrons.size();iHadron++) hadrons[iHadron]->reset();
   vector<double> array(nStableHadrons,0.0);
@@ -347,6 +337,7 @@ void ThermalGas::clear()
   thermalNetBaryonDensity      = 0.0;
   thermalNetStrangenessDensity = 0.0;
   thermalNetChargeDensity      = 0.0;
+  decayProbabilitiesCalculated = false;
   for (unsigned int iHadron=0; iHadron<hadrons.size();iHadron++) hadrons[iHadron]->clear();
   hadrons.clear();
   rho1_stable.clear();
@@ -375,6 +366,39 @@ void ThermalGas::execute()
     cout << " temperature =" <<  temperature << endl;
     cout << " ============================================================"  << endl;
     }
+  calculateThermalProperties();
+  //return;
+  calculateParticleDecayProbability();
+  decayProbabilitiesCalculated = true;
+  calculateStableDensities();
+  //setupDecayGenerator();
+  if (reportEnd(__FUNCTION__))
+    ;
+}
+
+void ThermalGas::calculate(double _temperature, double _muB, double _muS)
+{
+  temperature = _temperature;
+  muB         = _muB;
+  muS         = _muS;
+  calculateThermalProperties();
+  if (!decayProbabilitiesCalculated)
+    {
+    calculateParticleDecayProbability();
+    decayProbabilitiesCalculated = true;
+    }
+  calculateStableDensities();
+}
+
+void ThermalGas::calculateThermalProperties()
+{
+  thermalNumberDensity         = 0.0;
+  thermalEnergyDensity         = 0.0;
+  thermalEntropyDensity        = 0.0;
+  pressure                     = 0.0;
+  thermalNetBaryonDensity      = 0.0;
+  thermalNetStrangenessDensity = 0.0;
+  thermalNetChargeDensity      = 0.0;
   for (unsigned int iHadron=0; iHadron < hadrons.size(); iHadron++)
     {
     if (hadrons[iHadron]->getMass()<=0.0) continue;
@@ -387,12 +411,82 @@ void ThermalGas::execute()
     thermalNetChargeDensity      += hadrons[iHadron]->getChargeDensity();
     thermalNetStrangenessDensity += hadrons[iHadron]->getStrangeDensity();
     }
-  //return;
-  calculateParticleDecayProbability();
-  calculateStableDensities();
-  //setupDecayGenerator();
-  if (reportEnd(__FUNCTION__))
-    ;
+}
+
+void ThermalGas::exportPoint(ThermalGasPoint & point) const
+{
+  unsigned int nHadrons = hadrons.size();
+  unsigned int nStable  = rho1_stable.size();
+  point.temperature           = temperature;
+  point.muB                   = muB;
+  point.muS                   = muS;
+  point.numberDensity         = thermalNumberDensity;
+  point.energyDensity         = thermalEnergyDensity;
+  point.entropyDensity        = thermalEntropyDensity;
+  point.pressure              = pressure;
+  point.netBaryonDensity      = thermalNetBaryonDensity;
+  point.netStrangenessDensity = thermalNetStrangenessDensity;
+  point.netChargeDensity      = thermalNetChargeDensity;
+  point.hadronNumberDensity.resize(nHadrons);
+  point.hadronEnergyDensity.resize(nHadrons);
+  point.hadronEntropyDensity.resize(nHadrons);
+  point.hadronPressure.resize(nHadrons);
+  for (unsigned int iHadron=0; iHadron<nHadrons; iHadron++)
+    {
+    point.hadronNumberDensity[iHadron]  = hadrons[iHadron]->numberDensity;
+    point.hadronEnergyDensity[iHadron]  = hadrons[iHadron]->energyDensity;
+    point.hadronEntropyDensity[iHadron] = hadrons[iHadron]->entropyDensity;
+    point.hadronPressure[iHadron]       = hadrons[iHadron]->pressure;
+    }
+  point.rho1 = rho1_stable;
+  point.rho2.resize(nStable*nStable);
+  point.rho2cor.resize(nStable*nStable);
+  for (unsigned int iStable1=0; iStable1<nStable; iStable1++)
+    {
+    for (unsigned int iStable2=0; iStable2<nStable; iStable2++)
+      {
+      point.rho2   [iStable1*nStable+iStable2] = rho2_stable[iStable1][iStable2];
+      point.rho2cor[iStable1*nStable+iStable2] = rho2cor_stable[iStable1][iStable2];
+      }
+    }
+}
+
+void ThermalGas::importPoint(const ThermalGasPoint & point)
+{
+  unsigned int nHadrons = hadrons.size();
+  unsigned int nStable  = stableParticleTypes->size();
+  if (point.hadronNumberDensity.size()!=nHadrons || point.rho1.size()!=nStable)
+    throw TaskException("Point incompatible with the particle collections of this gas","ThermalGas::importPoint()");
+  temperature                  = point.temperature;
+  muB                          = point.muB;
+  muS                          = point.muS;
+  thermalNumberDensity         = point.numberDensity;
+  thermalEnergyDensity         = point.energyDensity;
+  thermalEntropyDensity        = point.entropyDensity;
+  pressure                     = point.pressure;
+  thermalNetBaryonDensity      = point.netBaryonDensity;
+  thermalNetStrangenessDensity = point.netStrangenessDensity;
+  thermalNetChargeDensity      = point.netChargeDensity;
+  for (unsigned int iHadron=0; iHadron<nHadrons; iHadron++)
+    {
+    hadrons[iHadron]->numberDensity  = point.hadronNumberDensity[iHadron];
+    hadrons[iHadron]->energyDensity  = point.hadronEnergyDensity[iHadron];
+    hadrons[iHadron]->entropyDensity = point.hadronEntropyDensity[iHadron];
+    hadrons[iHadron]->pressure       = point.hadronPressure[iHadron];
+    }
+  rho1_stable = point.rho1;
+  for (unsigned int iStable1=0; iStable1<nStable; iStable1++)
+    {
+    for (unsigned int iStable2=0; iStable2<nStable; iStable2++)
+      {
+      double rho2     = point.rho2[iStable1*nStable+iStable2];
+      double rho1rho1 = rho1_stable[iStable1]*rho1_stable[iStable2];
+      rho2_stable[iStable1][iStable2]     = rho2;
+      rho2cor_stable[iStable1][iStable2]  = point.rho2cor[iStable1*nStable+iStable2];
+      rho1rho1_stable[iStable1][iStable2] = rho1rho1;
+      c2_stable[iStable1][iStable2]       = rho2 - rho1rho1;
+      }
+    }
 }
 
 // this needs to be "fixed"
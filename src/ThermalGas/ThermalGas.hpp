@@ -23,6 +23,33 @@ using namespace std;
 namespace CAP
 {
 
+//!
+//!Compact record of the properties of a hadron gas at one (temperature, muB, muS) point: the totals, the partial densities and
+//!pressure of each hadron, and the densities of the stable hadrons. Pair densities are stored as [iStable1*nStable+iStable2].
+//!The dbHash identifies the particle collections the point was calculated with (see ThermalGasTable).
+//!
+struct ThermalGasPoint
+{
+  unsigned int dbHash;
+  double temperature;
+  double muB;
+  double muS;
+  double numberDensity;
+  double energyDensity;
+  double entropyDensity;
+  double pressure;
+  double netBaryonDensity;
+  double netStrangenessDensity;
+  double netChargeDensity;
+  vector<double> hadronNumberDensity;
+  vector<double> hadronEnergyDensity;
+  vector<double> hadronEntropyDensity;
+  vector<double> hadronPressure;
+  vector<double> rho1;
+  vector<double> rho2;
+  vector<double> rho2cor;
+};
+
 class ThermalGas : public Task
 {
 protected:
@@ -108,6 +135,11 @@ protected:
   //!
   double pressure;
 
+  //!
+  //!Whether the decay probabilities, which do not depend on the temperature and chemical potentials, are calculated
+  //!
+  bool decayProbabilitiesCalculated;
+
 public:
 
   vector<double> rho1_stable;
@@ -149,6 +181,23 @@ public:
   //!
   virtual void execute();
 
+  //!
+  //!Calculate the properties of the hadron gas at the given temperature and chemical potentials. Unlike execute, this method can be
+  //!called repeatedly on the same instance: the decay probabilities are calculated once.
+  //!
+  virtual void calculate(double _temperature, double _muB, double _muS);
+
+  //!
+  //!Calculate the thermal properties of all hadrons and the totals of the gas.
+  //!
+  virtual void calculateThermalProperties();
+
+  //!
+  //!Copy the properties of this hadron gas into, or restore them from, the given record.
+  //!
+  void exportPoint(ThermalGasPoint & point) const;
+  void importPoint(const ThermalGasPoint & point);
+
   virtual void reset();
   virtual void clear();
 
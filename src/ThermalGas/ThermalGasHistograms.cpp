@@ -203,7 +203,7 @@ void ThermalGasHistograms::fill(ThermalGas & ThermalGas)
   int     nStableSpecies           = config.getValueInt(pn,"nStableSpecies");
 //  bool    plotStableSpeciesVsT     = config.getValueBool(pn,"DoPlotVsStableSpecies");
 //  bool    plotThermalSpeciesVsT    = config.getValueBool(pn,"DoPlotVsAllSpecies");
-  bool    plotPtDistHistos         = config.getValueBool(pn,"PlotPtDistHistos");
+//  bool    plotPtDistHistos         = config.getValueBool(pn,"PlotPtDistHistos");
 //  int     nChemicalTemp            = config.getValueInt(pn,"nChemicalTemp");
 //  double  minChemicalTemp          = config.getValueDouble(pn,"MinChemicalTemp");
 //  double  maxChemicalTemp          = config.getValueDouble(pn,"MaxChemicalTemp");
@@ -216,9 +216,9 @@ void ThermalGasHistograms::fill(ThermalGas & ThermalGas)
 //  double  minMuS                   = configuration.getValueDouble(pn,"MinMuS");
 //  double  maxMuS                   = configuration.getValueDouble(pn,"MaxMuS");
 //  double  stepMuS                  = (maxMuS - minMuS)/double(nMuS);
-  int     nP                       = config.getValueInt(pn,"nP");
-  double  minP                     = config.getValueDouble(pn,"MinP");
-  double  maxP                     = config.getValueDouble(pn,"MaxP");
+//  int     nP                       = config.getValueInt(pn,"nP");
+//  double  minP                     = config.getValueDouble(pn,"MinP");
+//  double  maxP                     = config.getValueDouble(pn,"MaxP");
   //double  stepP                    = (maxP - minP)/double(nP);
   double  zero = 0.0;
   
@@ -6,6 +6,8 @@
 
 #pragma link C++ class CAP::ThermalGas+;
 #pragma link C++ class CAP::ThermalGasModel+;
+#pragma link C++ class CAP::ThermalGasTable+;
+#pragma link C++ struct CAP::ThermalGasPoint+;
 #pragma link C++ class CAP::ParticleThermalProperties+;
 #pragma link C++ class CAP::ThermalGasHistograms+;
 #pragma link C++ class CAP::ThermalGasVsTempHistograms+;
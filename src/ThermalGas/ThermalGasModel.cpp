@@ -11,6 +11,13 @@
  * Copyright 2022 Claude Pruneau
  *
  * *********************************************************************/
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include "TSystem.h"
 #include "ThermalGasModel.hpp"
 #include "ThermalGasHistograms.hpp"
 #include "ThermalGasVsTempHistograms.hpp"
@@ -29,7 +36,13 @@ EventTask(_name,_configuration),
 particleTypes(nullptr),
 stableParticleTypes(nullptr),
 nThermalSpecies(0),
-nStableSpecies(0)
+nStableSpecies(0),
+nThreads(1),
+useTable(false),
+tablePath("./"),
+tableFile("ThermalGasTable"),
+dbHash(0),
+table()
 {
   appendClassName("ThermalGasModel");
 }
@@ -63,6 +76,10 @@ void ThermalGasModel::setDefaultConfiguration()
   addParameter("nP",                    500);
   addParameter("MinP",                  0.0);
   addParameter("MaxP",                  5.0);
+  addParameter("nThreads",              1);
+  addParameter("UseTable",              false);
+  addParameter("TablePath",             "./");
+  addParameter("TableFile",             "ThermalGasTable");
   if (reportEnd(__FUNCTION__))
     ;
 }
@@ -137,7 +154,13 @@ void ThermalGasModel::initialize()
     }
   else
     stepMuS = (maxMuS - minMuS)/double(nMuS-1);
-  
+
+  nThreads  = getValueInt("nThreads");
+  useTable  = getValueBool("UseTable");
+  tablePath = getValueString("TablePath");
+  tableFile = getValueString("TableFile");
+  dbHash    = ThermalGasTable::calculateDbHash(*particleTypes,*stableParticleTypes);
+
   if (reportInfo(__FUNCTION__))
     {
     cout << endl;
@@ -154,6 +177,11 @@ void ThermalGasModel::initialize()
     cout << "           minMuS:" << minMuS <<  endl;
     cout << "           maxMuS:" << maxMuS <<  endl;
     cout << "          stepMuS:" << stepMuS <<  endl;
+    cout << "         nThreads:" << nThreads <<  endl;
+    cout << "         useTable:" << useTable <<  endl;
+    cout << "        tablePath:" << tablePath <<  endl;
+    cout << "        tableFile:" << tableFile <<  endl;
+    cout << "           dbHash:" << dbHash <<  endl;
     }
   Task::initialize();
   
@@ -165,35 +193,73 @@ void ThermalGasModel::execute()
 {
   if (reportStart(__FUNCTION__))
     ;
-  
+  // grid points, in the order of the histogram groups
+  vector<ThermalGasPoint> points;
+  for (int iTemp=0; iTemp<nChemicalTemp; iTemp++ )
+    {
+    for (int iMuB=0; iMuB<nMuB; iMuB++ )
+      {
+      for (int iMuS=0; iMuS<nMuS; iMuS++ )
+        {
+        ThermalGasPoint point;
+        point.dbHash      = dbHash;
+        point.temperature = minChemicalTemp+stepTemp*double(iTemp);
+        point.muB         = minMuB+stepMuB*double(iMuB);
+        point.muS         = minMuS+stepMuS*double(iMuS);
+        points.push_back(point);
+        }
+      }
+    }
+  if (useTable) importTable();
+  vector<int> missing;
+  for (unsigned int iPoint=0; iPoint<points.size(); iPoint++)
+    {
+    ThermalGasPoint & point = points[iPoint];
+    const ThermalGasPoint * found = useTable ? table.find(dbHash,point.temperature,point.muB,point.muS) : nullptr;
+    if (found)
+      point = *found;
+    else
+      missing.push_back(iPoint);
+    }
+  if (reportInfo(__FUNCTION__))
+    {
+    cout << endl;
+    printItem("nPoints",          int(points.size()));
+    printItem("nPointsFromTable", int(points.size()-missing.size()));
+    printItem("nPointsCalculated",int(missing.size()));
+    }
+  calculatePoints(points,missing);
+  if (useTable && missing.size()>0)
+    {
+    for (auto iPoint : missing) table.add(points[iPoint]);
+    exportTable();
+    }
+
   int count = 0;
-  double temperature, muB, muS;
+  ThermalGasVsTempHistograms * hgVsTHistos = (ThermalGasVsTempHistograms*) histogramManager.getGroup(1,0);
   for (int iTemp=0; iTemp<nChemicalTemp; iTemp++ )
     {
-    temperature = minChemicalTemp+stepTemp*double(iTemp);
     String tempLabel = "T";
-    tempLabel += int(0.5+1000*temperature);
+    tempLabel += int(0.5+1000*points[count].temperature);
     for (int iMuB=0; iMuB<nMuB; iMuB++ )
       {
-      muB = minMuB+stepMuB*double(iMuB);
       String muBLabel = "B";
-      muBLabel += int(0.5+1000*muB);
+      muBLabel += int(0.5+1000*points[count].muB);
       for (int iMuS=0; iMuS<nMuS; iMuS++ )
         {
-        muS = minMuS+stepMuS*double(iMuS);
+        ThermalGasPoint & point = points[count];
         String muSLabel = "S";
-        muSLabel += int(0.5+1000*muB);
+        muSLabel += int(0.5+1000*point.muS);
         String name = createName(modelName,tempLabel,muBLabel,muSLabel);
         Configuration gasConfig;
-        gasConfig.addParameter("Temperature", temperature);
-        gasConfig.addParameter("MuB",         muB);
-        gasConfig.addParameter("MuS",         muS);
+        gasConfig.addParameter("Temperature", point.temperature);
+        gasConfig.addParameter("MuB",         point.muB);
+        gasConfig.addParameter("MuS",         point.muS);
         ThermalGas * gas = new ThermalGas(name,gasConfig, particleTypes,stableParticleTypes);
         gas->initialize();
-        gas->execute();
-        ThermalGasVsTempHistograms * hgVsTHistos = (ThermalGasVsTempHistograms*) histogramManager.getGroup(1,0);
+        gas->importPoint(point);
         hgVsTHistos->fill(*gas);
-        ThermalGasHistograms * hgHistos = (ThermalGasHistograms*) histogramManager.getGroup(0,iMuS);
+        ThermalGasHistograms * hgHistos = (ThermalGasHistograms*) histogramManager.getGroup(0,count);
         hgHistos->fill(*gas);
         count++;
         // keep track of these as subtasks for future in ParticleThermalPropertiesGenerator
@@ -207,6 +273,137 @@ void ThermalGasModel::execute()
     ;
 }
 
+void ThermalGasModel::calculatePoints(vector<ThermalGasPoint> & points, const vector<int> & missing)
+{
+  int nPoints  = missing.size();
+  if (nPoints<1) return;
+  int nWorkers = (nThreads>0) ? nThreads : int(std::thread::hardware_concurrency());
+  if (nWorkers<1)       nWorkers = 1;
+  if (nWorkers>nPoints) nWorkers = nPoints;
+  if (reportInfo(__FUNCTION__))
+    {
+    cout << endl;
+    printItem("nPoints", nPoints);
+    printItem("nWorkers",nWorkers);
+    }
+
+  // the gases of the workers are created and initialized here, on the calling thread.
+  vector<ThermalGas*> gases;
+  for (int iWorker=0; iWorker<nWorkers; iWorker++)
+    {
+    String name = modelName + "_Worker";
+    name += iWorker;
+    Configuration gasConfig;
+    gasConfig.addParameter("Temperature", points[missing[0]].temperature);
+    gasConfig.addParameter("MuB",         points[missing[0]].muB);
+    gasConfig.addParameter("MuS",         points[missing[0]].muS);
+    ThermalGas * gas = new ThermalGas(name,gasConfig, particleTypes,stableParticleTypes);
+    gas->initialize();
+    gases.push_back(gas);
+    }
+
+  std::atomic<int> nPointsClaimed(0);
+  vector<std::exception_ptr> exceptions(nWorkers);
+  auto run = [&](int iWorker)
+  {
+  try
+    {
+    ThermalGas & gas = *gases[iWorker];
+    int iPoint;
+    while ((iPoint = nPointsClaimed++) < nPoints)
+      {
+      ThermalGasPoint & point = points[missing[iPoint]];
+      gas.calculate(point.temperature,point.muB,point.muS);
+      gas.exportPoint(point);
+      point.dbHash = dbHash;
+      }
+    }
+  catch (...)
+    {
+    exceptions[iWorker] = std::current_exception();
+    }
+  };
+  vector<std::thread> threads;
+  for (int iWorker=0; iWorker<nWorkers; iWorker++) threads.emplace_back(run,iWorker);
+  for (auto & thread : threads) thread.join();
+  for (auto gas : gases) delete gas;
+  for (auto & exception : exceptions)
+    {
+    if (exception) std::rethrow_exception(exception);
+    }
+}
+
+void ThermalGasModel::importTable()
+{
+  table.clear();
+  // AccessPathName returns false if the file exists
+  String fileName = tablePath + "/" + tableFile + ".bin";
+  if (gSystem->AccessPathName(fileName))
+    {
+    if (reportInfo(__FUNCTION__)) cout << "No thermal gas table named: " << fileName << endl;
+    return;
+    }
+  ifstream & inputFile = openInputBinaryFile(tablePath,tableFile,".bin");
+  table.read(inputFile);
+  inputFile.close();
+  if (reportInfo(__FUNCTION__))
+    {
+    cout << endl;
+    printItem("tablePath",tablePath);
+    printItem("tableFile",tableFile);
+    printItem("nPoints",  int(table.size()));
+    }
+}
+
+void ThermalGasModel::exportTable()
+{
+  gSystem->mkdir(tablePath,1);
+  // scans sharing the table take turns through a lock file. The table saved by the others since importTable() is merged
+  // into this one, then written to a file private to this process and renamed: no point is lost and no scan reads a
+  // partial file. The lock is released when the descriptor is closed, also if the process dies.
+  String fileName = tablePath + "/" + tableFile + ".bin";
+  String lockName = tablePath + "/" + tableFile + ".lock";
+  int lockDescriptor = open(lockName.Data(),O_CREAT|O_RDWR,0644);
+  if (lockDescriptor<0 || flock(lockDescriptor,LOCK_EX)!=0)
+    {
+    if (lockDescriptor>=0) close(lockDescriptor);
+    if (reportWarning(__FUNCTION__)) cout << "Could not lock the thermal gas table: " << lockName << endl;
+    return;
+    }
+  if (!gSystem->AccessPathName(fileName))
+    {
+    ifstream & inputFile = openInputBinaryFile(tablePath,tableFile,".bin");
+    try
+      {
+      table.read(inputFile);
+      }
+    catch (FileException &)
+      {
+      if (reportWarning(__FUNCTION__)) cout << "Replacing the unreadable thermal gas table: " << fileName << endl;
+      }
+    inputFile.close();
+    }
+  String temporaryFile = tableFile + Form("_%d",gSystem->GetPid());
+  ofstream & outputFile = openOutputBinaryFile(tablePath,temporaryFile,".bin");
+  table.write(outputFile);
+  outputFile.close();
+  bool renamed = gSystem->Rename(tablePath + "/" + temporaryFile + ".bin",fileName)==0;
+  close(lockDescriptor);
+  if (!renamed)
+    {
+    gSystem->Unlink(tablePath + "/" + temporaryFile + ".bin");
+    if (reportWarning(__FUNCTION__)) cout << "Could not save the thermal gas table to: " << tablePath << endl;
+    return;
+    }
+  if (reportInfo(__FUNCTION__))
+    {
+    cout << endl;
+    printItem("tablePath",tablePath);
+    printItem("tableFile",tableFile);
+    printItem("nPoints",  int(table.size()));
+    }
+}
+
 
 // temperature, muB, and muS  must be input in GeV
 void ThermalGasModel::createHistograms()
@@ -214,7 +411,7 @@ void ThermalGasModel::createHistograms()
   if (reportStart(__FUNCTION__))
     ;
   histogramManager.addSet("ThermalGasHistograms");
-  Severity debugLevel = getSeverityLevel();
+  //Severity debugLevel = getSeverityLevel();
   String bn = getValueString("HistoBaseName");
   bool    doTempDependentHistos = getValueBool("DoTempDependentHistos");
   HistogramGroup * histos;
@@ -251,7 +448,7 @@ void ThermalGasModel::importHistograms(TFile & inputFile)
 {
   if (reportStart(__FUNCTION__))
     ;
-  Severity debugLevel = getSeverityLevel();
+  //Severity debugLevel = getSeverityLevel();
   histogramManager.addSet("ThermalGasHistograms");
   String bn = getValueString("HistoBaseName");
   bool doTempDependentHistos = getValueBool("DoTempDependentHistos");
@@ -12,10 +12,19 @@
 #ifndef CAP_ThermalGasModel
 #define CAP_ThermalGasModel
 #include "ThermalGas.hpp"
+#include "ThermalGasTable.hpp"
 #include "EventTask.hpp"
 
 namespace CAP
 {
+
+//!
+//!Scan of the properties of a hadron gas over a grid of (temperature, muB, muS) points. The points are independent: they are
+//!calculated by nThreads workers, each with its own ThermalGas instance, and the histograms are filled afterwards in the order of
+//!the grid. With UseTable, the points are also saved in, and loaded from, a ThermalGasTable so repeated scans only calculate the
+//!points not already in the table. Scans run at the same time may share the table: each merges the points saved by the others
+//!before saving its own.
+//!
 class ThermalGasModel : public EventTask
 {
 public:
@@ -28,7 +37,15 @@ public:
   virtual void execute();
   virtual void createHistograms();
   virtual void importHistograms(TFile & inputFile);
-  
+
+  //!
+  //!Calculate the given points, for which no record was found in the table, with nThreads workers.
+  //!
+  virtual void calculatePoints(vector<ThermalGasPoint> & points, const vector<int> & missing);
+
+  virtual void importTable();
+  virtual void exportTable();
+
 protected:
   ParticleDb *   particleTypes;
   ParticleDb *   stableParticleTypes;
@@ -48,6 +65,12 @@ protected:
   double  minMuS;
   double  maxMuS;
   double  stepMuS;
+  int     nThreads;       //!< number of workers used to calculate the grid points (default 1, 0: one per core)
+  bool    useTable;       //!< whether calculated points are loaded from and saved to the table file
+  String  tablePath;
+  String  tableFile;
+  unsigned int dbHash;    //!< hash of the particle collections, see ThermalGasTable
+  ThermalGasTable table;
   
   ClassDef(ThermalGasModel,0)
 };
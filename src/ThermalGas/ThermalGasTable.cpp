@@ -0,0 +1,180 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+#include "ThermalGasTable.hpp"
+#include "Crc32.hpp"
+#include "Exceptions.hpp"
+using CAP::ThermalGasTable;
+using CAP::ThermalGasPoint;
+
+ClassImp(ThermalGasTable);
+
+static const char tableMagic[9] = "CAPTGT01";
+
+ThermalGasTable::ThermalGasTable()
+:
+points(),
+index()
+{
+}
+
+unsigned int ThermalGasTable::calculateDbHash(ParticleDb & particleTypes, ParticleDb & stableParticleTypes)
+{
+  ostringstream text;
+  text << setprecision(17);
+  for (unsigned int iType=0; iType<particleTypes.size(); iType++)
+    {
+    ParticleType & type = *particleTypes.getParticleType(iType);
+    text << type.getPdgCode()
+    << " " << type.getMass()
+    << " " << type.getSpinFactor()
+    << " " << type.getStatistics()
+    << " " << type.getBaryonNumber()
+    << " " << type.getCharge()
+    << " " << type.getStrangessNumber();
+    for (int iMode=0; iMode<type.getNDecayModes(); iMode++)
+      {
+      ParticleDecayMode & mode = type.getDecayMode(iMode);
+      text << " [" << mode.getBranchingRatio();
+      for (int iChild=0; iChild<mode.getNChildren(); iChild++) text << " " << mode.getChildPdgCode(iChild);
+      text << "]";
+      }
+    text << endl;
+    }
+  text << "stable:";
+  for (unsigned int iType=0; iType<stableParticleTypes.size(); iType++)
+    text << " " << stableParticleTypes.getParticleType(iType)->getPdgCode();
+  std::string s = text.str();
+  CAP::Crc32 crc(s.data(),s.size());
+  return crc.finish();
+}
+
+ThermalGasTable::Key ThermalGasTable::makeKey(unsigned int dbHash, double temperature, double muB, double muS)
+{
+  return Key(dbHash, std::llround(1.0E9*temperature), std::llround(1.0E9*muB), std::llround(1.0E9*muS));
+}
+
+const ThermalGasPoint * ThermalGasTable::find(unsigned int dbHash, double temperature, double muB, double muS) const
+{
+  auto iter = index.find(makeKey(dbHash,temperature,muB,muS));
+  if (iter==index.end()) return nullptr;
+  return &points[iter->second];
+}
+
+void ThermalGasTable::add(const ThermalGasPoint & point)
+{
+  Key key = makeKey(point.dbHash,point.temperature,point.muB,point.muS);
+  auto iter = index.find(key);
+  if (iter!=index.end())
+    {
+    points[iter->second] = point;
+    return;
+    }
+  index[key] = points.size();
+  points.push_back(point);
+}
+
+void ThermalGasTable::clear()
+{
+  points.clear();
+  index.clear();
+}
+
+//!
+//!Binary layout: magic, number of points, then for each point: dbHash, the ten scalars, nHadrons and the four partial
+//!quantities of each hadron, nStable and rho1, rho2, rho2cor.
+//!
+void ThermalGasTable::read(istream & input)
+{
+  auto readCount = [&]()
+  {
+  unsigned int n = 0;
+  input.read((char*) &n, sizeof(n));
+  return n;
+  };
+  auto readArray = [&](vector<double> & array, unsigned int n)
+  {
+  array.resize(n);
+  if (n>0) input.read((char*) array.data(), n*sizeof(double));
+  };
+  char magic[8];
+  input.read(magic,8);
+  if (!input || strncmp(magic,tableMagic,8)!=0)
+    throw FileException("ThermalGasTable","Not a thermal gas table","ThermalGasTable::read()");
+  unsigned int nPoints = readCount();
+  ThermalGasPoint point;
+  for (unsigned int iPoint=0; iPoint<nPoints; iPoint++)
+    {
+    point.dbHash = readCount();
+    double scalars[10];
+    input.read((char*) scalars, sizeof(scalars));
+    point.temperature           = scalars[0];
+    point.muB                   = scalars[1];
+    point.muS                   = scalars[2];
+    point.numberDensity         = scalars[3];
+    point.energyDensity         = scalars[4];
+    point.entropyDensity        = scalars[5];
+    point.pressure              = scalars[6];
+    point.netBaryonDensity      = scalars[7];
+    point.netStrangenessDensity = scalars[8];
+    point.netChargeDensity      = scalars[9];
+    unsigned int nHadrons = readCount();
+    readArray(point.hadronNumberDensity,  nHadrons);
+    readArray(point.hadronEnergyDensity,  nHadrons);
+    readArray(point.hadronEntropyDensity, nHadrons);
+    readArray(point.hadronPressure,       nHadrons);
+    unsigned int nStable = readCount();
+    readArray(point.rho1,    nStable);
+    readArray(point.rho2,    nStable*nStable);
+    readArray(point.rho2cor, nStable*nStable);
+    if (!input)
+      throw FileException("ThermalGasTable","Truncated thermal gas table","ThermalGasTable::read()");
+    add(point);
+    }
+}
+
+void ThermalGasTable::write(ostream & output) const
+{
+  auto writeCount = [&](unsigned int n)
+  {
+  output.write((const char*) &n, sizeof(n));
+  };
+  auto writeArray = [&](const vector<double> & array)
+  {
+  if (array.size()>0) output.write((const char*) array.data(), array.size()*sizeof(double));
+  };
+  output.write(tableMagic,8);
+  writeCount(points.size());
+  for (auto & point : points)
+    {
+    writeCount(point.dbHash);
+    double scalars[10] =
+    {
+      point.temperature, point.muB, point.muS,
+      point.numberDensity, point.energyDensity, point.entropyDensity, point.pressure,
+      point.netBaryonDensity, point.netStrangenessDensity, point.netChargeDensity
+    };
+    output.write((const char*) scalars, sizeof(scalars));
+    writeCount(point.hadronNumberDensity.size());
+    writeArray(point.hadronNumberDensity);
+    writeArray(point.hadronEnergyDensity);
+    writeArray(point.hadronEntropyDensity);
+    writeArray(point.hadronPressure);
+    writeCount(point.rho1.size());
+    writeArray(point.rho1);
+    writeArray(point.rho2);
+    writeArray(point.rho2cor);
+    }
+}
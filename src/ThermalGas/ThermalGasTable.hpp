@@ -0,0 +1,75 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#ifndef CAP_ThermalGasTable
+#define CAP_ThermalGasTable
+#include <map>
+#include <tuple>
+#include <iostream>
+#include "ThermalGas.hpp"
+
+using namespace std;
+
+namespace CAP
+{
+
+//!
+//!Table of hadron gas properties calculated at (temperature, muB, muS) points, keyed by the point and by a hash of the particle
+//!collections used in the calculation. ThermalGasModel saves the table after each scan so that later scans only calculate the
+//!points not already in the table. Points are matched to 1e-9 (in the units of the configuration).
+//!
+class ThermalGasTable
+{
+public:
+
+  ThermalGasTable();
+  virtual ~ThermalGasTable() {}
+
+  //!
+  //!CRC32 hash of the properties of the given particle collections that enter the hadron gas calculation.
+  //!
+  static unsigned int calculateDbHash(ParticleDb & particleTypes, ParticleDb & stableParticleTypes);
+
+  //!
+  //!Returns the point calculated with the given particle collections at the given temperature and chemical potentials, or
+  //!a null pointer if the table does not contain it.
+  //!
+  const ThermalGasPoint * find(unsigned int dbHash, double temperature, double muB, double muS) const;
+
+  //!
+  //!Add the given point to the table, replacing the point with the same key if any.
+  //!
+  void add(const ThermalGasPoint & point);
+
+  unsigned int size() const { return points.size(); }
+  void clear();
+
+  //!
+  //!Read points from, or write all points to, the given binary stream.
+  //!
+  void read(istream & input);
+  void write(ostream & output) const;
+
+protected:
+
+  typedef std::tuple<unsigned int,long long,long long,long long> Key;
+
+  static Key makeKey(unsigned int dbHash, double temperature, double muB, double muS);
+
+  vector<ThermalGasPoint> points;
+  std::map<Key,unsigned int> index;
+
+  ClassDef(ThermalGasTable,0)
+};
+
+} // namespace CAP
+
+#endif /* CAP_ThermalGasTable */
@@ -173,7 +173,7 @@ void ThermalGasVsTempHistograms::fill(ThermalGas & ThermalGas)
     ;
   String pn = getParentTask()->getName();
   const Configuration & config = getConfiguration();
-  int  nThermalSpecies       = config.getValueInt(pn,"nThermalSpecies");
+//  int  nThermalSpecies       = config.getValueInt(pn,"nThermalSpecies");
   int  nStableSpecies        = config.getValueInt(pn,"nStableSpecies");
   bool plotStableSpeciesVsT  = config.getValueBool(pn,"DoPlotVsStableSpecies");
   bool plotThermalSpeciesVsT = config.getValueBool(pn,"DoPlotVsAllSpecies");
@@ -52,7 +52,7 @@ public:
 
   virtual double getDSigmaP(double aMt __attribute__((unused)), double aPt __attribute__((unused)), double aPhiP __attribute__((unused)), double aRapP __attribute__((unused)) ) { return 0; };
   virtual double getPdotU(  double aMt __attribute__((unused)), double aPt __attribute__((unused)), double aPhiP __attribute__((unused)), double aRapP __attribute__((unused)) ) { return 0; };
-  virtual void   setPositionOnHypersurface(LorentzVector & position __attribute__((unused)) ) { };
+  virtual void   setPositionOnHypersurface(LorentzVector & position __attribute__((unused)), const double * r __attribute__((unused)) ) { };
   virtual void   setDefaultConfiguration();
   virtual double getHyperCubeSpatialVolume() const;
   virtual void   configure();
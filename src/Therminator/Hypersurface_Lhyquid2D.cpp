@@ -30,6 +30,7 @@
 #include "XmlParser.hpp"
 #include "XmlVectorField.hpp"
 #include "Hypersurface_Lhyquid2D.hpp"
+#include "RandomStream.hpp"
 
 using namespace std;
 using namespace TMath;
@@ -106,11 +107,11 @@ void Hypersurface_Lhyquid2D::printConfiguration(ostream & output)
   output << "=================================================================" << endl;
 }
 
-void Hypersurface_Lhyquid2D::setPositionOnHypersurface(LorentzVector & position)
+void Hypersurface_Lhyquid2D::setPositionOnHypersurface(LorentzVector & position, const double * r)
 {
-  zeta      = mDistance->getXMin() + (mDistance->getXMax() - mDistance->getXMin()) * gRandom->Rndm();
-  phiS      = mDistance->getYMin() + (mDistance->getYMax() - mDistance->getYMin()) * gRandom->Rndm();
-  rapidityS = spatialRapidityRange * (gRandom->Rndm() - 0.5); // * spatialRapidityRange;
+  zeta      = mDistance->getXMin() + (mDistance->getXMax() - mDistance->getXMin()) * r[0];
+  phiS      = mDistance->getYMin() + (mDistance->getYMax() - mDistance->getYMin()) * r[1];
+  rapidityS = spatialRapidityRange * (r[2] - 0.5); // * spatialRapidityRange;
   Dhs       = mDistance     ->interpolate(zeta, phiS, 0.0);
   dDdPhi    = mDistanceDPhi ->interpolate(zeta, phiS, 0.0);
   dDdZeta   = mDistanceDZeta->interpolate(zeta, phiS, 0.0);
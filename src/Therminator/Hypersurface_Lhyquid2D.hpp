@@ -41,7 +41,7 @@ public:
 
   virtual double getDSigmaP(double aMt, double aPt, double aPhiP, double aRapP);
   virtual double getPdotU(  double aMt, double aPt, double aPhiP, double aRapP);
-  virtual void   setPositionOnHypersurface(LorentzVector & position);
+  virtual void   setPositionOnHypersurface(LorentzVector & position, const double * r);
   virtual void   setDefaultConfiguration();
   virtual void   configure();
   virtual double getHyperCubeSpatialVolume() const;
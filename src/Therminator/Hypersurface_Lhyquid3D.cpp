@@ -29,6 +29,7 @@
 #include "XmlParser.hpp"
 #include "XmlVectorField.hpp"
 #include "Hypersurface_Lhyquid3D.hpp"
+#include "RandomStream.hpp"
 //#include "THGlobal.hpp"
 using namespace std;
 using namespace CAP::Math;
@@ -79,11 +80,11 @@ double Hypersurface_Lhyquid3D::getHyperCubeSpatialVolume()  const
   return  xRange*yRange*zRange;
 }
 
-void Hypersurface_Lhyquid3D::setPositionOnHypersurface(LorentzVector & position)
+void Hypersurface_Lhyquid3D::setPositionOnHypersurface(LorentzVector & position, const double * r)
 {
-  zeta    = mDistance->getXMin() + (mDistance->getXMax() - mDistance->getXMin()) * gRandom->Rndm();
-  phiS    = mDistance->getYMin() + (mDistance->getYMax() - mDistance->getYMin()) * gRandom->Rndm();
-  Theta   = mDistance->getZMin() + (mDistance->getZMax() - mDistance->getZMin()) * gRandom->Rndm();
+  zeta    = mDistance->getXMin() + (mDistance->getXMax() - mDistance->getXMin()) * r[0];
+  phiS    = mDistance->getYMin() + (mDistance->getYMax() - mDistance->getYMin()) * r[1];
+  Theta   = mDistance->getZMin() + (mDistance->getZMax() - mDistance->getZMin()) * r[2];
   Dhs     = mDistance      ->interpolate(zeta, phiS, Theta);
   dDdZeta = mDistanceDZeta ->interpolate(zeta, phiS, Theta);
   dDdPhi  = mDistanceDPhi  ->interpolate(zeta, phiS, Theta);
@@ -39,7 +39,7 @@ class Hypersurface_Lhyquid3D : public Hypersurface
 
   virtual double getDSigmaP(double aMt, double aPt, double aPhiP, double aRapP);
   virtual double getPdotU(  double aMt, double aPt, double aPhiP, double aRapP);
-  virtual void   setPositionOnHypersurface(LorentzVector & position);
+  virtual void   setPositionOnHypersurface(LorentzVector & position, const double * r);
   virtual void   setDefaultConfiguration();
   virtual double getHyperCubeSpatialVolume() const;
   virtual void   configure();
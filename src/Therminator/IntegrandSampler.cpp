@@ -0,0 +1,325 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#include <cmath>
+#include "RandomStream.hpp"
+#include "IntegrandSampler.hpp"
+
+ClassImp(IntegrandSampler);
+
+static const int nDimensions = Model::nIntegrandDimensions;
+
+IntegrandSampler::IntegrandSampler()
+:
+nBins(0),
+edges(),
+cellLower(),
+cellUpper(),
+cellVolume(),
+cellMaximum(),
+cellSelector(),
+safetyFactor(1.0),
+efficiency(0.0),
+nViolations(0)
+{
+}
+
+void IntegrandSampler::initialize(Model & model, ParticleType & type,
+                                  int _nBins, int nIterations, int nSamples,
+                                  int nCells, int nCellSamples, double _safetyFactor)
+{
+  CAP::RandomStream * random = CAP::RandomStream::getRandomStream();
+  nBins        = _nBins>0 ? _nBins : 1;
+  safetyFactor = _safetyFactor;
+  nViolations  = 0;
+  edges.resize(nDimensions*(nBins+1));
+  for (int iDimension=0; iDimension<nDimensions; iDimension++)
+    for (int iEdge=0; iEdge<=nBins; iEdge++)
+      edges[iDimension*(nBins+1)+iEdge] = double(iEdge)/double(nBins);
+
+  double u[nDimensions];
+  double x[nDimensions];
+  int    bins[nDimensions];
+  vector<double> binWeights(nDimensions*nBins);
+  for (int iIteration=0; iIteration<nIterations; iIteration++)
+    {
+    binWeights.assign(nDimensions*nBins,0.0);
+    for (int iSample=0; iSample<nSamples; iSample++)
+      {
+      random->fillUniform(nDimensions,u);
+      double jacobian = map(u,x,bins);
+      double weight   = model.getIntegrandAt(type,x) * jacobian;
+      if (weight<=0.0) continue;
+      for (int iDimension=0; iDimension<nDimensions; iDimension++) binWeights[iDimension*nBins+bins[iDimension]] += weight;
+      }
+    refine(binWeights);
+    }
+  buildCells(model,type,nCells>0 ? nCells : 1,nCellSamples>0 ? nCellSamples : 1);
+}
+
+double IntegrandSampler::getWeight(Model & model, ParticleType & type, const double * u) const
+{
+  double x[nDimensions];
+  int    bins[nDimensions];
+  double jacobian = map(u,x,bins);
+  double weight   = model.getIntegrandAt(type,x) * jacobian;
+  return weight>0.0 ? weight : 0.0;
+}
+
+//!
+//! The cells are split at mid-width. The cell split next is the one with the largest difference between its envelope and its mean
+//! weight, times its volume, i.e., the one where most proposals are rejected. Each half keeps the points of its parent that fall in
+//! it and is completed with new points up to nCellSamples. Cells in which no positive weight is found get an envelope of a thousandth
+//! of the largest one so that no part of the hypercube is excluded.
+//!
+void IntegrandSampler::buildCells(Model & model, ParticleType & type, int nCells, int nCellSamples)
+{
+  CAP::RandomStream * random = CAP::RandomStream::getRandomStream();
+  struct Cell
+  {
+    double lower[nDimensions];
+    double upper[nDimensions];
+    double volume;
+    double maximum;
+    double mean;
+    vector<double> points;   // nDimensions coordinates per point
+    vector<double> weights;
+  };
+  auto explore = [&](Cell & cell)
+  {
+    double r[nDimensions];
+    double u[nDimensions];
+    while (int(cell.weights.size())<nCellSamples)
+      {
+      random->fillUniform(nDimensions,r);
+      for (int iDimension=0; iDimension<nDimensions; iDimension++)
+        u[iDimension] = cell.lower[iDimension] + r[iDimension]*(cell.upper[iDimension]-cell.lower[iDimension]);
+      cell.points.insert(cell.points.end(),u,u+nDimensions);
+      cell.weights.push_back(getWeight(model,type,u));
+      }
+    cell.maximum = 0.0;
+    cell.mean    = 0.0;
+    for (double weight : cell.weights)
+      {
+      if (weight>cell.maximum) cell.maximum = weight;
+      cell.mean += weight;
+      }
+    cell.mean /= cell.weights.size();
+  };
+
+  vector<Cell> cells(1);
+  for (int iDimension=0; iDimension<nDimensions; iDimension++)
+    {
+    cells[0].lower[iDimension] = 0.0;
+    cells[0].upper[iDimension] = 1.0;
+    }
+  cells[0].volume = 1.0;
+  explore(cells[0]);
+  while (int(cells.size())<nCells)
+    {
+    int    worstCell  = -1;
+    double worstWaste = 0.0;
+    for (unsigned int iCell=0; iCell<cells.size(); iCell++)
+      {
+      double waste = (cells[iCell].maximum-cells[iCell].mean)*cells[iCell].volume;
+      if (waste>worstWaste)
+        {
+        worstWaste = waste;
+        worstCell  = iCell;
+        }
+      }
+    if (worstCell<0) break;
+    Cell & cell = cells[worstCell];
+    int    bestDimension = 0;
+    double bestEnvelope  = -1.0;
+    unsigned int nPoints = cell.weights.size();
+    for (int iDimension=0; iDimension<nDimensions; iDimension++)
+      {
+      double middle = 0.5*(cell.lower[iDimension]+cell.upper[iDimension]);
+      double maximumLow  = 0.0;
+      double maximumHigh = 0.0;
+      for (unsigned int iPoint=0; iPoint<nPoints; iPoint++)
+        {
+        double & maximum = cell.points[iPoint*nDimensions+iDimension]<middle ? maximumLow : maximumHigh;
+        if (cell.weights[iPoint]>maximum) maximum = cell.weights[iPoint];
+        }
+      if (bestEnvelope<0.0 || maximumLow+maximumHigh<bestEnvelope)
+        {
+        bestEnvelope  = maximumLow+maximumHigh;
+        bestDimension = iDimension;
+        }
+      }
+    double middle = 0.5*(cell.lower[bestDimension]+cell.upper[bestDimension]);
+    Cell low  = cell;
+    Cell high = cell;
+    low.upper[bestDimension]  = middle;
+    high.lower[bestDimension] = middle;
+    low.volume  = high.volume = 0.5*cell.volume;
+    low.points.clear();  low.weights.clear();
+    high.points.clear(); high.weights.clear();
+    for (unsigned int iPoint=0; iPoint<nPoints; iPoint++)
+      {
+      const double * point = &cell.points[iPoint*nDimensions];
+      Cell & half = point[bestDimension]<middle ? low : high;
+      half.points.insert(half.points.end(),point,point+nDimensions);
+      half.weights.push_back(cell.weights[iPoint]);
+      }
+    explore(low);
+    explore(high);
+    cells[worstCell] = std::move(low);
+    cells.push_back(std::move(high));
+    }
+
+  unsigned int nCellsBuilt = cells.size();
+  cellLower.resize(nCellsBuilt*nDimensions);
+  cellUpper.resize(nCellsBuilt*nDimensions);
+  cellVolume.resize(nCellsBuilt);
+  cellMaximum.resize(nCellsBuilt);
+  double largest  = 0.0;
+  double integral = 0.0;
+  for (unsigned int iCell=0; iCell<nCellsBuilt; iCell++)
+    {
+    for (int iDimension=0; iDimension<nDimensions; iDimension++)
+      {
+      cellLower[iCell*nDimensions+iDimension] = cells[iCell].lower[iDimension];
+      cellUpper[iCell*nDimensions+iDimension] = cells[iCell].upper[iDimension];
+      }
+    cellVolume[iCell]  = cells[iCell].volume;
+    cellMaximum[iCell] = safetyFactor*cells[iCell].maximum;
+    if (cellMaximum[iCell]>largest) largest = cellMaximum[iCell];
+    integral += cells[iCell].mean*cells[iCell].volume;
+    }
+  for (auto & maximum : cellMaximum) if (maximum<1.0E-3*largest) maximum = 1.0E-3*largest;
+  updateCellSelector();
+  double envelope = 0.0;
+  for (unsigned int iCell=0; iCell<nCellsBuilt; iCell++) envelope += cellMaximum[iCell]*cellVolume[iCell];
+  efficiency = envelope>0.0 ? integral/envelope : 0.0;
+}
+
+void IntegrandSampler::updateCellSelector()
+{
+  vector<double> probabilities(cellMaximum.size());
+  for (unsigned int iCell=0; iCell<cellMaximum.size(); iCell++) probabilities[iCell] = cellMaximum[iCell]*cellVolume[iCell];
+  cellSelector.initializeWith(probabilities);
+}
+
+long IntegrandSampler::generate(Model & model, ParticleType & type, int & violatedCell, double & violatingWeight) const
+{
+  CAP::RandomStream * random = CAP::RandomStream::getRandomStream();
+  double r[nDimensions+2];
+  double u[nDimensions];
+  long   nTrials = 0;
+  while (true)
+    {
+    nTrials++;
+    random->fillUniform(nDimensions+2,r);
+    int iCell = cellSelector.generate(r[nDimensions]);
+    const double * lower = &cellLower[iCell*nDimensions];
+    const double * upper = &cellUpper[iCell*nDimensions];
+    for (int iDimension=0; iDimension<nDimensions; iDimension++)
+      u[iDimension] = lower[iDimension] + r[iDimension]*(upper[iDimension]-lower[iDimension]);
+    double weight = getWeight(model,type,u);
+    if (weight>cellMaximum[iCell])
+      {
+      violatedCell    = iCell;
+      violatingWeight = weight;
+      return nTrials;
+      }
+    if (r[nDimensions+1]*cellMaximum[iCell] < weight)
+      {
+      violatedCell    = -1;
+      violatingWeight = 0.0;
+      return nTrials;
+      }
+    }
+}
+
+void IntegrandSampler::raiseEnvelope(int iCell, double weight)
+{
+  nViolations++;
+  double maximum = safetyFactor*weight;
+  if (maximum<=cellMaximum[iCell]) return;
+  double envelope = 0.0;
+  for (unsigned int jCell=0; jCell<cellMaximum.size(); jCell++) envelope += cellMaximum[jCell]*cellVolume[jCell];
+  double raisedEnvelope = envelope + (maximum-cellMaximum[iCell])*cellVolume[iCell];
+  efficiency *= envelope/raisedEnvelope;
+  cellMaximum[iCell] = maximum;
+  updateCellSelector();
+}
+
+double IntegrandSampler::map(const double * u, double * x, int * bins) const
+{
+  double jacobian = 1.0;
+  for (int iDimension=0; iDimension<nDimensions; iDimension++)
+    {
+    double position = u[iDimension]*nBins;
+    int    bin      = int(position);
+    if (bin>=nBins) bin = nBins-1;
+    const double * edge = &edges[iDimension*(nBins+1)+bin];
+    double width    = edge[1] - edge[0];
+    x[iDimension]   = edge[0] + (position-bin)*width;
+    bins[iDimension] = bin;
+    jacobian *= nBins*width;
+    }
+  return jacobian;
+}
+
+//!
+//! The weights are smoothed over neighbouring bins and damped as in VEGAS (exponent 1.5) so the grid converges without oscillating. Each
+//! bin keeps at least a hundredth of the average share so no part of the hypercube is left out of the proposals.
+//!
+void IntegrandSampler::refine(const vector<double> & binWeights)
+{
+  vector<double> smoothed(nBins);
+  vector<double> newEdges(nBins+1);
+  for (int iDimension=0; iDimension<nDimensions; iDimension++)
+    {
+    const double * w = &binWeights[iDimension*nBins];
+    double sum = 0.0;
+    for (int iBin=0; iBin<nBins; iBin++)
+      {
+      double left  = iBin>0       ? w[iBin-1] : w[iBin];
+      double right = iBin<nBins-1 ? w[iBin+1] : w[iBin];
+      smoothed[iBin] = (left + w[iBin] + right)/3.0;
+      sum += smoothed[iBin];
+      }
+    if (sum<=0.0) continue;
+    double total = 0.0;
+    for (int iBin=0; iBin<nBins; iBin++)
+      {
+      double fraction = smoothed[iBin]/sum;
+      smoothed[iBin]  = (fraction>0.0 && fraction<1.0) ? pow((fraction-1.0)/log(fraction), 1.5) : fraction;
+      total += smoothed[iBin];
+      }
+    double minimumShare = 0.01*total/nBins;
+    total = 0.0;
+    for (int iBin=0; iBin<nBins; iBin++)
+      {
+      if (smoothed[iBin]<minimumShare) smoothed[iBin] = minimumShare;
+      total += smoothed[iBin];
+      }
+    double * edge = &edges[iDimension*(nBins+1)];
+    double share  = total/nBins;
+    double accumulated = 0.0;
+    int    iBin   = 0;
+    newEdges[0]     = 0.0;
+    newEdges[nBins] = 1.0;
+    for (int iEdge=1; iEdge<nBins; iEdge++)
+      {
+      double target = iEdge*share;
+      while (iBin<nBins-1 && accumulated+smoothed[iBin]<target) accumulated += smoothed[iBin++];
+      double fraction = smoothed[iBin]>0.0 ? (target-accumulated)/smoothed[iBin] : 0.0;
+      if (fraction>1.0) fraction = 1.0;
+      newEdges[iEdge] = edge[iBin] + fraction*(edge[iBin+1]-edge[iBin]);
+      }
+    for (int iEdge=0; iEdge<=nBins; iEdge++) edge[iEdge] = newEdges[iEdge];
+    }
+}
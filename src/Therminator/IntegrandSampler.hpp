@@ -0,0 +1,114 @@
+/* **********************************************************************
+ * Copyright (C) 2019-2022, Claude Pruneau, Victor Gonzalez, Sumit Basu
+ * All rights reserved.
+ *
+ * Based on the ROOT package and environment
+ *
+ * For the licensing terms see LICENSE.
+ *
+ * Author: Claude Pruneau,   04/01/2022
+ *
+ * *********************************************************************/
+#ifndef _TH2_IntegrandSampler_
+#define _TH2_IntegrandSampler_
+#include <vector>
+#include "Model.hpp"
+#include "SelectionGenerator.hpp"
+using namespace std;
+using CAP::SelectionGenerator;
+
+//!
+//! Importance sampler of the Cooper-Frye integrand of a particle species (see Model::getIntegrandAt).
+//!
+//! The sampler is built in two steps. The unit hypercube of the model is first mapped onto itself with a separable, piecewise linear
+//! grid (as in VEGAS): each dimension is divided in nBins bins whose widths are adapted, pass after pass, so that the bins hold equal
+//! shares of the integrand. The weight of a point u of the mapped hypercube is w(u) = f(x(u)) J(u), where J is the jacobian of the
+//! grid. The mapped hypercube is then split in nCells cells (as in FOAM): the cell that wastes the most proposals is split in two
+//! halves, along the dimension that best separates its large and small weights, until nCells cells are obtained. The largest weight
+//! found in each cell, times a safety factor, is the envelope of the weights in that cell.
+//!
+//! A point is generated by choosing a cell with probability proportional to its envelope times its volume, proposing a uniform point
+//! in that cell, and accepting it with probability w/envelope. Accepted points are thus distributed as the integrand f. Should a weight
+//! larger than the envelope of its cell be found, the point is discarded and counted as a violation: the envelope of the cell must then
+//! be raised (see raiseEnvelope) before points are generated again. A non zero number of violations means the safety factor (or the
+//! number of points per cell) should be increased.
+//!
+//! Generating points does not modify the sampler, so a sampler may be shared by generators running on different threads as long as
+//! each of them raises the envelope of its own copy.
+//!
+class IntegrandSampler
+{
+public:
+
+  IntegrandSampler();
+  virtual ~IntegrandSampler() {}
+
+  //!
+  //! Build the sampler for the given species: nIterations passes of nSamples points adapt the grid, then nCells cells are built with
+  //! nCellSamples points per cell.
+  //!
+  void initialize(Model & model, ParticleType & type,
+                  int nBins, int nIterations, int nSamples,
+                  int nCells, int nCellSamples, double safetyFactor);
+
+  //!
+  //! Generate points until one is accepted, or until a point exceeds the envelope of its cell. The position and momentum of the
+  //! accepted point are left in the model (see Model::setParticlePX). Returns the number of points tried. The cell of the point that
+  //! exceeded the envelope, if any, is returned in violatedCell (-1 otherwise) and its weight in violatingWeight: that point is not
+  //! accepted, and raiseEnvelope must be called before points are generated again.
+  //!
+  long generate(Model & model, ParticleType & type, int & violatedCell, double & violatingWeight) const;
+
+  //!
+  //! Raise the envelope of the given cell to the safety factor times the given weight, and count the violation.
+  //!
+  void raiseEnvelope(int iCell, double weight);
+
+  bool   isInitialized() const     { return nBins>0;              }
+  int    getNCells() const         { return cellMaximum.size();   }
+  long   getNViolations() const    { return nViolations;          }
+
+  //!
+  //! Expected fraction of proposed points that are accepted, i.e., the integral of the weights over that of the envelope.
+  //!
+  double getEfficiency() const     { return efficiency;           }
+
+protected:
+
+  //!
+  //! Map the point u of the unit hypercube onto the grid point x. Returns the jacobian of the mapping.
+  //!
+  double map(const double * u, double * x, int * bins) const;
+
+  //!
+  //! Move the bin edges of each dimension so the bins hold equal shares of the given accumulated weights.
+  //!
+  void refine(const vector<double> & binWeights);
+
+  //!
+  //! Split the mapped hypercube in nCells cells and set the envelope of each cell.
+  //!
+  void buildCells(Model & model, ParticleType & type, int nCells, int nCellSamples);
+
+  //!
+  //! Weight of the point u of the mapped hypercube.
+  //!
+  double getWeight(Model & model, ParticleType & type, const double * u) const;
+
+  void updateCellSelector();
+
+  int            nBins;
+  vector<double> edges;          //!< bin edges, [iDimension*(nBins+1)+iEdge]
+  vector<double> cellLower;      //!< lower corners of the cells, [iCell*nIntegrandDimensions+iDimension]
+  vector<double> cellUpper;      //!< upper corners of the cells, [iCell*nIntegrandDimensions+iDimension]
+  vector<double> cellVolume;
+  vector<double> cellMaximum;    //!< envelope of the weights in each cell
+  SelectionGenerator cellSelector;
+  double         safetyFactor;
+  double         efficiency;
+  long           nViolations;
+
+  ClassDef(IntegrandSampler,0)
+};
+
+#endif
@@ -29,6 +29,7 @@
 //#include <sys/stat.h>
 #include "Model.hpp"
 #include "PhysicsConstants.hpp"
+#include "RandomStream.hpp"
 
 using namespace std;
 ClassImp(Model);
@@ -281,7 +282,15 @@ void   Model::initialize()
 }
 
 
-double Model::getIntegrand(ParticleType& aPartType __attribute__((unused)))
+double Model::getIntegrand(ParticleType& aPartType)
+{
+  double r[nIntegrandDimensions];
+  CAP::RandomStream::getRandomStream()->fillUniform(nIntegrandDimensions,r);
+  return getIntegrandAt(aPartType,r);
+}
+
+double Model::getIntegrandAt(ParticleType& aPartType __attribute__((unused)),
+                             const double * r __attribute__((unused)) )
 {
   return -1.0;
 }
@@ -49,6 +49,8 @@ public:
   Model(const Configuration & _requestedConfiguration);
   virtual ~Model() {};
 
+  static constexpr int nIntegrandDimensions = 6; //!< number of uniform numbers used by getIntegrandAt
+
   virtual void   setDefaultConfiguration();
   virtual void   configure();
   virtual void   printConfiguration(ostream & output);
@@ -78,6 +80,7 @@ public:
   virtual Hypersurface   * getHypersurface() const;
   virtual void   setParticlePX(Particle& _particle);
   virtual double getIntegrand(ParticleType& aPartType);
+  virtual double getIntegrandAt(ParticleType& aPartType, const double * r);
   virtual double getDSigmaP(double mT,  double pT,  double phiP, double rapidityP);
   virtual double getPdotU(double mT,  double pT,  double phiP, double rapidityP);
   
@@ -140,7 +143,14 @@ protected:
  * @fn virtual Model::~Model();
  * @brief Destructor.
  *
- * @fn virtual double Model::getIntegrand(ParticleType& aPartType) = 0
+ * @fn virtual double Model::getIntegrand(ParticleType& aPartType)
+ * @brief Calculates the integrand at a random point of the model hypercube: draws nIntegrandDimensions uniform numbers and calls getIntegrandAt.
+ *
+ * @fn virtual double Model::getIntegrandAt(ParticleType& aPartType, const double * r)
+ * @brief Calculates the integrand at the point r of the unit hypercube. r[0..2] select the position (or the point on the hypersurface),
+ * r[3] the transverse momentum through pT = r[3]/(1-r[3]), r[4] the azimuth, and r[5] the rapidity. The integrand includes the jacobian
+ * of this mapping, so its average over the unit hypercube times the hypercube volume is the multiplicity. Returns -1 in this base class.
+ *
  * @brief Generates random space-time coordinates and four-momentum of a particle of a given type
  * and returns the value of the integrand of the Cooper-Frye formula.
  * @warning The user MUST define this function in his own derived class.
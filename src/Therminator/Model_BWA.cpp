@@ -28,6 +28,7 @@
 #include <sstream>
 //// #include <TMath.h>
 #include "Model_BWA.hpp"
+#include "RandomStream.hpp"
 
 using namespace std;
 
@@ -39,7 +40,7 @@ Model_BWA::Model_BWA(const Configuration & _requestedConfiguration)
 Model(_requestedConfiguration)
 {    }
 
-double Model_BWA::getIntegrand(ParticleType& aPartType)
+double Model_BWA::getIntegrandAt(ParticleType& aPartType, const double * r)
 {
   double dSigmaP, PdotU;
   double spinFactor, statistics, mass;
@@ -58,17 +59,17 @@ double Model_BWA::getIntegrand(ParticleType& aPartType)
   mass          = aPartType.getMass();
   chemPotential = thermodynamics->getChemicalPotential(aPartType);
   // Generate spacial components
-  rho	      = rhoMax * gRandom->Rndm();
-  phiS    	= CAP::Math::twoPi() * gRandom->Rndm();
-  rapidityS	= spatialRapidityRange * (gRandom->Rndm() - 0.5);;
+  rho	      = rhoMax * r[0];
+  phiS    	= CAP::Math::twoPi() * r[1];
+  rapidityS	= spatialRapidityRange * (r[2] - 0.5);;
   tau       = tauI + amp * rho;
 // Generate momentum components
-  zeta      = gRandom->Rndm();
+  zeta      = r[3];
   zetac     = (zeta>0.9999999) ? 0.00000001 : 1.00-zeta;
   pT        = zeta/zetac;
   dPt       = 1.0/(zetac*zetac);
-  phiP	    = CAP::Math::twoPi() * gRandom->Rndm();
-  rapidityP	= momentumRapidityRange * (gRandom->Rndm() - 0.5);// * momentumRapidityRange;
+  phiP	    = CAP::Math::twoPi() * r[4];
+  rapidityP	= momentumRapidityRange * (r[5] - 0.5);// * momentumRapidityRange;
   mT	      = sqrt(mass*mass+pT*pT);
 // Transverse velocity
   //vT        = pT/(mT*cosh(rapidityP));
@@ -105,10 +106,10 @@ double Model_BWA::getIntegrand(ParticleType& aPartType)
       default: break;
       case 3:
       case 5:
-      Xt += -delay * log(gRandom->Rndm()); break;
+      Xt += -delay * log(CAP::RandomStream::getRandomStream()->Rndm()); break;
       case 6:
       double Energy = sqrt(mT*mT + Pz*Pz);    //hypot(mT,Pz);
-      Xt += -delay * log(gRandom->Rndm());
+      Xt += -delay * log(CAP::RandomStream::getRandomStream()->Rndm());
       Xx += Xt * Px / Energy;
       Xy += Xt * Py / Energy;
       Xz += Xt * Pz / Energy;
@@ -37,7 +37,7 @@ class Model_BWA : public Model
 public:
   Model_BWA(const Configuration & _requestedConfiguration);
   virtual ~Model_BWA() {}
-  virtual double getIntegrand(ParticleType& aPartType);
+  virtual double getIntegrandAt(ParticleType& aPartType, const double * r);
 
   ClassDef(Model_BWA,0)
 };
@@ -26,6 +26,7 @@
  *                                                                              *
  ********************************************************************************/
 #include "Model_BlastWave.hpp"
+#include "RandomStream.hpp"
 ClassImp(Model_BlastWave);
 
 Model_BlastWave::Model_BlastWave(const Configuration & _requestedConfiguration)
@@ -33,7 +34,7 @@ Model_BlastWave::Model_BlastWave(const Configuration & _requestedConfiguration)
 Model(_requestedConfiguration)
 {   }
 
-double Model_BlastWave::getIntegrand(ParticleType& aPartType)
+double Model_BlastWave::getIntegrandAt(ParticleType& aPartType, const double * r)
 {
   double dSigmaP, PdotU;
   double spinFactor, statistics, mass;
@@ -51,19 +52,19 @@ double Model_BlastWave::getIntegrand(ParticleType& aPartType)
   chemPotential = thermodynamics->getChemicalPotential(aPartType);
   //temperature   = thermodynamics->getTemperature();
   // Generate spacial components
-  rho	  = rhoMax * gRandom->Rndm();
-  phiS	= CAP::Math::twoPi() * gRandom->Rndm();
-  rapidityS  = spatialRapidityRange * (gRandom->Rndm() - 0.5);
+  rho	  = rhoMax * r[0];
+  phiS	= CAP::Math::twoPi() * r[1];
+  rapidityS  = spatialRapidityRange * (r[2] - 0.5);
   Tau	= tauI;
 // Generate momentum components
-  zeta  = gRandom->Rndm();
+  zeta  = r[3];
   zetac = (zeta>0.9999999) ? 0.00000001 : 1.00-zeta;
   pT	  = zeta/zetac;
   dPt	  = 1.0/(zetac*zetac);
 
-  phiP	= CAP::Math::twoPi() * gRandom->Rndm();
+  phiP	= CAP::Math::twoPi() * r[4];
   mT    = sqrt(mass*mass+pT*pT);
-  rapidityP	= momentumRapidityRange * (gRandom->Rndm() - 0.5);
+  rapidityP	= momentumRapidityRange * (r[5] - 0.5);
 // Invariants
  // double vT     = transverseVelocity;
  // double gammaT = 1.0 / sqrt(1.000 - vT * vT);
@@ -38,7 +38,7 @@ class Model_BlastWave
 public:
   Model_BlastWave(const Configuration & _requestedConfiguration);
   virtual ~Model_BlastWave() {}
-  virtual double getIntegrand(ParticleType& aPartType);
+  virtual double getIntegrandAt(ParticleType& aPartType, const double * r);
  
 protected:
 
@@ -27,6 +27,7 @@
  ********************************************************************************/
 #include "Model_HadronGas.hpp"
 #include "MathConstants.hpp"
+#include "RandomStream.hpp"
 
 ClassImp(Model_HadronGas);
 
@@ -35,7 +36,7 @@ Model_HadronGas::Model_HadronGas(const Configuration & _requestedConfiguration)
 Model(_requestedConfiguration)
 {   }
 
-double Model_HadronGas::getIntegrand(ParticleType& aPartType)
+double Model_HadronGas::getIntegrandAt(ParticleType& aPartType, const double * r)
 {
   double dSigmaP, PdotU;
   double spinFactor, statistics, mass;
@@ -52,18 +53,18 @@ double Model_HadronGas::getIntegrand(ParticleType& aPartType)
   statistics    = aPartType.getStatistics();
   mass          = aPartType.getMass();
   chemPotential = thermodynamics->getChemicalPotential(aPartType);
-  rho	          = rhoMax * gRandom->Rndm();
-  phiS          = CAP::Math::twoPi() * gRandom->Rndm();
-  rapidityS     = spatialRapidityRange * (gRandom->Rndm() - 0.5);
+  rho	          = rhoMax * r[0];
+  phiS          = CAP::Math::twoPi() * r[1];
+  rapidityS     = spatialRapidityRange * (r[2] - 0.5);
   Tau	          = tauI;
 // Generate momentum components
-  zeta          = gRandom->Rndm();
+  zeta          = r[3];
   zetac         = (zeta>0.9999999) ? 0.00000001 : 1.00-zeta;
   pT	          = zeta/zetac;
   dPt	          = 1.0/(zetac*zetac);
-  phiP	        = CAP::Math::twoPi() * gRandom->Rndm();
+  phiP	        = CAP::Math::twoPi() * r[4];
   mT            = sqrt(mass*mass+pT*pT);
-  rapidityP	    = momentumRapidityRange * (gRandom->Rndm() - 0.5);
+  rapidityP	    = momentumRapidityRange * (r[5] - 0.5);
   energy        = mT * cosh(rapidityP);
   denom         = statistics + exp( (energy-chemPotential)/temperature );
   integrand     = spinFactor * pT * dPt /(CAP::Math::twoPiCube()*denom);
@@ -16,7 +16,7 @@ class Model_HadronGas
 public:
   Model_HadronGas(const Configuration & _requestedConfiguration);
   virtual ~Model_HadronGas() {}
-  virtual double getIntegrand(ParticleType& aPartType);
+  virtual double getIntegrandAt(ParticleType& aPartType, const double * r);
  
 protected:
 
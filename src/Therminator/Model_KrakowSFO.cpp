@@ -30,6 +30,7 @@
 //// #include <TMath.h>
 //#include "THGlobal.hpp"
 #include "Model_KrakowSFO.hpp"
+#include "RandomStream.hpp"
 
 using namespace CAP::Math;
 using namespace std;
@@ -40,7 +41,7 @@ Model_KrakowSFO::Model_KrakowSFO(const Configuration & _requestedConfiguration)
 Model(_requestedConfiguration)
 {    }
 
-double Model_KrakowSFO::getIntegrand(ParticleType& aPartType)
+double Model_KrakowSFO::getIntegrandAt(ParticleType& aPartType, const double * r)
 {
   double dSigmaP, PdotU;
   double spinFactor, statistics, mass;
@@ -58,17 +59,17 @@ double Model_KrakowSFO::getIntegrand(ParticleType& aPartType)
   mass          = aPartType.getMass();
   chemPotential = thermodynamics->getChemicalPotential(aPartType);
   // Generate spacial components
-  rho	       = rhoMax * gRandom->Rndm();
-  phiS	     = CAP::Math::twoPi() * gRandom->Rndm();
-  rapidityS	 = spatialRapidityRange * (gRandom->Rndm() - 0.5);
+  rho	       = rhoMax * r[0];
+  phiS	     = CAP::Math::twoPi() * r[1];
+  rapidityS	 = spatialRapidityRange * (r[2] - 0.5);
   tau	       = tauC; // that is the KrakowSFO Model tau that equals $\tau_{KrakowSFO}^2 = t^2 - x^2 - y^2 - z^2 = \tau^2 - \rho^2 - z^2$
   // Generate momentum components
-  zeta       = gRandom->Rndm();
+  zeta       = r[3];
   zetac      = (zeta>0.9999999) ? 0.00000001 : 1.00-zeta;
   pT         = zeta/zetac;
   dPt        = 1.0/(zetac*zetac);
-  phiP	     = CAP::Math::twoPi() * gRandom->Rndm();
-  rapidityP	 = momentumRapidityRange * (gRandom->Rndm() - 0.5);;
+  phiP	     = CAP::Math::twoPi() * r[4];
+  rapidityP	 = momentumRapidityRange * (r[5] - 0.5);;
   mT	       = sqrt(mass*mass+pT*pT);
   tauTrue    =  sqrt(tau*tau + rho*rho);  // that's the true $\tau^2 = t^2 - z^2$
   // Invariants
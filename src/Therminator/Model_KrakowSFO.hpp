@@ -36,7 +36,7 @@ class Model_KrakowSFO
 public:
    Model_KrakowSFO(const Configuration & _requestedConfiguration);
   virtual ~Model_KrakowSFO() {}
-  virtual double getIntegrand(ParticleType& aPartType);
+  virtual double getIntegrandAt(ParticleType& aPartType, const double * r);
 
 protected:
   ClassDef(Model_KrakowSFO,0)
@@ -28,6 +28,7 @@
 
 #include "Model_Lhyquid2DBI.hpp"
 #include "Hypersurface_Lhyquid2D.hpp"
+#include "RandomStream.hpp"
 ClassImp(Model_Lhyquid2DBI);
 
 Model_Lhyquid2DBI::Model_Lhyquid2DBI(const Configuration & _requestedConfiguration)
@@ -35,7 +36,7 @@ Model_Lhyquid2DBI::Model_Lhyquid2DBI(const Configuration & _requestedConfigurati
 Model(_requestedConfiguration)
 {    }
 
-double Model_Lhyquid2DBI::getIntegrand(ParticleType& aPartType)
+double Model_Lhyquid2DBI::getIntegrandAt(ParticleType& aPartType, const double * r)
 {
   double dSigmaP, PdotU;
   double spinFactor, statistics, mass;
@@ -52,14 +53,14 @@ double Model_Lhyquid2DBI::getIntegrand(ParticleType& aPartType)
   chemPotential = thermodynamics->getChemicalPotential(aPartType);
   temperature   = thermodynamics->getTemperature();
   // Generate random position on the hypersurface
-  hypersurface->setPositionOnHypersurface(position);
+  hypersurface->setPositionOnHypersurface(position,r);
   // Generate momentum components
-  zeta      = gRandom->Rndm();
+  zeta      = r[3];
   zetac     = (zeta>0.9999999) ? 0.00000001 : 1.00-zeta;
   pT        = zeta/zetac;
   dPt       = 1.0/(zetac*zetac);
-  phiP	    = CAP::Math::twoPi() * gRandom->Rndm();
-  rapidityP = momentumRapidityRange * (gRandom->Rndm() - 0.5); // * momentumRapidityRange;
+  phiP	    = CAP::Math::twoPi() * r[4];
+  rapidityP = momentumRapidityRange * (r[5] - 0.5); // * momentumRapidityRange;
   mT        = sqrt(mass*mass+pT*pT);
   // d Sigmap_\mu p^\mu
   dSigmaP   = getDSigmaP(mT, pT, phiP, rapidityP);
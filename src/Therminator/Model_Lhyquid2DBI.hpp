@@ -39,7 +39,7 @@ public:
   Model_Lhyquid2DBI(const Configuration & _requestedConfiguration);
   virtual ~Model_Lhyquid2DBI() {}
   virtual void  initialize();
-  virtual double getIntegrand(ParticleType& aPartType);
+  virtual double getIntegrandAt(ParticleType& aPartType, const double * r);
 
 protected:
   ClassDef(Model_Lhyquid2DBI,0)
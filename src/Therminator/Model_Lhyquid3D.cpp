@@ -28,6 +28,7 @@
 
 #include "Model_Lhyquid3D.hpp"
 #include "Hypersurface_Lhyquid3D.hpp"
+#include "RandomStream.hpp"
 
 ClassImp(Model_Lhyquid3D);
 
@@ -36,7 +37,7 @@ Model_Lhyquid3D::Model_Lhyquid3D(const Configuration & _requestedConfiguration)
 Model(_requestedConfiguration)
 {   }
 
-double Model_Lhyquid3D::getIntegrand(ParticleType& aPartType)
+double Model_Lhyquid3D::getIntegrandAt(ParticleType& aPartType, const double * r)
 {
   double dSigmaP, PdotU;
   double spinFactor, statistics, mass;
@@ -54,15 +55,15 @@ double Model_Lhyquid3D::getIntegrand(ParticleType& aPartType)
   chemPotential = thermodynamics->getChemicalPotential(aPartType);
   temperature   = thermodynamics->getTemperature();
 // Generate random position on the hypersurface
-  hypersurface->setPositionOnHypersurface(position);
+  hypersurface->setPositionOnHypersurface(position,r);
 // Generate momentum components
-  zeta  = gRandom->Rndm();
+  zeta  = r[3];
   zetac = (zeta>0.9999999) ? 0.00000001 : 1.00-zeta;
   pT    = zeta/zetac;
   dPt    = 1.0/(zetac*zetac);
-  phiP	= CAP::Math::twoPi() * gRandom->Rndm();
+  phiP	= CAP::Math::twoPi() * r[4];
   //rapidityP  = momentumRapidityRange * gRandom->Rndm() - 0.5 * momentumRapidityRange;
-  rapidityP  = momentumRapidityRange * (gRandom->Rndm() - 0.5);
+  rapidityP  = momentumRapidityRange * (r[5] - 0.5);
   mT	= sqrt(mass*mass+pT*pT);
 // d Sigamp_\mu p^\mu
   dSigmaP = getDSigmaP(mT, pT, phiP, rapidityP);
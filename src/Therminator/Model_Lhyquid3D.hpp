@@ -38,7 +38,7 @@ class Model_Lhyquid3D
   public:
   Model_Lhyquid3D(const Configuration & _requestedConfiguration);
   virtual ~Model_Lhyquid3D() {}
-  virtual double getIntegrand(ParticleType& aPartType);
+  virtual double getIntegrandAt(ParticleType& aPartType, const double * r);
   virtual void initialize();
 
 protected:
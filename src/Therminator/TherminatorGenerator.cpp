@@ -25,6 +25,13 @@
  * available.                                                                   *
  *                                                                              *
  ********************************************************************************/
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <sstream>
+#include "TROOT.h"
+#include "TSystem.h"
 #include "TherminatorGenerator.hpp"
 #include "Model_BWA.hpp"
 #include "Model_BlastWave.hpp"
@@ -34,10 +41,24 @@
 #include "Model_HadronGas.hpp"
 #include "Hypersurface_Lhyquid2D.hpp"
 #include "Hypersurface_Lhyquid3D.hpp"
+#include "RandomStream.hpp"
+#include "Crc32.hpp"
 
 using CAP::Event;
 ClassImp(TherminatorGenerator);
 
+//!
+//! Index of the random streams used to integrate the multiplicities: stream (integrationStreamIndex,iType) integrates species iType.
+//! The index is distinct from those used by TaskIterator for threads and sub-bunches.
+//!
+static const ULong64_t integrationStreamIndex = 0xFFFFFFFF;
+
+//!
+//! Serializes the integration of the multiplicities and the cache accesses of the generators initialized concurrently (one per
+//! thread, see TaskIterator): the first generator integrates and fills the cache, the others load it.
+//!
+static std::mutex multiplicitiesMutex;
+
 
 //  if      (modelType == "KrakowSFO")    { sModel = 0;  tModelINI += "krakow.ini";  }
 //  else if (modelType == "BlastWave")    { sModel = 1;  tModelINI += "blastwave.ini";  }
@@ -78,19 +99,45 @@ multiplicitiesFractionRange(0.5),
 multiplicitiesForceZeroNetQ(1),
 disablePhotons(true),
 nSamplesIntegration(10000),
+nThreadsIntegration(1),
+multiplicitiesCache(false),
+multiplicitiesCachePath("./"),
 modelOnlyBackFlow(0),
 decayRescaleChannels(0),
 decayDisabled(false),
 decayDisable2Prong(false),
 decayDisable3Prong(false),
-particleDecayer(),
+samplingAdaptive(true),
+samplingBins(50),
+samplingIterations(5),
+samplingSamples(5000),
+samplingCells(256),
+samplingCellSamples(1000),
+samplingSafetyFactor(1.5),
+decayCascade(),
 model(nullptr),
 averageMultiplicities(),
-eventMultiplicities()
+eventMultiplicities(),
+speciesSelector(),
+totalAverageMultiplicity(0.0),
+samplers(),
+speciesTrials(),
+speciesAccepted()
 {
   appendClassName("TherminatorGenerator");
 }
 
+CAP::Task * TherminatorGenerator::clone() const
+{
+  TherminatorGenerator * task = new TherminatorGenerator(getName(),configuration);
+  configureClone(task);
+  // the samplers are only read while generating, so the clones use those already built until they must raise an envelope (see generateAdaptive()).
+  task->samplers = samplers;
+  // the multiplicities are integrated once, by the generator the clones are made from (see initializeEventGenerator()).
+  task->averageMultiplicities = averageMultiplicities;
+  return task;
+}
+
 void TherminatorGenerator::setDefaultConfiguration()
 {
   EventTask::setDefaultConfiguration();
@@ -119,6 +166,9 @@ void TherminatorGenerator::setDefaultConfiguration()
 
   addParameter( "DisablePhotons",               disablePhotons);
   addParameter( "nSamplesIntegration",          nSamplesIntegration);
+  addParameter( "nThreadsIntegration",          nThreadsIntegration);
+  addParameter( "MultiplicitiesCache",          multiplicitiesCache);
+  addParameter( "MultiplicitiesCachePath",      multiplicitiesCachePath);
   addParameter( "ModelOnlyBackFlow",            modelOnlyBackFlow);
   addParameter( "DecayRescaleChannels",         decayRescaleChannels);
   addParameter( "DecayDisabled",                decayDisabled);
@@ -126,6 +176,13 @@ void TherminatorGenerator::setDefaultConfiguration()
   addParameter( "DecayDisable2Prong",           decayDisable2Prong);
   addParameter( "DecayNoWeakDecay",             decayNoWeakDecay);
   addParameter( "DecayStoreDecayedParts",       decayStoreDecayedParts);
+  addParameter( "SamplingAdaptive",             samplingAdaptive);
+  addParameter( "SamplingBins",                 samplingBins);
+  addParameter( "SamplingIterations",           samplingIterations);
+  addParameter( "SamplingSamples",              samplingSamples);
+  addParameter( "SamplingCells",                samplingCells);
+  addParameter( "SamplingCellSamples",          samplingCellSamples);
+  addParameter( "SamplingSafetyFactor",         samplingSafetyFactor);
 }
 
 void TherminatorGenerator::configure()
@@ -156,6 +213,9 @@ void TherminatorGenerator::configure()
 
   disablePhotons              = getValueBool(   "DisablePhotons");
   nSamplesIntegration         = getValueInt(    "nSamplesIntegration");
+  nThreadsIntegration         = getValueInt(    "nThreadsIntegration");
+  multiplicitiesCache         = getValueBool(   "MultiplicitiesCache");
+  multiplicitiesCachePath     = getValueString( "MultiplicitiesCachePath");
   modelOnlyBackFlow           = getValueBool(   "ModelOnlyBackFlow");
   decayRescaleChannels        = getValueBool(   "DecayRescaleChannels");
   decayDisabled               = getValueBool(   "DecayDisabled");
@@ -163,6 +223,15 @@ void TherminatorGenerator::configure()
   decayDisable2Prong          = getValueBool(   "DecayDisable2Prong");
   decayNoWeakDecay            = getValueBool(   "DecayNoWeakDecay");
   decayStoreDecayedParts      = getValueBool(   "DecayStoreDecayedParts");
+  samplingAdaptive            = getValueBool(   "SamplingAdaptive");
+  samplingBins                = getValueInt(    "SamplingBins");
+  samplingIterations          = getValueInt(    "SamplingIterations");
+  samplingSamples             = getValueInt(    "SamplingSamples");
+  samplingCells               = getValueInt(    "SamplingCells");
+  samplingCellSamples         = getValueInt(    "SamplingCellSamples");
+  samplingSafetyFactor        = getValueDouble( "SamplingSafetyFactor");
+  decayCascade.setDisable2Prong(decayDisable2Prong);
+  decayCascade.setDisable3Prong(decayDisable3Prong);
 
   if (reportInfo(__FUNCTION__))
     {
@@ -191,6 +260,9 @@ void TherminatorGenerator::configure()
     printItem( "MultiplicitiesForceZeroNetQ", multiplicitiesForceZeroNetQ);
     printItem( "DisablePhotons",              disablePhotons);
     printItem( "nSamplesIntegration",         nSamplesIntegration);
+    printItem( "nThreadsIntegration",         nThreadsIntegration);
+    printItem( "MultiplicitiesCache",         multiplicitiesCache);
+    printItem( "MultiplicitiesCachePath",     multiplicitiesCachePath);
     printItem( "ModelOnlyBackFlow",           modelOnlyBackFlow);
     printItem( "DecayRescaleChannels",        decayRescaleChannels);
     printItem( "DecayDisabled",               decayDisabled);
@@ -198,6 +270,13 @@ void TherminatorGenerator::configure()
     printItem( "DecayDisable2Prong",          decayDisable2Prong);
     printItem( "DecayNoWeakDecay",            decayNoWeakDecay);
     printItem( "DecayStoreDecayedParts",      decayStoreDecayedParts);
+    printItem( "SamplingAdaptive",            samplingAdaptive);
+    printItem( "SamplingBins",                samplingBins);
+    printItem( "SamplingIterations",          samplingIterations);
+    printItem( "SamplingSamples",             samplingSamples);
+    printItem( "SamplingCells",               samplingCells);
+    printItem( "SamplingCellSamples",         samplingCellSamples);
+    printItem( "SamplingSafetyFactor",        samplingSafetyFactor);
     cout << endl;
     }
 }
@@ -238,6 +317,7 @@ void TherminatorGenerator::printEvent() {}
 
 void TherminatorGenerator::createEvent()
 {
+  TRandom * random = CAP::RandomStream::getRandomStream();
   Event & event = *eventStreams[0];
   event.reset();
   particleFactory->reset();
@@ -251,42 +331,53 @@ void TherminatorGenerator::createEvent()
   double multiplicitiesFraction = 1.0;
   if (multiplicitiesFractionRange>0 || multiplicitiesFractionMin<1)
     {
-    multiplicitiesFraction = multiplicitiesFractionMin + multiplicitiesFractionRange*gRandom->Rndm();
+    multiplicitiesFraction = multiplicitiesFractionMin + multiplicitiesFractionRange*random->Rndm();
     }
   int    mult  = 0;
   double mean  = 0;
-  for (unsigned int iType=0; iType<nTypes; iType++)
+  if (multiplicitiesFluctType==4)
+    {
+    // Poisson total multiplicity shared among species in proportion to their average multiplicities: equivalent to
+    // independent Poisson fluctuations of the species, with one Poisson draw and one uniform draw per particle.
+    eventMultiplicities.assign(nTypes,0);
+    mult = random->Poisson(multiplicitiesFraction * totalAverageMultiplicity);
+    for (int iParticle=0; iParticle<mult; iParticle++) eventMultiplicities[speciesSelector.generate()]++;
+    }
+  else
     {
-    switch (multiplicitiesFluctType)
+    for (unsigned int iType=0; iType<nTypes; iType++)
       {
-        case 0: // Poisson fluctuations
-        {
-        mean  = multiplicitiesFraction * averageMultiplicities[iType].multiplicity;
-        mult  = gRandom->Poisson(mean);
-        }
-        break;
-        case 1: // Negative Binomial  fluctuations
-        {
-        mult = 0; // HOW?
-        }
-        break;
-        default:
-        case 2: // Gaussian fluctuations
-        {
-        mean  = multiplicitiesFraction * averageMultiplicities[iType].multiplicity;
-        mult  = TMath::Max(0, int(gRandom->Gaus(mean,sqrt(mean))));
-        }
-        break;
-        case 3:  // Poisson or Gaussian fluctuations
+      switch (multiplicitiesFluctType)
         {
-        mean  = multiplicitiesFraction * averageMultiplicities[iType].multiplicity;
-        if (mean>20)
-          mult = TMath::Max(0, int(gRandom->Gaus(mean,sqrt(mean))));
-        else
-          mult = TMath::Max(0, int(gRandom->Poisson(mean)));
+          case 0: // Poisson fluctuations
+          {
+          mean  = multiplicitiesFraction * averageMultiplicities[iType].multiplicity;
+          mult  = random->Poisson(mean);
+          }
+          break;
+          case 1: // Negative Binomial  fluctuations
+          {
+          mult = 0; // HOW?
+          }
+          break;
+          default:
+          case 2: // Gaussian fluctuations
+          {
+          mean  = multiplicitiesFraction * averageMultiplicities[iType].multiplicity;
+          mult  = TMath::Max(0, int(random->Gaus(mean,sqrt(mean))));
+          }
+          break;
+          case 3:  // Poisson or Gaussian fluctuations
+          {
+          mean  = multiplicitiesFraction * averageMultiplicities[iType].multiplicity;
+          if (mean>20)
+            mult = TMath::Max(0, int(random->Gaus(mean,sqrt(mean))));
+          else
+            mult = TMath::Max(0, int(random->Poisson(mean)));
+          }
         }
+      eventMultiplicities[iType] = mult;
       }
-    eventMultiplicities[iType] = mult;
     }
 
   if (multiplicitiesForceZeroNetQ)
@@ -322,7 +413,7 @@ void TherminatorGenerator::createEvent()
   double  charge;
   double  strange;
   double  baryon;
-
+  vector<Particle*> unstableParticles;
 
   for (unsigned int iType=0; iType<nTypes; iType++)
     {
@@ -342,24 +433,32 @@ void TherminatorGenerator::createEvent()
     int iParticle = 0;
     while (iParticle < multiplicity)
       {
-      value     = model->getIntegrand(*particleType);
-      valueTest = gRandom->Rndm() * maxIntegrand;
-      if (valueTest<value)
+      if (samplingAdaptive)
         {
-        Particle * particle = factory->getNextObject();
-        particle->setType(particleType);
-        particle->setLive(true);
-        model->setParticlePX(*particle);
-        iParticle++;
-        if (decayDisabled || particleType->isStable())
-          {
-          if (accept(*particle)) event.add(particle);
-          }
-        else
-          decayParticle(event, *particle);
+        speciesTrials[iType] += generateAdaptive(iType,*particleType);
         }
+      else
+        {
+        speciesTrials[iType]++;
+        value     = model->getIntegrand(*particleType);
+        valueTest = random->Rndm() * maxIntegrand;
+        if (valueTest>=value) continue;
+        }
+      speciesAccepted[iType]++;
+      Particle * particle = factory->getNextObject();
+      particle->setType(particleType);
+      particle->setLive(true);
+      model->setParticlePX(*particle);
+      iParticle++;
+      if (decayDisabled || particleType->isStable())
+        {
+        if (accept(*particle)) event.add(particle);
+        }
+      else
+        unstableParticles.push_back(particle);
       }
     }
+  if (unstableParticles.size()>0) decayParticles(event, unstableParticles);
   if (totalQ!=0 || totalB!=0 || totalS!=0)
     {
     cout << "totalQ " << totalQ <<  "   totalB " << totalB <<  "   totalS " << totalS << endl;
@@ -381,210 +480,29 @@ bool TherminatorGenerator::accept(Particle & particle)
   return false;
 }
 
-void TherminatorGenerator::decayParticle(Event & event, Particle & parent)
+//!
+//!Decay the given unstable particles and their unstable descendants (see ParticleDecayCascade). Stable descendants are added to the event if
+//!accepted by the particle filters. Particles whose two- or three-body decays are disabled are added as is; decayed particles are added
+//!only if DecayStoreDecayedParts is true.
+//!
+void TherminatorGenerator::decayParticles(Event & event, vector<Particle*> & particles)
 {
-  ParticleType      & parentType = parent.getType();
-
-//  cout << " parent type name: " <<  parentType.getName() << endl;
-//  cout << " parent mass     : " <<  parentType.getMass() << endl;
-//  cout << " parent width    : " <<  parentType.getWidth() << endl;
-//  cout << " parent stable   : " <<  parentType.isStable() << endl;
-//  cout << " parent n modes  : " <<  parentType.getNDecayModes() << endl;
-
-//  bool flag = false;
-//  int pdg = std::fabs(parentType.getPdgCode());
-  //if (pdg==3112 || pdg==3212 || pdg==3222)
-//    if (pdg==3112 || pdg==3212)
-//    {
-//    cout << "Trying to decay pdg:" << pdg << endl;
-//    flag = true;
-//    }
- // double parentB = parentType.getBaryonNumber();
-
-  ParticleDecayMode & decayMode  = parentType.generateDecayMode();
-  int nChildren = decayMode.getNChildren();
-  if (nChildren<2)  return;
-  if ((nChildren==2 && decayDisable2Prong) ||
-      (nChildren==3 && decayDisable3Prong))
-    {
-    event.add(&parent);
-    return;
+  decayCascade.decay(particles, *particleFactory);
+  const vector<Particle*> & undecayed  = decayCascade.getUndecayed();
+  const vector<int>       & nChildren  = decayCascade.getUndecayedNChildren();
+  for (unsigned int iParticle=0; iParticle<undecayed.size(); iParticle++)
+    {
+    if (nChildren[iParticle]<2) continue;
+    if (nChildren[iParticle]>3) throw TaskException("4- or more body decay should not happen","TherminatorGenerator::decayParticles()");
+    event.add(undecayed[iParticle]);
     }
-  LorentzVector & parentMomentum  = parent.getMomentum();
-  LorentzVector & parentPosition  = parent.getPosition();
-
-  bool shit = false;
-  switch (nChildren)
+  if (decayStoreDecayedParts)
     {
-      case 1:
-      {
-      String s = "Single particle decay for ";
-      s += parent.getName();
-      throw TaskException(s,"TherminatorGenerator::decayParticle(Event & event, Particle & parent)");
-      }
-      break;
-
-      case 2:
-      {
-      Particle * child1 = particleFactory->getNextObject();
-      Particle * child2 = particleFactory->getNextObject();
-      ParticleType  & childType1 = decayMode.getChildType(0); child1->setType(&childType1); child1->setLive(true);
-      ParticleType  & childType2 = decayMode.getChildType(1); child2->setType(&childType2); child2->setLive(true);
-
-//      double childType1B = childType1.getBaryonNumber();
-//      double childType2B = childType2.getBaryonNumber();
-//      if (parentB != (childType1B+childType2B ))
-//        {
-//        cout << "Parent:" << parentType.getName << " C1: " << childType1.getName() << " C2: "<< childType1.getName() << "  "
-//        << "parentB: " << parentB << " childType1B+childType2B" << childType1B+childType2B << endl;
-//        exit(1);
-//        }
-
-      LorentzVector & p1 = child1->getMomentum();
-      LorentzVector & r1 = child1->getPosition();
-      LorentzVector & p2 = child2->getMomentum();
-      LorentzVector & r2 = child2->getPosition();
-      particleDecayer.decay2(parentType,
-                             parentMomentum,
-                             parentPosition,
-                             childType1,p1,r1,
-                             childType2,p2,r2);
-      parent.setDecayed(true);
-      if (decayStoreDecayedParts) event.add(&parent);
-      if (child1->isStable())
-        {
-        if (accept(*child1))
-          {
-          event.add(child1);
-          }
-//        else
-//          cout << "not accepted:" << childType1.getName() << endl;
-        }
-      else
-        decayParticle(event, *child1);
-
-      if (child2->isStable())
-        {
-        if (accept(*child2))
-          {
-          event.add(child2);
-          }
-//        else
-//          cout << "not accepted:" << childType2.getName() << endl;
-        }
-      else
-        decayParticle(event, *child2);
-      break;
-      }
-
-      case 3:
-      {
-      Particle * child1 = particleFactory->getNextObject();
-      Particle * child2 = particleFactory->getNextObject();
-      Particle * child3 = particleFactory->getNextObject();
-      ParticleType  & childType1 = decayMode.getChildType(0); child1->setType(&childType1); child1->setLive(true);
-      ParticleType  & childType2 = decayMode.getChildType(1); child2->setType(&childType2); child2->setLive(true);
-      ParticleType  & childType3 = decayMode.getChildType(2); child3->setType(&childType3); child3->setLive(true);
-      LorentzVector & p1 = child1->getMomentum();
-      LorentzVector & r1 = child1->getPosition();
-      LorentzVector & p2 = child2->getMomentum();
-      LorentzVector & r2 = child2->getPosition();
-      LorentzVector & p3 = child3->getMomentum();
-      LorentzVector & r3 = child3->getPosition();
-      particleDecayer.decay3(parentType,
-                             parentMomentum,
-                             parentPosition,
-                             childType1,p1,r1,
-                             childType2,p2,r2,
-                             childType3,p3,r3);
-      parent.setDecayed(true);
-      if (decayStoreDecayedParts) event.add(&parent);
-      if (child1->isStable())
-        {
-        if (accept(*child1))
-          {
-          event.add(child1);
-          }
-//        else
-//          cout << "not accepted:" << childType1.getName() << endl;
-        }
-      else
-        decayParticle(event, *child1);
-      if (child2->isStable())
-        {
-        if (accept(*child2))
-          {
-          event.add(child2);
-          }
-//        else
-//          cout << "not accepted:" << childType2.getName() << endl;
-        }
-      else
-        decayParticle(event, *child2);
-
-      if (child3->isStable())
-        {
-        if (accept(*child3))
-          {
-          event.add(child3);
-          }
-//        else
-//          cout << "not accepted:" << childType3.getName() << endl;
-        }
-      else
-        decayParticle(event, *child3);
-      break;
-      }
-
-      default:
-      case 4:
-      {
-      throw TaskException("4- or more body decay should not happen","TherminatorGenerator::createEvent()");
-
-      //        Particle * child1 = particleFactory->getNextObject();
-      //        Particle * child2 = particleFactory->getNextObject();
-      //        Particle * child3 = particleFactory->getNextObject();
-      //        Particle * child4 = particleFactory->getNextObject();
-      //        ParticleType   & childType1 = decayMode.getChildType(0); child1->setType(&childType1); child1->setLive(true);
-      //        ParticleType   & childType2 = decayMode.getChildType(1); child2->setType(&childType2); child2->setLive(true);
-      //        ParticleType   & childType3 = decayMode.getChildType(2); child3->setType(&childType3); child3->setLive(true);
-      //        ParticleType   & childType4 = decayMode.getChildType(3); child4->setType(&childType4); child4->setLive(true);
-      //        LorentzVector & p1 = child1->getMomentum();
-      //        LorentzVector & r1 = child1->getPosition();
-      //        LorentzVector & p2 = child2->getMomentum();
-      //        LorentzVector & r2 = child2->getPosition();
-      //        LorentzVector & p3 = child3->getMomentum();
-      //        LorentzVector & r3 = child3->getPosition();
-      //        LorentzVector & p4 = child4->getMomentum();
-      //        LorentzVector & r4 = child4->getPosition();
-      //        decayer.decay4(parentType,
-      //                       parentMomentum,
-      //                       parentPosition,
-      //                       childType1,p1,r1,
-      //                       childType2,p2,r2,
-      //                       childType3,p3,r3,
-      //                       childType4,p4,r4);
-      //      parent.setDecayed(true);
-      //      if (decayStoreDecayedParts) event.add(&parent);
-      //      if (child1->isStable() && accept(*child1))
-      //        event.add(child1);
-      //      else
-      //        decayParticle(event, *child1);
-      //      if (child2->isStable() && accept(*child2))
-      //        event.add(child2);
-      //      else
-      //        decayParticle(event, *child2);
-      //      if (child3->isStable() && accept(*child3))
-      //        event.add(child3);
-      //      else
-      //        decayParticle(event, *child3);
-      //      if (child4->isStable() && accept(*child4))
-      //        event.add(child4);
-      //      else
-      //        decayParticle(event, *child4);
-      //      break;
-      break;
-      }
+    for (Particle * parent : decayCascade.getDecayed()) event.add(parent);
+    }
+  for (Particle * child : decayCascade.getProduced())
+    {
+    if (child->isStable() && accept(*child)) event.add(child);
     }
 }
 
@@ -626,42 +544,152 @@ void TherminatorGenerator::printVersion(const TString & option __attribute__ ((
 }
 
 
+Model * TherminatorGenerator::createModel()
+{
+  Model * newModel = nullptr;
+  switch (modelType)
+    {
+      default:
+      throw TaskException("Unknown model requested","TherminatorGenerator::createModel()");
+      case 0:  newModel = new Model_KrakowSFO(*requestedConfiguration);   break;
+      case 1:  newModel = new Model_BlastWave(*requestedConfiguration);   break;
+      case 5:  newModel = new Model_HadronGas(*requestedConfiguration);   break;
+      case 6:  newModel = new Model_BWA(*requestedConfiguration);         break;
+      case 10: newModel = new Model_Lhyquid3D(*requestedConfiguration);   break;
+      case 11: newModel = new Model_Lhyquid2DBI(*requestedConfiguration); break;
+    };
+  newModel->setConfigurationPath(getFullTaskPath());
+  newModel->initialize();
+  return newModel;
+}
+
 void TherminatorGenerator::initializeEventGenerator()
 {
   if (reportInfo(__FUNCTION__)) printIntroMessage();
   particleDb = ParticleDb::getDefaultParticleDb();
   if (particleDb->getNumberOfTypes()<1)
     throw TaskException("Particle Database is not initialized. Waky Waky!!!!!","TherminatorGenerator::initializeEventGenerator()");
-  switch (modelType)
+  model = createModel();
+  bool cloned = averageMultiplicities.size()>0 && int(averageMultiplicities.size())==particleDb->getParticleTypeCount();
+  if (cloned)
     {
-      default:
-      throw TaskException("Unknown model requested","TherminatorGenerator::initializeEventGenerator()");
-      case 0:  model = new Model_KrakowSFO(*requestedConfiguration);   break;
-      case 1:  model = new Model_BlastWave(*requestedConfiguration);   break;
-      case 5:  model = new Model_HadronGas(*requestedConfiguration);   break;
-      case 6:  model = new Model_BWA(*requestedConfiguration);         break;
-      case 10: model = new Model_Lhyquid3D(*requestedConfiguration);   break;
-      case 11: model = new Model_Lhyquid2DBI(*requestedConfiguration); break;
-    };
-  model->setConfigurationPath(getFullTaskPath());
-  model->initialize();
-  if (multiplicitiesImport)
+    if (reportInfo(__FUNCTION__)) cout << " Using the multiplicities of the generator this one was cloned from." << endl;
+    }
+  else if (multiplicitiesImport)
     {
     importMultiplicities();
     }
   else if (multiplicitiesCreate)
     {
-    calculateMultiplicities();
+    std::lock_guard<std::mutex> lock(multiplicitiesMutex);
+    if (!multiplicitiesCache || !importCachedMultiplicities())
+      {
+      calculateMultiplicities();
+      if (multiplicitiesCache) exportCachedMultiplicities();
+      }
     }
   else
     {
     throw TaskException("Not loading or creating multiplicities","TherminatorGenerator::initializeEventGenerator()");
     }
-  if (multiplicitiesExport && !multiplicitiesImport)
+  if (multiplicitiesExport && !multiplicitiesImport && !cloned)
     {
     exportMultiplicities();
     }
   eventMultiplicities.assign(averageMultiplicities.size(),0.0);
+  vector<double> speciesMultiplicities;
+  totalAverageMultiplicity = 0.0;
+  for (auto & averageMultiplicity : averageMultiplicities)
+    {
+    speciesMultiplicities.push_back(averageMultiplicity.multiplicity);
+    totalAverageMultiplicity += averageMultiplicity.multiplicity;
+    }
+  speciesSelector.initializeWith(speciesMultiplicities);
+  initializeSamplers();
+}
+
+//!
+//!Build the adaptive sampler of each species produced (SamplingAdaptive) and reset the sampling counters. A clone keeps the samplers
+//!of the generator it was cloned from.
+//!
+void TherminatorGenerator::initializeSamplers()
+{
+  unsigned int nTypes = averageMultiplicities.size();
+  speciesTrials.assign(nTypes,0);
+  speciesAccepted.assign(nTypes,0);
+  if (!samplingAdaptive)
+    {
+    samplers.clear();
+    return;
+    }
+  if (samplers.size()==nTypes) return;
+  samplers.assign(nTypes,nullptr);
+  for (unsigned int iType=0; iType<nTypes; iType++)
+    {
+    std::shared_ptr<IntegrandSampler> sampler = std::make_shared<IntegrandSampler>();
+    samplers[iType] = sampler;
+    if (averageMultiplicities[iType].multiplicity<=0.0) continue;
+    ParticleType * particleType = particleDb->getParticleType(iType);
+    if (particleType->isPhoton() && disablePhotons) continue;
+    sampler->initialize(*model,*particleType,
+                        samplingBins,samplingIterations,samplingSamples,
+                        samplingCells,samplingCellSamples,samplingSafetyFactor);
+    }
+}
+
+//!
+//!A point exceeding the envelope of its cell is discarded: the envelope is raised and the generation restarts with the raised envelope.
+//!A sampler still shared with other generators (see clone()) is first copied, once: this generator then raises the envelopes of its
+//!own copy in place.
+//!
+long TherminatorGenerator::generateAdaptive(unsigned int iType, ParticleType & particleType)
+{
+  long   nTrials = 0;
+  int    violatedCell;
+  double violatingWeight;
+  while (true)
+    {
+    nTrials += samplers[iType]->generate(*model,particleType,violatedCell,violatingWeight);
+    if (violatedCell<0) return nTrials;
+    if (samplers[iType].use_count()>1) samplers[iType] = std::make_shared<IntegrandSampler>(*samplers[iType]);
+    samplers[iType]->raiseEnvelope(violatedCell,violatingWeight);
+    }
+}
+
+//!
+//!Print the number of points tried and accepted per species and, for adaptive samplers, the number of envelope violations.
+//!
+void TherminatorGenerator::printSamplingStatistics()
+{
+  cout << endl;
+  cout << "Sampling statistics vs. Species.................: " << (samplingAdaptive ? "adaptive" : "flat") << endl;
+  cout << endl;
+  cout << fixed << setw(5)  <<  "Index";
+  cout << fixed << setw(12) <<  "Name";
+  cout << fixed << setw(16) <<  "Tried";
+  cout << fixed << setw(16) <<  "Accepted";
+  cout << fixed << setw(16) <<  "Acceptance";
+  cout << fixed << setw(16) <<  "Expected";
+  cout << fixed << setw(16) <<  "Violations";
+  cout << endl;
+  long nViolations = 0;
+  for (unsigned int iType=0; iType<speciesTrials.size(); iType++)
+    {
+    if (speciesTrials[iType]<1) continue;
+    long violations = samplingAdaptive ? samplers[iType]->getNViolations() : 0;
+    nViolations += violations;
+    cout
+    << fixed << setw(5) <<  iType
+    << fixed << setw(12)  << particleDb->getParticleType(iType)->getName()
+    << fixed << setw(16)  << speciesTrials[iType]
+    << fixed << setw(16)  << speciesAccepted[iType]
+    << scientific << setw(16) << setprecision(4) << double(speciesAccepted[iType])/double(speciesTrials[iType])
+    << scientific << setw(16) << setprecision(4) << (samplingAdaptive ? samplers[iType]->getEfficiency() : 0.0)
+    << fixed << setw(16)  << violations << endl;
+    }
+  cout << endl;
+  if (nViolations>0 && reportWarning(__FUNCTION__))
+    cout << nViolations << " points exceeded the sampling envelope: increase SamplingSafetyFactor or SamplingCellSamples." << endl;
 }
 
 
@@ -670,12 +698,16 @@ void TherminatorGenerator::finalizeEventGenerator()
   if (reportInfo(__FUNCTION__))
     {
     cout << endl;
+    printSamplingStatistics();
     }
 
   particleDb = nullptr;
   if (model) delete model;
   averageMultiplicities.clear();
   eventMultiplicities.clear();
+  samplers.clear();
+  speciesTrials.clear();
+  speciesAccepted.clear();
 }
 
 void TherminatorGenerator::importMultiplicities()
@@ -686,6 +718,18 @@ void TherminatorGenerator::importMultiplicities()
     printItem("multiplicitiesInputPath",multiplicitiesInputPath);
     printItem("multiplicitiesInputFile",multiplicitiesInputFile);
     }
+  readMultiplicities(multiplicitiesInputPath,multiplicitiesInputFile);
+}
+
+void TherminatorGenerator::exportMultiplicities()
+{
+  // create the outputpath if it does not exist...
+  gSystem->mkdir(multiplicitiesOutputPath,1);
+  writeMultiplicities(multiplicitiesOutputPath,multiplicitiesOutputFile);
+}
+
+int TherminatorGenerator::readMultiplicities(const String & path, const String & file)
+{
   // initialize the multiplicity array
   averageMultiplicities.clear();
   int nPartTypes = particleDb->getParticleTypeCount();
@@ -700,16 +744,15 @@ void TherminatorGenerator::importMultiplicities()
     averageMultiplicities.push_back(pm);
     }
   if (reportDebug(__FUNCTION__)) cout <<" averageMultiplicities initialized -- now open and read the file" << endl;
-  ifstream & inputFile = openInputAsciiFile(multiplicitiesInputPath,multiplicitiesInputFile,".txt");
+  ifstream & inputFile = openInputAsciiFile(path,file,".txt");
+  int count = 0;
   try {
     {
-    int count = 0;
     String name;
     double integral;
     double multiplicity;
-    while (!inputFile.eof())
+    while (inputFile >> name >> integral >> multiplicity)
       {
-      inputFile >> name >> integral >> multiplicity;
       if (reportDebug(__FUNCTION__))
         {
         cout << endl;
@@ -735,26 +778,112 @@ void TherminatorGenerator::importMultiplicities()
   }
   catch (...)
   {
-  throw FileException(multiplicitiesInputFile,"Error reading multiplicity file.","TherminatorGenerator::importMultiplicities()");
+  throw FileException(file,"Error reading multiplicity file.","TherminatorGenerator::readMultiplicities()");
   }
+  return count;
 }
 
-void TherminatorGenerator::exportMultiplicities()
+void TherminatorGenerator::writeMultiplicities(const String & path, const String & file)
 {
-  // create the outputpath if it does not exist...
-  gSystem->mkdir(multiplicitiesOutputPath,1);
-  ofstream & outputFile = openOutputAsciiFile(multiplicitiesOutputPath,multiplicitiesOutputFile,".txt");
+  ofstream & outputFile = openOutputAsciiFile(path,file,".txt");
+  outputFile << setprecision(12);
   unsigned int nTypes = averageMultiplicities.size();
   for (unsigned int iType=0; iType<nTypes; iType++)
     {
     ParticleMultiplicity & pm = averageMultiplicities[iType];
     outputFile << pm.name << "    " << pm.integral << "    " << pm.multiplicity << endl;
-    //3cout  << pm.name << "    " << pm.integral << "    " << pm.multiplicity << endl;
-    //if (iType>10) exit(1);
     }
   outputFile.close();
 }
 
+String TherminatorGenerator::getMultiplicitiesCacheKey()
+{
+  ostringstream key;
+  key << "ModelType: " << modelType << endl;
+  model->printConfiguration(key);
+  key << "nSamplesIntegration: " << nSamplesIntegration << endl;
+  key << "DisablePhotons: " << disablePhotons << endl;
+  key << setprecision(17);
+  int nPartTypes = particleDb->getParticleTypeCount();
+  for (int iPartType=0; iPartType<nPartTypes; iPartType++)
+    {
+    ParticleType & type = *particleDb->getParticleType(iPartType);
+    key << type.getName()
+    << " " << type.getPdgCode()
+    << " " << type.getMass()
+    << " " << type.getWidth()
+    << " " << type.getSpin()
+    << " " << type.getStatistics()
+    << " " << type.getBaryonNumber()
+    << " " << type.getCharge()
+    << " " << type.getStrangessNumber()
+    << " " << type.getCharmNumber()
+    << " " << type.getBottomNumber()
+    << " " << type.getIsospin3() << endl;
+    }
+  String text = key.str();
+  CAP::Crc32 crc(text.Data(),text.Length());
+  return Form("%08X",crc.finish());
+}
+
+bool TherminatorGenerator::importCachedMultiplicities()
+{
+  String cacheFile = "TherminatorMultiplicities_";
+  cacheFile += getMultiplicitiesCacheKey();
+  String cacheFileName = multiplicitiesCachePath + "/" + cacheFile + ".txt";
+  if (reportInfo(__FUNCTION__))
+    {
+    cout << endl;
+    printItem("multiplicitiesCachePath",multiplicitiesCachePath);
+    printItem("multiplicitiesCacheFile",cacheFile);
+    }
+  // AccessPathName returns false if the file exists
+  if (gSystem->AccessPathName(cacheFileName))
+    {
+    if (reportInfo(__FUNCTION__)) cout << "No cached multiplicities: integrating." << endl;
+    return false;
+    }
+  int nPartTypes = particleDb->getParticleTypeCount();
+  int count = readMultiplicities(multiplicitiesCachePath,cacheFile);
+  if (count!=nPartTypes)
+    {
+    if (reportWarning(__FUNCTION__)) cout << "Cache file lists " << count << " of " << nPartTypes << " species: integrating." << endl;
+    averageMultiplicities.clear();
+    return false;
+    }
+  if (reportDebug(__FUNCTION__)) printMultiplicities();
+  return true;
+}
+
+void TherminatorGenerator::exportCachedMultiplicities()
+{
+  String cacheFile = "TherminatorMultiplicities_";
+  cacheFile += getMultiplicitiesCacheKey();
+  gSystem->mkdir(multiplicitiesCachePath,1);
+  // write a file private to this process and rename it: concurrent jobs sharing the cache never read a partial file.
+  String temporaryFile = cacheFile + Form("_%d",gSystem->GetPid());
+  String temporaryFileName = multiplicitiesCachePath + "/" + temporaryFile + ".txt";
+  gSystem->Unlink(temporaryFileName);
+  writeMultiplicities(multiplicitiesCachePath,temporaryFile);
+  if (gSystem->Rename(temporaryFileName,multiplicitiesCachePath + "/" + cacheFile + ".txt")!=0)
+    {
+    gSystem->Unlink(temporaryFileName);
+    if (reportWarning(__FUNCTION__)) cout << "Could not save cached multiplicities to: " << multiplicitiesCachePath << endl;
+    return;
+    }
+  if (reportInfo(__FUNCTION__))
+    {
+    cout << endl;
+    printItem("multiplicitiesCachePath",multiplicitiesCachePath);
+    printItem("multiplicitiesCacheFile",cacheFile);
+    }
+}
+
+//!
+//!Integrate the average multiplicity of each species. Species are shared among nThreadsIntegration threads (one per core if
+//!nThreadsIntegration is 0), each with its own model since models are not thread safe. Species iType is integrated with the random stream (integrationStreamIndex,iType)
+//!so the multiplicities do not depend on the number of threads.
+//!
 void TherminatorGenerator::calculateMultiplicities()
 {
   int nPartTypes = particleDb->getParticleTypeCount();
@@ -765,37 +894,68 @@ void TherminatorGenerator::calculateMultiplicities()
     }
   if (nPartTypes<1)
     throw TaskException("nPartTypes<1","TherminatorGenerator::calculateMultiplicities()");
-  for (int iPartType = 0; iPartType<nPartTypes; iPartType++)
-    {
-    ParticleType & particleType = *particleDb->getParticleType(iPartType);
-    double maxIntegrand  = 0.0;
-    double multiplicity  = 0.0;
-    double integrand     = 0.0;
-    ParticleMultiplicity particleMultiplicity;
-    particleMultiplicity.name         = particleType.getName();
-    if (particleType.isPhoton() && disablePhotons)
+  int nWorkers = (nThreadsIntegration>0) ? nThreadsIntegration : int(std::thread::hardware_concurrency());
+  if (nWorkers<1)          nWorkers = 1;
+  if (nWorkers>nPartTypes) nWorkers = nPartTypes;
+  if (reportInfo(__FUNCTION__))
+    {
+    cout << endl;
+    printItem("nPartTypes",nPartTypes);
+    printItem("nSamplesIntegration",nSamplesIntegration);
+    printItem("nWorkers",nWorkers);
+    }
+
+  averageMultiplicities.assign(nPartTypes,ParticleMultiplicity());
+  // models are created and initialized here, on the calling thread; the workers only evaluate integrands.
+  vector<Model*> models(nWorkers,nullptr);
+  models[0] = model;
+  for (int iWorker=1; iWorker<nWorkers; iWorker++) models[iWorker] = createModel();
+  ROOT::EnableThreadSafety();
+
+  std::atomic<int> nTypesClaimed(0);
+  vector<std::exception_ptr> exceptions(nWorkers);
+  auto run = [&](int iWorker)
+  {
+  try
+    {
+    Model & workerModel = *models[iWorker];
+    int iPartType;
+    while ((iPartType = nTypesClaimed++) < nPartTypes)
       {
+      ParticleType & particleType = *particleDb->getParticleType(iPartType);
+      ParticleMultiplicity & particleMultiplicity = averageMultiplicities[iPartType];
+      particleMultiplicity.name         = particleType.getName();
       particleMultiplicity.integral     = 0.0;
       particleMultiplicity.multiplicity = 0.0;
-      }
-    else
-      {
+      if (particleType.isPhoton() && disablePhotons) continue;
+      CAP::RandomStream::selectRandomStream(integrationStreamIndex,iPartType);
+      double maxIntegrand  = 0.0;
+      double multiplicity  = 0.0;
+      double integrand     = 0.0;
       for (int iParticle = 0; iParticle < nSamplesIntegration; iParticle++)
         {
-        integrand = model->getIntegrand(particleType);
-        //if (integrand<0.0) continue;
+        integrand = workerModel.getIntegrand(particleType);
         if (integrand>maxIntegrand) maxIntegrand = integrand;
         multiplicity += integrand;
         }
-      //multiplicity *= 1.0/ double(nSamplesIntegration);
-      //cout << "iPartType:" << iPartType << " maxIntegrand: " << maxIntegrand << " multiplicity:" << multiplicity << endl;
-      //cout << "            volume: " << model->getHyperCubeVolume() <<  " nSamplesIntegration:" << nSamplesIntegration << endl;
-      multiplicity *= model->getHyperCubeVolume() / double(nSamplesIntegration);
-      //cout << "            multiplicity: "  <<  multiplicity << endl;
+      multiplicity *= workerModel.getHyperCubeVolume() / double(nSamplesIntegration);
       particleMultiplicity.integral     = maxIntegrand;
       particleMultiplicity.multiplicity = multiplicity;
       }
-    averageMultiplicities.push_back(particleMultiplicity);
+    }
+  catch (...)
+    {
+    exceptions[iWorker] = std::current_exception();
+    }
+  };
+  // the workers run on their own threads so the random stream of the calling thread is left untouched.
+  vector<std::thread> threads;
+  for (int iWorker=0; iWorker<nWorkers; iWorker++) threads.emplace_back(run,iWorker);
+  for (auto & thread : threads) thread.join();
+  for (int iWorker=1; iWorker<nWorkers; iWorker++) delete models[iWorker];
+  for (auto & exception : exceptions)
+    {
+    if (exception) std::rethrow_exception(exception);
     }
   if (reportDebug(__FUNCTION__)) printMultiplicities();
 }
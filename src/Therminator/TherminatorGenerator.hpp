@@ -28,10 +28,13 @@
 #ifndef _TH2_TherminatorGenerator_
 #define _TH2_TherminatorGenerator_
 #include <fstream>
+#include <memory>
 #include <TString.h>
 #include "THGlobal.hpp"
 #include "ParticleDb.hpp"
-#include "ParticleDecayer.hpp"
+#include "SelectionGenerator.hpp"
+#include "ParticleDecayCascade.hpp"
+#include "IntegrandSampler.hpp"
 #include "EventTask.hpp"
 #include "Model.hpp"
 #include "Hypersurface.hpp"
@@ -46,7 +49,7 @@ using CAP::Particle;
 using CAP::ParticleDb;
 using CAP::ParticleType;
 using CAP::ParticleDecayMode;
-using CAP::ParticleDecayer;
+using CAP::ParticleDecayCascade;
 using CAP::ParticleFilter;
 using CAP::TaskException;
 using CAP::FileException;
@@ -69,6 +72,11 @@ public:
 
   virtual  ~TherminatorGenerator(){};
 
+  //!
+  //! Returns a configured clone of this task used for multithreaded execution.
+  //!
+  virtual Task * clone() const;
+
   virtual void initializeEventGenerator() ;   // throw (TaskException);
   virtual void finalizeEventGenerator();
   virtual void setDefaultConfiguration();
@@ -77,7 +85,39 @@ public:
   virtual void importMultiplicities()  ;   // throw (FileException);
   virtual void calculateMultiplicities();
   virtual void exportMultiplicities();
+
+  //!
+  //! Read the multiplicities of the species of the particle db from the given file. Returns the number of species read.
+  //!
+  virtual int  readMultiplicities(const String & path, const String & file);
+  virtual void writeMultiplicities(const String & path, const String & file);
+
+  //!
+  //! Key of the multiplicities cache: CRC32 hash of the model type and configuration, of the properties of the species
+  //! of the particle db, and of the integration parameters. The seed is not part of the key: multiplicities integrated with
+  //! different seeds are statistically equivalent.
+  //!
+  virtual String getMultiplicitiesCacheKey();
+
+  //!
+  //! Load the multiplicities from the cache file of the current key (MultiplicitiesCachePath). Returns false if there is no
+  //! such file or if it does not list all the species of the particle db.
+  //!
+  virtual bool importCachedMultiplicities();
+  virtual void exportCachedMultiplicities();
+
+  //!
+  //! Create, configure and initialize a new model of the requested type.
+  //!
+  virtual Model * createModel();
   virtual void printMultiplicities();
+  virtual void initializeSamplers();
+  virtual void printSamplingStatistics();
+
+  //!
+  //! Generate a point of the given species with its adaptive sampler. Returns the number of points tried.
+  //!
+  long generateAdaptive(unsigned int iType, ParticleType & particleType);
 
   virtual void printIntroMessage(const TString & option="")  const;
   virtual void printHelp(const TString & option="") const;
@@ -90,7 +130,7 @@ public:
 
   bool accept(Particle & parent);
 
-  virtual void decayParticle(Event & event, Particle & parent);
+  virtual void decayParticles(Event & event, vector<Particle*> & particles);
 
 //  virtual void createHistograms();
 //  virtual void importHistograms(TFile & inputFile);
@@ -117,7 +157,7 @@ protected:
   bool   multiplicitiesImport;
   bool   multiplicitiesExport;
   bool   multiplicitiesCreate;
-  int    multiplicitiesFluctType;
+  int    multiplicitiesFluctType;  //!< 0: Poisson, 1: negative binomial (not implemented), 2: Gaussian, 3: Poisson or Gaussian, 4: Poisson total with sampled species
   String multiplicitiesInputPath;
   String multiplicitiesInputFile;
   String multiplicitiesOutputPath;
@@ -130,6 +170,9 @@ protected:
  // int eventsExportMaxPerFile;
   bool   disablePhotons;
   int    nSamplesIntegration;
+  int    nThreadsIntegration;   //!< number of threads used to integrate the multiplicities (default 1, 0: one per core)
+  bool   multiplicitiesCache;   //!< load the multiplicities from, or save them to, the cache (MultiplicitiesCreate)
+  String multiplicitiesCachePath;
   bool   modelOnlyBackFlow;
   bool   decayRescaleChannels;
   bool   decayDisabled;
@@ -137,12 +180,24 @@ protected:
   bool   decayDisable3Prong;
   bool   decayNoWeakDecay;
   bool   decayStoreDecayedParts;
+  bool   samplingAdaptive;      //!< generate momenta and positions with adaptive importance samplers rather than flat accept/reject
+  int    samplingBins;          //!< number of bins per dimension of the adaptive samplers
+  int    samplingIterations;    //!< number of adaptation passes of the adaptive samplers
+  int    samplingSamples;       //!< number of points per adaptation pass
+  int    samplingCells;         //!< number of cells of the adaptive samplers
+  int    samplingCellSamples;   //!< number of points used to set the envelope of each cell
+  double samplingSafetyFactor;  //!< factor applied to the largest weight found to set the envelope of the adaptive samplers
 
-  ParticleDecayer particleDecayer;
+  ParticleDecayCascade decayCascade;
   Model           * model;
   Event           * event;
   vector<ParticleMultiplicity> averageMultiplicities;
   vector<int> eventMultiplicities;
+  SelectionGenerator speciesSelector;  //!< species of the particles of an event, in proportion to their average multiplicity (MultiplicitiesFluctType 4)
+  double totalAverageMultiplicity;
+  vector< std::shared_ptr<IntegrandSampler> > samplers; //!< one sampler per species (SamplingAdaptive), shared with the clones until its envelope is raised
+  vector<long>             speciesTrials;   //!< number of points tried, per species
+  vector<long>             speciesAccepted; //!< number of points accepted, per species
 
 
 //  TTree*  thParameterTree;
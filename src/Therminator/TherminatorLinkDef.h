@@ -9,6 +9,7 @@
 #pragma link C++ class Hypersurface+;
 #pragma link C++ class Hypersurface_Lhyquid2D+;
 #pragma link C++ class Hypersurface_Lhyquid3D+;
+#pragma link C++ class IntegrandSampler+;
 #pragma link C++ class Model+;
 #pragma link C++ class Model_BWA+;
 #pragma link C++ class Model_BlastWave+;